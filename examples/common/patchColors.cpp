@@ -27,11 +27,12 @@
 
 float const * getAdaptivePatchColor(OpenSubdiv::OsdDrawContext::PatchDescriptor const & desc) {
 
-    static float _colors[4][5][4] = {{{1.0f,  1.0f,  1.0f,  1.0f},   // regular
+    static float _colors[7][6][4] = {{{1.0f,  1.0f,  1.0f,  1.0f},   // regular
                                       {0.8f,  0.0f,  0.0f,  1.0f},   // boundary
                                       {0.0f,  1.0f,  0.0f,  1.0f},   // corner
                                       {1.0f,  1.0f,  0.0f,  1.0f},   // gregory
-                                      {1.0f,  0.5f,  0.0f,  1.0f}},  // gregory boundary
+                                      {1.0f,  0.5f,  0.0f,  1.0f},   // gregory boundary
+                                      {1.0f,  0.7f,  0.6f,  1.0f}},  // single crease
 
                                      {{0.0f,  1.0f,  1.0f,  1.0f},   // regular pattern 0
                                       {0.0f,  0.5f,  1.0f,  1.0f},   // regular pattern 1
@@ -49,7 +50,25 @@ float const * getAdaptivePatchColor(OpenSubdiv::OsdDrawContext::PatchDescriptor
                                       {0.25f, 0.25f, 0.25f, 1.0f},   // corner pattern 1
                                       {0.25f, 0.25f, 0.25f, 1.0f},   // corner pattern 2
                                       {0.25f, 0.25f, 0.25f, 1.0f},   // corner pattern 3
-                                      {0.25f, 0.25f, 0.25f, 1.0f}}}; // corner pattern 4
+                                      {0.25f, 0.25f, 0.25f, 1.0f}},  // corner pattern 4
+
+                                     {{0.0f,  0.0f,  0.0f,  1.0f},   // gregory transition
+                                      {0.0f,  0.0f,  0.0f,  1.0f},   // (unused)
+                                      {0.0f,  0.0f,  0.0f,  1.0f},
+                                      {0.0f,  0.0f,  0.0f,  1.0f},
+                                      {0.0f,  0.0f,  0.0f,  1.0f}},
+
+                                     {{0.0f,  0.0f,  0.0f,  1.0f},   // gregory boundary transition
+                                      {0.0f,  0.0f,  0.0f,  1.0f},   // (unused)
+                                      {0.0f,  0.0f,  0.0f,  1.0f},
+                                      {0.0f,  0.0f,  0.0f,  1.0f},
+                                      {0.0f,  0.0f,  0.0f,  1.0f}},
+
+                                     {{1.0f,  0.5f,  0.4f,  1.0f},   // single crease pattern 0
+                                      {1.0f,  0.5f,  0.4f,  1.0f},   // single crease pattern 1
+                                      {1.0f,  0.5f,  0.4f,  1.0f},   // single crease pattern 2
+                                      {1.0f,  0.5f,  0.4f,  1.0f},   // single crease pattern 3
+                                      {1.0f,  0.5f,  0.4f,  1.0f}}}; // single crease pattern 4
 
     typedef OpenSubdiv::FarPatchTables FPT;
 
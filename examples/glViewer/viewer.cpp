@@ -1225,7 +1225,7 @@ display() {
     OpenSubdiv::OsdDrawContext::PatchArrayVector const & patches = g_mesh->GetDrawContext()->patchArrays;
 
     // patch drawing
-    int patchCount[11][6][4]; // [Type][Pattern][Rotation] (see far/patchTables.h)
+    int patchCount[12][6][4]; // [Type][Pattern][Rotation] (see far/patchTables.h)
     memset(patchCount, 0, sizeof(patchCount));
 
     // primitive counting
@@ -29,6 +29,7 @@
 #include "../version.h"
 
 #include "../far/bilinearSubdivisionTables.h"
+#include "../far/kernelBatchFactory.h"
 #include "../far/meshFactory.h"
 #include "../far/subdivisionTablesFactory.h"
 
@@ -67,6 +68,8 @@ template <class T, class U> FarBilinearSubdivisionTables<U> *
 FarBilinearSubdivisionTablesFactory<T,U>::Create( FarMeshFactory<T,U> * meshFactory, FarMesh<U> * farMesh, FarKernelBatchVector * batches ) {
 
     assert( meshFactory and farMesh );
+
+    FarFactoryStats::Scope scope("FarBilinearSubdivisionTablesFactory::Create");
      
     int maxlevel = meshFactory->GetMaxLevel();
     
@@ -109,16 +112,10 @@ FarBilinearSubdivisionTablesFactory<T,U>::Create( FarMeshFactory<T,U> * meshFact
         // Face vertices
         // "For each vertex, gather all the vertices from the parent face."
         int nFaceVertices = (int)tablesFactory._faceVertsList[level].size();
-        if (nFaceVertices > 0)
-            batches->push_back(FarKernelBatch( FarKernelBatch::BILINEAR_FACE_VERTEX,
-                                               level,
-                                               /*tableIndex=*/0,
-                                               /*start=*/0,
-                                               /*end=*/nFaceVertices,
-                                               faceTableOffset,
-                                               vertexOffset) );
-        vertexOffset += nFaceVertices;
-        faceTableOffset += nFaceVertices;
+
+        // face vertices are sorted by valence : add a batch for each run of
+        // faces with the same number of vertices
+        FarValenceRuns faceRuns;
 
         for (int i=0; i < nFaceVertices; ++i) {
 
@@ -135,9 +132,17 @@ FarBilinearSubdivisionTablesFactory<T,U>::Create( FarMeshFactory<T,U> * meshFact
 
             for (int j=0; j<valence; ++j)
                 F_IT[F_IT_offset++] = remap[f->GetVertex(j)->GetID()];
+
+            faceRuns.AddVertex(i, valence);
         }
         F_ITa += nFaceVertices*2;
 
+        faceRuns.AppendBatches(FarKernelBatch::BILINEAR_FACE_VERTEX, level,
+                               faceTableOffset, vertexOffset, batches);
+
+        vertexOffset += nFaceVertices;
+        faceTableOffset += nFaceVertices;
+
         // Edge vertices
 
         // "Average the end-points of the parent edge"
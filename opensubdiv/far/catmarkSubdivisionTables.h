@@ -73,6 +73,10 @@ private:
     // Kernel "B" Handles the k_Crease and k_Corner rules
     void computeVertexPointsB(int offset, int level, int start, int end, void * clientdata) const;
 
+    // Compute-kernel applied to the face, edge and vertex vertices of the
+    // structured grids [start, end[
+    void computeStructuredGrids(int start, int end, void * clientdata) const;
+
 };
 
 template <class U>
@@ -224,6 +228,94 @@ FarCatmarkSubdivisionTables<U>::computeVertexPointsB( int offset, int tableOffse
     }
 }
 
+//
+// Structured grids compute Kernel - completely re-entrant
+//
+
+// the grids only cover smooth regular regions : all the weights are constant
+template <class U> void
+FarCatmarkSubdivisionTables<U>::computeStructuredGrids( int start, int end, void * clientdata ) const {
+
+    assert(this->_mesh);
+
+    FarStructuredGrids const & structuredGrids = this->_structuredGrids;
+
+    FarStructuredGrids::Grid const * grids = &structuredGrids.GetGrids().at(0);
+    int const * indices = &structuredGrids.GetIndices().at(0);
+
+    U * vsrc = &this->_mesh->GetVertices().at(0);
+
+    for (int i=start; i<end; ++i) {
+
+        FarStructuredGrids::Grid const & g = grids[i];
+        int w = g.width,
+            h = g.height;
+
+#define PARENT(x,y) vsrc[ FarStructuredGrids::GetParentVertex(grids, indices, i, (x), (y)) ]
+#define FACE(x,y) vsrc[ g.faceOffset + (y)*w + (x) ]
+
+        // face-vertices
+        for (int y=0; y<h; ++y)
+            for (int x=0; x<w; ++x) {
+                U & dst = FACE(x,y);
+                dst.Clear(clientdata);
+                dst.AddWithWeight( PARENT(x,  y  ), 0.25f, clientdata );
+                dst.AddWithWeight( PARENT(x+1,y  ), 0.25f, clientdata );
+                dst.AddWithWeight( PARENT(x+1,y+1), 0.25f, clientdata );
+                dst.AddWithWeight( PARENT(x,  y+1), 0.25f, clientdata );
+                dst.AddVaryingWithWeight( PARENT(x,  y  ), 0.25f, clientdata );
+                dst.AddVaryingWithWeight( PARENT(x+1,y  ), 0.25f, clientdata );
+                dst.AddVaryingWithWeight( PARENT(x+1,y+1), 0.25f, clientdata );
+                dst.AddVaryingWithWeight( PARENT(x,  y+1), 0.25f, clientdata );
+            }
+
+        // edge-vertices along u
+        for (int y=1; y<h; ++y)
+            for (int x=0; x<w; ++x) {
+                U & dst = vsrc[ g.hEdgeOffset + (y-1)*w + x ];
+                dst.Clear(clientdata);
+                dst.AddWithWeight( PARENT(x,  y), 0.25f, clientdata );
+                dst.AddWithWeight( PARENT(x+1,y), 0.25f, clientdata );
+                dst.AddWithWeight( FACE(x,y-1), 0.25f, clientdata );
+                dst.AddWithWeight( FACE(x,y  ), 0.25f, clientdata );
+                dst.AddVaryingWithWeight( PARENT(x,  y), 0.5f, clientdata );
+                dst.AddVaryingWithWeight( PARENT(x+1,y), 0.5f, clientdata );
+            }
+
+        // edge-vertices along v
+        for (int y=0; y<h; ++y)
+            for (int x=1; x<w; ++x) {
+                U & dst = vsrc[ g.vEdgeOffset + y*(w-1) + x-1 ];
+                dst.Clear(clientdata);
+                dst.AddWithWeight( PARENT(x,y  ), 0.25f, clientdata );
+                dst.AddWithWeight( PARENT(x,y+1), 0.25f, clientdata );
+                dst.AddWithWeight( FACE(x-1,y), 0.25f, clientdata );
+                dst.AddWithWeight( FACE(x,  y), 0.25f, clientdata );
+                dst.AddVaryingWithWeight( PARENT(x,y  ), 0.5f, clientdata );
+                dst.AddVaryingWithWeight( PARENT(x,y+1), 0.5f, clientdata );
+            }
+
+        // vertex-vertices (valence 4 k_Smooth rule)
+        for (int y=1; y<h; ++y)
+            for (int x=1; x<w; ++x) {
+                U & dst = vsrc[ g.vertOffset + (y-1)*(w-1) + x-1 ];
+                dst.Clear(clientdata);
+                dst.AddWithWeight( PARENT(x,y), 0.5f, clientdata );
+                dst.AddWithWeight( PARENT(x+1,y), 0.0625f, clientdata );
+                dst.AddWithWeight( PARENT(x,y+1), 0.0625f, clientdata );
+                dst.AddWithWeight( PARENT(x-1,y), 0.0625f, clientdata );
+                dst.AddWithWeight( PARENT(x,y-1), 0.0625f, clientdata );
+                dst.AddWithWeight( FACE(x,  y  ), 0.0625f, clientdata );
+                dst.AddWithWeight( FACE(x-1,y  ), 0.0625f, clientdata );
+                dst.AddWithWeight( FACE(x-1,y-1), 0.0625f, clientdata );
+                dst.AddWithWeight( FACE(x,  y-1), 0.0625f, clientdata );
+                dst.AddVaryingWithWeight( PARENT(x,y), 1.0f, clientdata );
+            }
+#undef FACE
+#undef PARENT
+    }
+}
+
 } // end namespace OPENSUBDIV_VERSION
 using namespace OPENSUBDIV_VERSION;
 
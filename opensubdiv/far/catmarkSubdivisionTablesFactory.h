@@ -59,6 +59,18 @@ protected:
     ///                     will reserve and append refinement tasks
     ///
     static FarCatmarkSubdivisionTables<U> * Create( FarMeshFactory<T,U> * meshFactory, FarMesh<U> * farMesh, FarKernelBatchVector *batches  );
+
+    // Computes the indices and weights of the edge vertex v (4 E_IT indices
+    // and 2 E_W weights)
+    static void computeEdgeVertex( HbrVertex<T> * v, std::vector<int> const & remap,
+                                   typename HbrCatmarkSubdivision<T>::TriangleSubdivision triangleMethod,
+                                   int * E_IT, float * E_W );
+
+    // Computes the indices and weight of the vertex vertex v (5 V_ITa entries
+    // and 1 V_W weight) : V_ITa[0] must be set to the offset of its ring in the
+    // V_IT table. Returns the rank of the vertex (see GetMaskRanking).
+    static int computeVertexVertex( HbrVertex<T> * v, std::vector<int> const & remap,
+                                    int * V_ITa, unsigned int * V_IT, float * V_W );
 };
 
 // This factory walks the Hbr vertices and accumulates the weights and adjacency
@@ -69,29 +81,47 @@ FarCatmarkSubdivisionTablesFactory<T,U>::Create( FarMeshFactory<T,U> * meshFacto
 
     assert( meshFactory and farMesh );
 
+    FarFactoryStats::Scope scope("FarCatmarkSubdivisionTablesFactory::Create");
+
     int maxlevel = meshFactory->GetMaxLevel();
     
     std::vector<int> & remap = meshFactory->getRemappingTable();
     
-    FarSubdivisionTablesFactory<T,U> tablesFactory( meshFactory->GetHbrMesh(), maxlevel, remap );
+    // The regular regions of the mesh are optionally refined by structured
+    // grids : the vertices they compute have no entries in the indexing tables
+    FarStructuredGridsFactory<T,U> * gridsFactory = meshFactory->_structuredGrids ?
+        new FarStructuredGridsFactory<T,U>( meshFactory->GetHbrMesh(), maxlevel ) : 0;
+
+    FarSubdivisionTablesFactory<T,U> tablesFactory( meshFactory->GetHbrMesh(), maxlevel, remap, gridsFactory );
 
     FarCatmarkSubdivisionTables<U> * result = new FarCatmarkSubdivisionTables<U>(farMesh, maxlevel);
 
+    int nGridFaceVertices = gridsFactory ? gridsFactory->GetNumFaceVerticesTotal() : 0,
+        nGridEdgeVertices = gridsFactory ? gridsFactory->GetNumEdgeVerticesTotal() : 0,
+        nGridVertVertices = gridsFactory ? gridsFactory->GetNumVertexVerticesTotal() : 0;
+
     // Allocate memory for the indexing tables
-    result->_F_ITa.resize(tablesFactory.GetNumFaceVerticesTotal(maxlevel)*2);
+    result->_F_ITa.resize((tablesFactory.GetNumFaceVerticesTotal(maxlevel) - nGridFaceVertices)*2);
     result->_F_IT.resize(tablesFactory.GetFaceVertsValenceSum());
 
-    result->_E_IT.resize(tablesFactory.GetNumEdgeVerticesTotal(maxlevel)*4);
-    result->_E_W.resize(tablesFactory.GetNumEdgeVerticesTotal(maxlevel)*2);
+    result->_E_IT.resize((tablesFactory.GetNumEdgeVerticesTotal(maxlevel) - nGridEdgeVertices)*4);
+    result->_E_W.resize((tablesFactory.GetNumEdgeVerticesTotal(maxlevel) - nGridEdgeVertices)*2);
 
     result->_V_ITa.resize((tablesFactory.GetNumVertexVerticesTotal(maxlevel)
-                           - tablesFactory.GetNumVertexVerticesTotal(0))*5); // subtract corase cage vertices
+                           - tablesFactory.GetNumVertexVerticesTotal(0)
+                           - nGridVertVertices)*5); // subtract corase cage vertices
     result->_V_IT.resize(tablesFactory.GetVertVertsValenceSum()*2);
     result->_V_W.resize(tablesFactory.GetNumVertexVerticesTotal(maxlevel)
-                        - tablesFactory.GetNumVertexVerticesTotal(0));
+                        - tablesFactory.GetNumVertexVerticesTotal(0)
+                        - nGridVertVertices);
+
+    if (gridsFactory)
+        gridsFactory->Create(remap, &result->_structuredGrids);
 
     // Prepare batch table
-    batches->reserve(maxlevel*5);
+    batches->reserve(maxlevel*(gridsFactory ? 6 : 5));
+
+    int gridOffset = 0;
 
     int vertexOffset = 0;
     int F_IT_offset = 0;
@@ -115,26 +145,36 @@ FarCatmarkSubdivisionTablesFactory<T,U>::Create( FarMeshFactory<T,U> * meshFacto
             (int)tablesFactory._vertVertsList[level-1].size();
         result->_vertsOffsets[level] = vertexOffset;
 
-        // Face vertices
-        // "For each vertex, gather all the vertices from the parent face."
-        int nFaceVertices = (int)tablesFactory._faceVertsList[level].size();
+        // Structured grids : a single batch computes the face, edge and vertex
+        // vertices of all the grids of the level, before the other kernels
+        int nGrids = gridsFactory ? gridsFactory->GetNumGrids(level) : 0,
+            nGridFaces = gridsFactory ? (int)gridsFactory->GetFaceVertices(level).size() : 0,
+            nGridEdges = gridsFactory ? (int)gridsFactory->GetEdgeVertices(level).size() : 0,
+            nGridVerts = gridsFactory ? (int)gridsFactory->GetVertexVertices(level).size() : 0;
 
-        // add a batch for face vertices
-        if (nFaceVertices > 0)  // in torus case, nfacevertices could be zero
-            batches->push_back(FarKernelBatch( FarKernelBatch::CATMARK_FACE_VERTEX,
+        if (nGrids > 0)
+            batches->push_back(FarKernelBatch( FarKernelBatch::CATMARK_STRUCTURED_GRID,
                                                level,
                                                0,
+                                               gridOffset,
+                                               gridOffset + nGrids,
                                                0,
-                                               nFaceVertices,
-                                               faceTableOffset,
-                                               vertexOffset) );
+                                               0) );
+        gridOffset += nGrids;
 
-        vertexOffset += nFaceVertices;
-        faceTableOffset += nFaceVertices;
+        // Face vertices
+        // "For each vertex, gather all the vertices from the parent face."
+        vertexOffset += nGridFaces;
+        int nFaceVertices = (int)tablesFactory._faceVertsList[level].size() - nGridFaces;
+
+        // face vertices are sorted by valence : add a batch for each run of
+        // faces with the same number of vertices (in torus case, nfacevertices
+        // could be zero)
+        FarValenceRuns faceRuns;
 
         for (int i=0; i < nFaceVertices; ++i) {
 
-            HbrVertex<T> * v = tablesFactory._faceVertsList[level][i];
+            HbrVertex<T> * v = tablesFactory._faceVertsList[level][nGridFaces+i];
             assert(v);
 
             HbrFace<T> * f=v->GetParentFace();
@@ -147,9 +187,17 @@ FarCatmarkSubdivisionTablesFactory<T,U>::Create( FarMeshFactory<T,U> * meshFacto
 
             for (int j=0; j<valence; ++j)
                 F_IT[F_IT_offset++] = remap[f->GetVertex(j)->GetID()];
+
+            faceRuns.AddVertex(i, valence);
         }
         F_ITa += nFaceVertices * 2;
 
+        faceRuns.AppendBatches(FarKernelBatch::CATMARK_FACE_VERTEX, level,
+                               faceTableOffset, vertexOffset, batches);
+
+        vertexOffset += nFaceVertices;
+        faceTableOffset += nFaceVertices;
+
         // Edge vertices
 
         // Triangular interpolation mode :
@@ -160,7 +208,8 @@ FarCatmarkSubdivisionTablesFactory<T,U>::Create( FarMeshFactory<T,U> * meshFacto
         // "For each vertex, gather the 2 vertices from the parent edege and the
         // 2 child vertices from the faces to the left and right of that edge.
         // Adjust if edge has a crease or is on a boundary."
-        int nEdgeVertices = (int)tablesFactory._edgeVertsList[level].size();
+        vertexOffset += nGridEdges;
+        int nEdgeVertices = (int)tablesFactory._edgeVertsList[level].size() - nGridEdges;
 
         // add a batch for edge vertices
         if (nEdgeVertices > 0)
@@ -177,168 +226,199 @@ FarCatmarkSubdivisionTablesFactory<T,U>::Create( FarMeshFactory<T,U> * meshFacto
 
         for (int i=0; i < nEdgeVertices; ++i) {
 
-            HbrVertex<T> * v = tablesFactory._edgeVertsList[level][i];
+            HbrVertex<T> * v = tablesFactory._edgeVertsList[level][nGridEdges+i];
             assert(v);
-            HbrHalfedge<T> * e = v->GetParentEdge();
-            assert(e);
 
-            float esharp = e->GetSharpness();
+            computeEdgeVertex(v, remap, triangleMethod, E_IT+4*i, E_W+2*i);
+        }
+        E_IT += 4 * nEdgeVertices;
+        E_W += 2 * nEdgeVertices;
 
-            // get the indices 2 vertices from the parent edge
-            E_IT[4*i+0] = remap[e->GetOrgVertex()->GetID()];
-            E_IT[4*i+1] = remap[e->GetDestVertex()->GetID()];
+        // Vertex vertices
 
-            float faceWeight=0.5f, vertWeight=0.5f;
+        vertexOffset += nGridVerts;
+        int nVertVertices = (int)tablesFactory._vertVertsList[level].size() - nGridVerts;
 
-            // in the case of a fractional sharpness, set the adjacent faces vertices
-            if (!e->IsBoundary() && esharp <= 1.0f) {
+        FarVertexKernelBatchFactory batchFactory;
 
-                float leftWeight, rightWeight;
-                HbrFace<T>* rf = e->GetRightFace();
-                HbrFace<T>* lf = e->GetLeftFace();
+        for (int i=0; i < nVertVertices; ++i) {
 
-                leftWeight = ( triangleMethod == HbrCatmarkSubdivision<T>::k_New && lf->GetNumVertices() == 3) ? HBR_SMOOTH_TRI_EDGE_WEIGHT : 0.25f;
-                rightWeight = ( triangleMethod == HbrCatmarkSubdivision<T>::k_New && rf->GetNumVertices() == 3) ? HBR_SMOOTH_TRI_EDGE_WEIGHT : 0.25f;
+            HbrVertex<T> * v = tablesFactory._vertVertsList[level][nGridVerts+i];
+            assert(v);
 
-                faceWeight = 0.5f * (leftWeight + rightWeight);
-                vertWeight = 0.5f * (1.0f - 2.0f * faceWeight);
+            V_ITa[5*i+0] = V_IT_offset;
 
-                faceWeight *= (1.0f - esharp);
+            int rank = computeVertexVertex(v, remap, V_ITa+5*i, V_IT, V_W+i);
 
-                vertWeight = 0.5f * esharp + (1.0f - esharp) * vertWeight;
+            if (V_ITa[5*i+1] > 0)
+                V_IT_offset += 2*V_ITa[5*i+1];
 
-                E_IT[4*i+2] = remap[lf->Subdivide()->GetID()];
-                E_IT[4*i+3] = remap[rf->Subdivide()->GetID()];
-            } else {
-                E_IT[4*i+2] = -1;
-                E_IT[4*i+3] = -1;
-            }
-            E_W[2*i+0] = vertWeight;
-            E_W[2*i+1] = faceWeight;
+            batchFactory.AddVertex( i, rank, V_ITa[5*i+1] );
         }
-        E_IT += 4 * nEdgeVertices;
-        E_W += 2 * nEdgeVertices;
+        V_ITa += nVertVertices*5;
+        V_W += nVertVertices;
 
-        // Vertex vertices
+        // add batches for vert vertices
+        if (nVertVertices > 0)
+            batchFactory.AppendCatmarkBatches(level, vertTableOffset, vertexOffset, batches);
+        vertexOffset += nVertVertices;
+        vertTableOffset += nVertVertices;
+    }
+    result->_vertsOffsets[maxlevel+1] = vertexOffset;
 
-        FarVertexKernelBatchFactory batchFactory((int)tablesFactory._vertVertsList[level].size(), 0);
+    delete gridsFactory;
 
-        int nVertVertices = (int)tablesFactory._vertVertsList[level].size();
-        for (int i=0; i < nVertVertices; ++i) {
+    return result;
+}
 
-            HbrVertex<T> * v = tablesFactory._vertVertsList[level][i],
-                         * pv = v->GetParentVertex();
-            assert(v and pv);
-
-            // Look at HbrCatmarkSubdivision<T>::Subdivide for more details about
-            // the multi-pass interpolation
-            unsigned char masks[2];
-            int npasses;
-            float weights[2];
-            masks[0] = pv->GetMask(false);
-            masks[1] = pv->GetMask(true);
-
-            // If the masks are identical, only a single pass is necessary. If the
-            // vertex is transitioning to another rule, two passes are necessary,
-            // except when transitioning from k_Dart to k_Smooth : the same
-            // compute kernel is applied twice. Combining this special case allows
-            // to batch the compute kernels into fewer calls.
-            if (masks[0] != masks[1] and (
-                not (masks[0]==HbrVertex<T>::k_Smooth and
-                     masks[1]==HbrVertex<T>::k_Dart))) {
-                weights[1] = pv->GetFractionalMask();
-                weights[0] = 1.0f - weights[1];
-                npasses = 2;
-            } else {
-                weights[0] = 1.0f;
-                weights[1] = 0.0f;
-                npasses = 1;
-            }
+template <class T, class U> void
+FarCatmarkSubdivisionTablesFactory<T,U>::computeEdgeVertex( HbrVertex<T> * v, std::vector<int> const & remap,
+                                                            typename HbrCatmarkSubdivision<T>::TriangleSubdivision triangleMethod,
+                                                            int * E_IT, float * E_W ) {
 
-            int rank = FarSubdivisionTablesFactory<T,U>::GetMaskRanking(masks[0], masks[1]);
+    HbrHalfedge<T> * e = v->GetParentEdge();
+    assert(e);
 
-            V_ITa[5*i+0] = V_IT_offset;
-            V_ITa[5*i+1] = 0;
-            V_ITa[5*i+2] = remap[ pv->GetID() ];
-            V_ITa[5*i+3] = -1;
-            V_ITa[5*i+4] = -1;
+    float esharp = e->GetSharpness();
+
+    // get the indices 2 vertices from the parent edge
+    E_IT[0] = remap[e->GetOrgVertex()->GetID()];
+    E_IT[1] = remap[e->GetDestVertex()->GetID()];
+
+    float faceWeight=0.5f, vertWeight=0.5f;
+
+    // in the case of a fractional sharpness, set the adjacent faces vertices
+    if (!e->IsBoundary() && esharp <= 1.0f) {
+
+        float leftWeight, rightWeight;
+        HbrFace<T>* rf = e->GetRightFace();
+        HbrFace<T>* lf = e->GetLeftFace();
+
+        leftWeight = ( triangleMethod == HbrCatmarkSubdivision<T>::k_New && lf->GetNumVertices() == 3) ? HBR_SMOOTH_TRI_EDGE_WEIGHT : 0.25f;
+        rightWeight = ( triangleMethod == HbrCatmarkSubdivision<T>::k_New && rf->GetNumVertices() == 3) ? HBR_SMOOTH_TRI_EDGE_WEIGHT : 0.25f;
+
+        faceWeight = 0.5f * (leftWeight + rightWeight);
+        vertWeight = 0.5f * (1.0f - 2.0f * faceWeight);
+
+        faceWeight *= (1.0f - esharp);
+
+        vertWeight = 0.5f * esharp + (1.0f - esharp) * vertWeight;
+
+        E_IT[2] = remap[lf->Subdivide()->GetID()];
+        E_IT[3] = remap[rf->Subdivide()->GetID()];
+    } else {
+        E_IT[2] = -1;
+        E_IT[3] = -1;
+    }
+    E_W[0] = vertWeight;
+    E_W[1] = faceWeight;
+}
+
+template <class T, class U> int
+FarCatmarkSubdivisionTablesFactory<T,U>::computeVertexVertex( HbrVertex<T> * v, std::vector<int> const & remap,
+                                                              int * V_ITa, unsigned int * V_IT, float * V_W ) {
+
+    HbrVertex<T> * pv = v->GetParentVertex();
+    assert(pv);
+
+    int offset = V_ITa[0];
+
+    // Look at HbrCatmarkSubdivision<T>::Subdivide for more details about
+    // the multi-pass interpolation
+    unsigned char masks[2];
+    int npasses;
+    float weights[2];
+    masks[0] = pv->GetMask(false);
+    masks[1] = pv->GetMask(true);
+
+    // If the masks are identical, only a single pass is necessary. If the
+    // vertex is transitioning to another rule, two passes are necessary,
+    // except when transitioning from k_Dart to k_Smooth : the same
+    // compute kernel is applied twice. Combining this special case allows
+    // to batch the compute kernels into fewer calls.
+    if (masks[0] != masks[1] and (
+        not (masks[0]==HbrVertex<T>::k_Smooth and
+             masks[1]==HbrVertex<T>::k_Dart))) {
+        weights[1] = pv->GetFractionalMask();
+        weights[0] = 1.0f - weights[1];
+        npasses = 2;
+    } else {
+        weights[0] = 1.0f;
+        weights[1] = 0.0f;
+        npasses = 1;
+    }
+
+    int rank = FarSubdivisionTablesFactory<T,U>::GetMaskRanking(masks[0], masks[1]);
+
+    V_ITa[1] = 0;
+    V_ITa[2] = remap[ pv->GetID() ];
+    V_ITa[3] = -1;
+    V_ITa[4] = -1;
 
-            for (int p=0; p<npasses; ++p)
-                switch (masks[p]) {
-                    case HbrVertex<T>::k_Smooth :
-                    case HbrVertex<T>::k_Dart : {
-                        HbrHalfedge<T> *e = pv->GetIncidentEdge(),
-                                       *start = e;
-                        while (e) {
-                            V_ITa[5*i+1]++;
+    for (int p=0; p<npasses; ++p)
+        switch (masks[p]) {
+            case HbrVertex<T>::k_Smooth :
+            case HbrVertex<T>::k_Dart : {
+                HbrHalfedge<T> *e = pv->GetIncidentEdge(),
+                               *start = e;
+                while (e) {
+                    V_ITa[1]++;
 
-                            V_IT[V_IT_offset++] = remap[ e->GetDestVertex()->GetID() ];
+                    V_IT[offset++] = remap[ e->GetDestVertex()->GetID() ];
 
-                            V_IT[V_IT_offset++] = remap[ e->GetLeftFace()->Subdivide()->GetID() ];
+                    V_IT[offset++] = remap[ e->GetLeftFace()->Subdivide()->GetID() ];
 
-                            e = e->GetPrev()->GetOpposite();
+                    e = e->GetPrev()->GetOpposite();
 
-                            if (e==start) break;
+                    if (e==start) break;
+                }
+                break;
+            }
+            case HbrVertex<T>::k_Crease : {
+
+                class GatherCreaseEdgesOperator : public HbrHalfedgeOperator<T> {
+                public:
+                    HbrVertex<T> * vertex; int eidx[2]; int count; bool next;
+
+                    GatherCreaseEdgesOperator(HbrVertex<T> * v, bool n) : vertex(v), count(0), next(n) { eidx[0]=-1; eidx[1]=-1; }
+
+                    virtual void operator() (HbrHalfedge<T> &e) {
+                        if (e.IsSharp(next) and count < 2) {
+                            HbrVertex<T> * a = e.GetDestVertex();
+                            if (a==vertex)
+                                a = e.GetOrgVertex();
+                            eidx[count++]=a->GetID();
                         }
-                        break;
                     }
-                    case HbrVertex<T>::k_Crease : {
-
-                        class GatherCreaseEdgesOperator : public HbrHalfedgeOperator<T> {
-                        public:
-                            HbrVertex<T> * vertex; int eidx[2]; int count; bool next;
-
-                            GatherCreaseEdgesOperator(HbrVertex<T> * v, bool n) : vertex(v), count(0), next(n) { eidx[0]=-1; eidx[1]=-1; }
-
-                            virtual void operator() (HbrHalfedge<T> &e) {
-                                if (e.IsSharp(next) and count < 2) {
-                                    HbrVertex<T> * a = e.GetDestVertex();
-                                    if (a==vertex)
-                                        a = e.GetOrgVertex();
-                                    eidx[count++]=a->GetID();
-                                }
-                            }
-                        };
-
-                        GatherCreaseEdgesOperator op( pv, p==1 );
-                        pv->ApplyOperatorSurroundingEdges( op );
-
-                        assert(V_ITa[5*i+3]==-1 and V_ITa[5*i+4]==-1);
-                        assert(op.eidx[0]!=-1 and op.eidx[1]!=-1);
-                        V_ITa[5*i+3] = remap[op.eidx[0]];
-                        V_ITa[5*i+4] = remap[op.eidx[1]];
-                        break;
-                    }
-                    case HbrVertex<T>::k_Corner :
-                        // in the case of a k_Crease / k_Corner pass combination, we
-                        // need to set the valence to -1 to tell the "B" Kernel to
-                        // switch to k_Corner rule (as edge indices won't be -1)
-                        if (V_ITa[5*i+1]==0)
-                            V_ITa[5*i+1] = -1;
-
-                    default : break;
-                }
+                };
 
-            if (rank>7)
-                // the k_Corner and k_Crease single-pass cases apply a weight of 1.0
-                // but this value is inverted in the kernel
-                V_W[i] = 0.0;
-            else
-                V_W[i] = weights[0];
+                GatherCreaseEdgesOperator op( pv, p==1 );
+                pv->ApplyOperatorSurroundingEdges( op );
 
-            batchFactory.AddVertex( i, rank );
+                assert(V_ITa[3]==-1 and V_ITa[4]==-1);
+                assert(op.eidx[0]!=-1 and op.eidx[1]!=-1);
+                V_ITa[3] = remap[op.eidx[0]];
+                V_ITa[4] = remap[op.eidx[1]];
+                break;
+            }
+            case HbrVertex<T>::k_Corner :
+                // in the case of a k_Crease / k_Corner pass combination, we
+                // need to set the valence to -1 to tell the "B" Kernel to
+                // switch to k_Corner rule (as edge indices won't be -1)
+                if (V_ITa[1]==0)
+                    V_ITa[1] = -1;
+
+            default : break;
         }
-        V_ITa += nVertVertices*5;
-        V_W += nVertVertices;
 
-        // add batches for vert vertices
-        if (nVertVertices > 0)
-            batchFactory.AppendCatmarkBatches(level, vertTableOffset, vertexOffset, batches);
-        vertexOffset += nVertVertices;
-        vertTableOffset += nVertVertices;
-    }
-    result->_vertsOffsets[maxlevel+1] = vertexOffset;
-    return result;
+    if (rank>7)
+        // the k_Corner and k_Crease single-pass cases apply a weight of 1.0
+        // but this value is inverted in the kernel
+        V_W[0] = 0.0;
+    else
+        V_W[0] = weights[0];
+
+    return rank;
 }
 
 } // end namespace OPENSUBDIV_VERSION
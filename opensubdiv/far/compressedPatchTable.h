@@ -0,0 +1,201 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+//
+#ifndef FAR_COMPRESSED_PATCH_TABLE_H
+#define FAR_COMPRESSED_PATCH_TABLE_H
+
+#include "../version.h"
+
+#include "../far/memoryUsage.h"
+#include "../far/patchTables.h"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+/// \brief A compressed copy of the control vertex indices of FarPatchTables
+///
+/// The control vertices of a patch are gathered from a small neighborhood of
+/// the refined mesh, so their indices are stored as a 32 bits base per patch
+/// (the lowest index of its control vertices) and a 16 bits delta per control
+/// vertex. The few patches spanning more than 65536 vertex indices keep their
+/// indices uncompressed in an overflow table.
+///
+/// The deltas are stored in the order of the FarPatchTables::PTable : the
+/// control vertices of a patch are decoded from its absolute index and from
+/// the location of its first control vertex in the PTable (see
+/// FarPatchMap::Handle).
+///
+class FarCompressedPatchTable {
+
+public:
+
+    /// \brief Constructor
+    ///
+    /// @param patchTables  A valid set of FarPatchTables
+    ///
+    FarCompressedPatchTable( FarPatchTables const & patchTables );
+
+    /// \brief Decodes the control vertices of a patch
+    ///
+    /// @param patchIdx   Absolute index of the patch
+    ///
+    /// @param vertIndex  Index of the first control vertex of the patch in the
+    ///                   PTable
+    ///
+    /// @param ncvs       Number of control vertices of the patch
+    ///
+    /// @param result     Destination of the ncvs indices
+    ///
+    void GetPatchVertices( int patchIdx, int vertIndex, int ncvs, unsigned int * result ) const;
+
+    /// \brief Returns the number of patches
+    int GetNumPatches() const { return (int)_bases.size(); }
+
+    /// \brief Returns the number of control vertex indices
+    int GetNumControlVertices() const { return (int)_deltas.size(); }
+
+    /// \brief Returns the size of the uncompressed PTable divided by the size
+    /// of the compressed tables
+    float GetCompressionRatio() const;
+
+    /// \brief Returns the memory required to store the tables
+    int GetMemoryUsed() const;
+
+    /// \brief Itemized memory allocated by the tables
+    FarMemoryUsage GetMemoryUsage() const {
+        FarMemoryUsage result;
+        result.AddVector("bases", _bases);
+        result.AddVector("deltas", _deltas);
+        result.AddVector("overflow", _overflow);
+        return result;
+    }
+
+private:
+
+    // flags the bases of the patches stored in the overflow table
+    enum { OVERFLOW_BIT = 0x80000000 };
+
+    std::vector<unsigned int>   _bases;     // lowest index (or overflow offset) per patch
+
+    std::vector<unsigned short> _deltas;    // per-vertex offsets from the base of the patch
+
+    std::vector<unsigned int>   _overflow;  // uncompressed indices of the widest patches
+};
+
+// Constructor
+inline
+FarCompressedPatchTable::FarCompressedPatchTable( FarPatchTables const & patchTables ) {
+
+    FarPatchTables::PTable const & ptable = patchTables.GetPatchTable();
+
+    FarPatchTables::PatchArrayVector const & parrays = patchTables.GetPatchArrayVector();
+
+    int npatches = 0;
+    for (int i=0; i<(int)parrays.size(); ++i) {
+        npatches = std::max(npatches, (int)(parrays[i].GetPatchIndex()+parrays[i].GetNumPatches()));
+    }
+
+    _bases.resize(npatches);
+    _deltas.resize(ptable.size(), 0);
+
+    for (int i=0; i<(int)parrays.size(); ++i) {
+
+        FarPatchTables::PatchArray const & parray = parrays[i];
+
+        int ncvs = parray.GetDescriptor().GetNumControlVertices();
+
+        for (int j=0; j<(int)parray.GetNumPatches(); ++j) {
+
+            int vertIndex = parray.GetVertIndex() + j*ncvs,
+                patchIdx = parray.GetPatchIndex() + j;
+
+            unsigned int const * cvs = &ptable[vertIndex];
+
+            unsigned int minIndex = cvs[0],
+                         maxIndex = cvs[0];
+            for (int k=1; k<ncvs; ++k) {
+                minIndex = std::min(minIndex, cvs[k]);
+                maxIndex = std::max(maxIndex, cvs[k]);
+            }
+
+            if (maxIndex-minIndex <= 0xFFFF) {
+                assert(not (minIndex & OVERFLOW_BIT));
+                _bases[patchIdx] = minIndex;
+                for (int k=0; k<ncvs; ++k) {
+                    _deltas[vertIndex+k] = (unsigned short)(cvs[k]-minIndex);
+                }
+            } else {
+                _bases[patchIdx] = (unsigned int)_overflow.size() | OVERFLOW_BIT;
+                _overflow.insert(_overflow.end(), cvs, cvs+ncvs);
+            }
+        }
+    }
+}
+
+// Decodes the control vertices of a patch
+inline void
+FarCompressedPatchTable::GetPatchVertices( int patchIdx, int vertIndex, int ncvs, unsigned int * result ) const {
+
+    assert(patchIdx<(int)_bases.size() and vertIndex+ncvs<=(int)_deltas.size());
+
+    unsigned int base = _bases[patchIdx];
+
+    if (base & OVERFLOW_BIT) {
+        unsigned int const * cvs = &_overflow[base & ~OVERFLOW_BIT];
+        for (int k=0; k<ncvs; ++k) {
+            result[k] = cvs[k];
+        }
+    } else {
+        unsigned short const * deltas = &_deltas[vertIndex];
+        for (int k=0; k<ncvs; ++k) {
+            result[k] = base + deltas[k];
+        }
+    }
+}
+
+// Returns the memory required to store the tables
+inline int
+FarCompressedPatchTable::GetMemoryUsed() const {
+    return (int)(_bases.size() * sizeof(unsigned int) +
+                 _deltas.size() * sizeof(unsigned short) +
+                 _overflow.size() * sizeof(unsigned int));
+}
+
+// Returns the size of the PTable divided by the size of the compressed tables
+inline float
+FarCompressedPatchTable::GetCompressionRatio() const {
+    int memoryUsed = GetMemoryUsed();
+    return memoryUsed>0 ? (float)(_deltas.size() * sizeof(unsigned int)) / (float)memoryUsed : 1.0f;
+}
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif /* FAR_COMPRESSED_PATCH_TABLE_H */
@@ -33,10 +33,23 @@
 #include "../far/loopSubdivisionTables.h"
 #include "../far/vertexEditTables.h"
 #include "../far/kernelBatch.h"
+#include "../far/kernelBatchObserver.h"
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
+/// \brief Optional kernel batches applied by a compute controller.
+///
+/// The structured grid and end cap batches are applied by the controllers
+/// that share the CPU compute context. The controllers without these kernels
+/// specialize this template so that FarDispatcher skips these batches (their
+/// compute contexts refuse the meshes that have them).
+///
+template <class CONTROLLER> struct FarKernelSupport {
+    static const bool structuredGrids = true;
+    static const bool endCaps = true;
+};
+
 /// \brief Subdivision process encapsulation layer.
 ///
 /// The Compute dispatcher allows client code to customize parts or the entire
@@ -64,65 +77,153 @@ public:
     ///
     /// @param clientdata  custom client data passed to the controller
     ///
+    /// @param observer    optional instrumentation observer notified around
+    ///                    the processing of each batch (see
+    ///                    FarKernelBatchObserver)
+    ///
+    template <class CONTROLLER>
+    static void Refine(CONTROLLER const *controller, FarKernelBatchVector const & batches, int maxlevel, void * clientdata=0,
+                       FarKernelBatchObserver * observer=0);
+
+    /// \brief Launches the processing of a vector of kernel batches in reverse
+    /// order (used by the controllers of the adjoint refinement, see
+    /// OsdCpuAdjointController)
+    ///
+    /// @param controller  adjoint refinement controller implementation
+    ///
+    /// @param batches     batches of kernels that need to be processed
+    ///
+    /// @param maxlevel    process vertex batches up to this level
+    ///
+    /// @param clientdata  custom client data passed to the controller
+    ///
+    /// @param observer    optional instrumentation observer notified around
+    ///                    the processing of each batch
+    ///
     template <class CONTROLLER>
-    static void Refine(CONTROLLER const *controller, FarKernelBatchVector const & batches, int maxlevel, void * clientdata=0);
+    static void RefineReverse(CONTROLLER const *controller, FarKernelBatchVector const & batches, int maxlevel, void * clientdata=0,
+                              FarKernelBatchObserver * observer=0);
+
+private:
+    template <bool SUPPORTED> struct Support { };
+
+    template <class CONTROLLER>
+    static void applyKernel(CONTROLLER const *controller, FarKernelBatch const & batch, void * clientdata);
+
+    template <class CONTROLLER>
+    static void applyStructuredGridKernel(CONTROLLER const *controller, FarKernelBatch const & batch, void * clientdata, Support<true>) {
+        controller->ApplyCatmarkStructuredGridKernel(batch, clientdata);
+    }
+
+    template <class CONTROLLER>
+    static void applyStructuredGridKernel(CONTROLLER const *, FarKernelBatch const &, void *, Support<false>) { }
+
+    template <class CONTROLLER>
+    static void applyEndCapKernel(CONTROLLER const *controller, FarKernelBatch const & batch, void * clientdata, Support<true>) {
+        controller->ApplyEndCapKernel(batch, clientdata);
+    }
+
+    template <class CONTROLLER>
+    static void applyEndCapKernel(CONTROLLER const *, FarKernelBatch const &, void *, Support<false>) { }
 };
 
 template <class CONTROLLER> void
-FarDispatcher::Refine(CONTROLLER const *controller, FarKernelBatchVector const & batches, int maxlevel, void * clientdata) {
+FarDispatcher::Refine(CONTROLLER const *controller, FarKernelBatchVector const & batches, int maxlevel, void * clientdata,
+                     FarKernelBatchObserver * observer) {
 
     for (int i = 0; i < (int)batches.size(); ++i) {
         const FarKernelBatch &batch = batches[i];
 
         if (maxlevel >= 0 && batch.GetLevel() >= maxlevel) continue;
 
-        switch(batch.GetKernelType()) {
-            case FarKernelBatch::CATMARK_FACE_VERTEX:
-                controller->ApplyCatmarkFaceVerticesKernel(batch, clientdata);
-                break;
-            case FarKernelBatch::CATMARK_EDGE_VERTEX:
-                controller->ApplyCatmarkEdgeVerticesKernel(batch, clientdata);
-                break;
-            case FarKernelBatch::CATMARK_VERT_VERTEX_B:
-                controller->ApplyCatmarkVertexVerticesKernelB(batch, clientdata);
-                break;
-            case FarKernelBatch::CATMARK_VERT_VERTEX_A1:
-                controller->ApplyCatmarkVertexVerticesKernelA1(batch, clientdata);
-                break;
-            case FarKernelBatch::CATMARK_VERT_VERTEX_A2:
-                controller->ApplyCatmarkVertexVerticesKernelA2(batch, clientdata);
-                break;
-
-            case FarKernelBatch::LOOP_EDGE_VERTEX:
-                controller->ApplyLoopEdgeVerticesKernel(batch, clientdata);
-                break;
-            case FarKernelBatch::LOOP_VERT_VERTEX_B:
-                controller->ApplyLoopVertexVerticesKernelB(batch, clientdata);
-                break;
-            case FarKernelBatch::LOOP_VERT_VERTEX_A1:
-                controller->ApplyLoopVertexVerticesKernelA1(batch, clientdata);
-                break;
-            case FarKernelBatch::LOOP_VERT_VERTEX_A2:
-                controller->ApplyLoopVertexVerticesKernelA2(batch, clientdata);
-                break;
-
-            case FarKernelBatch::BILINEAR_FACE_VERTEX:
-                controller->ApplyBilinearFaceVerticesKernel(batch, clientdata);
-                break;
-            case FarKernelBatch::BILINEAR_EDGE_VERTEX:
-                controller->ApplyBilinearEdgeVerticesKernel(batch, clientdata);
-                break;
-            case FarKernelBatch::BILINEAR_VERT_VERTEX:
-                controller->ApplyBilinearVertexVerticesKernel(batch, clientdata);
-                break;
-
-            case FarKernelBatch::HIERARCHICAL_EDIT:
-                controller->ApplyVertexEdits(batch, clientdata);
-                break;
+        if (observer) {
+            observer->BeginBatch(batch);
+            applyKernel(controller, batch, clientdata);
+            observer->EndBatch(batch);
+        } else {
+            applyKernel(controller, batch, clientdata);
+        }
+    }
+}
+
+template <class CONTROLLER> void
+FarDispatcher::RefineReverse(CONTROLLER const *controller, FarKernelBatchVector const & batches, int maxlevel, void * clientdata,
+                            FarKernelBatchObserver * observer) {
+
+    for (int i = (int)batches.size()-1; i >= 0; --i) {
+        const FarKernelBatch &batch = batches[i];
+
+        if (maxlevel >= 0 && batch.GetLevel() >= maxlevel) continue;
+
+        if (observer) {
+            observer->BeginBatch(batch);
+            applyKernel(controller, batch, clientdata);
+            observer->EndBatch(batch);
+        } else {
+            applyKernel(controller, batch, clientdata);
         }
     }
 }
 
+template <class CONTROLLER> void
+FarDispatcher::applyKernel(CONTROLLER const *controller, FarKernelBatch const & batch, void * clientdata) {
+
+    switch(batch.GetKernelType()) {
+        case FarKernelBatch::CATMARK_FACE_VERTEX:
+            controller->ApplyCatmarkFaceVerticesKernel(batch, clientdata);
+            break;
+        case FarKernelBatch::CATMARK_EDGE_VERTEX:
+            controller->ApplyCatmarkEdgeVerticesKernel(batch, clientdata);
+            break;
+        case FarKernelBatch::CATMARK_VERT_VERTEX_B:
+            controller->ApplyCatmarkVertexVerticesKernelB(batch, clientdata);
+            break;
+        case FarKernelBatch::CATMARK_VERT_VERTEX_A1:
+            controller->ApplyCatmarkVertexVerticesKernelA1(batch, clientdata);
+            break;
+        case FarKernelBatch::CATMARK_VERT_VERTEX_A2:
+            controller->ApplyCatmarkVertexVerticesKernelA2(batch, clientdata);
+            break;
+
+        case FarKernelBatch::LOOP_EDGE_VERTEX:
+            controller->ApplyLoopEdgeVerticesKernel(batch, clientdata);
+            break;
+        case FarKernelBatch::LOOP_VERT_VERTEX_B:
+            controller->ApplyLoopVertexVerticesKernelB(batch, clientdata);
+            break;
+        case FarKernelBatch::LOOP_VERT_VERTEX_A1:
+            controller->ApplyLoopVertexVerticesKernelA1(batch, clientdata);
+            break;
+        case FarKernelBatch::LOOP_VERT_VERTEX_A2:
+            controller->ApplyLoopVertexVerticesKernelA2(batch, clientdata);
+            break;
+
+        case FarKernelBatch::BILINEAR_FACE_VERTEX:
+            controller->ApplyBilinearFaceVerticesKernel(batch, clientdata);
+            break;
+        case FarKernelBatch::BILINEAR_EDGE_VERTEX:
+            controller->ApplyBilinearEdgeVerticesKernel(batch, clientdata);
+            break;
+        case FarKernelBatch::BILINEAR_VERT_VERTEX:
+            controller->ApplyBilinearVertexVerticesKernel(batch, clientdata);
+            break;
+
+        case FarKernelBatch::HIERARCHICAL_EDIT:
+            controller->ApplyVertexEdits(batch, clientdata);
+            break;
+
+        case FarKernelBatch::CATMARK_STRUCTURED_GRID:
+            applyStructuredGridKernel(controller, batch, clientdata,
+                Support<FarKernelSupport<CONTROLLER>::structuredGrids>());
+            break;
+
+        case FarKernelBatch::END_CAP:
+            applyEndCapKernel(controller, batch, clientdata,
+                Support<FarKernelSupport<CONTROLLER>::endCaps>());
+            break;
+    }
+}
+
 // -----------------------------------------------------------------------------
 
 /// \brief Far default controller implementation
@@ -133,7 +234,7 @@ template <class U>
 class FarComputeController {
 
 public:
-    void Refine(FarMesh<U> * mesh, int maxlevel=-1) const;
+    void Refine(FarMesh<U> * mesh, int maxlevel=-1, FarKernelBatchObserver * observer=0) const;
 
     void ApplyBilinearFaceVerticesKernel(FarKernelBatch const &batch, void * clientdata) const;
 
@@ -152,6 +253,8 @@ public:
 
     void ApplyCatmarkVertexVerticesKernelA2(FarKernelBatch const &batch, void * clientdata) const;
 
+    void ApplyCatmarkStructuredGridKernel(FarKernelBatch const &batch, void * clientdata) const;
+
     void ApplyLoopEdgeVerticesKernel(FarKernelBatch const &batch, void * clientdata) const;
 
     void ApplyLoopVertexVerticesKernelB(FarKernelBatch const &batch, void * clientdata) const;
@@ -162,6 +265,8 @@ public:
 
     void ApplyVertexEdits(FarKernelBatch const &batch, void * clientdata) const;
 
+    void ApplyEndCapKernel(FarKernelBatch const &batch, void * clientdata) const;
+
     static FarComputeController _DefaultController;
     
 private:
@@ -171,9 +276,9 @@ private:
 template<class U> FarComputeController<U> FarComputeController<U>::_DefaultController;
 
 template <class U> void
-FarComputeController<U>::Refine(FarMesh<U> *mesh, int maxlevel) const {
+FarComputeController<U>::Refine(FarMesh<U> *mesh, int maxlevel, FarKernelBatchObserver * observer) const {
 
-    FarDispatcher::Refine(this, mesh->GetKernelBatches(), maxlevel, mesh);
+    FarDispatcher::Refine(this, mesh->GetKernelBatches(), maxlevel, mesh, observer);
 }
 
 template <class U> void
@@ -312,6 +417,21 @@ FarComputeController<U>::ApplyCatmarkVertexVerticesKernelA2(FarKernelBatch const
                                        clientdata );
 }
 
+template <class U> void
+FarComputeController<U>::ApplyCatmarkStructuredGridKernel(FarKernelBatch const &batch, void * clientdata) const {
+
+    FarMesh<U> * mesh = static_cast<FarMesh<U> *>(clientdata);
+
+    FarCatmarkSubdivisionTables<U> const * subdivision =
+        dynamic_cast<FarCatmarkSubdivisionTables<U> const *>(mesh->GetSubdivisionTables());
+
+    assert(subdivision);
+
+    subdivision->computeStructuredGrids( batch.GetStart(),
+                                         batch.GetEnd(),
+                                         clientdata );
+}
+
 template <class U> void
 FarComputeController<U>::ApplyLoopEdgeVerticesKernel(FarKernelBatch const &batch, void * clientdata) const {
 
@@ -398,6 +518,22 @@ FarComputeController<U>::ApplyVertexEdits(FarKernelBatch const &batch, void * cl
                                       clientdata );
 }
 
+template <class U> void
+FarComputeController<U>::ApplyEndCapKernel(FarKernelBatch const &batch, void * clientdata) const {
+
+    FarMesh<U> * mesh = static_cast<FarMesh<U> *>(clientdata);
+
+    FarEndCapTables const * endCaps = mesh->GetEndCapTables();
+
+    if (endCaps)
+        endCaps->Apply( &mesh->GetVertices().at(0),
+                        batch.GetVertexOffset(),
+                        batch.GetTableOffset(),
+                        batch.GetStart(),
+                        batch.GetEnd(),
+                        clientdata );
+}
+
 } // end namespace OPENSUBDIV_VERSION
 using namespace OPENSUBDIV_VERSION;
 
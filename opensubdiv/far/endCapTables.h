@@ -0,0 +1,144 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+//
+#ifndef FAR_END_CAP_TABLES_H
+#define FAR_END_CAP_TABLES_H
+
+#include "../version.h"
+
+#include "../far/memoryUsage.h"
+
+#include <cassert>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+/// \brief Stencils of the control vertices of the B-spline end caps.
+///
+/// When a feature adaptive FarMesh is created with B-spline end caps, the
+/// faces around the extraordinary vertices of the last level of isolation are
+/// represented with regular bicubic B-spline patches instead of Gregory
+/// patches. The 16 control vertices of each end cap are not vertices of the
+/// subdivided mesh : they are appended after the refined vertices and computed
+/// with stencils (weighted sums of the refined vertices) by an END_CAP kernel
+/// batch.
+///
+/// The stencils are stored in a compressed row format : stencil 'i' is made of
+/// the vertices Indices[Offsets[i]] to Indices[Offsets[i+1]-1], weighted by the
+/// matching entries of the weights table. A batch computes the vertices
+/// [VertexOffset+Start, VertexOffset+End[ from the stencils
+/// [TableOffset+Start, TableOffset+End[.
+///
+/// The varying data of an end cap vertex is copied from the closest corner of
+/// its face, so that the varying data of the 4 central control vertices
+/// interpolates bilinearly across the patch, as with the other patch types.
+///
+class FarEndCapTables {
+
+public:
+    /// \brief Returns the number of stencils
+    int GetNumVertices() const { return (int)_offsets.size()-1; }
+
+    /// \brief Returns the offsets of the stencils in the indices table
+    /// (GetNumVertices()+1 entries)
+    std::vector<int> const & GetOffsets() const { return _offsets; }
+
+    /// \brief Returns the indices of the vertices of the stencils
+    std::vector<int> const & GetIndices() const { return _indices; }
+
+    /// \brief Returns the weights of the vertices of the stencils
+    std::vector<float> const & GetWeights() const { return _weights; }
+
+    /// \brief Returns the index of the vertex each stencil copies its varying
+    /// data from
+    std::vector<int> const & GetVaryingIndices() const { return _varyingIndices; }
+
+    /// \brief Computes a range of end cap vertices (Far reference implementation)
+    ///
+    /// @param vertices      the vertices of the mesh
+    ///
+    /// @param vertexOffset  the index of the vertex computed by stencil 'start'
+    ///                      minus 'start'
+    ///
+    /// @param tableOffset   the offset of the stencils of the batch
+    ///
+    /// @param start         index of the first stencil of the range
+    ///
+    /// @param end           index past the last stencil of the range
+    ///
+    /// @param clientdata    passed to the vertex class methods
+    ///
+    template <class U> void Apply( U * vertices, int vertexOffset, int tableOffset,
+                                   int start, int end, void * clientdata=0 ) const;
+
+    /// \brief Itemized memory allocated by the tables
+    FarMemoryUsage GetMemoryUsage() const {
+        FarMemoryUsage result;
+        result.AddVector("offsets", _offsets);
+        result.AddVector("indices", _indices);
+        result.AddVector("weights", _weights);
+        result.AddVector("varyingIndices", _varyingIndices);
+        return result;
+    }
+
+private:
+    template <class X, class Y> friend class FarEndCapTablesFactory;
+    template <class X, class Y> friend class FarMultiMeshFactory;
+
+    FarEndCapTables() : _offsets(1, 0) { }
+
+    std::vector<int>   _offsets,        // offsets of the stencils in the indices table
+                       _indices;        // vertices of the stencils
+
+    std::vector<float> _weights;        // weights of the vertices of the stencils
+
+    std::vector<int>   _varyingIndices; // source of the varying data of each stencil
+};
+
+template <class U> void
+FarEndCapTables::Apply( U * vertices, int vertexOffset, int tableOffset,
+                        int start, int end, void * clientdata ) const {
+
+    assert(vertices);
+
+    U * vdst = vertices + vertexOffset + start;
+
+    for (int i=start+tableOffset; i<end+tableOffset; ++i, ++vdst) {
+
+        vdst->Clear(clientdata);
+
+        for (int j=_offsets[i]; j<_offsets[i+1]; ++j)
+            vdst->AddWithWeight( vertices[_indices[j]], _weights[j], clientdata );
+
+        vdst->AddVaryingWithWeight( vertices[_varyingIndices[i]], 1.0f, clientdata );
+    }
+}
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif /* FAR_END_CAP_TABLES_H */
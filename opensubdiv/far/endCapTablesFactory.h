@@ -0,0 +1,481 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+//
+#ifndef FAR_END_CAP_TABLES_FACTORY_H
+#define FAR_END_CAP_TABLES_FACTORY_H
+
+#include "../version.h"
+
+#include "../hbr/mesh.h"
+
+#include "../far/endCapTables.h"
+#include "../far/kernelBatch.h"
+#include "../far/factoryStats.h"
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+template <class T, class U> class FarMeshFactory;
+
+/// \brief A specialized factory for FarEndCapTables
+///
+/// The faces tagged as Gregory patches by FarPatchTablesFactory are
+/// represented with bicubic B-spline patches :
+/// - the corner and edge points of the Gregory patch are computed as in
+///   "Approximating Subdivision Surfaces with Gregory Patches for Hardware
+///   Tessellation" (Loop, Schaefer, Ni, Castano), so that the boundary curves
+///   of an end cap are the ones of the Gregory patch it replaces
+/// - each pair of Gregory face points is averaged into the interior point of
+///   a bicubic Bezier patch
+/// - the Bezier patch is converted to the 16 control vertices of a B-spline
+///   patch that evaluates to the same surface
+///
+/// The end caps are numbered in the order of the faces of the HbrMesh, which
+/// is the order FarPatchTablesFactory uses to emit their control vertices.
+///
+/// This factory is private to Far and should not be used by client code.
+///
+template <class T, class U> class FarEndCapTablesFactory {
+
+protected:
+    template <class X, class Y> friend class FarMeshFactory;
+
+    /// \brief Creates a FarEndCapTables instance and appends its kernel batch
+    ///
+    /// @param factory       the mesh factory
+    ///
+    /// @param vertexOffset  index of the first end cap vertex in the FarMesh
+    ///
+    /// @param batches       the kernel batches of the FarMesh
+    ///
+    static FarEndCapTables * Create( FarMeshFactory<T,U> const * factory, int vertexOffset, FarKernelBatchVector * batches );
+
+private:
+
+    typedef std::vector<double> Weights;
+
+    // One-ring of a corner of a face, in the order of the Gregory patch vertex
+    // valence table. The vertices are local indices in the support of the face.
+    struct Ring {
+        int center,
+            start,   // position of the next vertex of the face in the ring
+            prev;    // position of the previous vertex of the face in the ring
+        bool boundary;
+        std::vector<int> neighbors,
+                         diagonals;
+    };
+
+    // Returns the local index of v in the support of a face
+    static int getLocalIndex( std::vector<HbrVertex<T> *> & support, HbrVertex<T> * v );
+
+    // Gathers the one-ring of the corner 'vid' of f
+    static void gatherRing( HbrFace<T> * f, int vid, std::vector<HbrVertex<T> *> & support, Ring & ring );
+
+    // Returns the scale of the tangents of an interior vertex of valence n
+    static double computeTangentScale( int n );
+
+    // Computes the corner (P), edge (Ep, Em) and face (Fp, Fm) points of the
+    // Gregory patch of a face
+    static void computeGregoryBasis( Ring const * rings, int size,
+                                     Weights * P, Weights * Ep, Weights * Em,
+                                     Weights * Fp, Weights * Fm );
+};
+
+// dst += w * src
+inline void
+farAddWeights( std::vector<double> & dst, std::vector<double> const & src, double w ) {
+    for (int i=0; i<(int)dst.size(); ++i)
+        dst[i] += w * src[i];
+}
+
+template <class T, class U> int
+FarEndCapTablesFactory<T,U>::getLocalIndex( std::vector<HbrVertex<T> *> & support, HbrVertex<T> * v ) {
+
+    for (int i=0; i<(int)support.size(); ++i)
+        if (support[i]==v)
+            return i;
+
+    support.push_back(v);
+    return (int)support.size()-1;
+}
+
+template <class T, class U> void
+FarEndCapTablesFactory<T,U>::gatherRing( HbrFace<T> * f, int vid, std::vector<HbrVertex<T> *> & support, Ring & ring ) {
+
+    HbrVertex<T> * v = f->GetVertex(vid);
+
+    ring.center = getLocalIndex(support, v);
+    ring.boundary = v->OnBoundary();
+    ring.neighbors.clear();
+    ring.diagonals.clear();
+
+    // same traversal as ApplyOperatorSurroundingVertices : on boundaries, the
+    // ring starts and ends with the vertices across the boundary edges
+    std::vector<HbrVertex<T> *> neighbors;
+
+    HbrHalfedge<T> * start = v->GetIncidentEdge(), * e = start;
+    while (e) {
+        neighbors.push_back(e->GetDestVertex());
+        HbrHalfedge<T> * next = v->GetNextEdge(e);
+        if (next==start) {
+            break;
+        } else if (not next) {
+            neighbors.push_back(e->GetPrev()->GetOrgVertex());
+            break;
+        }
+        e = next;
+    }
+
+    int offsets[2] = { 0, 0 }, count = 0;
+
+    for (int i=0; i<(int)neighbors.size(); ++i) {
+
+        // the vertices of the face adjacent to v in the ring
+        for (int j=0; j<4; ++j)
+            if (neighbors[i]==f->GetVertex(j) and count<2)
+                offsets[count++] = i;
+
+        HbrHalfedge<T> * edge = v->GetEdge(neighbors[i]);
+        HbrVertex<T> * diagonal = edge ? edge->GetNext()->GetDestVertex() : neighbors[i];
+
+        ring.neighbors.push_back(getLocalIndex(support, neighbors[i]));
+        ring.diagonals.push_back(getLocalIndex(support, diagonal));
+    }
+
+    // see FarPatchTablesFactory::getQuadOffsets
+    if (offsets[1] - offsets[0] != 1)
+        std::swap(offsets[0], offsets[1]);
+
+    ring.start = offsets[0];
+    ring.prev = offsets[1];
+}
+
+template <class T, class U> double
+FarEndCapTablesFactory<T,U>::computeTangentScale( int n ) {
+
+    // inverse of the valence times the subdominant eigenvalue of the
+    // Catmull-Clark subdivision matrix
+    double c = cos(2.0*M_PI/n),
+           lambda = (5.0 + c + cos(M_PI/n)*sqrt(18.0 + 2.0*c)) / 16.0;
+
+    return 1.0 / (n * lambda);
+}
+
+template <class T, class U> void
+FarEndCapTablesFactory<T,U>::computeGregoryBasis( Ring const * rings, int size,
+                                                   Weights * P, Weights * Ep, Weights * Em,
+                                                   Weights * Fp, Weights * Fm ) {
+
+    std::vector<Weights> r[4];
+
+    // corner and edge points
+    for (int vid=0; vid<4; ++vid) {
+
+        Ring const & ring = rings[vid];
+
+        int n = (int)ring.neighbors.size(),
+            ip = (vid+1)%4,
+            im = (vid+3)%4;
+
+        P[vid].assign(size, 0.0);
+        Ep[vid].assign(size, 0.0);
+        Em[vid].assign(size, 0.0);
+
+        if (ring.boundary and n==2) {
+
+            // boundary corner : the edge points are on the boundary edges
+            P[vid][ring.center] = 1.0;
+
+            Ep[vid][ring.center] += 2.0/3.0;
+            Ep[vid][rings[ip].center] += 1.0/3.0;
+            Em[vid][ring.center] += 2.0/3.0;
+            Em[vid][rings[im].center] += 1.0/3.0;
+            continue;
+        }
+
+        // face points of the ring and their average
+        std::vector<Weights> f(n, Weights(size, 0.0));
+        r[vid].assign(n, Weights(size, 0.0));
+
+        for (int i=0; i<n; ++i) {
+            int ni = (i+1)%n,
+                pi = (i+n-1)%n;
+
+            double w = 1.0/(n+5.0);
+            f[i][ring.center] += n * w;
+            f[i][ring.neighbors[ni]] += 2.0 * w;
+            f[i][ring.neighbors[i]] += 2.0 * w;
+            f[i][ring.diagonals[i]] += w;
+
+            farAddWeights(P[vid], f[i], 1.0/n);
+
+            r[vid][i][ring.neighbors[ni]] += 1.0/3.0;
+            r[vid][i][ring.neighbors[pi]] -= 1.0/3.0;
+            r[vid][i][ring.diagonals[i]] += 1.0/6.0;
+            r[vid][i][ring.diagonals[pi]] -= 1.0/6.0;
+        }
+
+        Weights e0(size, 0.0), e1(size, 0.0);
+
+        if (not ring.boundary) {
+
+            double ef = computeTangentScale(n);
+
+            for (int i=0; i<n; ++i) {
+                int pi = (i+n-1)%n;
+                double a = 0.5 * ef * cos(2.0*M_PI*i/n),
+                       b = 0.5 * ef * sin(2.0*M_PI*i/n);
+                farAddWeights(e0, f[i], a);
+                farAddWeights(e0, f[pi], a);
+                farAddWeights(e1, f[i], b);
+                farAddWeights(e1, f[pi], b);
+            }
+
+            double thetaStart = 2.0*M_PI*ring.start/n,
+                   thetaPrev = 2.0*M_PI*ring.prev/n;
+
+            Ep[vid] = P[vid];
+            farAddWeights(Ep[vid], e0, cos(thetaStart));
+            farAddWeights(Ep[vid], e1, sin(thetaStart));
+
+            Em[vid] = P[vid];
+            farAddWeights(Em[vid], e0, cos(thetaPrev));
+            farAddWeights(Em[vid], e1, sin(thetaPrev));
+        } else {
+
+            // boundary vertex : cubic B-spline limit of the boundary curve and
+            // tangent across the k faces of the ring
+            int b0 = ring.neighbors[0],
+                b1 = ring.neighbors[n-1],
+                k = n-1;
+
+            P[vid].assign(size, 0.0);
+            P[vid][ring.center] += 4.0/6.0;
+            P[vid][b0] += 1.0/6.0;
+            P[vid][b1] += 1.0/6.0;
+
+            e0[b0] += 1.0/6.0;
+            e0[b1] -= 1.0/6.0;
+
+            double c = cos(M_PI/k),
+                   s = sin(M_PI/k),
+                   denom = 1.0/(3.0*k+c),
+                   gamma = -4.0*s*denom,
+                   alpha0k = -((1.0+2.0*c)*sqrt(1.0+c)) / sqrt(1.0-c) * denom,
+                   beta0 = s*denom;
+
+            e1[ring.center] += gamma/3.0;
+            e1[ring.diagonals[0]] += beta0/3.0;
+            e1[b0] += alpha0k/3.0;
+            e1[b1] += alpha0k/3.0;
+
+            for (int x=1; x<n-1; ++x) {
+                double alpha = 4.0*sin(M_PI*x/k)*denom,
+                       beta = (sin(M_PI*x/k) + sin(M_PI*(x+1)/k))*denom;
+                e1[ring.neighbors[x]] += alpha/3.0;
+                e1[ring.diagonals[x]] += beta/3.0;
+            }
+
+            double thetaStart = M_PI*ring.start/k,
+                   thetaPrev = M_PI*ring.prev/k;
+
+            Ep[vid] = P[vid];
+            farAddWeights(Ep[vid], e0, cos(thetaStart));
+            farAddWeights(Ep[vid], e1, sin(thetaStart));
+
+            Em[vid] = P[vid];
+            farAddWeights(Em[vid], e0, cos(thetaPrev));
+            farAddWeights(Em[vid], e1, sin(thetaPrev));
+        }
+    }
+
+    // face points
+    for (int vid=0; vid<4; ++vid) {
+
+        Ring const & ring = rings[vid];
+
+        int ip = (vid+1)%4,
+            im = (vid+3)%4,
+            n = (int)ring.neighbors.size();
+
+        Fp[vid].assign(size, 0.0);
+        Fm[vid].assign(size, 0.0);
+
+        if (ring.boundary and n==2) {
+
+            // boundary corner
+            Fp[vid][ring.center] += 4.0/9.0;
+            Fp[vid][rings[(vid+2)%4].center] += 1.0/9.0;
+            Fp[vid][rings[ip].center] += 2.0/9.0;
+            Fp[vid][rings[im].center] += 2.0/9.0;
+            Fm[vid] = Fp[vid];
+            continue;
+        }
+
+        // boundary valences are doubled : the ring is treated as half of a
+        // symmetric interior ring
+        int nv = ring.boundary ? 2*(n-1) : n,
+            np = (int)rings[ip].neighbors.size(),
+            nm = (int)rings[im].neighbors.size();
+        if (rings[ip].boundary)
+            np = 2*(np-1);
+        if (rings[im].boundary)
+            nm = 2*(nm-1);
+
+        double cn = cos(2.0*M_PI/nv),
+               cp = cos(2.0*M_PI/np),
+               cm = cos(2.0*M_PI/nm),
+               s1 = 3.0 - 2.0*cn - cp,
+               s2 = 2.0*cn,
+               s3 = 3.0 - 2.0*cn - cm;
+
+        farAddWeights(Fp[vid], P[vid], cp/3.0);
+        farAddWeights(Fp[vid], Ep[vid], s1/3.0);
+        farAddWeights(Fp[vid], Em[ip], s2/3.0);
+        farAddWeights(Fp[vid], r[vid][ring.start], 1.0/3.0);
+
+        farAddWeights(Fm[vid], P[vid], cm/3.0);
+        farAddWeights(Fm[vid], Em[vid], s3/3.0);
+        farAddWeights(Fm[vid], Ep[im], s2/3.0);
+        farAddWeights(Fm[vid], r[vid][ring.prev], -1.0/3.0);
+
+        if (ring.boundary) {
+            // the face points along the boundary are merged
+            if (rings[im].boundary)
+                Fm[vid] = Fp[vid];
+            else if (rings[ip].boundary)
+                Fp[vid] = Fm[vid];
+        }
+    }
+}
+
+template <class T, class U> FarEndCapTables *
+FarEndCapTablesFactory<T,U>::Create( FarMeshFactory<T,U> const * factory, int vertexOffset, FarKernelBatchVector * batches ) {
+
+    assert( factory and batches );
+
+    FarFactoryStats::Scope scope("FarEndCapTablesFactory::Create");
+
+    // Bezier to B-spline conversion of a cubic segment
+    static const double M[4][4] = { { 6.0, -7.0,  2.0, 0.0 },
+                                    { 0.0,  2.0, -1.0, 0.0 },
+                                    { 0.0, -1.0,  2.0, 0.0 },
+                                    { 0.0,  2.0, -7.0, 6.0 } };
+
+    // corner of the face closest to each control vertex of the lattice
+    static const int corners[16] = { 0, 0, 1, 1,
+                                     0, 0, 1, 1,
+                                     3, 3, 2, 2,
+                                     3, 3, 2, 2 };
+
+    HbrMesh<T> const * mesh = factory->GetHbrMesh();
+
+    std::vector<int> const & remap = factory->_remapTable;
+
+    FarEndCapTables * result = new FarEndCapTables;
+
+    std::vector<HbrVertex<T> *> support;
+    Ring rings[4];
+    Weights P[4], Ep[4], Em[4], Fp[4], Fm[4], q[16], cv(0);
+
+    for (int i=0; i<factory->_numFaces; ++i) {
+
+        HbrFace<T> * f = mesh->GetFace(i);
+
+        if (f->isTransitionPatch() or f->_adaptiveFlags.patchType!=HbrFace<T>::kGregory)
+            continue;
+
+        assert(f->GetNumVertices()==4 and f->_adaptiveFlags.rots==0);
+
+        support.clear();
+        for (int vid=0; vid<4; ++vid)
+            gatherRing(f, vid, support, rings[vid]);
+
+        int size = (int)support.size();
+
+        computeGregoryBasis(rings, size, P, Ep, Em, Fp, Fm);
+
+        // bicubic Bezier patch : the control points are indexed [row*4+col],
+        // with the rows running from corner 0 towards corner 3 and the
+        // columns from corner 0 towards corner 1
+        q[ 0] = P[0];  q[ 1] = Ep[0]; q[ 2] = Em[1]; q[ 3] = P[1];
+        q[ 4] = Em[0];                               q[ 7] = Ep[1];
+        q[ 8] = Ep[3];                               q[11] = Em[2];
+        q[12] = P[3];  q[13] = Em[3]; q[14] = Ep[2]; q[15] = P[2];
+
+        int interior[4] = { 5, 6, 10, 9 };
+        for (int vid=0; vid<4; ++vid) {
+            q[interior[vid]] = Fp[vid];
+            farAddWeights(q[interior[vid]], Fm[vid], 1.0);
+            for (int j=0; j<size; ++j)
+                q[interior[vid]][j] *= 0.5;
+        }
+
+        // B-spline control vertices, in the order of the regular patches
+        for (int row=0; row<4; ++row) {
+            for (int col=0; col<4; ++col) {
+
+                cv.assign(size, 0.0);
+                for (int a=0; a<4; ++a)
+                    for (int b=0; b<4; ++b)
+                        if (M[row][a]!=0.0 and M[col][b]!=0.0)
+                            farAddWeights(cv, q[a*4+b], M[row][a]*M[col][b]);
+
+                for (int j=0; j<size; ++j) {
+                    if (fabs(cv[j]) > 1e-10) {
+                        result->_indices.push_back(remap[support[j]->GetID()]);
+                        result->_weights.push_back((float)cv[j]);
+                    }
+                }
+                result->_offsets.push_back((int)result->_indices.size());
+                result->_varyingIndices.push_back(remap[f->GetVertex(corners[row*4+col])->GetID()]);
+            }
+        }
+    }
+
+    if (result->GetNumVertices()>0)
+        batches->push_back(FarKernelBatch( FarKernelBatch::END_CAP,
+                                           factory->GetMaxLevel(),
+                                           0,
+                                           0,
+                                           result->GetNumVertices(),
+                                           0,
+                                           vertexOffset) );
+
+    FarFactoryStats::Count(FarFactoryStats::BYTES_ALLOCATED,
+        result->GetMemoryUsage().GetTotal());
+
+    return result;
+}
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif /* FAR_END_CAP_TABLES_FACTORY_H */
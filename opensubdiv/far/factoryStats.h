@@ -0,0 +1,363 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+#ifndef FAR_FACTORY_STATS_H
+#define FAR_FACTORY_STATS_H
+
+#include "../version.h"
+
+#include "../far/stopwatch.h"
+
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+/// \brief Phase timers and counters for the Far factories.
+///
+/// While a FarFactoryStats instance is installed with SetCurrent(), the
+/// factories running on the same thread (FarMeshFactory, the subdivision
+/// tables factories, the kernel batch factory, FarPatchTablesFactory and
+/// FarVertexEditTablesFactory) record a timed phase for each of their
+/// processing steps, along with counters of the faces processed, vertices
+/// created, patches emitted and table bytes allocated. Phases nest : a phase
+/// opened while another one is running is recorded as its child.
+///
+/// When no instance is installed, the instrumentation points reduce to a
+/// pointer test.
+///
+/// The installed instance is local to the calling thread : factories running
+/// concurrently on other threads (for instance in OsdCpuMeshCache::Acquire)
+/// do not record into it, each thread installs its own instance if needed.
+/// The stats themselves are not thread-safe, so an instance should not be
+/// installed on several threads at once.
+///
+class FarFactoryStats {
+public:
+    enum Counter {
+        FACES_PROCESSED = 0,
+        VERTICES_CREATED,
+        PATCHES_EMITTED,
+        BYTES_ALLOCATED,
+
+        COUNTERS_COUNT
+    };
+
+    /// \brief A timed phase
+    struct Phase {
+        char const * name;       // phase names are expected to be static strings
+
+        int          parent,     // index of the parent phase (-1 for a root phase)
+                     depth;
+
+        double       start,      // in seconds, relative to the creation of the stats
+                     duration;   // in seconds
+
+        size_t       counters[COUNTERS_COUNT]; // accumulated while the phase was
+                                               // the innermost running phase
+    };
+
+    /// \brief Scoped phase : opens a phase on the current stats (if any) and
+    /// closes it when going out of scope
+    class Scope {
+    public:
+        explicit Scope(char const * name) : _stats(GetCurrent()) {
+            if (_stats)
+                _stats->BeginPhase(name);
+        }
+
+        ~Scope() {
+            if (_stats)
+                _stats->EndPhase();
+        }
+
+    private:
+        FarFactoryStats * _stats;
+    };
+
+    /// Constructor
+    FarFactoryStats() : _origin(FarStopwatch::GetTime()), _current(-1) {
+        clearCounters(_rootCounters);
+    }
+
+    /// \brief Installs the stats collected by the factories running on the
+    /// calling thread (pass NULL to disable the collection)
+    static void SetCurrent(FarFactoryStats * stats) {
+        getCurrent() = stats;
+    }
+
+    /// \brief Returns the stats installed on the calling thread (or NULL)
+    static FarFactoryStats * GetCurrent() {
+        return getCurrent();
+    }
+
+    /// \brief Adds to a counter of the current stats (if any)
+    static void Count(Counter counter, size_t value) {
+        if (FarFactoryStats * stats = GetCurrent())
+            stats->AddToCounter(counter, value);
+    }
+
+    /// \brief Opens a new phase nested in the running phase
+    void BeginPhase(char const * name);
+
+    /// \brief Closes the running phase
+    void EndPhase();
+
+    /// \brief Adds to a counter of the running phase
+    void AddToCounter(Counter counter, size_t value) {
+        size_t * counters = _current<0 ? _rootCounters : _phases[_current].counters;
+        counters[counter] += value;
+    }
+
+    /// \brief Returns the number of phases recorded
+    int GetNumPhases() const {
+        return (int)_phases.size();
+    }
+
+    /// \brief Returns a recorded phase
+    Phase const & GetPhase(int index) const {
+        return _phases[index];
+    }
+
+    /// \brief Returns the number of times a phase was recorded
+    int GetPhaseCount(char const * name) const;
+
+    /// \brief Returns the time spent in all the phases with the given name
+    /// (in seconds)
+    double GetPhaseTime(char const * name) const;
+
+    /// \brief Returns the total of a counter over all the phases
+    size_t GetCounter(Counter counter) const;
+
+    /// \brief Returns the total of a counter within all the phases with the
+    /// given name (nested phases included)
+    size_t GetCounter(char const * name, Counter counter) const;
+
+    /// \brief Returns the name of a counter
+    static char const * GetCounterName(Counter counter);
+
+    /// \brief Discards all the phases and counters recorded so far
+    void Reset();
+
+    /// \brief Writes the phase tree with timings and counters
+    void Print(std::ostream & os) const;
+
+    /// \brief Writes the phases in the Chrome trace event (JSON) format
+    void WriteChromeTrace(std::ostream & os) const;
+
+private:
+    static FarFactoryStats *& getCurrent() {
+#if defined(_MSC_VER)
+        static __declspec(thread) FarFactoryStats * current = 0;
+#else
+        static __thread FarFactoryStats * current = 0;
+#endif
+        return current;
+    }
+
+    static void clearCounters(size_t * counters) {
+        for (int i=0; i<COUNTERS_COUNT; ++i)
+            counters[i]=0;
+    }
+
+    // Returns true if the phase or one of its parents has the given name
+    bool isInPhase(int index, char const * name) const;
+
+    std::vector<Phase> _phases;
+
+    size_t _rootCounters[COUNTERS_COUNT];
+
+    double _origin;
+
+    int _current;
+};
+
+inline void
+FarFactoryStats::BeginPhase(char const * name) {
+
+    Phase phase;
+    phase.name = name;
+    phase.parent = _current;
+    phase.depth = _current<0 ? 0 : _phases[_current].depth+1;
+    phase.start = FarStopwatch::GetTime() - _origin;
+    phase.duration = 0.0;
+    clearCounters(phase.counters);
+
+    _current = (int)_phases.size();
+    _phases.push_back(phase);
+}
+
+inline void
+FarFactoryStats::EndPhase() {
+
+    if (_current<0)
+        return;
+
+    Phase & phase = _phases[_current];
+    phase.duration = (FarStopwatch::GetTime() - _origin) - phase.start;
+
+    _current = phase.parent;
+}
+
+inline int
+FarFactoryStats::GetPhaseCount(char const * name) const {
+
+    int count=0;
+    for (int i=0; i<(int)_phases.size(); ++i)
+        if (strcmp(_phases[i].name, name)==0)
+            ++count;
+    return count;
+}
+
+inline double
+FarFactoryStats::GetPhaseTime(char const * name) const {
+
+    double time=0.0;
+    for (int i=0; i<(int)_phases.size(); ++i) {
+        // skip recursive phases so that the time is not accounted for twice
+        if (strcmp(_phases[i].name, name)==0 and
+            (_phases[i].parent<0 or (not isInPhase(_phases[i].parent, name))))
+            time += _phases[i].duration;
+    }
+    return time;
+}
+
+inline size_t
+FarFactoryStats::GetCounter(Counter counter) const {
+
+    size_t total = _rootCounters[counter];
+    for (int i=0; i<(int)_phases.size(); ++i)
+        total += _phases[i].counters[counter];
+    return total;
+}
+
+inline size_t
+FarFactoryStats::GetCounter(char const * name, Counter counter) const {
+
+    size_t total = 0;
+    for (int i=0; i<(int)_phases.size(); ++i)
+        if (isInPhase(i, name))
+            total += _phases[i].counters[counter];
+    return total;
+}
+
+inline bool
+FarFactoryStats::isInPhase(int index, char const * name) const {
+
+    for (int i=index; i>=0; i=_phases[i].parent)
+        if (strcmp(_phases[i].name, name)==0)
+            return true;
+    return false;
+}
+
+inline char const *
+FarFactoryStats::GetCounterName(Counter counter) {
+
+    switch (counter) {
+        case FACES_PROCESSED  : return "faces";
+        case VERTICES_CREATED : return "vertices";
+        case PATCHES_EMITTED  : return "patches";
+        case BYTES_ALLOCATED  : return "bytes";
+        default : break;
+    }
+    return "unknown";
+}
+
+inline void
+FarFactoryStats::Reset() {
+
+    _phases.clear();
+    clearCounters(_rootCounters);
+    _origin = FarStopwatch::GetTime();
+    _current = -1;
+}
+
+inline void
+FarFactoryStats::Print(std::ostream & os) const {
+
+    std::ios_base::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+
+    os << std::fixed << std::setprecision(4);
+
+    for (int i=0; i<(int)_phases.size(); ++i) {
+
+        Phase const & phase = _phases[i];
+
+        os << std::string(phase.depth*2, ' ') << phase.name << " : "
+           << phase.duration*1000.0 << " ms";
+
+        for (int j=0; j<COUNTERS_COUNT; ++j) {
+            if (phase.counters[j]>0)
+                os << ", " << GetCounterName((Counter)j) << "=" << phase.counters[j];
+        }
+        os << "\n";
+    }
+
+    os.flags(flags);
+    os.precision(precision);
+}
+
+inline void
+FarFactoryStats::WriteChromeTrace(std::ostream & os) const {
+
+    std::ios_base::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+
+    os << std::fixed << std::setprecision(3);
+
+    // timestamps and durations are expressed in microseconds : nested phases
+    // are fully contained by their parent, which the trace viewer displays as
+    // a stack
+    os << "{ \"traceEvents\" : [";
+    for (int i=0; i<(int)_phases.size(); ++i) {
+
+        Phase const & phase = _phases[i];
+
+        os << (i ? "," : "") << "\n  { \"name\" : \"" << phase.name << "\", "
+           << "\"cat\" : \"far\", \"ph\" : \"X\", "
+           << "\"ts\" : " << phase.start*1000000.0 << ", "
+           << "\"dur\" : " << phase.duration*1000000.0 << ", "
+           << "\"pid\" : 0, \"tid\" : 0, \"args\" : {";
+
+        for (int j=0; j<COUNTERS_COUNT; ++j) {
+            os << (j ? ", " : " ") << "\"" << GetCounterName((Counter)j) << "\" : " << phase.counters[j];
+        }
+        os << " } }";
+    }
+    os << "\n], \"displayTimeUnit\" : \"ms\" }\n";
+
+    os.flags(flags);
+    os.precision(precision);
+}
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif  /* FAR_FACTORY_STATS_H */
@@ -78,6 +78,8 @@ public:
         BILINEAR_EDGE_VERTEX,
         BILINEAR_VERT_VERTEX,
         HIERARCHICAL_EDIT,
+        CATMARK_STRUCTURED_GRID, ///< start/end index FarStructuredGrids descriptors
+        END_CAP,                 ///< start/end index FarEndCapTables stencils
     };
 
     /// \brief Constructor.
@@ -98,6 +100,9 @@ public:
     ///
     /// @param meshIndex     XXXX
     ///
+    /// @param valence       the valence shared by all the vertices in the batch
+    ///                      (0 if it varies from vertex to vertex)
+    ///
     FarKernelBatch( KernelType kernelType,
                     int level,
                     int tableIndex,
@@ -105,7 +110,8 @@ public:
                     int end,
                     int tableOffset,
                     int vertexOffset,
-                    int meshIndex=0) :
+                    int meshIndex=0,
+                    int valence=0) :
         _kernelType(kernelType),
         _level(level),
         _tableIndex(tableIndex),
@@ -113,7 +119,8 @@ public:
         _end(end),
         _tableOffset(tableOffset),
         _vertexOffset(vertexOffset),
-        _meshIndex(meshIndex) {
+        _meshIndex(meshIndex),
+        _valence(valence) {
     }
 
     /// \brief Returns the type of kernel to apply to the vertices in the batch.
@@ -188,6 +195,15 @@ public:
         return _meshIndex;
     }
 
+    /// \brief Returns the valence shared by all the vertices in the batch, or
+    /// 0 if it varies. For face-vertex kernels this is the number of vertices
+    /// of the parent faces, for vertex-vertex "B" kernels the number of
+    /// vertices adjacent to the parent vertex. Kernels can use it to select an
+    /// implementation specialized for that valence.
+    int GetValence() const {
+        return _valence;
+    }
+
 private:
     friend class FarKernelBatchFactory;
     template <class X, class Y> friend class FarMultiMeshFactory;
@@ -200,6 +216,7 @@ private:
     int _tableOffset;
     int _vertexOffset;
     int _meshIndex;
+    int _valence;
 };
 
 typedef std::vector<FarKernelBatch> FarKernelBatchVector;
@@ -28,26 +28,63 @@
 #include "../version.h"
 
 #include "../far/kernelBatch.h"
+#include "../far/factoryStats.h"
+
+#include <vector>
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
-
-class FarVertexKernelBatchFactory {
-
+/// \brief Contiguous run of vertices sharing the same valence.
+///
+/// The vertices of a level are sorted by valence (see FarSubdivisionTablesFactory)
+/// so that the face-vertex and vertex-vertex "B" kernels can be split into
+/// valence-homogeneous batches.
+///
+class FarValenceRuns {
 public:
 
-    /// \brief Constructor.
+    /// \brief Adds a vertex to the runs
     ///
-    /// @param start index of the first vertex in the batch
+    /// @param index    the index of the vertex
     ///
-    /// @param end   index of the last vertex in the batch
+    /// @param valence  the valence of the vertex (0 if unknown)
     ///
-    FarVertexKernelBatchFactory(int start, int end) {
-        kernelB.start = kernelA1.start = kernelA2.start = start;
-        kernelB.end = kernelA1.end = kernelA2.end = end;
+    void AddVertex( int index, int valence ) {
+        if (_runs.empty() or _runs.back().end+1!=index or _runs.back().valence!=valence) {
+            Run run = { index, index, valence };
+            _runs.push_back(run);
+        } else {
+            _runs.back().end = index;
+        }
     }
 
+    /// \brief Appends a batch of the given kernel type for each run
+    void AppendBatches(FarKernelBatch::KernelType kernelType, int level,
+                       int tableOffset, int vertexOffset, FarKernelBatchVector *result) const {
+
+        for (int i=0; i<(int)_runs.size(); ++i)
+            result->push_back(FarKernelBatch( kernelType, level, 0,
+                                              _runs[i].start, _runs[i].end+1,
+                                              tableOffset, vertexOffset, 0,
+                                              _runs[i].valence) );
+    }
+
+private:
+
+    struct Run {
+        int start,
+            end,
+            valence;
+    };
+
+    std::vector<Run> _runs;
+};
+
+
+class FarVertexKernelBatchFactory {
+
+public:
 
     /// \brief Adds a vertex-vertex to the appropriate compute batch based on "Rank". 
     ///
@@ -94,7 +131,14 @@ public:
     /// @param rank  the rank of the vertex (see 
     ///              FarSubdivisionTables::GetMaskRanking())
     ///
-    void AddVertex( int index, int rank );
+    /// @param valence the number of vertices gathered by kernel B for this
+    ///              vertex (0 if unknown)
+    ///
+    /// Note : vertices are expected in increasing index order. Sorting them by
+    /// rank (see FarSubdivisionTablesFactory) minimizes the number of batches,
+    /// but is not required.
+    ///
+    void AddVertex( int index, int rank, int valence=0 );
 
 
 
@@ -126,38 +170,23 @@ public:
 
 private:
 
-    struct Range {
-        int start,
-            end;
-    };
-
-    Range kernelB;  // vertex batch reange (kernel B)
-    Range kernelA1; // vertex batch reange (kernel A pass 1)
-    Range kernelA2; // vertex batch reange (kernel A pass 2)
+    // contiguous runs of vertices of each kernel : the runs of kernel B are
+    // also split by valence
+    FarValenceRuns kernelBRuns,  // kernel B
+                   kernelA1Runs, // kernel A pass 1
+                   kernelA2Runs; // kernel A pass 2
 };
 
 inline void 
-FarVertexKernelBatchFactory::AddVertex( int index, int rank ) {
-
-    // expand the range of kernel batches based on vertex index and rank
-    if (rank<7) {
-        if (index < kernelB.start)
-            kernelB.start=index;
-        if (index > kernelB.end)
-            kernelB.end=index;
-    }
-    if ((rank>2) and (rank<8)) {
-        if (index < kernelA2.start)
-            kernelA2.start=index;
-        if (index > kernelA2.end)
-            kernelA2.end=index;
-    }
-    if (rank>6) {
-        if (index < kernelA1.start)
-            kernelA1.start=index;
-        if (index > kernelA1.end)
-            kernelA1.end=index;
-    }
+FarVertexKernelBatchFactory::AddVertex( int index, int rank, int valence ) {
+
+    // add the vertex to the runs of the kernels its rank requires
+    if (rank<7)
+        kernelBRuns.AddVertex(index, valence);
+    if ((rank>2) and (rank<8))
+        kernelA2Runs.AddVertex(index, 0);
+    if (rank>6)
+        kernelA1Runs.AddVertex(index, 0);
 }
 
 inline void 
@@ -166,18 +195,14 @@ FarVertexKernelBatchFactory::AppendCatmarkBatches(int level,
                                                   int vertexOffset, 
                                                   FarKernelBatchVector *result) {
 
-    if (kernelB.end >= kernelB.start)
-        result->push_back(FarKernelBatch( FarKernelBatch::CATMARK_VERT_VERTEX_B, level, 0,
-                                          kernelB.start, kernelB.end+1,
-                                          tableOffset, vertexOffset) );
-    if (kernelA1.end >= kernelA1.start)
-        result->push_back(FarKernelBatch( FarKernelBatch::CATMARK_VERT_VERTEX_A1, level, 0,
-                                          kernelA1.start, kernelA1.end+1,
-                                          tableOffset, vertexOffset));
-    if (kernelA2.end >= kernelA2.start)
-        result->push_back(FarKernelBatch( FarKernelBatch::CATMARK_VERT_VERTEX_A2, level, 0,
-                                          kernelA2.start, kernelA2.end+1,
-                                          tableOffset, vertexOffset) );
+    FarFactoryStats::Scope scope("FarVertexKernelBatchFactory::AppendCatmarkBatches");
+
+    kernelBRuns.AppendBatches(FarKernelBatch::CATMARK_VERT_VERTEX_B, level,
+                              tableOffset, vertexOffset, result);
+    kernelA1Runs.AppendBatches(FarKernelBatch::CATMARK_VERT_VERTEX_A1, level,
+                               tableOffset, vertexOffset, result);
+    kernelA2Runs.AppendBatches(FarKernelBatch::CATMARK_VERT_VERTEX_A2, level,
+                               tableOffset, vertexOffset, result);
 }
 
 inline void 
@@ -185,18 +210,15 @@ FarVertexKernelBatchFactory::AppendLoopBatches(int level,
                                                int tableOffset, 
                                                int vertexOffset, 
                                                FarKernelBatchVector *result) {
-    if (kernelB.end >= kernelB.start)
-        result->push_back(FarKernelBatch( FarKernelBatch::LOOP_VERT_VERTEX_B, level, 0,
-                                          kernelB.start, kernelB.end+1,
-                                          tableOffset, vertexOffset) );
-    if (kernelA1.end >= kernelA1.start)
-        result->push_back(FarKernelBatch( FarKernelBatch::LOOP_VERT_VERTEX_A1, level, 0,
-                                          kernelA1.start, kernelA1.end+1,
-                                          tableOffset, vertexOffset) );
-    if (kernelA2.end >= kernelA2.start)
-        result->push_back(FarKernelBatch( FarKernelBatch::LOOP_VERT_VERTEX_A2, level, 0,
-                                          kernelA2.start, kernelA2.end+1,
-                                          tableOffset, vertexOffset) );
+
+    FarFactoryStats::Scope scope("FarVertexKernelBatchFactory::AppendLoopBatches");
+
+    kernelBRuns.AppendBatches(FarKernelBatch::LOOP_VERT_VERTEX_B, level,
+                              tableOffset, vertexOffset, result);
+    kernelA1Runs.AppendBatches(FarKernelBatch::LOOP_VERT_VERTEX_A1, level,
+                               tableOffset, vertexOffset, result);
+    kernelA2Runs.AppendBatches(FarKernelBatch::LOOP_VERT_VERTEX_A2, level,
+                               tableOffset, vertexOffset, result);
 }
 
 } // end namespace OPENSUBDIV_VERSION
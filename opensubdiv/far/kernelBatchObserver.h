@@ -0,0 +1,110 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+#ifndef FAR_KERNEL_BATCH_OBSERVER_H
+#define FAR_KERNEL_BATCH_OBSERVER_H
+
+#include "../version.h"
+
+#include "../far/kernelBatch.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+/// \brief Instrumentation interface for the processing of kernel batches.
+///
+/// An observer passed to FarDispatcher::Refine() is notified before and after
+/// each kernel batch is applied by a compute controller. The Osd controllers
+/// pass the observer attached to the compute context they refine (see
+/// SetKernelBatchObserver()). When no observer is given, the dispatcher skips
+/// the notifications entirely.
+///
+/// Note : the notifications come from the thread that refines the context.
+/// An observer attached to several contexts refined concurrently (by
+/// OsdCpuAsyncComputeController or OsdOmpRefineScheduler) is notified from
+/// several threads at once; attach a separate observer to each context
+/// instead.
+///
+/// Note : controllers that launch their kernels asynchronously (GPU devices)
+/// only return control to the dispatcher once the kernel has been queued, so
+/// the interval between the two notifications does not cover the execution
+/// of the kernel on the device.
+///
+/// Note : the caller is responsible for deleting the observer
+///
+class FarKernelBatchObserver {
+public:
+    /// Destructor
+    virtual ~FarKernelBatchObserver() { }
+
+    /// \brief Called before the batch is handed to the controller
+    ///
+    /// @param batch  the kernel batch about to be processed
+    ///
+    virtual void BeginBatch(FarKernelBatch const & batch) = 0;
+
+    /// \brief Called after the controller has applied the batch
+    ///
+    /// @param batch  the kernel batch that was processed
+    ///
+    virtual void EndBatch(FarKernelBatch const & batch) = 0;
+
+    /// \brief Returns the number of vertices (or vertex edits, or structured
+    /// grids) processed by the batch
+    static int GetNumVertices(FarKernelBatch const & batch) {
+        return batch.GetEnd() - batch.GetStart();
+    }
+
+    /// \brief Returns the name of a kernel type
+    static char const * GetKernelTypeName(FarKernelBatch::KernelType kernelType);
+};
+
+inline char const *
+FarKernelBatchObserver::GetKernelTypeName(FarKernelBatch::KernelType kernelType) {
+
+    switch (kernelType) {
+        case FarKernelBatch::CATMARK_FACE_VERTEX    : return "CATMARK_FACE_VERTEX";
+        case FarKernelBatch::CATMARK_EDGE_VERTEX    : return "CATMARK_EDGE_VERTEX";
+        case FarKernelBatch::CATMARK_VERT_VERTEX_A1 : return "CATMARK_VERT_VERTEX_A1";
+        case FarKernelBatch::CATMARK_VERT_VERTEX_A2 : return "CATMARK_VERT_VERTEX_A2";
+        case FarKernelBatch::CATMARK_VERT_VERTEX_B  : return "CATMARK_VERT_VERTEX_B";
+        case FarKernelBatch::LOOP_EDGE_VERTEX       : return "LOOP_EDGE_VERTEX";
+        case FarKernelBatch::LOOP_VERT_VERTEX_A1    : return "LOOP_VERT_VERTEX_A1";
+        case FarKernelBatch::LOOP_VERT_VERTEX_A2    : return "LOOP_VERT_VERTEX_A2";
+        case FarKernelBatch::LOOP_VERT_VERTEX_B     : return "LOOP_VERT_VERTEX_B";
+        case FarKernelBatch::BILINEAR_FACE_VERTEX   : return "BILINEAR_FACE_VERTEX";
+        case FarKernelBatch::BILINEAR_EDGE_VERTEX   : return "BILINEAR_EDGE_VERTEX";
+        case FarKernelBatch::BILINEAR_VERT_VERTEX   : return "BILINEAR_VERT_VERTEX";
+        case FarKernelBatch::HIERARCHICAL_EDIT      : return "HIERARCHICAL_EDIT";
+        case FarKernelBatch::CATMARK_STRUCTURED_GRID: return "CATMARK_STRUCTURED_GRID";
+        case FarKernelBatch::END_CAP                : return "END_CAP";
+    }
+    return "UNKNOWN";
+}
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif  /* FAR_KERNEL_BATCH_OBSERVER_H */
@@ -0,0 +1,254 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+#ifndef FAR_KERNEL_BATCH_PROFILER_H
+#define FAR_KERNEL_BATCH_PROFILER_H
+
+#include "../version.h"
+
+#include "../far/kernelBatchObserver.h"
+#include "../far/stopwatch.h"
+
+#include <iomanip>
+#include <ostream>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+/// \brief A kernel batch observer that times every batch.
+///
+/// The profiler records one event per batch processed by the dispatcher and
+/// aggregates the timings per kernel type. The events can be exported in the
+/// Chrome trace event format (chrome://tracing).
+///
+/// Note : the profiler is not thread-safe. When meshes are refined
+/// concurrently, attach a separate profiler to each compute context and
+/// Merge() them once the refinement has completed.
+///
+class FarKernelBatchProfiler : public FarKernelBatchObserver {
+public:
+    /// \brief A timed kernel batch
+    struct Event {
+        FarKernelBatch::KernelType kernelType;
+
+        int    level,
+               numVertices,
+               meshIndex;
+
+        double start,     // in seconds, relative to the creation of the profiler
+               duration;  // in seconds
+    };
+
+    /// \brief Statistics aggregated for a given kernel type
+    struct Statistics {
+        Statistics() : numBatches(0), numVertices(0), totalTime(0.0), minTime(0.0), maxTime(0.0) { }
+
+        int    numBatches,
+               numVertices;
+
+        double totalTime,  // all times in seconds
+               minTime,
+               maxTime;
+    };
+
+    /// Constructor
+    FarKernelBatchProfiler() : _origin(FarStopwatch::GetTime()), _batchStart(0.0) { }
+
+    /// Destructor
+    virtual ~FarKernelBatchProfiler() { }
+
+    /// \brief Starts timing a batch (FarKernelBatchObserver interface)
+    virtual void BeginBatch(FarKernelBatch const & batch);
+
+    /// \brief Records the timed batch (FarKernelBatchObserver interface)
+    virtual void EndBatch(FarKernelBatch const & batch);
+
+    /// \brief Returns the events recorded since the last reset
+    std::vector<Event> const & GetEvents() const {
+        return _events;
+    }
+
+    /// \brief Returns the statistics aggregated for a kernel type
+    Statistics const & GetStatistics(FarKernelBatch::KernelType kernelType) const {
+        return _statistics[kernelType];
+    }
+
+    /// \brief Discards all the events and statistics recorded so far
+    void Reset();
+
+    /// \brief Appends the events and statistics recorded by another profiler
+    /// (the start times of its events are rebased on the origin of this one)
+    void Merge(FarKernelBatchProfiler const & other);
+
+    /// \brief Writes the statistics aggregated per kernel type as a table
+    void PrintStatistics(std::ostream & os) const;
+
+    /// \brief Writes the recorded events in the Chrome trace event (JSON)
+    /// format
+    void WriteChromeTrace(std::ostream & os) const;
+
+private:
+    enum { NUM_KERNEL_TYPES = FarKernelBatch::END_CAP + 1 };
+
+    std::vector<Event> _events;
+
+    Statistics _statistics[NUM_KERNEL_TYPES];
+
+    double _origin,
+           _batchStart;
+};
+
+inline void
+FarKernelBatchProfiler::BeginBatch(FarKernelBatch const & /* batch */) {
+
+    _batchStart = FarStopwatch::GetTime();
+}
+
+inline void
+FarKernelBatchProfiler::EndBatch(FarKernelBatch const & batch) {
+
+    double end = FarStopwatch::GetTime();
+
+    Event event;
+    event.kernelType = batch.GetKernelType();
+    event.level = batch.GetLevel();
+    event.numVertices = GetNumVertices(batch);
+    event.meshIndex = batch.GetMeshIndex();
+    event.start = _batchStart - _origin;
+    event.duration = end - _batchStart;
+    _events.push_back(event);
+
+    Statistics & stats = _statistics[event.kernelType];
+    if (stats.numBatches==0 or event.duration < stats.minTime)
+        stats.minTime = event.duration;
+    if (stats.numBatches==0 or event.duration > stats.maxTime)
+        stats.maxTime = event.duration;
+    ++stats.numBatches;
+    stats.numVertices += event.numVertices;
+    stats.totalTime += event.duration;
+}
+
+inline void
+FarKernelBatchProfiler::Reset() {
+
+    _events.clear();
+    for (int i=0; i<NUM_KERNEL_TYPES; ++i)
+        _statistics[i] = Statistics();
+    _origin = FarStopwatch::GetTime();
+}
+
+inline void
+FarKernelBatchProfiler::Merge(FarKernelBatchProfiler const & other) {
+
+    double offset = other._origin - _origin;
+
+    for (int i=0; i<(int)other._events.size(); ++i) {
+        Event event = other._events[i];
+        event.start += offset;
+        _events.push_back(event);
+    }
+
+    for (int i=0; i<NUM_KERNEL_TYPES; ++i) {
+
+        Statistics & stats = _statistics[i];
+        Statistics const & otherStats = other._statistics[i];
+        if (otherStats.numBatches==0)
+            continue;
+
+        if (stats.numBatches==0 or otherStats.minTime < stats.minTime)
+            stats.minTime = otherStats.minTime;
+        if (stats.numBatches==0 or otherStats.maxTime > stats.maxTime)
+            stats.maxTime = otherStats.maxTime;
+        stats.numBatches += otherStats.numBatches;
+        stats.numVertices += otherStats.numVertices;
+        stats.totalTime += otherStats.totalTime;
+    }
+}
+
+inline void
+FarKernelBatchProfiler::PrintStatistics(std::ostream & os) const {
+
+    std::ios_base::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+
+    os << std::left << std::setw(24) << "kernel" << std::right
+       << std::setw(9) << "batches" << std::setw(11) << "vertices"
+       << std::setw(12) << "total(ms)" << std::setw(10) << "min(ms)"
+       << std::setw(10) << "max(ms)" << "\n";
+
+    os << std::fixed << std::setprecision(4);
+
+    for (int i=0; i<NUM_KERNEL_TYPES; ++i) {
+
+        Statistics const & stats = _statistics[i];
+        if (stats.numBatches==0)
+            continue;
+
+        os << std::left << std::setw(24) << GetKernelTypeName((FarKernelBatch::KernelType)i)
+           << std::right << std::setw(9) << stats.numBatches
+           << std::setw(11) << stats.numVertices
+           << std::setw(12) << stats.totalTime*1000.0
+           << std::setw(10) << stats.minTime*1000.0
+           << std::setw(10) << stats.maxTime*1000.0 << "\n";
+    }
+
+    os.flags(flags);
+    os.precision(precision);
+}
+
+inline void
+FarKernelBatchProfiler::WriteChromeTrace(std::ostream & os) const {
+
+    std::ios_base::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+
+    os << std::fixed << std::setprecision(3);
+
+    // timestamps and durations are expressed in microseconds, the mesh index
+    // is used as thread id so that batched meshes show up on separate tracks
+    os << "{ \"traceEvents\" : [";
+    for (int i=0; i<(int)_events.size(); ++i) {
+
+        Event const & event = _events[i];
+
+        os << (i ? "," : "") << "\n  { \"name\" : \"" << GetKernelTypeName(event.kernelType) << "\", "
+           << "\"cat\" : \"far\", \"ph\" : \"X\", "
+           << "\"ts\" : " << event.start*1000000.0 << ", "
+           << "\"dur\" : " << event.duration*1000000.0 << ", "
+           << "\"pid\" : 0, \"tid\" : " << event.meshIndex << ", "
+           << "\"args\" : { \"level\" : " << event.level << ", "
+           << "\"vertices\" : " << event.numVertices << " } }";
+    }
+    os << "\n], \"displayTimeUnit\" : \"ms\" }\n";
+
+    os.flags(flags);
+    os.precision(precision);
+}
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif  /* FAR_KERNEL_BATCH_PROFILER_H */
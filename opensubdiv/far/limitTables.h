@@ -0,0 +1,147 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+
+#ifndef FAR_LIMIT_TABLES_H
+#define FAR_LIMIT_TABLES_H
+
+#include "../version.h"
+
+#include "../far/memoryUsage.h"
+
+#include <cassert>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+/// \brief Limit masks of the vertices of the finest level of subdivision.
+///
+/// After uniform refinement, the vertices of the finest level are only an
+/// approximation of the limit surface. A limit mask is a set of weights over
+/// the one-ring of a vertex : applying the mask to the refined vertices
+/// projects the vertex onto the limit surface and computes two tangents of the
+/// surface at that point, so that a single sweep over the finest level replaces
+/// an evaluation pass of the limit surface.
+///
+/// The masks are stored in a compressed row format : the ring of mask 'i' is
+/// made of the vertices Indices[Offsets[i]] to Indices[Offsets[i+1]-1] and
+/// each ring vertex has 3 interleaved weights (position, first tangent and
+/// second tangent). The mask writes its results at the index Vertices[i] of
+/// the output buffers.
+///
+/// Note : the tangents are not normalized ; their cross product is oriented
+/// along the winding of the faces.
+///
+class FarLimitTables {
+
+public:
+    /// \brief Returns the number of limit masks
+    int GetNumVertices() const { return (int)_vertices.size(); }
+
+    /// \brief Returns the index of the vertex projected by each mask
+    std::vector<int> const & GetVertices() const { return _vertices; }
+
+    /// \brief Returns the offsets of the masks in the indices table
+    /// (GetNumVertices()+1 entries)
+    std::vector<int> const & GetOffsets() const { return _offsets; }
+
+    /// \brief Returns the indices of the ring vertices of the masks
+    std::vector<int> const & GetIndices() const { return _indices; }
+
+    /// \brief Returns the interleaved position and tangent weights of the ring
+    /// vertices (3 per index)
+    std::vector<float> const & GetWeights() const { return _weights; }
+
+    /// \brief Applies the limit masks to a vector of refined vertices (Far
+    /// reference implementation)
+    ///
+    /// @param vertices   the refined vertices
+    ///
+    /// @param positions  destination of the limit positions (can be NULL)
+    ///
+    /// @param tangents1  destination of the first tangents (can be NULL)
+    ///
+    /// @param tangents2  destination of the second tangents (can be NULL)
+    ///
+    template <class U> void Apply( U const * vertices, U * positions, U * tangents1=0, U * tangents2=0 ) const;
+
+    /// \brief Itemized memory allocated by the tables
+    FarMemoryUsage GetMemoryUsage() const {
+        FarMemoryUsage result;
+        result.AddVector("vertices", _vertices);
+        result.AddVector("offsets", _offsets);
+        result.AddVector("indices", _indices);
+        result.AddVector("weights", _weights);
+        return result;
+    }
+
+private:
+    template <class X, class Y> friend class FarLimitTablesFactory;
+
+    FarLimitTables() { }
+
+    std::vector<int>   _vertices, // index of the vertex of each mask
+                       _offsets,  // offsets of the masks in the indices table
+                       _indices;  // ring vertices of the masks
+
+    std::vector<float> _weights;  // interleaved position & tangent weights
+};
+
+template <class U> void
+FarLimitTables::Apply( U const * vertices, U * positions, U * tangents1, U * tangents2 ) const {
+
+    assert(vertices);
+
+    for (int i=0; i<GetNumVertices(); ++i) {
+
+        int dst = _vertices[i];
+
+        if (positions)
+            positions[dst].Clear();
+        if (tangents1)
+            tangents1[dst].Clear();
+        if (tangents2)
+            tangents2[dst].Clear();
+
+        for (int j=_offsets[i]; j<_offsets[i+1]; ++j) {
+
+            U const & src = vertices[_indices[j]];
+            float const * w = &_weights[3*j];
+
+            if (positions)
+                positions[dst].AddWithWeight(src, w[0]);
+            if (tangents1)
+                tangents1[dst].AddWithWeight(src, w[1]);
+            if (tangents2)
+                tangents2[dst].AddWithWeight(src, w[2]);
+        }
+    }
+}
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif /* FAR_LIMIT_TABLES_H */
@@ -0,0 +1,370 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+
+#ifndef FAR_LIMIT_TABLES_FACTORY_H
+#define FAR_LIMIT_TABLES_FACTORY_H
+
+#include "../version.h"
+
+#include "../hbr/mesh.h"
+
+#include "../far/limitTables.h"
+#include "../far/factoryStats.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+template <class T, class U> class FarMeshFactory;
+
+/// \brief A specialized factory for FarLimitTables
+///
+/// The masks are computed for the vertices of the faces of the finest level of
+/// a uniformly refined Catmark or Loop mesh :
+/// - smooth and dart vertices use the smooth limit and tangent masks of the
+///   scheme
+/// - boundary and crease vertices use the cubic B-spline limit of the crease
+///   curve, the tangent along the crease and the tangent across the faces on
+///   one side of the crease
+/// - corner vertices are already on the limit surface and their tangents are
+///   aligned with their first incident edges
+///
+/// Semi-sharp features are classified with their sharpness at the finest level :
+/// the masks are exact once the sharpness of the features in the one-ring has
+/// either decayed to 0 or is infinite. Hierarchical edits are not accounted for.
+///
+/// This factory is private to Far and should not be used by client code.
+///
+template <class T, class U> class FarLimitTablesFactory {
+
+protected:
+    template <class X, class Y> friend class FarMeshFactory;
+
+    /// \brief Creates a FarLimitTables instance (NULL if the scheme is not
+    /// supported)
+    static FarLimitTables * Create( FarMeshFactory<T,U> const * factory );
+
+private:
+
+    // Limit mask of a vertex under construction : ring vertices may appear
+    // more than once.
+    struct Mask {
+        std::vector<HbrVertex<T> *> verts;
+        std::vector<float> weights;
+
+        void Add( HbrVertex<T> * v, double wp, double wt1, double wt2 ) {
+            verts.push_back(v);
+            weights.push_back((float)wp);
+            weights.push_back((float)wt1);
+            weights.push_back((float)wt2);
+        }
+    };
+
+    // Gathers the one-ring of v in counter-clockwise order : 'edges' receives
+    // the vertices across the incident edges (and their sharpness), 'faces' the
+    // vertices opposite to v in the incident quads. Returns false if the ring
+    // cannot be represented.
+    static bool gatherRing( HbrVertex<T> * v, bool quads, bool & boundary,
+                            std::vector<HbrVertex<T> *> & edges,
+                            std::vector<HbrVertex<T> *> & faces,
+                            std::vector<bool> & sharp );
+
+    // Corner rule : the vertex is interpolated
+    static void computeCornerMask( HbrVertex<T> * v, HbrVertex<T> * e0, HbrVertex<T> * e1, Mask & mask );
+
+    // Crease rule over the edges e[0..k] and faces f[0..k-1] of a ring
+    static void computeCreaseMask( HbrVertex<T> * v, HbrVertex<T> * const * e, HbrVertex<T> * const * f, int k, bool loop, Mask & mask );
+
+    // Smooth rule over the edges e[0..n-1] and faces f[0..n-1] of a ring
+    static void computeSmoothMask( HbrVertex<T> * v, HbrVertex<T> * const * e, HbrVertex<T> * const * f, int n, bool loop, Mask & mask );
+
+    // Computes the limit mask of a vertex
+    static void computeMask( HbrVertex<T> * v, bool loop, Mask & mask );
+};
+
+template <class T, class U> bool
+FarLimitTablesFactory<T,U>::gatherRing( HbrVertex<T> * v, bool quads, bool & boundary,
+                                        std::vector<HbrVertex<T> *> & edges,
+                                        std::vector<HbrVertex<T> *> & faces,
+                                        std::vector<bool> & sharp ) {
+
+    edges.clear();
+    faces.clear();
+    sharp.clear();
+    boundary = false;
+
+    if (v->IsSingular())
+        return false;
+
+    HbrHalfedge<T> * start = v->GetIncidentEdge(), * e = start;
+    if (not start)
+        return false;
+
+    do {
+        HbrFace<T> * f = e->GetFace();
+        if (not f or (f->GetNumVertices() != (quads ? 4 : 3)))
+            return false;
+
+        edges.push_back(e->GetDestVertex());
+        sharp.push_back(e->IsSharp(false));
+        if (quads)
+            faces.push_back(e->GetNext()->GetDestVertex());
+
+        HbrHalfedge<T> * next = v->GetNextEdge(e);
+        if (not next) {
+            // the last edge of a boundary ring is the previous edge of the
+            // last face
+            boundary = true;
+            edges.push_back(e->GetPrev()->GetOrgVertex());
+            sharp.push_back(e->GetPrev()->IsSharp(false));
+            break;
+        }
+        e = next;
+    } while (e != start);
+
+    return true;
+}
+
+template <class T, class U> void
+FarLimitTablesFactory<T,U>::computeCornerMask( HbrVertex<T> * v, HbrVertex<T> * e0, HbrVertex<T> * e1, Mask & mask ) {
+
+    mask.Add(v, 1.0, -1.0, -1.0);
+    mask.Add(e0, 0.0, 1.0, 0.0);
+    mask.Add(e1, 0.0, 0.0, 1.0);
+}
+
+template <class T, class U> void
+FarLimitTablesFactory<T,U>::computeCreaseMask( HbrVertex<T> * v, HbrVertex<T> * const * e, HbrVertex<T> * const * f, int k, bool loop, Mask & mask ) {
+
+    assert(k>=1);
+
+    // limit position on the cubic B-spline crease curve & tangent along the
+    // crease
+    mask.Add(v,    4.0/6.0,  0.0, 0.0);
+    mask.Add(e[0], 1.0/6.0,  0.5, 0.0);
+    mask.Add(e[k], 1.0/6.0, -0.5, 0.0);
+
+    // tangent across the k faces of the ring
+    if (k==1) {
+        mask.Add(v,    0.0, 0.0, -2.0);
+        mask.Add(e[0], 0.0, 0.0,  1.0);
+        mask.Add(e[1], 0.0, 0.0,  1.0);
+        return;
+    }
+
+    double theta = M_PI / k,
+           cosTheta = cos(theta),
+           sinTheta = sin(theta);
+
+    if (loop) {
+
+        // left eigenvector of the subdivision matrix of the ring under the
+        // Hbr rules (crease vertex : 3/4, 1/8, 1/8 ; crease edges : 1/2, 1/2 ;
+        // smooth edges : 3/8, 3/8, 1/8, 1/8). The smooth edges weigh
+        // sin(i*theta) with the eigenvalue l = 3/8 + cos(theta)/4, and the
+        // weights a of v and b of e[0] and e[k] solve :
+        //   (l - 1/2) b - a/8 = sin(theta) / 8
+        //   (l - 3/4) a - b   = 3/8 sum(sin(i*theta))
+        double l = 0.375 + 0.25*cosTheta,
+               sum = 0.0;
+        for (int i=1; i<k; ++i)
+            sum += sin(i*theta);
+
+        double b = (0.375*sum + (l-0.75)*sinTheta) / (8.0*(l-0.75)*(l-0.5) - 1.0),
+               a = 8.0*(l-0.5)*b - sinTheta;
+
+        mask.Add(v,    0.0, 0.0, a);
+        mask.Add(e[0], 0.0, 0.0, b);
+        mask.Add(e[k], 0.0, 0.0, b);
+        for (int i=1; i<k; ++i)
+            mask.Add(e[i], 0.0, 0.0, sin(i*theta));
+    } else {
+
+        // Biermann et al. : "Piecewise smooth subdivision surfaces with normal
+        // control"
+        double denom = 1.0 / (k * (3.0 + cosTheta)),
+               R = (cosTheta + 1.0) / sinTheta;
+
+        mask.Add(v,    0.0, 0.0, 4.0*R*(cosTheta-1.0)*denom);
+        mask.Add(e[0], 0.0, 0.0, -R*(1.0+2.0*cosTheta)*denom);
+        mask.Add(e[k], 0.0, 0.0, -R*(1.0+2.0*cosTheta)*denom);
+        for (int i=1; i<k; ++i)
+            mask.Add(e[i], 0.0, 0.0, 4.0*sin(i*theta)*denom);
+        for (int i=0; i<k; ++i)
+            mask.Add(f[i], 0.0, 0.0, (sin(i*theta)+sin((i+1)*theta))*denom);
+    }
+}
+
+template <class T, class U> void
+FarLimitTablesFactory<T,U>::computeSmoothMask( HbrVertex<T> * v, HbrVertex<T> * const * e, HbrVertex<T> * const * f, int n, bool loop, Mask & mask ) {
+
+    double theta = 2.0 * M_PI / n;
+
+    if (loop) {
+
+        double beta = 0.375 + 0.25*cos(theta);
+        beta = (0.625 - beta*beta) / n;
+
+        double chi = 1.0 / (3.0/(8.0*beta) + n);
+
+        mask.Add(v, 1.0-n*chi, 0.0, 0.0);
+        for (int i=0; i<n; ++i)
+            mask.Add(e[i], chi, cos(i*theta), sin(i*theta));
+    } else {
+
+        double wf = 1.0 / (n*(n+5.0)),
+               A = 1.0 + cos(theta) + cos(0.5*theta)*sqrt(2.0*(9.0+cos(theta)));
+
+        mask.Add(v, n*n*wf, 0.0, 0.0);
+        for (int i=0; i<n; ++i) {
+            mask.Add(e[i], 4.0*wf, A*cos(i*theta), A*sin(i*theta));
+            mask.Add(f[i], wf, cos(i*theta)+cos((i+1)*theta),
+                               sin(i*theta)+sin((i+1)*theta));
+        }
+    }
+}
+
+template <class T, class U> void
+FarLimitTablesFactory<T,U>::computeMask( HbrVertex<T> * v, bool loop, Mask & mask ) {
+
+    bool boundary;
+    std::vector<HbrVertex<T> *> edges, faces;
+    std::vector<bool> sharp;
+
+    if (not gatherRing(v, not loop, boundary, edges, faces, sharp)) {
+        // unsupported topology : leave the vertex where it is
+        mask.Add(v, 1.0, 0.0, 0.0);
+        return;
+    }
+
+    // pad the face vertices so that the loop rules can share the indexing
+    if (loop)
+        faces.resize(edges.size(), 0);
+
+    int n = (int)edges.size();
+
+    unsigned char vmask = v->GetMask(false);
+
+    if (vmask>=HbrVertex<T>::k_Corner or (boundary and n<2)) {
+        computeCornerMask(v, edges[0], edges[boundary ? n-1 : 1], mask);
+    } else if (boundary) {
+        computeCreaseMask(v, &edges[0], &faces[0], n-1, loop, mask);
+    } else if (vmask==HbrVertex<T>::k_Crease) {
+
+        // rotate the ring so that it starts with the first sharp edge and
+        // apply the crease rule to the faces up to the second sharp edge
+        int a=0, b=0;
+        while (not sharp[a])
+            ++a;
+        b = a+1;
+        while (not sharp[b%n])
+            ++b;
+
+        std::vector<HbrVertex<T> *> e(n+1), f(n+1);
+        for (int i=0; i<=n; ++i) {
+            e[i] = edges[(a+i)%n];
+            f[i] = faces[(a+i)%n];
+        }
+        computeCreaseMask(v, &e[0], &f[0], b-a, loop, mask);
+    } else {
+        computeSmoothMask(v, &edges[0], &faces[0], n, loop, mask);
+    }
+}
+
+template <class T, class U> FarLimitTables *
+FarLimitTablesFactory<T,U>::Create( FarMeshFactory<T,U> const * factory ) {
+
+    assert( factory );
+
+    HbrMesh<T> const * mesh = factory->GetHbrMesh();
+
+    bool loop = FarMeshFactory<T,U>::isLoop(mesh);
+    if (not (loop or FarMeshFactory<T,U>::isCatmark(mesh)))
+        return 0;
+
+    FarFactoryStats::Scope scope("FarLimitTablesFactory::Create");
+
+    std::vector<int> const & remap = factory->_remapTable;
+
+    // gather the vertices of the faces of the finest level, sorted by their
+    // index in the FarMesh
+    typedef std::pair<int, HbrVertex<T> *> VertexPair;
+    std::vector<VertexPair> verts;
+
+    std::vector<char> gathered(mesh->GetNumVertices(), 0);
+
+    std::vector<HbrFace<T> *> const & faces = factory->_facesList[factory->GetMaxLevel()];
+    for (int i=0; i<(int)faces.size(); ++i) {
+        HbrFace<T> * f = faces[i];
+        for (int j=0; j<f->GetNumVertices(); ++j) {
+            HbrVertex<T> * v = f->GetVertex(j);
+            if (not gathered[v->GetID()]) {
+                gathered[v->GetID()] = 1;
+                verts.push_back(VertexPair(remap[v->GetID()], v));
+            }
+        }
+    }
+    std::sort(verts.begin(), verts.end());
+
+    FarLimitTables * result = new FarLimitTables;
+
+    result->_vertices.resize(verts.size());
+    result->_offsets.resize(verts.size()+1);
+    result->_offsets[0] = 0;
+    result->_indices.reserve(verts.size() * (loop ? 7 : 9));
+    result->_weights.reserve(verts.size() * (loop ? 7 : 9) * 3);
+
+    Mask mask;
+    for (int i=0; i<(int)verts.size(); ++i) {
+
+        mask.verts.clear();
+        mask.weights.clear();
+
+        computeMask(verts[i].second, loop, mask);
+
+        for (int j=0; j<(int)mask.verts.size(); ++j) {
+            result->_indices.push_back(remap[mask.verts[j]->GetID()]);
+            result->_weights.insert(result->_weights.end(), &mask.weights[3*j], &mask.weights[3*j]+3);
+        }
+        result->_vertices[i] = verts[i].first;
+        result->_offsets[i+1] = (int)result->_indices.size();
+    }
+
+    FarFactoryStats::Count(FarFactoryStats::BYTES_ALLOCATED,
+        result->GetMemoryUsage().GetTotal());
+
+    return result;
+}
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif /* FAR_LIMIT_TABLES_FACTORY_H */
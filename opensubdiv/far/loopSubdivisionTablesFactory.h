@@ -59,6 +59,17 @@ protected:
     ///                     will reserve and append refinement tasks
     ///
     static FarLoopSubdivisionTables<U> * Create( FarMeshFactory<T,U> * meshFactory, FarMesh<U> * farMesh, FarKernelBatchVector * batches );
+
+    // Computes the indices and weights of the edge vertex v (4 E_IT indices
+    // and 2 E_W weights)
+    static void computeEdgeVertex( HbrVertex<T> * v, std::vector<int> const & remap,
+                                   int * E_IT, float * E_W );
+
+    // Computes the indices and weight of the vertex vertex v (5 V_ITa entries
+    // and 1 V_W weight) : V_ITa[0] must be set to the offset of its ring in the
+    // V_IT table. Returns the rank of the vertex (see GetMaskRanking).
+    static int computeVertexVertex( HbrVertex<T> * v, std::vector<int> const & remap,
+                                    int * V_ITa, unsigned int * V_IT, float * V_W );
 };
 
 // This factory walks the Hbr vertices and accumulates the weights and adjacency
@@ -69,6 +80,8 @@ FarLoopSubdivisionTablesFactory<T,U>::Create( FarMeshFactory<T,U> * meshFactory,
 
     assert( meshFactory and farMesh );
 
+    FarFactoryStats::Scope scope("FarLoopSubdivisionTablesFactory::Create");
+
     int maxlevel = meshFactory->GetMaxLevel();
     
     std::vector<int> & remap = meshFactory->getRemappingTable();
@@ -125,140 +138,30 @@ FarLoopSubdivisionTablesFactory<T,U>::Create( FarMeshFactory<T,U> * meshFactory,
 
             HbrVertex<T> * v = tablesFactory._edgeVertsList[level][i];
             assert(v);
-            HbrHalfedge<T> * e = v->GetParentEdge();
-            assert(e);
-
-            float esharp = e->GetSharpness(),
-                  endPtWeight = 0.5f,
-                  oppPtWeight = 0.5f;
-
-            E_IT[4*i+0]= remap[e->GetOrgVertex()->GetID()];
-            E_IT[4*i+1]= remap[e->GetDestVertex()->GetID()];
-
-            if (!e->IsBoundary() && esharp <= 1.0f) {
-                endPtWeight = 0.375f + esharp * (0.5f - 0.375f);
-                oppPtWeight = 0.125f * (1 - esharp);
-
-                HbrHalfedge<T>* ee = e->GetNext();
-                E_IT[4*i+2]= remap[ee->GetDestVertex()->GetID()];
-                ee = e->GetOpposite()->GetNext();
-                E_IT[4*i+3]= remap[ee->GetDestVertex()->GetID()];
-            } else {
-                E_IT[4*i+2]= -1;
-                E_IT[4*i+3]= -1;
-            }
-            E_W[2*i+0] = endPtWeight;
-            E_W[2*i+1] = oppPtWeight;
+
+            computeEdgeVertex(v, remap, E_IT+4*i, E_W+2*i);
         }
         E_IT += 4 * nEdgeVertices;
         E_W += 2 * nEdgeVertices;
 
         // Vertex vertices
 
-        FarVertexKernelBatchFactory batchFactory((int)tablesFactory._vertVertsList[level].size(), 0);
+        FarVertexKernelBatchFactory batchFactory;
 
         int nVertVertices = (int)tablesFactory._vertVertsList[level].size();
         for (int i=0; i < nVertVertices; ++i) {
 
-            HbrVertex<T> * v = tablesFactory._vertVertsList[level][i],
-                         * pv = v->GetParentVertex();
-            assert(v and pv);
-
-            // Look at HbrCatmarkSubdivision<T>::Subdivide for more details about
-            // the multi-pass interpolation
-            unsigned char masks[2];
-            int npasses;
-            float weights[2];
-            masks[0] = pv->GetMask(false);
-            masks[1] = pv->GetMask(true);
-
-            // If the masks are identical, only a single pass is necessary. If the
-            // vertex is transitioning to another rule, two passes are necessary,
-            // except when transitioning from k_Dart to k_Smooth : the same
-            // compute kernel is applied twice. Combining this special case allows
-            // to batch the compute kernels into fewer calls.
-            if (masks[0] != masks[1] and (
-                not (masks[0]==HbrVertex<T>::k_Smooth and
-                     masks[1]==HbrVertex<T>::k_Dart))) {
-                weights[1] = pv->GetFractionalMask();
-                weights[0] = 1.0f - weights[1];
-                npasses = 2;
-            } else {
-                weights[0] = 1.0f;
-                weights[1] = 0.0f;
-                npasses = 1;
-            }
-
-            int rank = FarSubdivisionTablesFactory<T,U>::GetMaskRanking(masks[0], masks[1]);
+            HbrVertex<T> * v = tablesFactory._vertVertsList[level][i];
+            assert(v);
 
             V_ITa[5*i+0] = V_IT_offset;
-            V_ITa[5*i+1] = 0;
-            V_ITa[5*i+2] = remap[ pv->GetID() ];
-            V_ITa[5*i+3] = -1;
-            V_ITa[5*i+4] = -1;
-
-            for (int p=0; p<npasses; ++p)
-                switch (masks[p]) {
-                    case HbrVertex<T>::k_Smooth :
-                    case HbrVertex<T>::k_Dart : {
-                        HbrHalfedge<T> *e = pv->GetIncidentEdge(),
-                                       *start = e;
-                        while (e) {
-                            V_ITa[5*i+1]++;
 
-                            V_IT[V_IT_offset++] = remap[ e->GetDestVertex()->GetID() ];
+            int rank = computeVertexVertex(v, remap, V_ITa+5*i, V_IT, V_W+i);
 
-                            e = e->GetPrev()->GetOpposite();
+            if (V_ITa[5*i+1] > 0)
+                V_IT_offset += V_ITa[5*i+1];
 
-                            if (e==start) break;
-                        }
-                        break;
-                    }
-                    case HbrVertex<T>::k_Crease : {
-
-                        class GatherCreaseEdgesOperator : public HbrHalfedgeOperator<T> {
-                        public:
-                            HbrVertex<T> * vertex; int eidx[2]; int count; bool next;
-
-                            GatherCreaseEdgesOperator(HbrVertex<T> * v, bool n) : vertex(v), count(0), next(n) { eidx[0]=-1; eidx[1]=-1; }
-
-                            virtual void operator() (HbrHalfedge<T> &e) {
-                                if (e.IsSharp(next) and count < 2) {
-                                    HbrVertex<T> * a = e.GetDestVertex();
-                                    if (a==vertex)
-                                        a = e.GetOrgVertex();
-                                    eidx[count++]=a->GetID();
-                                }
-                            }
-                        };
-
-                        GatherCreaseEdgesOperator op( pv, p==1 );
-                        pv->ApplyOperatorSurroundingEdges( op );
-
-                        assert(V_ITa[5*i+3]==-1 and V_ITa[5*i+4]==-1);
-                        assert(op.eidx[0]!=-1 and op.eidx[1]!=-1);
-                        V_ITa[5*i+3] = remap[op.eidx[0]];
-                        V_ITa[5*i+4] = remap[op.eidx[1]];
-                        break;
-                    }
-                    case HbrVertex<T>::k_Corner :
-                        // in the case of a k_Crease / k_Corner pass combination, we
-                        // need to set the valence to -1 to tell the "B" Kernel to
-                        // switch to k_Corner rule (as edge indices won't be -1)
-                        if (V_ITa[5*i+1]==0)
-                            V_ITa[5*i+1] = -1;
-
-                    default : break;
-                }
-
-            if (rank>7)
-                // the k_Corner and k_Crease single-pass cases apply a weight of 1.0
-                // but this value is inverted in the kernel
-                V_W[i] = 0.0;
-            else
-                V_W[i] = weights[0];
-
-            batchFactory.AddVertex( i, rank );
+            batchFactory.AddVertex( i, rank, V_ITa[5*i+1] );
         }
         V_ITa += nVertVertices*5;
         V_W += nVertVertices;
@@ -271,6 +174,141 @@ FarLoopSubdivisionTablesFactory<T,U>::Create( FarMeshFactory<T,U> * meshFactory,
     return result;
 }
 
+template <class T, class U> void
+FarLoopSubdivisionTablesFactory<T,U>::computeEdgeVertex( HbrVertex<T> * v, std::vector<int> const & remap,
+                                                         int * E_IT, float * E_W ) {
+
+    HbrHalfedge<T> * e = v->GetParentEdge();
+    assert(e);
+
+    float esharp = e->GetSharpness(),
+          endPtWeight = 0.5f,
+          oppPtWeight = 0.5f;
+
+    E_IT[0]= remap[e->GetOrgVertex()->GetID()];
+    E_IT[1]= remap[e->GetDestVertex()->GetID()];
+
+    if (!e->IsBoundary() && esharp <= 1.0f) {
+        endPtWeight = 0.375f + esharp * (0.5f - 0.375f);
+        oppPtWeight = 0.125f * (1 - esharp);
+
+        HbrHalfedge<T>* ee = e->GetNext();
+        E_IT[2]= remap[ee->GetDestVertex()->GetID()];
+        ee = e->GetOpposite()->GetNext();
+        E_IT[3]= remap[ee->GetDestVertex()->GetID()];
+    } else {
+        E_IT[2]= -1;
+        E_IT[3]= -1;
+    }
+    E_W[0] = endPtWeight;
+    E_W[1] = oppPtWeight;
+}
+
+template <class T, class U> int
+FarLoopSubdivisionTablesFactory<T,U>::computeVertexVertex( HbrVertex<T> * v, std::vector<int> const & remap,
+                                                           int * V_ITa, unsigned int * V_IT, float * V_W ) {
+
+    HbrVertex<T> * pv = v->GetParentVertex();
+    assert(pv);
+
+    int offset = V_ITa[0];
+
+    // Look at HbrCatmarkSubdivision<T>::Subdivide for more details about
+    // the multi-pass interpolation
+    unsigned char masks[2];
+    int npasses;
+    float weights[2];
+    masks[0] = pv->GetMask(false);
+    masks[1] = pv->GetMask(true);
+
+    // If the masks are identical, only a single pass is necessary. If the
+    // vertex is transitioning to another rule, two passes are necessary,
+    // except when transitioning from k_Dart to k_Smooth : the same
+    // compute kernel is applied twice. Combining this special case allows
+    // to batch the compute kernels into fewer calls.
+    if (masks[0] != masks[1] and (
+        not (masks[0]==HbrVertex<T>::k_Smooth and
+             masks[1]==HbrVertex<T>::k_Dart))) {
+        weights[1] = pv->GetFractionalMask();
+        weights[0] = 1.0f - weights[1];
+        npasses = 2;
+    } else {
+        weights[0] = 1.0f;
+        weights[1] = 0.0f;
+        npasses = 1;
+    }
+
+    int rank = FarSubdivisionTablesFactory<T,U>::GetMaskRanking(masks[0], masks[1]);
+
+    V_ITa[1] = 0;
+    V_ITa[2] = remap[ pv->GetID() ];
+    V_ITa[3] = -1;
+    V_ITa[4] = -1;
+
+    for (int p=0; p<npasses; ++p)
+        switch (masks[p]) {
+            case HbrVertex<T>::k_Smooth :
+            case HbrVertex<T>::k_Dart : {
+                HbrHalfedge<T> *e = pv->GetIncidentEdge(),
+                               *start = e;
+                while (e) {
+                    V_ITa[1]++;
+
+                    V_IT[offset++] = remap[ e->GetDestVertex()->GetID() ];
+
+                    e = e->GetPrev()->GetOpposite();
+
+                    if (e==start) break;
+                }
+                break;
+            }
+            case HbrVertex<T>::k_Crease : {
+
+                class GatherCreaseEdgesOperator : public HbrHalfedgeOperator<T> {
+                public:
+                    HbrVertex<T> * vertex; int eidx[2]; int count; bool next;
+
+                    GatherCreaseEdgesOperator(HbrVertex<T> * v, bool n) : vertex(v), count(0), next(n) { eidx[0]=-1; eidx[1]=-1; }
+
+                    virtual void operator() (HbrHalfedge<T> &e) {
+                        if (e.IsSharp(next) and count < 2) {
+                            HbrVertex<T> * a = e.GetDestVertex();
+                            if (a==vertex)
+                                a = e.GetOrgVertex();
+                            eidx[count++]=a->GetID();
+                        }
+                    }
+                };
+
+                GatherCreaseEdgesOperator op( pv, p==1 );
+                pv->ApplyOperatorSurroundingEdges( op );
+
+                assert(V_ITa[3]==-1 and V_ITa[4]==-1);
+                assert(op.eidx[0]!=-1 and op.eidx[1]!=-1);
+                V_ITa[3] = remap[op.eidx[0]];
+                V_ITa[4] = remap[op.eidx[1]];
+                break;
+            }
+            case HbrVertex<T>::k_Corner :
+                // in the case of a k_Crease / k_Corner pass combination, we
+                // need to set the valence to -1 to tell the "B" Kernel to
+                // switch to k_Corner rule (as edge indices won't be -1)
+                if (V_ITa[1]==0)
+                    V_ITa[1] = -1;
+
+            default : break;
+        }
+
+    if (rank>7)
+        // the k_Corner and k_Crease single-pass cases apply a weight of 1.0
+        // but this value is inverted in the kernel
+        V_W[0] = 0.0;
+    else
+        V_W[0] = weights[0];
+
+    return rank;
+}
+
 } // end namespace OPENSUBDIV_VERSION
 using namespace OPENSUBDIV_VERSION;
 
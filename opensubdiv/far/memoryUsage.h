@@ -0,0 +1,125 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+#ifndef FAR_MEMORY_USAGE_H
+#define FAR_MEMORY_USAGE_H
+
+#include "../version.h"
+
+#include <cstddef>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+/// \brief Itemized memory footprint of a set of tables.
+///
+/// Each entry records the number of bytes allocated by one of the tables held
+/// by an object (vector capacities, not sizes). Breakdowns can be nested : the
+/// entries of a child breakdown are appended with the child name as a prefix
+/// (ex. "subdivisionTables.E_IT").
+///
+class FarMemoryUsage {
+public:
+
+    struct Entry {
+        std::string name;
+        size_t      bytes;
+    };
+
+    /// \brief Adds an entry
+    ///
+    /// @param name   the name of the table
+    ///
+    /// @param bytes  the number of bytes allocated by the table
+    ///
+    void Add(std::string const & name, size_t bytes) {
+        Entry e;
+        e.name = name;
+        e.bytes = bytes;
+        _entries.push_back(e);
+    }
+
+    /// \brief Adds an entry for the storage allocated by a vector
+    template <class T> void AddVector(std::string const & name, std::vector<T> const & v) {
+        Add(name, v.capacity()*sizeof(T));
+    }
+
+    /// \brief Appends all the entries of a child breakdown
+    ///
+    /// @param prefix  the name of the child, prepended to each entry name
+    ///
+    /// @param usage   the breakdown of the child
+    ///
+    void Append(std::string const & prefix, FarMemoryUsage const & usage) {
+        for (int i=0; i<usage.GetNumEntries(); ++i) {
+            Add(prefix+"."+usage._entries[i].name, usage._entries[i].bytes);
+        }
+    }
+
+    /// \brief Returns the number of entries
+    int GetNumEntries() const { return (int)_entries.size(); }
+
+    /// \brief Returns the entry at the given index
+    Entry const & GetEntry(int index) const { return _entries[index]; }
+
+    /// \brief Returns the bytes of the entry with the given name (0 if not found)
+    size_t GetBytes(std::string const & name) const {
+        for (int i=0; i<(int)_entries.size(); ++i) {
+            if (_entries[i].name==name)
+                return _entries[i].bytes;
+        }
+        return 0;
+    }
+
+    /// \brief Returns the sum of the bytes of all the entries
+    size_t GetTotal() const {
+        size_t result=0;
+        for (int i=0; i<(int)_entries.size(); ++i)
+            result += _entries[i].bytes;
+        return result;
+    }
+
+    /// \brief Writes the breakdown as a table of bytes per entry
+    void Print(std::ostream & out) const {
+        for (int i=0; i<(int)_entries.size(); ++i) {
+            out << std::setw(40) << std::left << _entries[i].name
+                << std::setw(14) << std::right << _entries[i].bytes << "\n";
+        }
+        out << std::setw(40) << std::left << "total"
+            << std::setw(14) << std::right << GetTotal() << "\n";
+    }
+
+private:
+    std::vector<Entry> _entries;
+};
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif /* FAR_MEMORY_USAGE_H */
@@ -31,6 +31,8 @@
 #include "../far/subdivisionTables.h"
 #include "../far/patchTables.h"
 #include "../far/vertexEditTables.h"
+#include "../far/limitTables.h"
+#include "../far/endCapTables.h"
 #include "../far/kernelBatch.h"
 
 #include <cassert>
@@ -59,7 +61,10 @@ public:
     FarPatchTables const * GetPatchTables() const { return _patchTables; }
 
     /// \brief Returns the total number of vertices in the mesh across across all depths
-    int GetNumVertices() const { return GetSubdivisionTables()->GetNumVertices(); }
+    /// (including the control vertices of the end cap patches)
+    int GetNumVertices() const {
+        return GetSubdivisionTables()->GetNumVertices() + (_endCapTables ? _endCapTables->GetNumVertices() : 0);
+    }
 
     /// \brief Returns the list of vertices in the mesh (from subdiv level 0 to N)
     std::vector<U> & GetVertices() { return _vertices; }
@@ -76,6 +81,14 @@ public:
     /// \brief Returns vertex edit tables
     FarVertexEditTables<U> const * GetVertexEdit() const { return _vertexEditTables; }
 
+    /// \brief Returns the limit masks of the finest level (NULL unless requested
+    /// from the FarMeshFactory)
+    FarLimitTables const * GetLimitTables() const { return _limitTables; }
+
+    /// \brief Returns the B-spline end cap stencils (NULL unless requested
+    /// from the FarMeshFactory)
+    FarEndCapTables const * GetEndCapTables() const { return _endCapTables; }
+
     /// \brief Returns the total number of vertices in the mesh across across all depths
     int GetNumPtexFaces() const { return _numPtexFaces; }
 
@@ -87,13 +100,17 @@ public:
     /// subdivision scheme to the vertices in the mesh.    
     const FarKernelBatchVector & GetKernelBatches() const { return _batches; }
 
+    /// \brief Itemized memory allocated by the mesh : the entries of each set
+    /// of tables are prefixed with the name of the set (ex. "patchTables.patches")
+    FarMemoryUsage GetMemoryUsage() const;
+
 private:
     // Note : the vertex classes are renamed <X,Y> so as not to shadow the 
     // declaration of the templated vertex class U.
     template <class X, class Y> friend class FarMeshFactory;
     template <class X, class Y> friend class FarMultiMeshFactory;
 
-    FarMesh() : _subdivisionTables(0), _patchTables(0), _vertexEditTables(0) { }
+    FarMesh() : _subdivisionTables(0), _patchTables(0), _vertexEditTables(0), _limitTables(0), _endCapTables(0), _totalFVarWidth(0) { }
 
     // non-copyable, so these are not implemented:
     FarMesh(FarMesh<U> const &);
@@ -108,6 +125,12 @@ private:
     // hierarchical vertex edit tables
     FarVertexEditTables<U> * _vertexEditTables;
 
+    // limit masks of the finest level
+    FarLimitTables * _limitTables;
+
+    // control vertices of the B-spline end cap patches
+    FarEndCapTables * _endCapTables;
+
     // kernel execution batches
     FarKernelBatchVector _batches;
 
@@ -125,6 +148,26 @@ FarMesh<U>::~FarMesh()
     delete _subdivisionTables;
     delete _patchTables;
     delete _vertexEditTables;
+    delete _limitTables;
+    delete _endCapTables;
+}
+
+template <class U> FarMemoryUsage
+FarMesh<U>::GetMemoryUsage() const {
+    FarMemoryUsage result;
+    if (_subdivisionTables)
+        result.Append("subdivisionTables", _subdivisionTables->GetMemoryUsage());
+    if (_patchTables)
+        result.Append("patchTables", _patchTables->GetMemoryUsage());
+    if (_vertexEditTables)
+        result.Append("vertexEditTables", _vertexEditTables->GetMemoryUsage());
+    if (_limitTables)
+        result.Append("limitTables", _limitTables->GetMemoryUsage());
+    if (_endCapTables)
+        result.Append("endCapTables", _endCapTables->GetMemoryUsage());
+    result.AddVector("kernelBatches", _batches);
+    result.AddVector("vertices", _vertices);
+    return result;
 }
 
 } // end namespace OPENSUBDIV_VERSION
@@ -38,21 +38,82 @@
 #include "../hbr/bilinear.h"
 #include "../hbr/catmark.h"
 #include "../hbr/loop.h"
+#include "../hbr/cornerEdit.h"
 
 #include "../far/mesh.h"
 #include "../far/dispatcher.h"
+#include "../far/factoryStats.h"
 #include "../far/bilinearSubdivisionTablesFactory.h"
 #include "../far/catmarkSubdivisionTablesFactory.h"
+#include "../far/endCapTablesFactory.h"
+#include "../far/limitTablesFactory.h"
 #include "../far/loopSubdivisionTablesFactory.h"
 #include "../far/patchTablesFactory.h"
 #include "../far/vertexEditTablesFactory.h"
 
+#include <algorithm>
 #include <typeinfo>
 #include <set>
+#include <utility>
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
+/// \brief Build options of FarMeshFactory.
+///
+struct FarMeshFactoryOptions {
+
+    FarMeshFactoryOptions() : adaptive(false), firstLevel(-1), structuredGrids(false),
+        faceLevels(0), limitTables(false), singleCreasePatch(false),
+        bsplineEndCaps(false), sparseValenceTable(false) { }
+
+    /// Switch between uniform and feature adaptive mode
+    bool adaptive;
+
+    /// First level of subdivision to use when building the FarMesh. The
+    /// default -1 only generates a single patch array for the highest level
+    /// of subdivision (uniform mode only)
+    int firstLevel;
+
+    /// Refine the regular regions of the mesh with table-free structured
+    /// grids (uniform Catmark only). Only the CPU compute contexts apply
+    /// them, the GPU contexts cannot be created for such a FarMesh.
+    bool structuredGrids;
+
+    /// Optional per-coarse-face target level of subdivision (uniform mode
+    /// only). Only the selected faces are refined (along with the neighborhood
+    /// Hbr requires to interpolate them), so that the tables and face lists
+    /// only cover the region of interest. Levels are clamped to maxlevel and a
+    /// level of 0 leaves a face unrefined. The vector must outlive the factory.
+    std::vector<int> const * faceLevels;
+
+    /// Create the limit masks of the vertices of the finest level (uniform
+    /// Catmark and Loop only, see FarLimitTables). With faceLevels, the
+    /// one-ring of the vertices of the finest level is completed so that their
+    /// limit masks can be computed : the refined region grows by a ring of
+    /// faces.
+    bool limitTables;
+
+    /// Represent the regular faces with a semi-sharp crease running along one
+    /// of their edges with SINGLE_CREASE patches instead of isolating the
+    /// crease (adaptive mode only). These patches are currently only evaluated
+    /// by OsdCpuEvalLimitController : the GL and D3D11 draw contexts refuse
+    /// to be created for them.
+    bool singleCreasePatch;
+
+    /// Represent the faces around the extraordinary vertices of the finest
+    /// level with regular B-spline patches instead of Gregory patches
+    /// (adaptive mode only). The control vertices of these end caps are
+    /// appended to the vertices of the FarMesh and computed by an END_CAP
+    /// kernel batch, which only the CPU compute contexts apply.
+    bool bsplineEndCaps;
+
+    /// Only store the vertex valence records used by the Gregory patches in
+    /// the FarPatchTables (adaptive mode only). The draw contexts and the limit
+    /// evaluation read either layout.
+    bool sparseValenceTable;
+};
+
 /// \brief Instantiates a FarMesh from an HbrMesh.
 ///
 /// FarMeshFactory requires a 2 steps process : 
@@ -90,6 +151,20 @@ public:
     ///
     FarMeshFactory(HbrMesh<T> * mesh, int maxlevel, bool adaptive=false, int firstLevel=-1);
 
+    /// \brief Constructor for the factory with the full set of build options.
+    ///
+    /// @param mesh        The HbrMesh describing the topology (this mesh *WILL* be
+    ///                    modified by this factory).
+    ///
+    /// @param maxlevel    In uniform subdivision mode : number of levels of
+    ///                    subdivision. In feature adaptive mode : maximum 
+    ///                    level of isolation around extraordinary topological
+    ///                    features.
+    ///
+    /// @param options     The build options (see FarMeshFactoryOptions)
+    ///
+    FarMeshFactory(HbrMesh<T> * mesh, int maxlevel, FarMeshFactoryOptions const & options);
+
     /// \brief Create a table-based mesh representation
     ///
     /// @param requireFVarData create a face-varying table
@@ -98,6 +173,53 @@ public:
     ///
     FarMesh<U> * Create( bool requireFVarData=false );
 
+    /// \brief Sets the sharpness of an edge of the coarse HbrMesh. The new
+    /// value is applied to the HbrMesh and to a FarMesh by the next call to
+    /// UpdateSharpness.
+    ///
+    /// @param edge       a coarse edge of the HbrMesh
+    ///
+    /// @param sharpness  the new sharpness of the edge
+    ///
+    void SetEdgeSharpness( HbrHalfedge<T> * edge, float sharpness );
+
+    /// \brief Sets the sharpness of a vertex of the coarse HbrMesh. The new
+    /// value is applied to the HbrMesh and to a FarMesh by the next call to
+    /// UpdateSharpness.
+    ///
+    /// @param vertex     a coarse vertex of the HbrMesh
+    ///
+    /// @param sharpness  the new sharpness of the vertex
+    ///
+    void SetVertexSharpness( HbrVertex<T> * vertex, float sharpness );
+
+    /// \brief Applies the sharpness values set since the previous update to
+    /// the refined HbrMesh and to a FarMesh created by this factory, without
+    /// rebuilding the topology.
+    ///
+    /// Only the edge and vertex vertices whose rules depend on the modified
+    /// edges and vertices are recomputed, along with the vertex kernel batches
+    /// of the levels where their rules changed, and the limit tables if the
+    /// FarMesh has some. The vertex indices of the FarMesh are preserved : the
+    /// vertex buffers remain valid, as do the compute contexts that reference
+    /// the Far subdivision tables (contexts holding a copy of the tables must be
+    /// recreated). The limit tables are recreated : contexts using them must be
+    /// recreated as well.
+    ///
+    /// Updates are supported for meshes refined uniformly with the Catmark and
+    /// Loop schemes, without structured grids, crease edits or Chaikin crease
+    /// subdivision. The tables only have room for the vertices gathered by the
+    /// rules the FarMesh was created with : create it with the smoothest pose
+    /// of the animation (typically with the animated sharpness at 0).
+    ///
+    /// @param mesh  a FarMesh created by this factory
+    ///
+    /// @return      false if the FarMesh cannot be updated in place : it is
+    ///              then left unchanged, and a new FarMesh must be created
+    ///              to reflect the new sharpness (the HbrMesh is up to date)
+    ///
+    bool UpdateSharpness( FarMesh<U> * mesh );
+
     /// \brief Computes the minimum number of adaptive feature isolation levels required
     /// in order for the limit surface to be an accurate representation of the 
     /// shape given all the tags and edits.
@@ -108,10 +230,14 @@ public:
     ///
     /// @param cornerIsolate  The level of isolation desired for patch corners
     ///
+    /// @param singleCreasePatch  Ignore the sharpness of the creases that can be
+    ///                       represented with single crease patches
+    ///
     /// @return               The minimum level of isolation of extraordinary
     ///                       topological features.
     ///
-    static int ComputeMinIsolation( HbrMesh<T> const * mesh, int nfaces, int cornerIsolate=5 );
+    static int ComputeMinIsolation( HbrMesh<T> const * mesh, int nfaces, int cornerIsolate=5,
+                                    bool singleCreasePatch=false );
 
     /// \brief The Hbr mesh that this factory is converting
     HbrMesh<T> const * GetHbrMesh() const { return _hbrMesh; }
@@ -154,6 +280,8 @@ public:
 private:
     friend class FarBilinearSubdivisionTablesFactory<T,U>;
     friend class FarCatmarkSubdivisionTablesFactory<T,U>;
+    friend class FarEndCapTablesFactory<T,U>;
+    friend class FarLimitTablesFactory<T,U>;
     friend class FarLoopSubdivisionTablesFactory<T,U>;
     friend class FarSubdivisionTablesFactory<T,U>;
     friend class FarVertexEditTablesFactory<T,U>;
@@ -182,12 +310,20 @@ private:
     // True if the factory is refining adaptively
     bool isAdaptive() { return _adaptive; }
 
+    // Refines the Hbr mesh and gathers the faces of each level (shared by
+    // the constructors)
+    void initialize( HbrMesh<T> * mesh, int maxlevel, std::vector<int> const * faceLevels );
+
     // False if v prevents a face from being represented with a BSpline
     static bool vertexIsBSpline( HbrVertex<T> * v, bool next );
 
     // True if a vertex is a regular boundary
     static bool vertexIsRegularBoundary( HbrVertex<T> * v );
 
+    // True if v is a regular vertex on a semi-sharp crease that can be
+    // represented by single crease patches
+    static bool vertexIsSingleCrease( HbrVertex<T> * v, bool next );
+
     // Non-const accessor to the remapping table
     std::vector<int> & getRemappingTable( ) { return _remapTable; }
 
@@ -196,11 +332,22 @@ private:
     // Calls Hbr to refines the neighbors of v
     static void refineVertexNeighbors(HbrVertex<T> * v);
 
-    // Uniformly refine the Hbr mesh
-    static void refine( HbrMesh<T> * mesh, int maxlevel );
+    // Uniformly refine the Hbr mesh (completing the one-ring of the finest
+    // vertices of a sparse refinement if completeRings is set)
+    static void refine( HbrMesh<T> * mesh, int maxlevel, std::vector<int> const * faceLevels, bool completeRings );
+
+    // Returns the target level of the coarse face that f descends from
+    static int getFaceLevel( HbrFace<T> const * f, int maxlevel, std::vector<int> const * faceLevels );
 
     // Adaptively refine the Hbr mesh
     int refineAdaptive( HbrMesh<T> * mesh, int maxIsolate );
+
+    // Returns the half-edge between 2 vertices (NULL if there is none)
+    static HbrHalfedge<T> * getEdge( HbrVertex<T> * v0, HbrVertex<T> * v1 );
+
+    // Returns the number of entries the rule of a vertex vertex writes in the
+    // V_IT table (see computeVertexVertex)
+    static int getVertVertexRingSize( HbrVertex<T> * v, bool catmark );
     
     typedef std::vector<std::vector< HbrFace<T> *> > FacesList;
     
@@ -210,7 +357,13 @@ private:
 private:
     HbrMesh<T> * _hbrMesh;
 
-    bool _adaptive;
+    bool _adaptive,
+         _sparse,
+         _limitTables,
+         _structuredGrids,
+         _singleCreasePatch,
+         _bsplineEndCaps,
+         _sparseValenceTable;
 
     int _maxlevel,
         _firstlevel,
@@ -225,6 +378,13 @@ private:
     std::vector<int> _remapTable;
 
     FacesList _facesList;
+
+    // sharpness values waiting for UpdateSharpness
+    std::vector<std::pair<HbrHalfedge<T> *, float> > _edgeSharpness;
+    std::vector<std::pair<HbrVertex<T> *, float> > _vertexSharpness;
+
+    // ranks of the vertex vertices in the tables of the updated FarMesh
+    std::vector<unsigned char> _vertexRanks;
 };
 
 template <class T, class U>
@@ -238,9 +398,27 @@ FarMeshFactory<T,U>::sumList( std::vector<std::vector<Type> > const & list, int
     return total;
 }
 
-// Refines non-adaptively an Hbr mesh
+// Returns the target level of the coarse face that f descends from
+template <class T, class U> int
+FarMeshFactory<T,U>::getFaceLevel( HbrFace<T> const * f, int maxlevel, std::vector<int> const * faceLevels ) {
+
+    if (not faceLevels)
+        return maxlevel;
+
+    while (f->GetParent())
+        f = f->GetParent();
+
+    int id = f->GetID();
+    if (id >= (int)faceLevels->size())
+        return 0;
+
+    return std::max(0, std::min(maxlevel, (*faceLevels)[id]));
+}
+
+// Refines non-adaptively an Hbr mesh (optionally restricted to the coarse
+// faces selected by faceLevels)
 template <class T, class U> void
-FarMeshFactory<T,U>::refine( HbrMesh<T> * mesh, int maxlevel ) {
+FarMeshFactory<T,U>::refine( HbrMesh<T> * mesh, int maxlevel, std::vector<int> const * faceLevels, bool completeRings ) {
 
     for (int level=0, firstface=0; level<maxlevel; ++level ) {
 
@@ -250,8 +428,11 @@ FarMeshFactory<T,U>::refine( HbrMesh<T> * mesh, int maxlevel ) {
         
             HbrFace<T> * f = mesh->GetFace(i);
 
-            if (f->GetDepth()==level) {
+            if (f->GetDepth()==level and getFaceLevel(f, maxlevel, faceLevels)>level) {
 
+                // Note : Hbr guarantees the neighborhood of the vertices of
+                // the refined faces, so the selected region is interpolated
+                // exactly as if the whole mesh had been refined.
                 if (not f->IsHole()) {
                     f->Refine();
                 } else {                
@@ -282,12 +463,25 @@ FarMeshFactory<T,U>::refine( HbrMesh<T> * mesh, int maxlevel ) {
         firstface = nfaces;
     }
 
+    // Sparse refinement : complete the one-ring of the vertices of the finest
+    // level so that their limit masks can be computed.
+    if (faceLevels and completeRings) {
+        int nfaces = mesh->GetNumFaces();
+        for (int i=0; i<nfaces; ++i) {
+            HbrFace<T> * f = mesh->GetFace(i);
+            if (f->GetDepth()==maxlevel and getFaceLevel(f, maxlevel, faceLevels)==maxlevel and (not f->IsHole())) {
+                for (int j=0; j<f->GetNumVertices(); ++j)
+                    f->GetVertex(j)->GuaranteeNeighbors();
+            }
+        }
+    }
+
     mesh->SetSubdivisionMethod(HbrMesh<T>::k_SubdivisionMethodUniform);
 }
 
 // Scan the faces of a mesh and compute the max level of subdivision required
 template <class T, class U> int 
-FarMeshFactory<T,U>::ComputeMinIsolation( HbrMesh<T> const * mesh, int nfaces, int cornerIsolate ) {
+FarMeshFactory<T,U>::ComputeMinIsolation( HbrMesh<T> const * mesh, int nfaces, int cornerIsolate, bool singleCreasePatch ) {
 
     assert(mesh);
 
@@ -335,8 +529,15 @@ FarMeshFactory<T,U>::ComputeMinIsolation( HbrMesh<T> const * mesh, int nfaces, i
         for (int j=0; j<nv; ++j) {
             
             HbrHalfedge<T> * e = f->GetEdge(j);
-            if (not e->IsBoundary())
-                sharpmax = std::max( sharpmax, f->GetEdge(j)->GetSharpness() );
+            if (e->IsBoundary())
+                continue;
+
+            // Single crease patches do not require any isolation
+            if (singleCreasePatch and vertexIsSingleCrease(e->GetOrgVertex(), false) and
+                                      vertexIsSingleCrease(e->GetDestVertex(), false))
+                continue;
+
+            sharpmax = std::max( sharpmax, f->GetEdge(j)->GetSharpness() );
         }
     }
 
@@ -376,6 +577,43 @@ FarMeshFactory<T,U>::vertexIsBSpline( HbrVertex<T> * v, bool next ) {
     return true;
 }
 
+// True if the vertex is an interior regular vertex with a single crease
+// running through it : two opposite edges of equal sharpness, all the other
+// edges and the vertex itself being smooth (at the current level or, if
+// 'next' is true, at the next level of subdivision)
+template <class T, class U> bool 
+FarMeshFactory<T,U>::vertexIsSingleCrease( HbrVertex<T> * v, bool next ) {
+
+    // Chaikin's rule changes the sharpness along the crease
+    if (v->GetMesh()->GetSubdivision()->GetCreaseSubdivisionMethod()==
+        HbrSubdivision<T>::k_CreaseChaikin)
+        return false;
+
+    if (v->OnBoundary() or v->IsExtraordinary() or v->GetValence()!=4)
+        return false;
+
+    // the sharpness of the children is one less than the parent's
+    float smooth = next ? 1.0f : 0.0f;
+
+    if (v->GetSharpness()>smooth)
+        return false;
+
+    float sharpness[4];
+    HbrHalfedge<T> * e = v->GetIncidentEdge();
+    for (int i=0; i<4; ++i) {
+        assert(e);
+        sharpness[i] = e->GetSharpness();
+        e = v->GetNextEdge(e);
+    }
+
+    for (int i=0; i<2; ++i) {
+        if ((sharpness[i]>smooth) and (sharpness[i]==sharpness[i+2]) and
+            (sharpness[i+1]<=smooth) and (sharpness[(i+3)%4]<=smooth))
+            return true;
+    }
+    return false;
+}
+
 // Calls Hbr to refines the neighbors of v
 template <class T, class U> void 
 FarMeshFactory<T,U>::refineVertexNeighbors(HbrVertex<T> * v) {
@@ -449,13 +687,22 @@ FarMeshFactory<T,U>::refineAdaptive( HbrMesh<T> * mesh, int maxIsolate ) {
             HbrHalfedge<T> * e = f->GetEdge(j);
             assert(e);
 
-            // Tag sharp edges for refinement
+            // Tag sharp edges for refinement (except the vertices of single
+            // crease patches)
             if (e->IsSharp(true) and (not e->IsBoundary())) {
-                nextverts.insert(e->GetOrgVertex());
-                nextverts.insert(e->GetDestVertex());
-                
-                e->GetOrgVertex()->_adaptiveFlags.isTagged=true;
-                e->GetDestVertex()->_adaptiveFlags.isTagged=true;
+
+                HbrVertex<T> * org = e->GetOrgVertex(),
+                             * dst = e->GetDestVertex();
+
+                if (not (_singleCreasePatch and vertexIsSingleCrease(org, false))) {
+                    nextverts.insert(org);
+                    org->_adaptiveFlags.isTagged=true;
+                }
+
+                if (not (_singleCreasePatch and vertexIsSingleCrease(dst, false))) {
+                    nextverts.insert(dst);
+                    dst->_adaptiveFlags.isTagged=true;
+                }
             }
             
             // Tag extraordinary (non-quad) faces for refinement
@@ -496,6 +743,35 @@ FarMeshFactory<T,U>::refineAdaptive( HbrMesh<T> * mesh, int maxIsolate ) {
         }
         _maxValence = std::max(_maxValence, nv);
     }
+
+    // Tag the quads left untagged with sharp edges that cannot be represented
+    // by a single crease patch (ex. parallel creases)
+    if (_singleCreasePatch) {
+        for (int i=0; i<ncoarsefaces; ++i) {
+            HbrFace<T> * f = mesh->GetFace(i);
+
+            if (f->IsHole() or f->GetNumVertices()!=4)
+                continue;
+
+            bool isTagged=false, isSharp=false;
+            for (int j=0; j<4; ++j) {
+                if (f->GetVertex(j)->_adaptiveFlags.isTagged)
+                    isTagged=true;
+                if (f->GetEdge(j)->IsSharp(true) and (not f->GetEdge(j)->IsBoundary()))
+                    isSharp=true;
+            }
+
+            if (isTagged or (not isSharp) or
+                FarPatchTablesFactory<T>::computeSingleCreasePatchRotation(f)>=0)
+                continue;
+
+            for (int j=0; j<4; ++j) {
+                HbrVertex<T> * v = f->GetVertex(j);
+                v->_adaptiveFlags.isTagged=true;
+                nextverts.insert(v);
+            }
+        }
+    }
     
 
     // Second pass : refine adaptively around singularities
@@ -526,22 +802,44 @@ FarMeshFactory<T,U>::refineAdaptive( HbrMesh<T> * mesh, int maxIsolate ) {
             int valence = v->GetValence();
             _maxValence = std::max(_maxValence, valence);
 
+            bool isCreased = false;
+
             HbrHalfedge<T> * e = v->GetIncidentEdge();
             for (int j=0; j<valence; ++j) {
 
+                if (e->IsSharp(false) and (not e->IsBoundary()))
+                    isCreased = true;
+
                 // Skip edges that have already been processed (HasChild())
                 if ((not e->HasChild()) and e->IsSharp(false) and (not e->IsBoundary())) {
                 
                     if (not e->IsInsideHole()) {
-                        nextverts.insert( e->Subdivide() );
-                        nextverts.insert( e->GetOrgVertex()->Subdivide() );
-                        nextverts.insert( e->GetDestVertex()->Subdivide() );
+
+                        // Vertices on a single crease at the next level are
+                        // not isolated any further
+                        HbrVertex<T> * child = e->Subdivide();
+                        if (not (_singleCreasePatch and vertexIsSingleCrease(child, false)))
+                            nextverts.insert( child );
+
+                        HbrVertex<T> * org = e->GetOrgVertex(),
+                                     * dst = e->GetDestVertex();
+
+                        if (not (_singleCreasePatch and vertexIsSingleCrease(org, false)))
+                            nextverts.insert( org->Subdivide() );
+
+                        if (not (_singleCreasePatch and vertexIsSingleCrease(dst, false)))
+                            nextverts.insert( dst->Subdivide() );
                     }
                 }
                 HbrHalfedge<T> * next = v->GetNextEdge(e);
                 e = next ? next : e->GetPrev();
             }
 
+            // The neighbors along the crease may not be isolated when using
+            // single crease patches : keep isolating the end of the crease
+            if (_singleCreasePatch and isCreased and (not vertexIsSingleCrease(v, false)))
+                nextverts.insert(v->Subdivide());
+
             // Flag verts with hierarchical edits for neighbor refinement at the next level
             HbrVertex<T> * childvert = v->Subdivide();
             HbrHalfedge<T> * childedge = childvert->GetIncidentEdge();
@@ -582,6 +880,12 @@ template <class T, class U>
 FarMeshFactory<T,U>::FarMeshFactory( HbrMesh<T> * mesh, int maxlevel, bool adaptive, int firstlevel ) :
     _hbrMesh(mesh),
     _adaptive(adaptive),
+    _sparse(false),
+    _limitTables(false),
+    _structuredGrids(false),
+    _singleCreasePatch(false),
+    _bsplineEndCaps(false),
+    _sparseValenceTable(false),
     _maxlevel(maxlevel),
     _firstlevel(firstlevel),
     _numVertices(-1),
@@ -591,6 +895,36 @@ FarMeshFactory<T,U>::FarMeshFactory( HbrMesh<T> * mesh, int maxlevel, bool adapt
     _numPtexFaces(-1),
     _facesList(maxlevel+1)
 {
+    initialize(mesh, maxlevel, 0);
+}
+
+template <class T, class U>
+FarMeshFactory<T,U>::FarMeshFactory( HbrMesh<T> * mesh, int maxlevel, FarMeshFactoryOptions const & options ) :
+    _hbrMesh(mesh),
+    _adaptive(options.adaptive),
+    _sparse(options.faceLevels and (not options.adaptive)),
+    _limitTables(options.limitTables and (not options.adaptive)),
+    _structuredGrids(options.structuredGrids and (not options.adaptive) and (not options.faceLevels)),
+    _singleCreasePatch(options.singleCreasePatch and options.adaptive),
+    _bsplineEndCaps(options.bsplineEndCaps and options.adaptive),
+    _sparseValenceTable(options.sparseValenceTable and options.adaptive),
+    _maxlevel(maxlevel),
+    _firstlevel(options.firstLevel),
+    _numVertices(-1),
+    _numCoarseVertices(-1),
+    _numFaces(-1),
+    _maxValence(3),
+    _numPtexFaces(-1),
+    _facesList(maxlevel+1)
+{
+    initialize(mesh, maxlevel, options.faceLevels);
+}
+
+template <class T, class U> void
+FarMeshFactory<T,U>::initialize( HbrMesh<T> * mesh, int maxlevel, std::vector<int> const * faceLevels ) {
+
+    FarFactoryStats::Scope scope("FarMeshFactory");
+
     _numCoarseVertices = mesh->GetNumVertices();
     _numPtexFaces = getNumPtexFaces(mesh);
     
@@ -598,35 +932,58 @@ FarMeshFactory<T,U>::FarMeshFactory( HbrMesh<T> * mesh, int maxlevel, bool adapt
     //
     // Note : using a placeholder vertex class 'T' can greatly speed up the 
     // topological analysis if the interpolation results are not used.
-    if (adaptive)
-        _maxlevel=refineAdaptive( mesh, maxlevel );
-    else
-        refine( mesh, maxlevel);
-    
-    _numFaces = mesh->GetNumFaces();
+    {
+        FarFactoryStats::Scope phase(_adaptive ? "FarMeshFactory::refineAdaptive" :
+                                                 "FarMeshFactory::refine");
+        if (_adaptive)
+            _maxlevel=refineAdaptive( mesh, maxlevel );
+        else
+            refine( mesh, maxlevel, faceLevels, _limitTables );
+
+        _numFaces = mesh->GetNumFaces();
+
+        _numVertices = mesh->GetNumVertices();
 
-    _numVertices = mesh->GetNumVertices();
+        FarFactoryStats::Count(FarFactoryStats::FACES_PROCESSED, _numFaces);
+        FarFactoryStats::Count(FarFactoryStats::VERTICES_CREATED, _numVertices-_numCoarseVertices);
+    }
     
-    if (not adaptive) {
+    if (not _adaptive) {
+
+        FarFactoryStats::Scope phase("FarMeshFactory::facesList");
 
         // Populate the face lists
-        int fsize=0;
-        for (int i=0; i<_numFaces; ++i) {
-            HbrFace<T> * f = mesh->GetFace(i);
-            assert(f);
-            if (f->GetDepth()==0 and (not f->IsHole()))
-                fsize += mesh->GetSubdivision()->GetFaceChildrenCount( f->GetNumVertices() );
-        }
+        if (faceLevels) {
 
-        _facesList[0].reserve(mesh->GetNumCoarseFaces());
-        _facesList[1].reserve(fsize);
-        for (int l=2; l<=maxlevel; ++l)
-            _facesList[l].reserve( _facesList[l-1].capacity()*4 );
-        
-        for (int i=0; i<_numFaces; ++i) {
-            HbrFace<T> * f = mesh->GetFace(i);
-            if (f->GetDepth()<=maxlevel and (not f->IsHole()))
-                _facesList[ f->GetDepth() ].push_back(f);
+            // Sparse refinement : the faces created by Hbr in order to
+            // guarantee the neighborhood of the selected region are not
+            // part of the region.
+            for (int i=0; i<_numFaces; ++i) {
+                HbrFace<T> * f = mesh->GetFace(i);
+                assert(f);
+                if (f->GetDepth()<=getFaceLevel(f, maxlevel, faceLevels) and (not f->IsHole()))
+                    _facesList[ f->GetDepth() ].push_back(f);
+            }
+        } else {
+
+            int fsize=0;
+            for (int i=0; i<_numFaces; ++i) {
+                HbrFace<T> * f = mesh->GetFace(i);
+                assert(f);
+                if (f->GetDepth()==0 and (not f->IsHole()))
+                    fsize += mesh->GetSubdivision()->GetFaceChildrenCount( f->GetNumVertices() );
+            }
+
+            _facesList[0].reserve(mesh->GetNumCoarseFaces());
+            _facesList[1].reserve(fsize);
+            for (int l=2; l<=maxlevel; ++l)
+                _facesList[l].reserve( _facesList[l-1].capacity()*4 );
+
+            for (int i=0; i<_numFaces; ++i) {
+                HbrFace<T> * f = mesh->GetFace(i);
+                if (f->GetDepth()<=maxlevel and (not f->IsHole()))
+                    _facesList[ f->GetDepth() ].push_back(f);
+            }
         }
     }
 }
@@ -763,17 +1120,26 @@ FarMeshFactory<T,U>::Create( bool requireFVarData ) {
     if (GetMaxLevel()<1)
         return 0;
 
+    FarFactoryStats::Scope scope("FarMeshFactory::Create");
+
     FarMesh<U> * result = new FarMesh<U>();
     
-    if ( isBilinear( GetHbrMesh() ) ) {
-        result->_subdivisionTables = FarBilinearSubdivisionTablesFactory<T,U>::Create(this, result, &result->_batches);
-    } else if ( isCatmark( GetHbrMesh() ) ) {
-        result->_subdivisionTables = FarCatmarkSubdivisionTablesFactory<T,U>::Create(this, result, &result->_batches);
-    } else if ( isLoop(GetHbrMesh()) ) {
-        result->_subdivisionTables = FarLoopSubdivisionTablesFactory<T,U>::Create(this, result, &result->_batches);
-    } else
-        assert(0);
-    assert(result->_subdivisionTables);
+    {
+        FarFactoryStats::Scope phase("FarMeshFactory::subdivisionTables");
+
+        if ( isBilinear( GetHbrMesh() ) ) {
+            result->_subdivisionTables = FarBilinearSubdivisionTablesFactory<T,U>::Create(this, result, &result->_batches);
+        } else if ( isCatmark( GetHbrMesh() ) ) {
+            result->_subdivisionTables = FarCatmarkSubdivisionTablesFactory<T,U>::Create(this, result, &result->_batches);
+        } else if ( isLoop(GetHbrMesh()) ) {
+            result->_subdivisionTables = FarLoopSubdivisionTablesFactory<T,U>::Create(this, result, &result->_batches);
+        } else
+            assert(0);
+        assert(result->_subdivisionTables);
+
+        FarFactoryStats::Count(FarFactoryStats::BYTES_ALLOCATED,
+            result->_subdivisionTables->GetMemoryUsed() + result->_batches.size()*sizeof(FarKernelBatch));
+    }
 
     // If the vertex classes aren't place-holders, copy the data of the coarse
     // vertices into the vertex buffer.
@@ -784,19 +1150,31 @@ FarMeshFactory<T,U>::Create( bool requireFVarData ) {
     }
 
     // Create the element indices tables (patches for adaptive, quads for non-adaptive)
-    if (isAdaptive()) {
+    {
+        FarFactoryStats::Scope phase("FarMeshFactory::patchTables");
 
-        FarPatchTablesFactory<T> factory(GetHbrMesh(), _numFaces, _remapTable);
+        if (isAdaptive()) {
 
-        // XXXX: currently PatchGregory shader supports up to 29 valence
-        result->_patchTables = factory.Create(GetMaxLevel()+1, _maxValence, requireFVarData);
+            FarPatchTablesFactory<T> factory(GetHbrMesh(), _numFaces, _remapTable, _singleCreasePatch,
+                                             _bsplineEndCaps ? _numVertices : -1);
 
-    } else {
-        result->_patchTables = FarPatchTablesFactory<T>::Create(GetHbrMesh(), _facesList, _remapTable, _firstlevel, requireFVarData );
+            // XXXX: currently PatchGregory shader supports up to 29 valence
+            result->_patchTables = factory.Create(GetMaxLevel()+1, _maxValence, requireFVarData, _sparseValenceTable);
+
+        } else {
+            result->_patchTables = FarPatchTablesFactory<T>::Create(GetHbrMesh(), _facesList, _remapTable, _firstlevel, requireFVarData );
+        }
+        assert( result->_patchTables );
     }
-    assert( result->_patchTables );
 
     result->_numPtexFaces = _numPtexFaces;
+
+    // Create the limit masks of the finest level
+    if (_limitTables) {
+        FarFactoryStats::Scope phase("FarMeshFactory::limitTables");
+
+        result->_limitTables = FarLimitTablesFactory<T,U>::Create( this );
+    }
     
     if (requireFVarData) {
         result->_totalFVarWidth = _hbrMesh->GetTotalFVarWidth();
@@ -804,8 +1182,26 @@ FarMeshFactory<T,U>::Create( bool requireFVarData ) {
 
     // Create VertexEditTables if necessary
     if (GetHbrMesh()->HasVertexEdits()) {
+        FarFactoryStats::Scope phase("FarMeshFactory::vertexEditTables");
+
         result->_vertexEditTables = FarVertexEditTablesFactory<T,U>::Create( this, result, &result->_batches, GetMaxLevel() );
         assert(result->_vertexEditTables);
+
+        FarFactoryStats::Count(FarFactoryStats::BYTES_ALLOCATED,
+            result->_vertexEditTables->GetMemoryUsed());
+    }
+
+    // Create the stencils of the B-spline end caps : their control vertices
+    // follow the vertices of the subdivision tables (and are computed after
+    // the vertex edits)
+    if (_bsplineEndCaps) {
+        FarFactoryStats::Scope phase("FarMeshFactory::endCapTables");
+
+        result->_endCapTables = FarEndCapTablesFactory<T,U>::Create( this, _numVertices, &result->_batches );
+        assert(result->_endCapTables);
+
+        if (sizeof(U)>1)
+            result->_vertices.resize( result->GetNumVertices() );
     }
     
     return result;
@@ -817,6 +1213,363 @@ FarMeshFactory<T,U>::GetVertexID( HbrVertex<T> * v ) {
     return _remapTable[ v->GetID() ];
 }
 
+template <class T, class U> void
+FarMeshFactory<T,U>::SetEdgeSharpness( HbrHalfedge<T> * edge, float sharpness ) {
+    assert( edge and edge->GetFace()->IsCoarse() );
+    _edgeSharpness.push_back( std::make_pair(edge, sharpness) );
+}
+
+template <class T, class U> void
+FarMeshFactory<T,U>::SetVertexSharpness( HbrVertex<T> * vertex, float sharpness ) {
+    assert( vertex and vertex->GetID() < _numCoarseVertices );
+    _vertexSharpness.push_back( std::make_pair(vertex, sharpness) );
+}
+
+template <class T, class U> HbrHalfedge<T> *
+FarMeshFactory<T,U>::getEdge( HbrVertex<T> * v0, HbrVertex<T> * v1 ) {
+    HbrHalfedge<T> * e = v0->GetEdge(v1);
+    return e ? e : v1->GetEdge(v0);
+}
+
+template <class T, class U> int
+FarMeshFactory<T,U>::getVertVertexRingSize( HbrVertex<T> * v, bool catmark ) {
+
+    HbrVertex<T> * pv = v->GetParentVertex();
+    assert(pv);
+
+    unsigned char masks[2] = { pv->GetMask(false), pv->GetMask(true) };
+
+    int npasses = (masks[0]!=masks[1] and
+        not (masks[0]==HbrVertex<T>::k_Smooth and masks[1]==HbrVertex<T>::k_Dart)) ? 2 : 1;
+
+    // the smooth and dart passes gather the edges around the parent vertex,
+    // up to a boundary
+    int nedges = 0;
+    HbrHalfedge<T> * e = pv->GetIncidentEdge(),
+                   * start = e;
+    while (e) {
+        ++nedges;
+        e = e->GetPrev()->GetOpposite();
+        if (e==start)
+            break;
+    }
+
+    int size = 0;
+    for (int p=0; p<npasses; ++p)
+        if (masks[p]==HbrVertex<T>::k_Smooth or masks[p]==HbrVertex<T>::k_Dart)
+            size += catmark ? 2*nedges : nedges;
+    return size;
+}
+
+template <class T, class U> bool
+FarMeshFactory<T,U>::UpdateSharpness( FarMesh<U> * mesh ) {
+
+    assert( mesh and mesh->_subdivisionTables );
+
+    FarFactoryStats::Scope scope("FarMeshFactory::UpdateSharpness");
+
+    HbrMesh<T> * hmesh = _hbrMesh;
+
+    bool catmark = isCatmark(hmesh),
+         loop = isLoop(hmesh);
+
+    if (isAdaptive() or _structuredGrids or hmesh->HasCreaseEdits() or
+        hmesh->GetSubdivision()->GetCreaseSubdivisionMethod()==HbrSubdivision<T>::k_CreaseChaikin)
+        return false;
+
+    // the bilinear rules do not depend on sharpness
+    if (not (catmark or loop)) {
+        for (int i=0; i<(int)_edgeSharpness.size(); ++i)
+            _edgeSharpness[i].first->SetSharpness(_edgeSharpness[i].second);
+        for (int i=0; i<(int)_vertexSharpness.size(); ++i)
+            _vertexSharpness[i].first->SetSharpness(_vertexSharpness[i].second);
+        _edgeSharpness.clear();
+        _vertexSharpness.clear();
+        return true;
+    }
+
+    // corner edits are not flagged by HbrMesh
+    for (int i=0; i<(int)hmesh->GetHierarchicalEdits().size(); ++i)
+        if (dynamic_cast<HbrCornerEdit<T> *>(hmesh->GetHierarchicalEdits()[i]))
+            return false;
+
+    FarSubdivisionTables<U> * tables = mesh->_subdivisionTables;
+
+    int maxlevel = GetMaxLevel();
+
+    // locate the edge and vertex vertices of each level in the vertex buffer
+    // and in the tables
+    std::vector<int> edgeVertexOffsets(maxlevel+1,0), edgeTableOffsets(maxlevel+1,0), numEdgeVertices(maxlevel+1,0),
+                     vertVertexOffsets(maxlevel+1,0), vertTableOffsets(maxlevel+1,0), numVertVertices(maxlevel+1,0);
+
+    for (int i=0; i<(int)mesh->_batches.size(); ++i) {
+        FarKernelBatch const & batch = mesh->_batches[i];
+        int level = batch.GetLevel();
+        switch (batch.GetKernelType()) {
+            case FarKernelBatch::CATMARK_EDGE_VERTEX :
+            case FarKernelBatch::LOOP_EDGE_VERTEX :
+                edgeVertexOffsets[level] = batch.GetVertexOffset();
+                edgeTableOffsets[level] = batch.GetTableOffset();
+                numEdgeVertices[level] = batch.GetEnd();
+                break;
+            case FarKernelBatch::CATMARK_VERT_VERTEX_B :
+            case FarKernelBatch::CATMARK_VERT_VERTEX_A1 :
+            case FarKernelBatch::CATMARK_VERT_VERTEX_A2 :
+            case FarKernelBatch::LOOP_VERT_VERTEX_B :
+            case FarKernelBatch::LOOP_VERT_VERTEX_A1 :
+            case FarKernelBatch::LOOP_VERT_VERTEX_A2 :
+                vertVertexOffsets[level] = batch.GetVertexOffset();
+                vertTableOffsets[level] = batch.GetTableOffset();
+                numVertVertices[level] = tables->GetFirstVertexOffset(level+1) - batch.GetVertexOffset();
+                break;
+            default : break;
+        }
+    }
+
+    int * E_IT = tables->_E_IT.empty() ? 0 : &tables->_E_IT[0];
+    float * E_W = tables->_E_W.empty() ? 0 : &tables->_E_W[0];
+    int * V_ITa = tables->_V_ITa.empty() ? 0 : &tables->_V_ITa[0];
+    unsigned int * V_IT = tables->_V_IT.empty() ? 0 : &tables->_V_IT[0];
+    float * V_W = tables->_V_W.empty() ? 0 : &tables->_V_W[0];
+
+    int numVertTable = (int)tables->_V_W.size();
+
+    // The batches are built from the ranks of the vertex vertices : gather the
+    // ranks the tables were created with before applying the new sharpness
+    if (_vertexRanks.empty()) {
+        _vertexRanks.resize(numVertTable, 0);
+        for (int i=0; i<hmesh->GetNumVertices(); ++i) {
+            HbrVertex<T> * v = hmesh->GetVertex(i),
+                         * pv = v ? v->GetParentVertex() : 0;
+            if (not pv)
+                continue;
+            int index = _remapTable[i];
+            for (int level=1; level<=maxlevel; ++level) {
+                int j = index - vertVertexOffsets[level];
+                if (j>=0 and j<numVertVertices[level]) {
+                    _vertexRanks[vertTableOffsets[level]+j] = (unsigned char)
+                        FarSubdivisionTablesFactory<T,U>::GetMaskRanking(pv->GetMask(false), pv->GetMask(true));
+                    break;
+                }
+            }
+        }
+    }
+
+    // apply the new sharpness to the coarse mesh
+    std::vector<HbrHalfedge<T> *> edges, nextEdges;
+    std::vector<HbrVertex<T> *> verts, nextVerts;
+
+    for (int i=0; i<(int)_edgeSharpness.size(); ++i) {
+        HbrHalfedge<T> * e = _edgeSharpness[i].first;
+        if (e->GetSharpness()!=_edgeSharpness[i].second) {
+            e->SetSharpness(_edgeSharpness[i].second);
+            edges.push_back(e);
+        }
+    }
+    for (int i=0; i<(int)_vertexSharpness.size(); ++i) {
+        HbrVertex<T> * v = _vertexSharpness[i].first;
+        if (v->GetSharpness()!=_vertexSharpness[i].second) {
+            v->SetSharpness(_vertexSharpness[i].second);
+            verts.push_back(v);
+        }
+    }
+    _edgeSharpness.clear();
+    _vertexSharpness.clear();
+
+    if (edges.empty() and verts.empty())
+        return true;
+
+    typename HbrCatmarkSubdivision<T>::TriangleSubdivision triangleMethod = catmark ?
+        dynamic_cast<HbrCatmarkSubdivision<T> *>(hmesh->GetSubdivision())->GetTriangleSubdivisionMethod() :
+        HbrCatmarkSubdivision<T>::k_Normal;
+
+    HbrSubdivision<T> * subdivision = hmesh->GetSubdivision();
+
+    // the edge and vertex vertices of each level whose rules must be recomputed
+    std::vector<std::vector<HbrVertex<T> *> > edgeVerts(maxlevel+1), vertVerts(maxlevel+1);
+
+    // Walk down the hierarchy : the modified edges of a level change the rule
+    // of their edge vertex and of the vertex vertices of their end points, and
+    // hand down their sharpness to their child edges. The modified vertices
+    // change the rule of their vertex vertex and hand down their sharpness.
+    for (int level=0; level<maxlevel and not (edges.empty() and verts.empty()); ++level) {
+
+        int child = level+1;
+
+        for (int i=0; i<(int)edges.size(); ++i) {
+            verts.push_back(edges[i]->GetOrgVertex());
+            verts.push_back(edges[i]->GetDestVertex());
+        }
+        std::sort(verts.begin(), verts.end());
+        verts.erase(std::unique(verts.begin(), verts.end()), verts.end());
+
+        for (int i=0; i<(int)edges.size(); ++i) {
+
+            // only one of the half-edges owns the child vertex
+            HbrHalfedge<T> * e = edges[i];
+            if (not (e->HasChild() or (e->GetOpposite() and e->GetOpposite()->HasChild())))
+                continue;
+
+            HbrVertex<T> * ev = e->Subdivide();
+            edgeVerts[child].push_back(ev);
+
+            for (int k=0; k<2; ++k) {
+
+                HbrVertex<T> * v = k==0 ? e->GetOrgVertex() : e->GetDestVertex();
+                if (not v->HasChild())
+                    continue;
+
+                HbrHalfedge<T> * childedge = getEdge(v->Subdivide(), ev);
+                if (not childedge)
+                    continue;
+
+                float sharpness = childedge->GetSharpness();
+                if (e->GetSharpness() > HbrHalfedge<T>::k_Smooth) {
+                    subdivision->SubdivideCreaseWeight(e, k==0 ? e->GetDestVertex() : e->GetOrgVertex(), childedge);
+                } else {
+                    childedge->SetSharpness(HbrHalfedge<T>::k_Smooth);
+                }
+                if (childedge->GetSharpness()!=sharpness)
+                    nextEdges.push_back(childedge);
+            }
+        }
+
+        for (int i=0; i<(int)verts.size(); ++i) {
+
+            HbrVertex<T> * v = verts[i];
+            if (not v->HasChild())
+                continue;
+
+            HbrVertex<T> * cv = v->Subdivide();
+            vertVerts[child].push_back(cv);
+
+            float sharpness = v->GetSharpness();
+            if (sharpness >= HbrVertex<T>::k_InfinitelySharp) {
+                sharpness = HbrVertex<T>::k_InfinitelySharp;
+            } else {
+                sharpness = std::max((float) HbrVertex<T>::k_Smooth, sharpness - 1.0f);
+            }
+            if (cv->GetSharpness()!=sharpness) {
+                cv->SetSharpness(sharpness);
+                nextVerts.push_back(cv);
+            }
+        }
+
+        edges.swap(nextEdges);
+        verts.swap(nextVerts);
+        nextEdges.clear();
+        nextVerts.clear();
+    }
+
+    // The rules of a level only depend on the sharpness of its parent level,
+    // which is final now : make sure the ring of every modified vertex vertex
+    // fits in the space the tables reserved for it before writing anything, so
+    // that the FarMesh is left untouched if it cannot be updated in place.
+    for (int level=1; level<=maxlevel; ++level) {
+        for (int i=0; i<(int)vertVerts[level].size(); ++i) {
+
+            HbrVertex<T> * cv = vertVerts[level][i];
+
+            int j = _remapTable[cv->GetID()] - vertVertexOffsets[level];
+            if (j<0 or j>=numVertVertices[level])
+                continue;
+            j += vertTableOffsets[level];
+
+            int capacity = (j+1<numVertTable ? V_ITa[5*(j+1)] : (int)tables->_V_IT.size()) - V_ITa[5*j],
+                size = getVertVertexRingSize(cv, catmark);
+            if (size > capacity)
+                return false;
+        }
+    }
+
+    std::vector<bool> dirtyLevels(maxlevel+1, false);
+
+    for (int level=1; level<=maxlevel; ++level) {
+
+        for (int i=0; i<(int)edgeVerts[level].size(); ++i) {
+
+            HbrVertex<T> * ev = edgeVerts[level][i];
+
+            int j = _remapTable[ev->GetID()] - edgeVertexOffsets[level];
+            if (j<0 or j>=numEdgeVertices[level])
+                continue;
+            j += edgeTableOffsets[level];
+
+            if (catmark)
+                FarCatmarkSubdivisionTablesFactory<T,U>::computeEdgeVertex(ev, _remapTable, triangleMethod, E_IT+4*j, E_W+2*j);
+            else
+                FarLoopSubdivisionTablesFactory<T,U>::computeEdgeVertex(ev, _remapTable, E_IT+4*j, E_W+2*j);
+        }
+
+        for (int i=0; i<(int)vertVerts[level].size(); ++i) {
+
+            HbrVertex<T> * cv = vertVerts[level][i];
+
+            int j = _remapTable[cv->GetID()] - vertVertexOffsets[level];
+            if (j<0 or j>=numVertVertices[level])
+                continue;
+            j += vertTableOffsets[level];
+
+            int rank = catmark ?
+                FarCatmarkSubdivisionTablesFactory<T,U>::computeVertexVertex(cv, _remapTable, V_ITa+5*j, V_IT, V_W+j) :
+                FarLoopSubdivisionTablesFactory<T,U>::computeVertexVertex(cv, _remapTable, V_ITa+5*j, V_IT, V_W+j);
+
+            if (rank!=_vertexRanks[j]) {
+                _vertexRanks[j] = (unsigned char)rank;
+                dirtyLevels[level] = true;
+            }
+        }
+    }
+
+    // rebuild the vertex batches of the levels where the ranks changed
+    FarKernelBatchVector batches;
+    batches.reserve(mesh->_batches.size());
+
+    std::vector<bool> rebuilt(maxlevel+1, false);
+
+    for (int i=0; i<(int)mesh->_batches.size(); ++i) {
+
+        FarKernelBatch const & batch = mesh->_batches[i];
+        int level = batch.GetLevel();
+
+        switch (batch.GetKernelType()) {
+            case FarKernelBatch::CATMARK_VERT_VERTEX_B :
+            case FarKernelBatch::CATMARK_VERT_VERTEX_A1 :
+            case FarKernelBatch::CATMARK_VERT_VERTEX_A2 :
+            case FarKernelBatch::LOOP_VERT_VERTEX_B :
+            case FarKernelBatch::LOOP_VERT_VERTEX_A1 :
+            case FarKernelBatch::LOOP_VERT_VERTEX_A2 :
+                if (dirtyLevels[level]) {
+                    if (not rebuilt[level]) {
+                        FarVertexKernelBatchFactory batchFactory;
+                        for (int j=0; j<numVertVertices[level]; ++j) {
+                            int index = vertTableOffsets[level]+j;
+                            batchFactory.AddVertex( j, _vertexRanks[index], V_ITa[5*index+1] );
+                        }
+                        if (catmark)
+                            batchFactory.AppendCatmarkBatches(level, vertTableOffsets[level], vertVertexOffsets[level], &batches);
+                        else
+                            batchFactory.AppendLoopBatches(level, vertTableOffsets[level], vertVertexOffsets[level], &batches);
+                        rebuilt[level] = true;
+                    }
+                    continue;
+                }
+                break;
+            default : break;
+        }
+        batches.push_back(batch);
+    }
+    mesh->_batches.swap(batches);
+
+    // the limit masks depend on the rules of the vertices of the finest level
+    if (mesh->_limitTables) {
+        delete mesh->_limitTables;
+        mesh->_limitTables = FarLimitTablesFactory<T,U>::Create( this );
+    }
+
+    return true;
+}
+
 } // end namespace OPENSUBDIV_VERSION
 using namespace OPENSUBDIV_VERSION;
 
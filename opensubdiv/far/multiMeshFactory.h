@@ -87,6 +87,9 @@ private:
     // splice hierarchical edit tables
     FarVertexEditTables<U> * spliceVertexEditTables(FarMesh<U> *farmesh, FarMeshVector const &meshes);
 
+    // splice B-spline end cap tables
+    FarEndCapTables * spliceEndCapTables(FarMeshVector const &meshes);
+
     int _maxlevel;
     int _maxvalence;
 
@@ -144,6 +147,9 @@ FarMultiMeshFactory<T, U>::Create(std::vector<FarMesh<U> const *> const &meshes)
     // splice vertex edit tables
     result->_vertexEditTables = spliceVertexEditTables(result, meshes);
 
+    // splice end cap tables
+    result->_endCapTables = spliceEndCapTables(meshes);
+
     // count total num vertices, numptex faces
     int numVertices = 0, numPtexFaces = 0;
     for (size_t i = 0; i < meshes.size(); ++i) {
@@ -208,24 +214,6 @@ copyWithOffsetV_ITa(IT dst_iterator, V const &src, int tableOffset, int vertexOf
     return dst_iterator;
 }
 
-template <typename V, typename IT> static IT
-copyWithOffsetVertexValence(IT dst_iterator, V const &src, int srcMaxValence, int dstMaxValence, int offset) {
-    for (typename V::const_iterator it = src.begin(); it != src.end(); ) {
-        int valence = *it++;
-        *dst_iterator++ = valence;
-        valence = abs(valence);
-        for (int i = 0; i < 2*dstMaxValence; ++i) {
-            if (i < 2*srcMaxValence) {
-                *dst_iterator++ = (i < 2*valence) ? *it + offset : 0;
-                ++it;
-            } else {
-                *dst_iterator++ = 0;
-            }
-        }
-    }
-    return dst_iterator;
-}
-
 template <class T, class U> FarSubdivisionTables<U> *
 FarMultiMeshFactory<T, U>::spliceSubdivisionTables(FarMesh<U> *farMesh, FarMeshVector const &meshes) {
 
@@ -347,9 +335,34 @@ FarMultiMeshFactory<T, U>::spliceSubdivisionTables(FarMesh<U> *farMesh, FarMeshV
         V_W = copyWithOffset(V_W, tables->Get_V_W(), 0);
     }
 
+    // merge structured grids
+    std::vector<int> gridOffsets;
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        FarStructuredGrids const & grids = meshes[i]->GetSubdivisionTables()->GetStructuredGrids();
+
+        int gridOffset = (int)result->_structuredGrids._grids.size(),
+            indexOffset = (int)result->_structuredGrids._indices.size();
+        gridOffsets.push_back(gridOffset);
+
+        for (int j = 0; j < grids.GetNumGrids(); ++j) {
+            FarStructuredGrids::Grid g = grids.GetGrid(j);
+            g.faceOffset += vertexOffsets[i];
+            g.hEdgeOffset += vertexOffsets[i];
+            g.vEdgeOffset += vertexOffsets[i];
+            g.vertOffset += vertexOffsets[i];
+            if (g.parent >= 0)
+                g.parent += gridOffset;
+            g.indexOffset += indexOffset;
+            result->_structuredGrids._grids.push_back(g);
+        }
+        copyWithOffset(std::back_inserter(result->_structuredGrids._indices),
+                       grids.GetIndices(), vertexOffsets[i]);
+    }
+
     // merge batch, model by model
     FarKernelBatchVector &batches = farMesh->_batches;
-    int editTableIndexOffset = 0;
+    int editTableIndexOffset = 0,
+        endCapOffset = 0;
     for (int i = 0; i < (int)meshes.size(); ++i) {
         for (int j = 0; j < (int)meshes[i]->_batches.size(); ++j) {
             FarKernelBatch batch = meshes[i]->_batches[j];
@@ -380,10 +393,20 @@ FarMultiMeshFactory<T, U>::spliceSubdivisionTables(FarMesh<U> *farMesh, FarMeshV
             } else if (batch._kernelType == FarKernelBatch::HIERARCHICAL_EDIT) {
             
                 batch._tableIndex += editTableIndexOffset;
+
+            } else if (batch._kernelType == FarKernelBatch::CATMARK_STRUCTURED_GRID) {
+
+                batch._start += gridOffsets[i];
+                batch._end += gridOffsets[i];
+
+            } else if (batch._kernelType == FarKernelBatch::END_CAP) {
+
+                batch._tableOffset += endCapOffset;
             }
             batches.push_back(batch);
         }
         editTableIndexOffset += meshes[i]->_vertexEditTables ? meshes[i]->_vertexEditTables->GetNumBatches() : 0;
+        endCapOffset += meshes[i]->_endCapTables ? meshes[i]->_endCapTables->GetNumVertices() : 0;
     }
 
     // count verts offsets
@@ -459,6 +482,7 @@ FarMultiMeshFactory<T, U>::splicePatchTables(FarMeshVector const &meshes) {
     int vertexOffset = 0;
     int maxValence = 0;
     int numTotalIndices = 0;
+    bool sparseValence = false;
 
     //result->_patchCounts.reserve(meshes.size());
     //FarPatchCount totalCount;
@@ -475,6 +499,9 @@ FarMultiMeshFactory<T, U>::splicePatchTables(FarMeshVector const &meshes) {
         // need to align maxvalence with the highest value
         maxValence = std::max(maxValence, ptables->_maxValence);
 
+        // the spliced valence table is sparse if one of the meshes is
+        sparseValence |= ptables->_sparseValence;
+
         FarPatchTables::PatchArray const *gregory = ptables->GetPatchArray(Descriptor(FarPatchTables::GREGORY, FarPatchTables::NON_TRANSITION, /*rot*/ 0));
         FarPatchTables::PatchArray const *gregoryBoundary = ptables->GetPatchArray(Descriptor(FarPatchTables::GREGORY_BOUNDARY, FarPatchTables::NON_TRANSITION, /*rot*/ 0));
 
@@ -494,7 +521,14 @@ FarMultiMeshFactory<T, U>::splicePatchTables(FarMeshVector const &meshes) {
 
     // Allocate vertex valence table, quad offset table
     if (totalQuadOffset0 + totalQuadOffset1 > 0) {
-        result->_vertexValenceTable.resize((2*maxValence+1) * vertexOffset);
+        if (sparseValence) {
+            // one offset per vertex, followed by the shared record of valence 0
+            result->_vertexValenceTable.assign(vertexOffset+1, vertexOffset);
+            result->_vertexValenceTable[vertexOffset] = 0;
+            result->_sparseValence = true;
+        } else {
+            result->_vertexValenceTable.resize((2*maxValence+1) * vertexOffset);
+        }
         result->_quadOffsetTable.resize(totalQuadOffset0 + totalQuadOffset1);
     }
 
@@ -519,20 +553,38 @@ FarMultiMeshFactory<T, U>::splicePatchTables(FarMeshVector const &meshes) {
     FarPatchTables::QuadOffsetTable::iterator Q0_IT = result->_quadOffsetTable.begin();
     FarPatchTables::QuadOffsetTable::iterator Q1_IT = Q0_IT + totalQuadOffset0;
 
-    FarPatchTables::VertexValenceTable::iterator VV_IT = result->_vertexValenceTable.begin();
+    FarPatchTables::VertexValenceTable & VV = result->_vertexValenceTable;
     for (size_t i = 0; i < meshes.size(); ++i) {
         const FarPatchTables *ptables = meshes[i]->GetPatchTables();
 
         // merge vertex valence
         // note: some prims may not have vertex valence table, but still need a space
         // in order to fill following prim's data at appropriate location.
-        copyWithOffsetVertexValence(VV_IT,
-                                    ptables->_vertexValenceTable,
-                                    ptables->_maxValence,
-                                    maxValence,
-                                    vertexOffsets[i]);
-
-        VV_IT += meshes[i]->GetNumVertices() * (2 * maxValence + 1);
+        if (not ptables->_vertexValenceTable.empty()) {
+            for (int j = 0; j < meshes[i]->GetNumVertices(); ++j) {
+
+                int const * src = ptables->GetVertexValences(j);
+                int valence = abs(src[0]),
+                    vertex = vertexOffsets[i] + j,
+                    dst;
+
+                if (sparseValence) {
+                    // unused vertices keep pointing to the shared record
+                    if (src[0] == 0)
+                        continue;
+                    dst = (int)VV.size();
+                    VV.resize(dst + 2*valence + 1);
+                    VV[vertex] = dst;
+                } else {
+                    dst = vertex * (2*maxValence + 1);
+                }
+
+                VV[dst] = src[0];
+                for (int k = 0; k < 2*valence; ++k) {
+                    VV[dst+1+k] = src[1+k] + vertexOffsets[i];
+                }
+            }
+        }
 
         // merge quad offsets
 //        int nGregoryQuads = (int)ptables->_full._G_IT.first.size();
@@ -566,6 +618,32 @@ FarMultiMeshFactory<T, U>::splicePatchTables(FarMeshVector const &meshes) {
         }
     }
 
+    // merge sharpness table (only if one of the meshes has single crease patches)
+    bool hasSharpness = false;
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        if (not meshes[i]->GetPatchTables()->_sharpnessTable.empty())
+            hasSharpness = true;
+    }
+    if (hasSharpness) {
+        for (FarPatchTables::Descriptor::iterator it(FarPatchTables::Descriptor(FarPatchTables::POINTS, FarPatchTables::NON_TRANSITION, 0));
+             it != FarPatchTables::Descriptor::end(); ++it) {
+            for (size_t i = 0; i < meshes.size(); ++i) {
+                FarPatchTables const *ptables = meshes[i]->GetPatchTables();
+                FarPatchTables::PatchArray const *parray = ptables->GetPatchArray(*it);
+                if (not parray)
+                    continue;
+                if (ptables->_sharpnessTable.empty()) {
+                    result->_sharpnessTable.insert(result->_sharpnessTable.end(), parray->GetNumPatches(), 0.0f);
+                } else {
+                    FarPatchTables::SharpnessTable::const_iterator begin =
+                        ptables->_sharpnessTable.begin() + parray->GetPatchIndex();
+                    result->_sharpnessTable.insert(result->_sharpnessTable.end(),
+                                                   begin, begin + parray->GetNumPatches());
+                }
+            }
+        }
+    }
+
     // merge fvardata table
     FarPatchTables::FVarDataTable::iterator FV_IT = result->_fvarTable.begin();
     for (FarPatchTables::Descriptor::iterator it(FarPatchTables::Descriptor(FarPatchTables::POINTS, FarPatchTables::NON_TRANSITION, 0));
@@ -610,6 +688,38 @@ FarMultiMeshFactory<T, U>::spliceVertexEditTables(FarMesh<U> *farMesh, FarMeshVe
     return result;
 }
 
+template <class T, class U> FarEndCapTables *
+FarMultiMeshFactory<T, U>::spliceEndCapTables(FarMeshVector const &meshes) {
+
+    FarEndCapTables * result = new FarEndCapTables;
+
+    int vertexOffset = 0;
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        const FarEndCapTables *endCapTables = meshes[i]->GetEndCapTables();
+
+        if (endCapTables) {
+            int indexOffset = (int)result->_indices.size();
+
+            // stencil offsets (skipping the leading 0 of each mesh)
+            copyWithOffset(std::back_inserter(result->_offsets),
+                           endCapTables->GetOffsets(), 1, endCapTables->GetNumVertices(), indexOffset);
+            copyWithOffset(std::back_inserter(result->_indices),
+                           endCapTables->GetIndices(), vertexOffset);
+            copyWithOffset(std::back_inserter(result->_weights),
+                           endCapTables->GetWeights(), 0);
+            copyWithOffset(std::back_inserter(result->_varyingIndices),
+                           endCapTables->GetVaryingIndices(), vertexOffset);
+        }
+        vertexOffset += meshes[i]->GetNumVertices();
+    }
+
+    if (result->GetNumVertices() == 0) {
+        delete result;
+        return NULL;
+    }
+    return result;
+}
+
 } // end namespace OPENSUBDIV_VERSION
 using namespace OPENSUBDIV_VERSION;
 
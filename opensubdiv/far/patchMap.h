@@ -75,6 +75,14 @@ public:
     ///                limit surface is tagged as a hole at the given location
     ///
     Handle const * FindPatch( int faceid, float u, float v ) const;
+
+    /// \brief Itemized memory allocated by the handles and the quadtree
+    FarMemoryUsage GetMemoryUsage() const {
+        FarMemoryUsage result;
+        result.AddVector("handles", _handles);
+        result.AddVector("quadtree", _quadtree);
+        return result;
+    }
     
 private:
     void initialize( FarPatchTables const & patchTables );
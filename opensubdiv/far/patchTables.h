@@ -28,6 +28,7 @@
 
 #include "../version.h"
 
+#include "../far/memoryUsage.h"
 #include "../far/patchParam.h"
 
 #include <cstdlib>
@@ -52,6 +53,7 @@ public:
     typedef std::vector<unsigned int>  QuadOffsetTable;
     typedef std::vector<FarPatchParam> PatchParamTable;
     typedef std::vector<float>         FVarDataTable;
+    typedef std::vector<float>         SharpnessTable;
 
     enum Type {
         NON_PATCH = 0,     ///< undefined
@@ -68,7 +70,9 @@ public:
         BOUNDARY,
         CORNER,
         GREGORY,
-        GREGORY_BOUNDARY
+        GREGORY_BOUNDARY,
+
+        SINGLE_CREASE      ///< regular patch with a semi-sharp crease along one edge
     };
     
     enum TransitionPattern {
@@ -95,6 +99,10 @@ public:
     ///   also further distinguished by a transition pattern as well as a rotational
     ///   orientation.
     ///
+    /// * Optionally, adaptively subdivided meshes can also contain SINGLE_CREASE
+    ///   patches : regular patches with a semi-sharp crease running along their
+    ///   first edge (see FarMeshFactory)
+    ///
     /// An iterator class is provided as a convenience to enumerate over the set
     /// of valid feature adaptive patch descriptors.
     ///
@@ -146,15 +154,18 @@ public:
         ///                         BOUNDARY
         ///                         CORNER
         ///                         GREGORY
-        ///                         GREGORY_BOUNDARY )
+        ///                         GREGORY_BOUNDARY
+        ///                         SINGLE_CREASE )
         ///
         ///        PATTERN0 ( REGULAR
-        ///                   BOUNDARY ROT0 ROT1 ROT2 ROT3
-        ///                   CORNER   ROT0 ROT1 ROT2 ROT3 )
+        ///                   BOUNDARY      ROT0 ROT1 ROT2 ROT3
+        ///                   CORNER        ROT0 ROT1 ROT2 ROT3
+        ///                   SINGLE_CREASE ROT0 ROT1 ROT2 ROT3 )
         ///
         ///        PATTERN1 ( REGULAR
-        ///                   BOUNDARY ROT0 ROT1 ROT2 ROT3
-        ///                   CORNER   ROT0 ROT1 ROT2 ROT3 )
+        ///                   BOUNDARY      ROT0 ROT1 ROT2 ROT3
+        ///                   CORNER        ROT0 ROT1 ROT2 ROT3
+        ///                   SINGLE_CREASE ROT0 ROT1 ROT2 ROT3 )
         ///        ...
         ///
         ///        NON_TRANSITION NON_PATCH ROT0 (end)
@@ -294,13 +305,20 @@ public:
     ///
     /// @param maxValence       Highest vertex valence allowed in the mesh
     ///
+    /// @param sharpness        Crease sharpness of the patches (optional)
+    ///
+    /// @param sparseValence    The vertex valence table uses the sparse layout
+    ///                         (see GetVertexValenceTable)
+    ///
     FarPatchTables(PatchArrayVector const & patchArrays,
                    PTable const & patches,
                    VertexValenceTable const * vertexValences,
                    QuadOffsetTable const * quadOffsets,
                    PatchParamTable const * patchParams,
                    FVarDataTable const * fvarData,
-                   int maxValence);
+                   int maxValence,
+                   SharpnessTable const * sharpness=0,
+                   bool sparseValence=false);
 
     /// \brief Get the table of patch control vertices
     PTable const & GetPatchTable() const { return _patches; }
@@ -350,8 +368,26 @@ public:
     int GetNumFaces(int level=0) const;
     
     /// \brief Returns a vertex valence table used by Gregory patches
+    ///
+    /// The record of a vertex is its valence (negative on boundaries) followed
+    /// by 'valence' pairs of neighbor and diagonal vertex indices. The dense
+    /// layout stores a record of 2*maxValence+1 ints for every vertex. The
+    /// sparse layout starts with one offset per vertex into the table, followed
+    /// by variable-length records for the vertices of the Gregory patches and
+    /// their neighbors only : the offsets of all the other vertices point to a
+    /// shared record of valence 0.
+    ///
     VertexValenceTable const & GetVertexValenceTable() const { return _vertexValenceTable; }
 
+    /// \brief Returns true if the vertex valence table uses the sparse layout
+    bool IsVertexValenceTableSparse() const { return _sparseValence; }
+
+    /// \brief Returns the valence record of a vertex (the table cannot be empty)
+    int const * GetVertexValences(int vertex) const {
+        assert(not _vertexValenceTable.empty());
+        return &_vertexValenceTable[ _sparseValence ? _vertexValenceTable[vertex] : vertex*(2*_maxValence+1) ];
+    }
+
     /// \brief Returns a quad offsets table used by Gregory patches
     QuadOffsetTable const & GetQuadOffsetTable() const { return _quadOffsetTable; }
 
@@ -366,6 +402,13 @@ public:
     ///            prim 0           prim 1
     FVarDataTable const & GetFVarDataTable() const { return _fvarTable; }
 
+    /// \brief Returns the crease sharpness of each patch
+    ///
+    /// The table holds one value per patch (in the same order as the
+    /// PatchParamTable), which is only relevant to SINGLE_CREASE patches. It
+    /// is empty if the tables do not contain any SINGLE_CREASE patch.
+    SharpnessTable const & GetSharpnessTable() const { return _sharpnessTable; }
+
     /// \brief Ringsize of Regular Patches in table.
     static int GetRegularPatchRingsize() { return 16; }
 
@@ -389,6 +432,12 @@ public:
     
     /// \brief True if the patches are of feature adaptive types
     bool IsFeatureAdaptive() const;
+
+    /// \brief Memory required to store the tables
+    int GetMemoryUsed() const;
+
+    /// \brief Itemized memory allocated by each of the tables
+    FarMemoryUsage GetMemoryUsage() const;
     
 private:
 
@@ -399,7 +448,7 @@ private:
     PatchArray * findPatchArray( Descriptor desc );
 
     // Private constructor
-    FarPatchTables( int maxvalence ) : _maxValence(maxvalence) { }
+    FarPatchTables( int maxvalence ) : _maxValence(maxvalence), _sparseValence(false) { }
 
     
     PatchArrayVector    _patchArrays;        // Vector of descriptors for arrays of patches
@@ -414,9 +463,14 @@ private:
 
     FVarDataTable       _fvarTable;
 
+    SharpnessTable      _sharpnessTable;     // crease sharpness (for single crease patches)
+
     // highest vertex valence allowed in the mesh (used for Gregory 
     // vertexValance & quadOffset tables)
     int _maxValence;
+
+    // the vertex valence table only holds the records needed by Gregory patches
+    bool _sparseValence;
 };
 
 /// \brief Descriptor iterator class 
@@ -467,10 +521,13 @@ FarPatchTables::FarPatchTables(PatchArrayVector const & patchArrays,
                                QuadOffsetTable const * quadOffsets,
                                PatchParamTable const * patchParams,
                                FVarDataTable const * fvarData,
-                               int maxValence) :
+                               int maxValence,
+                               SharpnessTable const * sharpness,
+                               bool sparseValence) :
     _patchArrays(patchArrays),
     _patches(patches),
-    _maxValence(maxValence) {
+    _maxValence(maxValence),
+    _sparseValence(sparseValence) {
 
     // copy other tables if exist
     if (vertexValences)
@@ -481,6 +538,8 @@ FarPatchTables::FarPatchTables(PatchArrayVector const & patchArrays,
         _paramTable = *patchParams;
     if (fvarData)
         _fvarTable = *fvarData;
+    if (sharpness)
+        _sharpnessTable = *sharpness;
 }
 
 inline bool 
@@ -497,7 +556,7 @@ FarPatchTables::IsFeatureAdaptive() const {
     for (int i=0; i<(int)parrays.size(); ++i) {
     
         if (parrays[i].GetDescriptor().GetType() >= REGULAR and
-            parrays[i].GetDescriptor().GetType() <= GREGORY_BOUNDARY)
+            parrays[i].GetDescriptor().GetType() <= SINGLE_CREASE)
             return true;
         
     }
@@ -508,7 +567,8 @@ FarPatchTables::IsFeatureAdaptive() const {
 inline short 
 FarPatchTables::Descriptor::GetNumControlVertices( FarPatchTables::Type type ) {
     switch (type) {
-        case REGULAR           : return FarPatchTables::GetRegularPatchRingsize();
+        case REGULAR           :
+        case SINGLE_CREASE     : return FarPatchTables::GetRegularPatchRingsize();
         case QUADS             : return 4;
         case GREGORY           :
         case GREGORY_BOUNDARY  : return FarPatchTables::GetGregoryPatchRingsize();
@@ -526,7 +586,7 @@ inline FarPatchTables::Descriptor &
 FarPatchTables::Descriptor::operator ++ () {
 
     if (GetPattern()==NON_TRANSITION) {
-        if (GetType()==GREGORY_BOUNDARY) {
+        if (GetType()==SINGLE_CREASE) {
             _type=REGULAR;
             ++_pattern;
         } else
@@ -546,6 +606,13 @@ FarPatchTables::Descriptor::operator ++ () {
                             }; break;
 
             case CORNER   : if (GetRotation()==3) {
+                                  _type=SINGLE_CREASE;
+                                  _rotation=0;
+                              } else {
+                                  ++_rotation;
+                              }; break;
+
+            case SINGLE_CREASE : if (GetRotation()==3) {
                                   if (GetPattern()!=PATTERN4) {
                                       _type=REGULAR;
                                       _rotation=0;
@@ -655,6 +722,31 @@ FarPatchTables::GetNumControlVertices() const {
     return result;
 }
 
+// Returns the memory required to store the tables
+inline int
+FarPatchTables::GetMemoryUsed() const {
+    return (int)(_patchArrays.size() * sizeof(PatchArray) +
+                 _patches.size() * sizeof(unsigned int) +
+                 _vertexValenceTable.size() * sizeof(int) +
+                 _quadOffsetTable.size() * sizeof(unsigned int) +
+                 _paramTable.size() * sizeof(FarPatchParam) +
+                 _fvarTable.size() * sizeof(float) +
+                 _sharpnessTable.size() * sizeof(float));
+}
+
+inline FarMemoryUsage
+FarPatchTables::GetMemoryUsage() const {
+    FarMemoryUsage result;
+    result.AddVector("patchArrays", _patchArrays);
+    result.AddVector("patches", _patches);
+    result.AddVector("vertexValence", _vertexValenceTable);
+    result.AddVector("quadOffsets", _quadOffsetTable);
+    result.AddVector("patchParams", _paramTable);
+    result.AddVector("fvarData", _fvarTable);
+    result.AddVector("sharpness", _sharpnessTable);
+    return result;
+}
+
 
 
 } // end namespace OPENSUBDIV_VERSION
@@ -29,6 +29,7 @@
 #include "../version.h"
 
 #include "../far/patchTables.h"
+#include "../far/factoryStats.h"
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
@@ -53,7 +54,15 @@ protected:
     ///
     /// @param remapTable  Vertex remapping table generated by FarMeshFactory
     ///
-    FarPatchTablesFactory( HbrMesh<T> const * mesh, int nfaces, std::vector<int> const & remapTable );
+    /// @param singleCreasePatch  Represent regular faces with a semi-sharp crease
+    ///                    along one of their edges with SINGLE_CREASE patches
+    ///
+    /// @param endCapOffset  Index of the first control vertex of the B-spline
+    ///                    end caps that replace the Gregory patches (-1 : the
+    ///                    faces are represented with Gregory patches)
+    ///
+    FarPatchTablesFactory( HbrMesh<T> const * mesh, int nfaces, std::vector<int> const & remapTable,
+                           bool singleCreasePatch=false, int endCapOffset=-1 );
     
     /// \brief Returns a feature-adaptive FarPatchTables instance 
     ///
@@ -63,9 +72,13 @@ protected:
     ///
     /// @param requireFVarData  Flag for generating face-varying data
     ///
+    /// @param sparseValence    Only store the vertex valence records required
+    ///                         by the Gregory patches (see
+    ///                         FarPatchTables::GetVertexValenceTable)
+    ///
     /// @return                 A new instance of FarPatchTables
     ///
-    FarPatchTables * Create( int maxlevel, int maxvalence, bool requireFVarData=false );
+    FarPatchTables * Create( int maxlevel, int maxvalence, bool requireFVarData=false, bool sparseValence=false );
 
 
     typedef std::vector<std::vector< HbrFace<T> *> > FacesList;
@@ -107,12 +120,25 @@ private:
     // Returns the rotation for a corner patch
     static unsigned char computeCornerPatchRotation( HbrFace<T> * f );
 
+    // Returns the rotation for a single crease patch (-1 if the face cannot be
+    // represented with a single crease patch)
+    static int computeSingleCreasePatchRotation( HbrFace<T> * f );
+
     // Populates an array of indices with the "one-ring" vertices for the given face
     void getOneRing( HbrFace<T> * f, int ringsize, unsigned int const * remap, unsigned int * result );
     
     // Populates the Gregory patch quad offsets table
     static void getQuadOffsets( HbrFace<T> * f, unsigned int * result );
 
+    // Writes the valence record of v at the given offset of the table and
+    // returns the valence of v
+    int gatherVertexValences( HbrVertex<T> * v, FarPatchTables::VertexValenceTable & table, int offset ) const;
+
+    // Appends the valence record of an output vertex to a sparse valence table
+    // (if it was not recorded yet)
+    void appendVertexValences( int vertexID, std::vector<HbrVertex<T> *> const & vertices,
+                               int maxvalence, FarPatchTables::VertexValenceTable & table ) const;
+
     // Iterates through the faces of an HbrMesh and tags the _adaptiveFlags on faces and vertices
     void tagAdaptivePatches( HbrMesh<T> const * mesh, int nfaces );
     
@@ -136,7 +162,8 @@ private:
         TYPE R,       // regular patch 
              B[4],    // boundary patch (4 rotations)
              C[4],    // corner patch (4 rotations)
-             G[2];    // gregory patch (boundary & corner)
+             G[2],    // gregory patch (boundary & corner)
+             S[4];    // single crease patch (4 rotations)
         
         PatchTypes() { memset(this, 0, sizeof(PatchTypes<TYPE>)); }
         
@@ -168,6 +195,10 @@ private:
     std::vector<int> const &_remapTable;
     
     int _nfaces;
+
+    bool _singleCreasePatch;
+
+    int _endCapOffset;
 };
 
 // True if the surrounding faces are "tagged" (unsupported feature : watertight 
@@ -220,6 +251,36 @@ FarPatchTablesFactory<T>::computeCornerPatchRotation( HbrFace<T> * f ) {
     return rot;
 }
 
+// Returns a rotation index for single crease patches (range [0-3]) : the
+// crease runs along the edge of the face with the rotation index. Returns -1
+// if the face has no sharp edge, or if the crease is not supported by the
+// patch (crease ending, turning or changing sharpness in the one-ring)
+template <class T> int
+FarPatchTablesFactory<T>::computeSingleCreasePatchRotation( HbrFace<T> * f ) {
+
+    int rot=-1;
+    for (int i=0; i<4; ++i) {
+        if (f->GetEdge(i)->GetSharpness()>0.0f) {
+            if (rot>=0)
+                return -1;
+            rot=i;
+        }
+    }
+
+    if (rot<0)
+        return -1;
+
+    for (int i=0; i<4; ++i) {
+        HbrVertex<T> * v = f->GetVertex((rot+i)%4);
+        if (i<2) {
+            if (not FarMeshFactory<T,T>::vertexIsSingleCrease(v, false))
+                return -1;
+        } else if (v->GetMask(false)!=HbrVertex<T>::k_Smooth or v->GetMask(true)!=HbrVertex<T>::k_Smooth)
+            return -1;
+    }
+    return rot;
+}
+
 // Reserves tables based on the contents of the PatchArrayVector
 template <class T> void
 FarPatchTablesFactory<T>::allocateTables( FarPatchTables * tables, int fvarwidth ) {
@@ -237,6 +298,13 @@ FarPatchTablesFactory<T>::allocateTables( FarPatchTables * tables, int fvarwidth
     if (fvarwidth>0) {
         tables->_fvarTable.resize( npatches * 4 * fvarwidth );
     }
+
+    for (int i=0; i<(int)tables->_patchArrays.size(); ++i) {
+        if (tables->_patchArrays[i].GetDescriptor().GetType()==FarPatchTables::SINGLE_CREASE) {
+            tables->_sharpnessTable.resize( npatches, 0.0f );
+            break;
+        }
+    }
 }
 
 // Uniform mesh factory (static function because it requires no cached state)
@@ -246,6 +314,8 @@ FarPatchTablesFactory<T>::Create( HbrMesh<T> const * mesh, FacesList const & fli
     if (flist.size()<2)
         return 0;
 
+    FarFactoryStats::Scope scope("FarPatchTablesFactory::Create");
+
     FarPatchTables * result = new FarPatchTables(0);
     
     bool isLoop = FarMeshFactory<T,T>::isLoop(mesh);
@@ -300,18 +370,28 @@ FarPatchTablesFactory<T>::Create( HbrMesh<T> const * mesh, FacesList const & fli
         }
     }
 
+    FarFactoryStats::Count(FarFactoryStats::PATCHES_EMITTED, result->GetNumPatches());
+    FarFactoryStats::Count(FarFactoryStats::BYTES_ALLOCATED, result->GetMemoryUsed());
+
     return result;
 }
 
 // Feature adaptive mesh factory
 template <class T>
-FarPatchTablesFactory<T>::FarPatchTablesFactory( HbrMesh<T> const * mesh, int nfaces,  std::vector<int> const & remapTable ) :
+FarPatchTablesFactory<T>::FarPatchTablesFactory( HbrMesh<T> const * mesh, int nfaces,  std::vector<int> const & remapTable,
+                                                 bool singleCreasePatch, int endCapOffset ) :
     _mesh(mesh),
     _remapTable(remapTable),
-    _nfaces(nfaces)
+    _nfaces(nfaces),
+    _singleCreasePatch(singleCreasePatch),
+    _endCapOffset(endCapOffset)
 {
     assert(mesh and nfaces>0);
 
+    FarFactoryStats::Scope scope("FarPatchTablesFactory::classify");
+
+    FarFactoryStats::Count(FarFactoryStats::FACES_PROCESSED, nfaces);
+
     // First pass : identify transition / watertight-critical
     for (int i=0; i<nfaces; ++i) {
 
@@ -432,6 +512,11 @@ FarPatchTablesFactory<T>::FarPatchTablesFactory( HbrMesh<T> const * mesh, int nf
             continue;
         
         assert(f->_adaptiveFlags.rots==0 and nv==4);
+
+        // Regular faces with a single semi-sharp crease
+        int creaseRot = -1;
+        if (_singleCreasePatch and boundaryVerts==0 and (not isExtraordinary))
+            creaseRot = computeSingleCreasePatchRotation(f);
         
         if (not isTagged and wasTagged) {
 
@@ -444,8 +529,15 @@ FarPatchTablesFactory<T>::FarPatchTablesFactory( HbrMesh<T> const * mesh, int nf
 
                     switch (boundaryVerts) {
                     
-                        case 0 : {   // Regular patch
-                                     _patchCtr[0].R++;
+                        case 0 : {   if (creaseRot>=0) {
+                                         // Single crease patch
+                                         f->_adaptiveFlags.rots=creaseRot;
+                                         f->_adaptiveFlags.isSingleCrease=true;
+                                         _patchCtr[0].S[0]++;
+                                     } else {
+                                         // Regular patch
+                                         _patchCtr[0].R++;
+                                     }
                                  } break; 
                         
                         case 2 : {   // Boundary patch
@@ -465,7 +557,12 @@ FarPatchTablesFactory<T>::FarPatchTablesFactory( HbrMesh<T> const * mesh, int nf
                     // Default to Gregory Patch
                     f->_adaptiveFlags.patchType = HbrFace<T>::kGregory;
 
-                    switch (boundaryVerts) {
+                    if (_endCapOffset>=0) {
+
+                        // B-spline end caps are counted as regular patches
+                        _patchCtr[0].R++;
+
+                    } else switch (boundaryVerts) {
                     
                         case 0 : {   // Regular Gregory patch
                                      _patchCtr[0].G[0]++;
@@ -533,8 +630,19 @@ FarPatchTablesFactory<T>::FarPatchTablesFactory( HbrMesh<T> const * mesh, int nf
                     
                     switch (boundaryVerts) {
                     
-                        case 0 : {   // regular patch
-                                     _patchCtr[tidx+1].R++;
+                        case 0 : {   if (creaseRot>=0) {
+                                         // single crease patch
+                                         f->_adaptiveFlags.brots=(4-f->_adaptiveFlags.rots+creaseRot)%4;
+
+                                         f->_adaptiveFlags.rots=creaseRot; // override the transition rotation
+
+                                         f->_adaptiveFlags.isSingleCrease=true;
+
+                                         _patchCtr[tidx+1].S[f->_adaptiveFlags.brots]++;
+                                     } else {
+                                         // regular patch
+                                         _patchCtr[tidx+1].R++;
+                                     }
                                  } break; 
                         
                         case 2 : {   // boundary patch
@@ -576,6 +684,7 @@ FarPatchTablesFactory<T>::PatchTypes<TYPE>::getValue( FarPatchTables::Descriptor
         case FarPatchTables::CORNER           : return C[desc.GetRotation()];
         case FarPatchTables::GREGORY          : return G[0];
         case FarPatchTables::GREGORY_BOUNDARY : return G[1];
+        case FarPatchTables::SINGLE_CREASE    : return S[desc.GetRotation()];
         default : assert(0);
     }
     // can't be reached (suppress compiler warning)
@@ -593,6 +702,7 @@ FarPatchTablesFactory<T>::PatchTypes<TYPE>::getNumPatchArrays() const {
         if (B[i]) ++result;
         if (C[i]) ++result;
         if ((i<2) and G[i]) ++result;
+        if (S[i]) ++result;
     }
     return result;
 }
@@ -637,7 +747,7 @@ FarPatchTablesFactory<T>::pushPatchArray( FarPatchTables::Descriptor desc,
 }
 
 template <class T> FarPatchTables *
-FarPatchTablesFactory<T>::Create( int maxlevel, int maxvalence, bool requireFVarData ) {
+FarPatchTablesFactory<T>::Create( int maxlevel, int maxvalence, bool requireFVarData, bool sparseValence ) {
 
     static const unsigned int remapRegular        [16] = {5,6,10,9,4,0,1,2,3,7,11,15,14,13,12,8};
     static const unsigned int remapRegularBoundary[12] = {1,2,6,5,0,3,7,11,10,9,8,4};
@@ -645,6 +755,8 @@ FarPatchTablesFactory<T>::Create( int maxlevel, int maxvalence, bool requireFVar
 
     assert(getMesh() and getNumFaces()>0);
 
+    FarFactoryStats::Scope scope("FarPatchTablesFactory::Create");
+
     FarPatchTables * result = new FarPatchTables(maxvalence);
     
     // Populate the patch array descriptors
@@ -662,6 +774,8 @@ FarPatchTablesFactory<T>::Create( int maxlevel, int maxvalence, bool requireFVar
     
     allocateTables( result, fvarwidth ); 
 
+    int endCapOffset = _endCapOffset;
+
     FarPatchTables::QuadOffsetTable quad_G_C0; // Quad-offsets tables (for Gregory patches)
     quad_G_C0.resize(_patchCtr[0].G[0]*4);
 
@@ -705,11 +819,21 @@ FarPatchTablesFactory<T>::Create( int maxlevel, int maxvalence, bool requireFVar
                 if (not f->_adaptiveFlags.isExtraordinary and f->_adaptiveFlags.bverts!=1) {
 
                     switch (f->_adaptiveFlags.bverts) {
-                        case 0 : {   // Regular Patch (16 CVs)
-                                     getOneRing(f, 16, remapRegular, iptrs[0].R);
-                                     iptrs[0].R+=16;
-                                     pptrs[0].R = computePatchParam(f, pptrs[0].R);
-                                     fptrs[0].R = computeFVarData(f, fvarwidth, fptrs[0].R, /*isAdaptive=*/true);
+                        case 0 : {   if (f->_adaptiveFlags.isSingleCrease) {
+                                         // Single Crease Patch (16 CVs + sharpness)
+                                         getOneRing(f, 16, remapRegular, iptrs[0].S[0]);
+                                         iptrs[0].S[0]+=16;
+                                         result->_sharpnessTable[pptrs[0].S[0]-&result->_paramTable[0]] =
+                                             f->GetEdge(f->_adaptiveFlags.rots)->GetSharpness();
+                                         pptrs[0].S[0] = computePatchParam(f, pptrs[0].S[0]);
+                                         fptrs[0].S[0] = computeFVarData(f, fvarwidth, fptrs[0].S[0], /*isAdaptive=*/true);
+                                     } else {
+                                         // Regular Patch (16 CVs)
+                                         getOneRing(f, 16, remapRegular, iptrs[0].R);
+                                         iptrs[0].R+=16;
+                                         pptrs[0].R = computePatchParam(f, pptrs[0].R);
+                                         fptrs[0].R = computeFVarData(f, fvarwidth, fptrs[0].R, /*isAdaptive=*/true);
+                                     }
                                  } break;
 
                         case 2 : {   // Boundary Patch (12 CVs)
@@ -733,7 +857,15 @@ FarPatchTablesFactory<T>::Create( int maxlevel, int maxvalence, bool requireFVar
                 }
             } else if (f->_adaptiveFlags.patchType==HbrFace<T>::kGregory) {
 
-                if (f->_adaptiveFlags.bverts==0) {
+                if (_endCapOffset>=0) {
+
+                    // B-spline End Cap (16 CVs computed by FarEndCapTables)
+                    for (int j=0; j<16; ++j)
+                        iptrs[0].R[j] = endCapOffset++;
+                    iptrs[0].R+=16;
+                    pptrs[0].R = computePatchParam(f, pptrs[0].R);
+                    fptrs[0].R = computeFVarData(f, fvarwidth, fptrs[0].R, /*isAdaptive=*/true);
+                } else if (f->_adaptiveFlags.bverts==0) {
                 
                     // Gregory Regular Patch (4 CVs + quad-offsets / valence tables)
                     for (int j=0; j<4; ++j)
@@ -768,12 +900,23 @@ FarPatchTablesFactory<T>::Create( int maxlevel, int maxvalence, bool requireFVar
             if (not f->_adaptiveFlags.isExtraordinary and f->_adaptiveFlags.bverts!=1) {
 
                 switch (f->_adaptiveFlags.bverts) {
-                    case 0 : {   // Regular Transition Patch (16 CVs)
-                                 getOneRing(f, 16, remapRegular, iptrs[tcase].R);
-
-                                 iptrs[tcase].R+=16;
-                                 pptrs[tcase].R = computePatchParam(f, pptrs[tcase].R);
-                                 fptrs[tcase].R = computeFVarData(f, fvarwidth, fptrs[tcase].R, /*isAdaptive=*/true);
+                    case 0 : {   if (f->_adaptiveFlags.isSingleCrease) {
+                                     // Single Crease Transition Patch (16 CVs + sharpness)
+                                     unsigned rot = f->_adaptiveFlags.brots;
+                                     getOneRing(f, 16, remapRegular, iptrs[tcase].S[rot]);
+                                     iptrs[tcase].S[rot]+=16;
+                                     result->_sharpnessTable[pptrs[tcase].S[rot]-&result->_paramTable[0]] =
+                                         f->GetEdge(f->_adaptiveFlags.rots)->GetSharpness();
+                                     pptrs[tcase].S[rot] = computePatchParam(f, pptrs[tcase].S[rot]);
+                                     fptrs[tcase].S[rot] = computeFVarData(f, fvarwidth, fptrs[tcase].S[rot], /*isAdaptive=*/true);
+                                 } else {
+                                     // Regular Transition Patch (16 CVs)
+                                     getOneRing(f, 16, remapRegular, iptrs[tcase].R);
+
+                                     iptrs[tcase].R+=16;
+                                     pptrs[tcase].R = computePatchParam(f, pptrs[tcase].R);
+                                     fptrs[tcase].R = computeFVarData(f, fvarwidth, fptrs[tcase].R, /*isAdaptive=*/true);
+                                 }
                              } break;
 
                     case 2 : {   // Boundary Transition Patch (12 CVs)
@@ -801,90 +944,68 @@ FarPatchTablesFactory<T>::Create( int maxlevel, int maxvalence, bool requireFVar
     // Build Gregory patches vertex valence indices table
     if ((_patchCtr[0].G[0] > 0) or (_patchCtr[0].G[1] > 0)) {
 
-        // MAX_VALENCE is a property of hardware shaders and needs to be matched in OSD
-        const int perVertexValenceSize = 2*maxvalence + 1;
+        FarFactoryStats::Scope phase("FarPatchTablesFactory::vertexValenceTable");
 
         const int nverts = getMesh()->GetNumVertices();
 
         FarPatchTables::VertexValenceTable & table = result->_vertexValenceTable;
-        table.resize(nverts * perVertexValenceSize);
-
-        class GatherNeighborsOperator : public HbrVertexOperator<T> {
-        public:
-            HbrVertex<T> * center;
-            FarPatchTables::VertexValenceTable & table;
-            int offset, valence;
-            std::vector<int> const & remap;
-
-            GatherNeighborsOperator(FarPatchTables::VertexValenceTable & itable, int ioffset, HbrVertex<T> * v, std::vector<int> const & iremap) : 
-                center(v), table(itable), offset(ioffset), valence(0), remap(iremap) { }
-
-            // Operator iterates over neighbor vertices of v and accumulates
-            // pairs of indices the neighbor and diagonal vertices
-            //
-            //          Regular case
-            //                                           Boundary case
-            //      o ------- o      D3 o
-            //   D0        N0 |         |
-            //                |         |             o ------- o      D2 o
-            //                |         |          D0        N0 |         |
-            //                |         |                       |         |
-            //      o ------- o ------- o                       |         |
-            //   N1 |       V |      N3                         |         |
-            //      |         |                       o ------- o ------- o
-            //      |         |                    N1          V       N2
-            //      |         |
-            //      o         o ------- o
-            //   D1         N2        D2
-            //
-            virtual void operator() (HbrVertex<T> &v) {
-
-                table[offset++] = remap[v.GetID()];
-
-                HbrVertex<T> * diagonal=&v;
-
-                HbrHalfedge<T> * e = center->GetEdge(&v);
-                if ( e ) {
-                    // If v is on a boundary, there may not be a diagonal vertex
-                    diagonal = e->GetNext()->GetDestVertex();
-                }
-                //else {
-                //    diagonal = v.GetQEONext( center );
-                //}
 
-                table[offset++] = remap[diagonal->GetID()];
+        if (sparseValence) {
 
-                ++valence;
+            result->_sparseValence = true;
+
+            // map the output vertices back to the Hbr vertices
+            std::vector<HbrVertex<T> *> vertices(nverts, (HbrVertex<T> *)0);
+            for (int i=0; i<nverts; ++i) {
+                HbrVertex<T> * v = getMesh()->GetVertex(i);
+                vertices[_remapTable[v->GetID()]] = v;
             }
-        };
 
-        for (int i=0; i<nverts; ++i) {
-            HbrVertex<T> * v = getMesh()->GetVertex(i);
+            // one offset per vertex, followed by the shared record of the
+            // vertices that are not used by any Gregory patch
+            table.assign(nverts+1, nverts);
+            table[nverts] = 0;
 
-            int outputVertexID = _remapTable[v->GetID()];
-            int offset = outputVertexID * perVertexValenceSize;
+            for (int i=0; i<2; ++i) {
 
-            // feature adaptive refinement can generate un-connected face-vertices
-            // that have a valence of 0
-            if (not v->IsConnected()) {
-                assert( v->GetParentFace() );
-                table[offset] = 0;
-                continue;
+                FarPatchTables::PatchArray const * gregory =
+                    result->GetPatchArray(Descriptor(i==0 ? FarPatchTables::GREGORY : FarPatchTables::GREGORY_BOUNDARY,
+                                                     FarPatchTables::NON_TRANSITION, 0));
+                if (not gregory)
+                    continue;
+
+                unsigned int const * cvs = &result->_patches[gregory->GetVertIndex()];
+                int ncvs = gregory->GetNumPatches() * 4;
+
+                for (int j=0; j<ncvs; ++j) {
+
+                    appendVertexValences(cvs[j], vertices, maxvalence, table);
+
+                    // boundary Gregory patches also test the valence sign of
+                    // the neighbors of their corners
+                    if (i==1) {
+                        int offset = table[cvs[j]],
+                            valence = abs(table[offset]);
+                        for (int k=0; k<valence; ++k) {
+                            appendVertexValences(table[offset+1+2*k], vertices, maxvalence, table);
+                        }
+                    }
+                }
             }
+        } else {
 
-            // "offset+1" : the first table entry is the vertex valence, which
-            // is gathered by the operator (see note below)
-            GatherNeighborsOperator op( table, offset+1, v, _remapTable );
-            v->ApplyOperatorSurroundingVertices( op );
+            // MAX_VALENCE is a property of hardware shaders and needs to be matched in OSD
+            const int perVertexValenceSize = 2*maxvalence + 1;
 
-            // Valence sign bit used to mark boundary vertices
-            table[offset] = v->OnBoundary() ? -op.valence : op.valence;
+            table.resize(nverts * perVertexValenceSize);
 
-            // Note : some topologies can cause v to be singular at certain
-            // levels of adaptive refinement, which prevents us from using
-            // the GetValence() function. Fortunately, the GatherNeighbors
-            // operator above just performed a similar traversal, so it is
-            // very convenient to use it to accumulate the actionable valence.
+            for (int i=0; i<nverts; ++i) {
+                HbrVertex<T> * v = getMesh()->GetVertex(i);
+
+                int outputVertexID = _remapTable[v->GetID()];
+
+                gatherVertexValences(v, table, outputVertexID * perVertexValenceSize);
+            }
         }
     } else {
         result->_vertexValenceTable.clear();
@@ -895,9 +1016,111 @@ FarPatchTablesFactory<T>::Create( int maxlevel, int maxvalence, bool requireFVar
     std::copy(quad_G_C0.begin(), quad_G_C0.end(), result->_quadOffsetTable.begin());
     std::copy(quad_G_C1.begin(), quad_G_C1.end(), result->_quadOffsetTable.begin()+_patchCtr[0].G[0]*4);
 
+    FarFactoryStats::Count(FarFactoryStats::PATCHES_EMITTED, result->GetNumPatches());
+    FarFactoryStats::Count(FarFactoryStats::BYTES_ALLOCATED, result->GetMemoryUsed());
+
     return result;
 }
 
+// Writes the valence record of v at the given offset of the table
+template <class T> int
+FarPatchTablesFactory<T>::gatherVertexValences( HbrVertex<T> * v, FarPatchTables::VertexValenceTable & table, int offset ) const {
+
+    class GatherNeighborsOperator : public HbrVertexOperator<T> {
+    public:
+        HbrVertex<T> * center;
+        FarPatchTables::VertexValenceTable & table;
+        int offset, valence;
+        std::vector<int> const & remap;
+
+        GatherNeighborsOperator(FarPatchTables::VertexValenceTable & itable, int ioffset, HbrVertex<T> * v, std::vector<int> const & iremap) : 
+            center(v), table(itable), offset(ioffset), valence(0), remap(iremap) { }
+
+        // Operator iterates over neighbor vertices of v and accumulates
+        // pairs of indices the neighbor and diagonal vertices
+        //
+        //          Regular case
+        //                                           Boundary case
+        //      o ------- o      D3 o
+        //   D0        N0 |         |
+        //                |         |             o ------- o      D2 o
+        //                |         |          D0        N0 |         |
+        //                |         |                       |         |
+        //      o ------- o ------- o                       |         |
+        //   N1 |       V |      N3                         |         |
+        //      |         |                       o ------- o ------- o
+        //      |         |                    N1          V       N2
+        //      |         |
+        //      o         o ------- o
+        //   D1         N2        D2
+        //
+        virtual void operator() (HbrVertex<T> &v) {
+
+            table[offset++] = remap[v.GetID()];
+
+            HbrVertex<T> * diagonal=&v;
+
+            HbrHalfedge<T> * e = center->GetEdge(&v);
+            if ( e ) {
+                // If v is on a boundary, there may not be a diagonal vertex
+                diagonal = e->GetNext()->GetDestVertex();
+            }
+            //else {
+            //    diagonal = v.GetQEONext( center );
+            //}
+
+            table[offset++] = remap[diagonal->GetID()];
+
+            ++valence;
+        }
+    };
+
+    // feature adaptive refinement can generate un-connected face-vertices
+    // that have a valence of 0
+    if (not v->IsConnected()) {
+        assert( v->GetParentFace() );
+        table[offset] = 0;
+        return 0;
+    }
+
+    // "offset+1" : the first table entry is the vertex valence, which
+    // is gathered by the operator (see note below)
+    GatherNeighborsOperator op( table, offset+1, v, _remapTable );
+    v->ApplyOperatorSurroundingVertices( op );
+
+    // Valence sign bit used to mark boundary vertices
+    table[offset] = v->OnBoundary() ? -op.valence : op.valence;
+
+    // Note : some topologies can cause v to be singular at certain
+    // levels of adaptive refinement, which prevents us from using
+    // the GetValence() function. Fortunately, the GatherNeighbors
+    // operator above just performed a similar traversal, so it is
+    // very convenient to use it to accumulate the actionable valence.
+    return op.valence;
+}
+
+// Appends the valence record of an output vertex to a sparse valence table
+template <class T> void
+FarPatchTablesFactory<T>::appendVertexValences( int vertexID, std::vector<HbrVertex<T> *> const & vertices,
+                                                int maxvalence, FarPatchTables::VertexValenceTable & table ) const {
+
+    int nverts = (int)vertices.size();
+
+    // the offsets of the vertices not recorded yet point to the shared record
+    if (table[vertexID] != nverts)
+        return;
+
+    assert(vertices[vertexID]);
+
+    int offset = (int)table.size();
+    table.resize(offset + 2*maxvalence + 1);
+
+    int valence = gatherVertexValences(vertices[vertexID], table, offset);
+
+    table.resize(offset + 2*valence + 1);
+    table[vertexID] = offset;
+}
+
 // The One Ring vertices to rule them all !
 template <class T> void 
 FarPatchTablesFactory<T>::getOneRing( HbrFace<T> * f, int ringsize, unsigned int const * remap, unsigned int * result) {
@@ -0,0 +1,88 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+#ifndef FAR_STOPWATCH_H
+#define FAR_STOPWATCH_H
+
+#include "../version.h"
+
+#include <ctime>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+/// \brief Timer used by the Far instrumentation classes.
+///
+/// Far is header-only and does not read a platform clock itself : the time
+/// stamps come from a clock function installed with SetClock (the Osd CPU
+/// library provides the monotonic wall clock OsdGetTime). Until a clock is
+/// installed, the processor time of std::clock is used.
+///
+class FarStopwatch {
+public:
+    /// Clock function returning a time stamp in seconds
+    typedef double (*Clock)();
+
+    /// Constructor (starts the stopwatch)
+    FarStopwatch() : _start(GetTime()) { }
+
+    /// Restarts the stopwatch
+    void Start() {
+        _start = GetTime();
+    }
+
+    /// Returns the time elapsed since the last start in seconds
+    double GetElapsed() const {
+        return GetTime() - _start;
+    }
+
+    /// Installs the clock read by all the stopwatches (NULL restores the
+    /// processor time clock)
+    static void SetClock(Clock clock) {
+        currentClock() = clock ? clock : processorTime;
+    }
+
+    /// Returns a time stamp in seconds from the installed clock
+    static double GetTime() {
+        return currentClock()();
+    }
+
+private:
+    static double processorTime() {
+        return (double)std::clock() / (double)CLOCKS_PER_SEC;
+    }
+
+    static Clock & currentClock() {
+        static Clock clock = processorTime;
+        return clock;
+    }
+
+    double _start;
+};
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif  /* FAR_STOPWATCH_H */
@@ -0,0 +1,224 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+
+#ifndef FAR_STRUCTURED_GRIDS_H
+#define FAR_STRUCTURED_GRIDS_H
+
+#include "../version.h"
+
+#include "../far/memoryUsage.h"
+
+#include <cassert>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+/// \brief Regular regions of a mesh refined with implicit indexing.
+///
+/// A structured grid is a rectangular region of the coarse mesh made of quads
+/// with smooth interior edges and smooth valence 4 interior vertices. Each level
+/// of refinement of the region is described by a Grid : the vertices computed
+/// for the region interior are stored contiguously in lattice order, so that
+/// they do not require any indexing table. Only the vertices of the parent
+/// lattice that are not computed by the grid itself (the coarse vertices and
+/// the boundary ring of each level) are indexed explicitly.
+///
+/// With a parent lattice of W x H faces, a grid computes :
+/// - W x H face-vertices
+/// - W x (H-1) edge-vertices for the interior edges along u
+/// - (W-1) x H edge-vertices for the interior edges along v
+/// - (W-1) x (H-1) vertex-vertices for the interior vertices
+///
+/// each block stored row-major at the given vertex offset. The remaining
+/// vertices of the level are computed from the regular indexing tables.
+///
+class FarStructuredGrids {
+public:
+
+    /// \brief Descriptor of the refinement of a grid to the next level
+    struct Grid {
+        int width,       ///< number of faces along u of the parent lattice
+            height,      ///< number of faces along v of the parent lattice
+            faceOffset,  ///< index of the first face-vertex
+            hEdgeOffset, ///< index of the first edge-vertex along u
+            vEdgeOffset, ///< index of the first edge-vertex along v
+            vertOffset,  ///< index of the first vertex-vertex
+            parent,      ///< grid that computed the parent lattice (-1 : coarse mesh)
+            indexOffset; ///< offset of the explicit parent lattice indices
+    };
+
+    /// \brief Returns the number of grids
+    int GetNumGrids() const { return (int)_grids.size(); }
+
+    /// \brief Returns a grid descriptor
+    Grid const & GetGrid(int grid) const { return _grids[grid]; }
+
+    /// \brief Returns the grid descriptors
+    std::vector<Grid> const & GetGrids() const { return _grids; }
+
+    /// \brief Returns the explicit indices of the parent lattices
+    std::vector<int> const & GetIndices() const { return _indices; }
+
+    /// \brief Returns the number of vertices computed by the grids
+    int GetNumVertices() const {
+        int result = 0;
+        for (int i=0; i<(int)_grids.size(); ++i)
+            result += GetNumVertices(_grids[i]);
+        return result;
+    }
+
+    /// \brief Returns the number of vertices computed by a grid
+    static int GetNumVertices(Grid const & grid) {
+        int w = grid.width, h = grid.height;
+        return w*h + w*(h-1) + (w-1)*h + (w-1)*(h-1);
+    }
+
+    /// \brief Returns the number of explicit parent lattice indices of a grid
+    static int GetNumIndices(Grid const & grid) {
+        int w = grid.width, h = grid.height;
+        return grid.parent<0 ? (w+1)*(h+1) : 2*(w+1) + 2*(h-1);
+    }
+
+    /// \brief Returns the index of the vertex (x,y) of the parent lattice of a grid
+    ///
+    /// @param grids    the grid descriptors
+    ///
+    /// @param indices  the explicit parent lattice indices
+    ///
+    /// @param grid     the index of the grid
+    ///
+    /// @param x        lattice coordinate along u (0 to width)
+    ///
+    /// @param y        lattice coordinate along v (0 to height)
+    ///
+    static int GetParentVertex(Grid const * grids, int const * indices, int grid, int x, int y);
+
+    /// \brief Returns the indices of a row of vertices of the parent lattice
+    ///
+    /// @param grids    the grid descriptors
+    ///
+    /// @param indices  the explicit parent lattice indices
+    ///
+    /// @param grid     the index of the grid
+    ///
+    /// @param y        lattice coordinate along v (0 to height)
+    ///
+    /// @param row      destination of the width+1 indices
+    ///
+    static void GetParentRow(Grid const * grids, int const * indices, int grid, int y, int * row);
+
+    /// \brief Itemized memory allocated by the grids
+    FarMemoryUsage GetMemoryUsage() const {
+        FarMemoryUsage result;
+        result.AddVector("grids", _grids);
+        result.AddVector("indices", _indices);
+        return result;
+    }
+
+private:
+    template <class X, class Y> friend class FarStructuredGridsFactory;
+    template <class X, class Y> friend class FarMultiMeshFactory;
+
+    std::vector<Grid> _grids;   // grid descriptors, sorted by level
+    std::vector<int>  _indices; // explicit parent lattice indices
+};
+
+inline int
+FarStructuredGrids::GetParentVertex(Grid const * grids, int const * indices, int grid, int x, int y) {
+
+    Grid const & g = grids[grid];
+
+    assert(x>=0 and x<=g.width and y>=0 and y<=g.height);
+
+    int const * ring = indices + g.indexOffset;
+
+    // coarse lattice : all the vertices are indexed
+    if (g.parent<0)
+        return ring[y*(g.width+1)+x];
+
+    // boundary ring : bottom and top rows, then left and right columns
+    if (y==0)
+        return ring[x];
+    if (y==g.height)
+        return ring[g.width+1+x];
+    if (x==0)
+        return ring[2*(g.width+1)+y-1];
+    if (x==g.width)
+        return ring[2*(g.width+1)+g.height-1+y-1];
+
+    // interior : implicit indexing in the blocks of the parent grid
+    Grid const & p = grids[g.parent];
+    if (x&1) {
+        if (y&1)
+            return p.faceOffset + ((y-1)/2)*p.width + (x-1)/2;
+        else
+            return p.hEdgeOffset + (y/2-1)*p.width + (x-1)/2;
+    } else {
+        if (y&1)
+            return p.vEdgeOffset + ((y-1)/2)*(p.width-1) + (x/2-1);
+        else
+            return p.vertOffset + (y/2-1)*(p.width-1) + (x/2-1);
+    }
+}
+
+inline void
+FarStructuredGrids::GetParentRow(Grid const * grids, int const * indices, int grid, int y, int * row) {
+
+    Grid const & g = grids[grid];
+
+    int const * ring = indices + g.indexOffset;
+
+    if (g.parent<0) {
+        ring += y*(g.width+1);
+        for (int x=0; x<=g.width; ++x)
+            row[x] = ring[x];
+    } else if (y==0 or y==g.height) {
+        ring += (y==0) ? 0 : g.width+1;
+        for (int x=0; x<=g.width; ++x)
+            row[x] = ring[x];
+    } else {
+        // interior rows interleave 2 arithmetic sequences
+        Grid const & p = grids[g.parent];
+        int even, odd;
+        if (y&1) {
+            even = p.vEdgeOffset + ((y-1)/2)*(p.width-1) - 1;
+            odd = p.faceOffset + ((y-1)/2)*p.width;
+        } else {
+            even = p.vertOffset + (y/2-1)*(p.width-1) - 1;
+            odd = p.hEdgeOffset + (y/2-1)*p.width;
+        }
+        row[0] = ring[2*(g.width+1)+y-1];
+        for (int x=1; x<g.width; ++x)
+            row[x] = (x&1) ? odd + (x-1)/2 : even + x/2;
+        row[g.width] = ring[2*(g.width+1)+g.height-1+y-1];
+    }
+}
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif /* FAR_STRUCTURED_GRIDS_H */
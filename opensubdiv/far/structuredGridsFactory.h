@@ -0,0 +1,511 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+
+#ifndef FAR_STRUCTURED_GRIDS_FACTORY_H
+#define FAR_STRUCTURED_GRIDS_FACTORY_H
+
+#include "../version.h"
+
+#include "../hbr/mesh.h"
+#include "../hbr/cornerEdit.h"
+#include "../hbr/creaseEdit.h"
+#include "../hbr/holeEdit.h"
+
+#include "../far/structuredGrids.h"
+#include "../far/factoryStats.h"
+
+#include <cassert>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+/// \brief A specialized factory for FarStructuredGrids
+///
+/// The factory detects rectangular regions of regular quads in the coarse
+/// Catmark mesh and gathers, for each level of subdivision, the Hbr vertices
+/// that the grids compute. The FarSubdivisionTablesFactory places these
+/// vertices first in their respective (face / edge / vertex) blocks, in
+/// lattice order, and excludes them from the indexing tables.
+///
+template <class T, class U> class FarStructuredGridsFactory {
+
+public:
+
+    /// \brief Constructor
+    ///
+    /// @param mesh      the uniformly refined Catmark HbrMesh
+    ///
+    /// @param maxlevel  the number of levels of subdivision (0 : no grids)
+    ///
+    FarStructuredGridsFactory( HbrMesh<T> const * mesh, int maxlevel );
+
+    /// \brief Returns true if the vertex is computed by a grid
+    bool IsStructured( HbrVertex<T> const * v ) const {
+        return v->GetID() < (int)_structured.size() and _structured[v->GetID()];
+    }
+
+    /// \brief Returns the face-vertices computed by the grids at a given level
+    std::vector<HbrVertex<T> *> const & GetFaceVertices( int level ) const {
+        return _faceVerts[level];
+    }
+
+    /// \brief Returns the edge-vertices computed by the grids at a given level
+    std::vector<HbrVertex<T> *> const & GetEdgeVertices( int level ) const {
+        return _edgeVerts[level];
+    }
+
+    /// \brief Returns the vertex-vertices computed by the grids at a given level
+    std::vector<HbrVertex<T> *> const & GetVertexVertices( int level ) const {
+        return _vertVerts[level];
+    }
+
+    /// \brief Total number of face-vertices computed by the grids
+    int GetNumFaceVerticesTotal() const { return sumList(_faceVerts); }
+
+    /// \brief Total number of edge-vertices computed by the grids
+    int GetNumEdgeVerticesTotal() const { return sumList(_edgeVerts); }
+
+    /// \brief Total number of vertex-vertices computed by the grids
+    int GetNumVertexVerticesTotal() const { return sumList(_vertVerts); }
+
+    /// \brief Returns the number of grids at a given level
+    int GetNumGrids( int level ) const {
+        return level < (int)_lattices.size() ? (int)_lattices[level].size() : 0;
+    }
+
+    /// \brief Creates the grid descriptors
+    ///
+    /// @param remap   the Hbr to Far vertex remapping table
+    ///
+    /// @param result  the grids to populate (sorted by level)
+    ///
+    void Create( std::vector<int> const & remap, FarStructuredGrids * result ) const;
+
+private:
+
+    // Refinement of a region at one level : the vertices computed are stored
+    // in lattice order
+    struct Lattice {
+        int width,
+            height,
+            parent;
+        std::vector<HbrVertex<T> *> faceVerts,
+                                    hEdgeVerts,
+                                    vEdgeVerts,
+                                    vertVerts,
+                                    parentVerts; // coarse lattice, or boundary ring
+    };
+
+    // Coarse face with the rotation that aligns its first vertex with the grid
+    struct Face {
+        HbrFace<T> * face;
+        int rot;
+    };
+
+    static int sumList( std::vector<std::vector<HbrVertex<T> *> > const & list );
+
+    // Returns true if the topology of the mesh allows regular grids
+    static bool isEligible( HbrMesh<T> const * mesh );
+
+    // Returns true if the coarse face can be part of a grid
+    static bool isEligible( HbrFace<T> const * f );
+
+    static bool isSmooth( HbrHalfedge<T> const * e );
+
+    static bool isSmooth( HbrVertex<T> * v );
+
+    // Returns the face across local edge 'edge' (1 : next along u, 2 : next
+    // along v) aligned with the grid
+    static Face getNeighbor( Face const & f, int edge );
+
+    static HbrVertex<T> * getVertex( Face const & f, int corner ) {
+        return f.face->GetVertex( (f.rot+corner)%4 );
+    }
+
+    // Returns either halfedge between 2 vertices (only one of them exists on
+    // the boundary of the mesh)
+    static HbrHalfedge<T> * getEdge( HbrVertex<T> * a, HbrVertex<T> * b ) {
+        HbrHalfedge<T> * e = a->GetEdge(b);
+        return e ? e : b->GetEdge(a);
+    }
+
+    // Grows a grid from a coarse face and returns its faces in row-major order
+    static void growRegion( Face origin, std::vector<char> & used,
+                            int * width, int * height, std::vector<Face> & faces );
+
+    // Refines the lattice of vertices 'parent' (width x height faces) : gathers
+    // the vertices of the interior of the region and returns the child lattice
+    void refineLattice( int level, int parentIndex, int width, int height,
+                        std::vector<HbrVertex<T> *> const & parent,
+                        std::vector<HbrVertex<T> *> * child );
+
+    void markStructured( std::vector<HbrVertex<T> *> const & verts );
+
+    std::vector<std::vector<Lattice> > _lattices;   // grids per level
+
+    std::vector<std::vector<HbrVertex<T> *> > _faceVerts, // vertices computed by
+                                              _edgeVerts, // the grids at each
+                                              _vertVerts; // level
+
+    std::vector<char> _structured; // per Hbr vertex ID
+};
+
+template <class T, class U>
+FarStructuredGridsFactory<T,U>::FarStructuredGridsFactory( HbrMesh<T> const * mesh, int maxlevel ) :
+    _lattices(maxlevel+1),
+    _faceVerts(maxlevel+1),
+    _edgeVerts(maxlevel+1),
+    _vertVerts(maxlevel+1) {
+
+    assert(mesh);
+
+    if (maxlevel<1 or (not isEligible(mesh)))
+        return;
+
+    FarFactoryStats::Scope scope("FarStructuredGridsFactory");
+
+    int nfaces = mesh->GetNumCoarseFaces();
+
+    // faces already in a grid (1), or in the grid being grown (2)
+    std::vector<char> used(mesh->GetNumFaces(), 0);
+
+    std::vector<Face> faces;
+    for (int i=0; i<nfaces; ++i) {
+
+        Face origin = { mesh->GetFace(i), 0 };
+        if ((not isEligible(origin.face)) or used[origin.face->GetID()])
+            continue;
+
+        int width, height;
+        growRegion(origin, used, &width, &height, faces);
+        if (width<2 or height<2)
+            continue;
+
+        // coarse lattice
+        std::vector<HbrVertex<T> *> lattice((width+1)*(height+1));
+        for (int y=0; y<height; ++y) {
+            for (int x=0; x<width; ++x) {
+                Face const & f = faces[y*width+x];
+                used[f.face->GetID()] = 1;
+                lattice[y*(width+1)+x] = getVertex(f, 0);
+                if (x==width-1)
+                    lattice[y*(width+1)+x+1] = getVertex(f, 1);
+                if (y==height-1) {
+                    lattice[(y+1)*(width+1)+x] = getVertex(f, 3);
+                    if (x==width-1)
+                        lattice[(y+1)*(width+1)+x+1] = getVertex(f, 2);
+                }
+            }
+        }
+
+        int parent = -1;
+        for (int level=1; level<=maxlevel; ++level) {
+
+            std::vector<HbrVertex<T> *> child;
+            refineLattice(level, parent, width, height, lattice,
+                          level<maxlevel ? &child : 0);
+
+            parent = (int)_lattices[level].size()-1;
+            width *= 2;
+            height *= 2;
+            lattice.swap(child);
+        }
+    }
+
+    // gather the vertices of each level in grid order
+    for (int level=1; level<=maxlevel; ++level) {
+        for (int i=0; i<(int)_lattices[level].size(); ++i) {
+            Lattice const & l = _lattices[level][i];
+            _faceVerts[level].insert(_faceVerts[level].end(), l.faceVerts.begin(), l.faceVerts.end());
+            _edgeVerts[level].insert(_edgeVerts[level].end(), l.hEdgeVerts.begin(), l.hEdgeVerts.end());
+            _edgeVerts[level].insert(_edgeVerts[level].end(), l.vEdgeVerts.begin(), l.vEdgeVerts.end());
+            _vertVerts[level].insert(_vertVerts[level].end(), l.vertVerts.begin(), l.vertVerts.end());
+        }
+        markStructured(_faceVerts[level]);
+        markStructured(_edgeVerts[level]);
+        markStructured(_vertVerts[level]);
+    }
+}
+
+template <class T, class U> int
+FarStructuredGridsFactory<T,U>::sumList( std::vector<std::vector<HbrVertex<T> *> > const & list ) {
+    int result = 0;
+    for (int i=0; i<(int)list.size(); ++i)
+        result += (int)list[i].size();
+    return result;
+}
+
+// Edits that change the sharpness or the topology of the mesh below the
+// coarse level cannot be represented by the grids.
+template <class T, class U> bool
+FarStructuredGridsFactory<T,U>::isEligible( HbrMesh<T> const * mesh ) {
+
+    std::vector<HbrHierarchicalEdit<T>*> const & edits = mesh->GetHierarchicalEdits();
+    for (int i=0; i<(int)edits.size(); ++i) {
+        if (dynamic_cast<HbrCreaseEdit<T> *>(edits[i]) or
+            dynamic_cast<HbrCornerEdit<T> *>(edits[i]) or
+            dynamic_cast<HbrHoleEdit<T> *>(edits[i]))
+            return false;
+    }
+    return true;
+}
+
+template <class T, class U> bool
+FarStructuredGridsFactory<T,U>::isEligible( HbrFace<T> const * f ) {
+    return f and f->GetNumVertices()==4 and (not f->IsHole()) and f->GetDepth()==0;
+}
+
+template <class T, class U> bool
+FarStructuredGridsFactory<T,U>::isSmooth( HbrHalfedge<T> const * e ) {
+    return e and e->GetOpposite() and
+           e->GetSharpness()==HbrHalfedge<T>::k_Smooth and
+           e->GetOpposite()->GetSharpness()==HbrHalfedge<T>::k_Smooth;
+}
+
+template <class T, class U> bool
+FarStructuredGridsFactory<T,U>::isSmooth( HbrVertex<T> * v ) {
+    return v->GetValence()==4 and
+           v->GetMask(false)==HbrVertex<T>::k_Smooth and
+           v->GetMask(true)==HbrVertex<T>::k_Smooth;
+}
+
+template <class T, class U> typename FarStructuredGridsFactory<T,U>::Face
+FarStructuredGridsFactory<T,U>::getNeighbor( Face const & f, int edge ) {
+
+    Face result = { 0, 0 };
+
+    HbrHalfedge<T> * e = f.face->GetEdge( (f.rot+edge)%4 );
+    if (not isSmooth(e))
+        return result;
+
+    HbrHalfedge<T> * opposite = e->GetOpposite();
+    HbrFace<T> * g = opposite->GetFace();
+    if (not isEligible(g))
+        return result;
+
+    for (int k=0; k<4; ++k)
+        if (g->GetEdge(k)==opposite) {
+            // the shared edge is local edge 3 of the next face along u, and
+            // local edge 0 of the next face along v
+            result.face = g;
+            result.rot = (edge==1) ? (k+1)%4 : k;
+            break;
+        }
+    return result;
+}
+
+template <class T, class U> void
+FarStructuredGridsFactory<T,U>::growRegion( Face origin, std::vector<char> & used,
+    int * width, int * height, std::vector<Face> & faces ) {
+
+    faces.clear();
+
+    // first row : walk along u
+    for (Face f=origin; f.face and (not used[f.face->GetID()]); f=getNeighbor(f, 1)) {
+        used[f.face->GetID()] = 2;
+        faces.push_back(f);
+    }
+    *width = (int)faces.size();
+    *height = 1;
+
+    // next rows : walk along v as long as the rows form a regular lattice
+    while (*width>=2) {
+        int row = (int)faces.size();
+        bool valid = true;
+        for (int x=0; x<*width and valid; ++x) {
+
+            Face f = getNeighbor(faces[row-*width+x], 2);
+
+            valid = f.face and (not used[f.face->GetID()]);
+
+            if (valid and x>0) {
+                // the new face must also be the neighbor along u of the
+                // previous face of the row, around a regular interior vertex
+                Face left = getNeighbor(faces.back(), 1);
+                valid = left.face==f.face and left.rot==f.rot and
+                        isSmooth(getVertex(f, 0));
+            }
+
+            if (valid) {
+                used[f.face->GetID()] = 2;
+                faces.push_back(f);
+            }
+        }
+        if (not valid) {
+            for (int i=row; i<(int)faces.size(); ++i)
+                used[faces[i].face->GetID()] = 0;
+            faces.resize(row);
+            break;
+        }
+        ++(*height);
+    }
+
+    for (int i=0; i<(int)faces.size(); ++i)
+        used[faces[i].face->GetID()] = 0;
+}
+
+template <class T, class U> void
+FarStructuredGridsFactory<T,U>::refineLattice( int level, int parentIndex, int width, int height,
+    std::vector<HbrVertex<T> *> const & parent, std::vector<HbrVertex<T> *> * child ) {
+
+    _lattices[level].push_back(Lattice());
+    Lattice & l = _lattices[level].back();
+
+    l.width = width;
+    l.height = height;
+    l.parent = parentIndex;
+
+#define PARENT(x,y) parent[(y)*(width+1)+(x)]
+
+    if (parentIndex<0) {
+        l.parentVerts = parent;
+    } else {
+        // boundary ring : bottom and top rows, then left and right columns
+        l.parentVerts.reserve(2*(width+1)+2*(height-1));
+        for (int x=0; x<=width; ++x)
+            l.parentVerts.push_back(PARENT(x,0));
+        for (int x=0; x<=width; ++x)
+            l.parentVerts.push_back(PARENT(x,height));
+        for (int y=1; y<height; ++y)
+            l.parentVerts.push_back(PARENT(0,y));
+        for (int y=1; y<height; ++y)
+            l.parentVerts.push_back(PARENT(width,y));
+    }
+
+    l.faceVerts.resize(width*height);
+    l.hEdgeVerts.resize(width*(height-1));
+    l.vEdgeVerts.resize((width-1)*height);
+    l.vertVerts.resize((width-1)*(height-1));
+
+    if (child)
+        child->resize((2*width+1)*(2*height+1));
+
+#define CHILD(x,y) (*child)[(y)*(2*width+1)+(x)]
+
+    for (int y=0; y<=height; ++y) {
+        for (int x=0; x<=width; ++x) {
+
+            HbrVertex<T> * v = PARENT(x,y);
+
+            bool interiorX = x>0 and x<width,
+                 interiorY = y>0 and y<height;
+
+            HbrVertex<T> * vchild = v->Subdivide();
+            if (interiorX and interiorY)
+                l.vertVerts[(y-1)*(width-1)+(x-1)] = vchild;
+            if (child)
+                CHILD(2*x,2*y) = vchild;
+
+            // edge along u and face
+            if (x<width) {
+                HbrHalfedge<T> * e = getEdge(v, PARENT(x+1,y));
+                assert(e);
+                HbrVertex<T> * echild = e->Subdivide();
+                if (interiorY)
+                    l.hEdgeVerts[(y-1)*width+x] = echild;
+                if (child)
+                    CHILD(2*x+1,2*y) = echild;
+
+                if (y<height) {
+                    // the face of the lattice owns the halfedge along +u
+                    assert(e->GetOrgVertex()==v);
+                    HbrVertex<T> * fchild = e->GetFace()->Subdivide();
+                    l.faceVerts[y*width+x] = fchild;
+                    if (child)
+                        CHILD(2*x+1,2*y+1) = fchild;
+                }
+            }
+
+            // edge along v
+            if (y<height) {
+                HbrHalfedge<T> * e = getEdge(v, PARENT(x,y+1));
+                assert(e);
+                HbrVertex<T> * echild = e->Subdivide();
+                if (interiorX)
+                    l.vEdgeVerts[y*(width-1)+(x-1)] = echild;
+                if (child)
+                    CHILD(2*x,2*y+1) = echild;
+            }
+        }
+    }
+#undef CHILD
+#undef PARENT
+}
+
+template <class T, class U> void
+FarStructuredGridsFactory<T,U>::markStructured( std::vector<HbrVertex<T> *> const & verts ) {
+
+    for (int i=0; i<(int)verts.size(); ++i) {
+        int id = verts[i]->GetID();
+        if (id >= (int)_structured.size())
+            _structured.resize(id+1, 0);
+        assert(not _structured[id]);
+        _structured[id] = 1;
+    }
+}
+
+template <class T, class U> void
+FarStructuredGridsFactory<T,U>::Create( std::vector<int> const & remap, FarStructuredGrids * result ) const {
+
+    assert(result);
+
+    result->_grids.clear();
+    result->_indices.clear();
+
+    for (int level=1; level<(int)_lattices.size(); ++level) {
+
+        // index of the first grid of the parent level
+        int parentOffset = (int)result->_grids.size() - GetNumGrids(level-1);
+
+        for (int i=0; i<(int)_lattices[level].size(); ++i) {
+
+            Lattice const & l = _lattices[level][i];
+
+            FarStructuredGrids::Grid g;
+            g.width = l.width;
+            g.height = l.height;
+            g.faceOffset = remap[ l.faceVerts[0]->GetID() ];
+            g.hEdgeOffset = remap[ l.hEdgeVerts[0]->GetID() ];
+            g.vEdgeOffset = remap[ l.vEdgeVerts[0]->GetID() ];
+            g.vertOffset = remap[ l.vertVerts[0]->GetID() ];
+            g.parent = l.parent<0 ? -1 : parentOffset + l.parent;
+            g.indexOffset = (int)result->_indices.size();
+
+            for (int j=0; j<(int)l.parentVerts.size(); ++j)
+                result->_indices.push_back( remap[ l.parentVerts[j]->GetID() ] );
+
+            assert((int)l.parentVerts.size()==FarStructuredGrids::GetNumIndices(g));
+
+            result->_grids.push_back(g);
+        }
+    }
+}
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif /* FAR_STRUCTURED_GRIDS_FACTORY_H */
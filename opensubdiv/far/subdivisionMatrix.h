@@ -0,0 +1,537 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+//
+#ifndef FAR_SUBDIVISION_MATRIX_H
+#define FAR_SUBDIVISION_MATRIX_H
+
+#include "../version.h"
+
+#include "../far/memoryUsage.h"
+#include "../far/mesh.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+/// \brief The subdivision operator of a FarMesh as a sparse matrix.
+///
+/// Every refined vertex is a linear combination of the vertices of the coarse
+/// mesh : composing the kernel batches of a mesh yields a matrix with a row
+/// per vertex of the mesh (coarse vertices included) and a column per coarse
+/// vertex. Multiplying the matrix by the coarse vertices refines them, and
+/// multiplying its transpose by the gradients of a loss with respect to the
+/// refined vertices back-propagates them to the coarse mesh.
+///
+/// The matrix is stored in a compressed row format : the non-zero entries of
+/// row 'i' are the columns Indices[Offsets[i]] to Indices[Offsets[i+1]-1]
+/// with the matching entries of the weights table.
+///
+/// Note : only the vertex-interpolated data is described (varying data is
+/// interpolated with different weights) and the hierarchical edits are not
+/// linear, so they are ignored.
+///
+class FarSubdivisionMatrix {
+
+public:
+    /// \brief Constructor : composes the kernel batches of a mesh
+    ///
+    /// @param mesh  the mesh to extract the subdivision operator of
+    ///
+    template <class U> FarSubdivisionMatrix( FarMesh<U> const & mesh );
+
+    /// \brief Returns the number of rows (the number of vertices of the mesh)
+    int GetNumRows() const { return (int)_offsets.size()-1; }
+
+    /// \brief Returns the number of columns (the number of coarse vertices)
+    int GetNumColumns() const { return _numColumns; }
+
+    /// \brief Returns the number of non-zero entries
+    int GetNumNonZeros() const { return (int)_indices.size(); }
+
+    /// \brief Returns the offsets of the rows in the indices table
+    /// (GetNumRows()+1 entries)
+    std::vector<int> const & GetOffsets() const { return _offsets; }
+
+    /// \brief Returns the column indices of the non-zero entries
+    std::vector<int> const & GetIndices() const { return _indices; }
+
+    /// \brief Returns the weights of the non-zero entries
+    std::vector<float> const & GetWeights() const { return _weights; }
+
+    /// \brief Refines interleaved coarse vertex data
+    ///
+    /// @param coarse       GetNumColumns() vertices of numElements floats
+    ///
+    /// @param vertices     destination of the GetNumRows() refined vertices
+    ///
+    /// @param numElements  number of floats per vertex
+    ///
+    void Apply( float const * coarse, float * vertices, int numElements ) const;
+
+    /// \brief Back-propagates interleaved gradients to the coarse vertices
+    ///
+    /// @param gradients    GetNumRows() vertices of numElements floats
+    ///
+    /// @param coarse       destination of the GetNumColumns() coarse gradients
+    ///
+    /// @param numElements  number of floats per vertex
+    ///
+    void ApplyTranspose( float const * gradients, float * coarse, int numElements ) const;
+
+    /// \brief Itemized memory allocated by the matrix
+    FarMemoryUsage GetMemoryUsage() const {
+        FarMemoryUsage result;
+        result.AddVector("offsets", _offsets);
+        result.AddVector("indices", _indices);
+        result.AddVector("weights", _weights);
+        return result;
+    }
+
+private:
+
+    // Composes the rows of the matrix one vertex at a time : the row of a
+    // refined vertex is the weighted sum of the rows of its sources.
+    class Builder {
+    public:
+        // the rows of the coarse vertices are the identity
+        Builder( int nrows, int ncols );
+
+        // starts the row of 'dst' (accumulates onto its current row if
+        // 'accumulate' is true)
+        void Begin( int dst, bool accumulate );
+
+        void Add( int src, float weight );
+
+        void End();
+
+        void Finalize( FarSubdivisionMatrix * matrix );
+
+    private:
+        std::vector<std::vector<int> >   _rowIndices;
+        std::vector<std::vector<float> > _rowWeights;
+
+        std::vector<float> _values; // dense accumulator
+        std::vector<int>   _marks,  // row being composed when a column was last touched
+                           _columns;
+
+        int _dst;
+    };
+
+    template <class U> static void addVertexA( Builder & builder,
+        FarSubdivisionTables<U> const * tables, int i, int dst, bool pass );
+
+    static void addStructuredGrid( Builder & builder,
+        FarStructuredGrids const & grids, int grid );
+
+    int _numColumns;
+
+    std::vector<int>   _offsets,  // offsets of the rows in the indices table
+                       _indices;  // columns of the non-zero entries
+
+    std::vector<float> _weights;  // weights of the non-zero entries
+};
+
+template <class U>
+FarSubdivisionMatrix::FarSubdivisionMatrix( FarMesh<U> const & mesh ) {
+
+    FarSubdivisionTables<U> const * tables = mesh.GetSubdivisionTables();
+    assert(tables);
+
+    _numColumns = tables->GetNumVertices(0);
+
+    Builder builder(mesh.GetNumVertices(), _numColumns);
+
+    FarKernelBatchVector const & batches = mesh.GetKernelBatches();
+
+    for (int b=0; b<(int)batches.size(); ++b) {
+
+        FarKernelBatch const & batch = batches[b];
+
+        // the grid batches range over grids rather than vertices
+        if (batch.GetKernelType()==FarKernelBatch::CATMARK_STRUCTURED_GRID) {
+            for (int g=batch.GetStart(); g<batch.GetEnd(); ++g)
+                addStructuredGrid(builder, tables->GetStructuredGrids(), g);
+            continue;
+        }
+
+        int vertexOffset = batch.GetVertexOffset(),
+            tableOffset = batch.GetTableOffset();
+
+        for (int i=batch.GetStart()+tableOffset; i<batch.GetEnd()+tableOffset; ++i) {
+
+            int dst = i + vertexOffset - tableOffset;
+
+            switch (batch.GetKernelType()) {
+
+                case FarKernelBatch::CATMARK_FACE_VERTEX:
+                case FarKernelBatch::BILINEAR_FACE_VERTEX: {
+                    int h = tables->Get_F_ITa()[2*i],
+                        n = tables->Get_F_ITa()[2*i+1];
+                    builder.Begin(dst, false);
+                    for (int j=0; j<n; ++j)
+                        builder.Add(tables->Get_F_IT()[h+j], 1.0f/n);
+                    builder.End();
+                } break;
+
+                case FarKernelBatch::CATMARK_EDGE_VERTEX:
+                case FarKernelBatch::LOOP_EDGE_VERTEX: {
+                    int const * e = &tables->Get_E_IT()[4*i];
+                    float const * w = &tables->Get_E_W()[2*i];
+                    builder.Begin(dst, false);
+                    builder.Add(e[0], w[0]);
+                    builder.Add(e[1], w[0]);
+                    if (e[2]!=-1) {
+                        builder.Add(e[2], w[1]);
+                        builder.Add(e[3], w[1]);
+                    }
+                    builder.End();
+                } break;
+
+                case FarKernelBatch::BILINEAR_EDGE_VERTEX: {
+                    int const * e = &tables->Get_E_IT()[2*i];
+                    builder.Begin(dst, false);
+                    builder.Add(e[0], 0.5f);
+                    builder.Add(e[1], 0.5f);
+                    builder.End();
+                } break;
+
+                case FarKernelBatch::BILINEAR_VERT_VERTEX: {
+                    builder.Begin(dst, false);
+                    builder.Add(tables->Get_V_ITa()[i], 1.0f);
+                    builder.End();
+                } break;
+
+                case FarKernelBatch::CATMARK_VERT_VERTEX_B: {
+                    int h = tables->Get_V_ITa()[5*i  ],
+                        n = tables->Get_V_ITa()[5*i+1],
+                        p = tables->Get_V_ITa()[5*i+2];
+
+                    float weight = tables->Get_V_W()[i],
+                              wp = 1.0f/(n*n),
+                              wv = (n-2.0f)*n*wp;
+
+                    builder.Begin(dst, false);
+                    builder.Add(p, weight * wv);
+                    for (int j=0; j<n; ++j) {
+                        builder.Add(tables->Get_V_IT()[h+j*2  ], weight * wp);
+                        builder.Add(tables->Get_V_IT()[h+j*2+1], weight * wp);
+                    }
+                    builder.End();
+                } break;
+
+                case FarKernelBatch::LOOP_VERT_VERTEX_B: {
+                    int h = tables->Get_V_ITa()[5*i  ],
+                        n = tables->Get_V_ITa()[5*i+1],
+                        p = tables->Get_V_ITa()[5*i+2];
+
+                    float weight = tables->Get_V_W()[i],
+                              wp = 1.0f/n,
+                            beta = 0.25f * cosf((float)M_PI * 2.0f * wp) + 0.375f;
+                    beta = beta*beta;
+                    beta = (0.625f-beta)*wp;
+
+                    builder.Begin(dst, false);
+                    builder.Add(p, weight * (1.0f-(beta*n)));
+                    for (int j=0; j<n; ++j)
+                        builder.Add(tables->Get_V_IT()[h+j], weight * beta);
+                    builder.End();
+                } break;
+
+                case FarKernelBatch::CATMARK_VERT_VERTEX_A1:
+                case FarKernelBatch::LOOP_VERT_VERTEX_A1:
+                    addVertexA(builder, tables, i, dst, false);
+                    break;
+
+                case FarKernelBatch::CATMARK_VERT_VERTEX_A2:
+                case FarKernelBatch::LOOP_VERT_VERTEX_A2:
+                    addVertexA(builder, tables, i, dst, true);
+                    break;
+
+                case FarKernelBatch::END_CAP: {
+                    FarEndCapTables const * endcaps = mesh.GetEndCapTables();
+                    assert(endcaps);
+                    builder.Begin(dst, false);
+                    for (int j=endcaps->GetOffsets()[i]; j<endcaps->GetOffsets()[i+1]; ++j)
+                        builder.Add(endcaps->GetIndices()[j], endcaps->GetWeights()[j]);
+                    builder.End();
+                } break;
+
+                case FarKernelBatch::CATMARK_STRUCTURED_GRID:
+                case FarKernelBatch::HIERARCHICAL_EDIT:
+                    break;
+            }
+        }
+    }
+
+    builder.Finalize(this);
+}
+
+template <class U> void
+FarSubdivisionMatrix::addVertexA( Builder & builder,
+    FarSubdivisionTables<U> const * tables, int i, int dst, bool pass ) {
+
+    int     n=tables->Get_V_ITa()[5*i+1],
+            p=tables->Get_V_ITa()[5*i+2],
+        eidx0=tables->Get_V_ITa()[5*i+3],
+        eidx1=tables->Get_V_ITa()[5*i+4];
+
+    float weight = pass ? tables->Get_V_W()[i] : 1.0f - tables->Get_V_W()[i];
+
+    // same weight inversion as the k_Crease / k_Corner kernels
+    if (weight>0.0f and weight<1.0f and n>0)
+        weight=1.0f-weight;
+
+    // the second pass accumulates onto the result of the first one
+    builder.Begin(dst, pass);
+    if (eidx0==-1 or (pass==false and (n==-1)) ) {
+        builder.Add(p, weight);
+    } else {
+        builder.Add(p, weight * 0.75f);
+        builder.Add(eidx0, weight * 0.125f);
+        builder.Add(eidx1, weight * 0.125f);
+    }
+    builder.End();
+}
+
+// The grids only cover smooth regular regions (see FarStructuredGrids)
+inline void
+FarSubdivisionMatrix::addStructuredGrid( Builder & builder,
+    FarStructuredGrids const & grids, int grid ) {
+
+    FarStructuredGrids::Grid const & g = grids.GetGrid(grid);
+
+    int w = g.width, h = g.height;
+
+    std::vector<int> lattice((w+1)*(h+1));
+    for (int y=0; y<=h; ++y)
+        FarStructuredGrids::GetParentRow(&grids.GetGrids()[0],
+            grids.GetIndices().empty() ? 0 : &grids.GetIndices()[0], grid, y, &lattice[y*(w+1)]);
+
+    int const * P = &lattice[0];
+
+    // face-vertices
+    for (int y=0; y<h; ++y) {
+        int const * r0 = P + y*(w+1), * r1 = r0 + (w+1);
+        for (int x=0; x<w; ++x) {
+            builder.Begin(g.faceOffset + y*w + x, false);
+            builder.Add(r0[x], 0.25f);
+            builder.Add(r0[x+1], 0.25f);
+            builder.Add(r1[x+1], 0.25f);
+            builder.Add(r1[x], 0.25f);
+            builder.End();
+        }
+    }
+
+    // edge-vertices along u
+    for (int y=1; y<h; ++y) {
+        int const * r = P + y*(w+1);
+        int f0 = g.faceOffset + (y-1)*w, f1 = f0 + w;
+        for (int x=0; x<w; ++x) {
+            builder.Begin(g.hEdgeOffset + (y-1)*w + x, false);
+            builder.Add(r[x], 0.25f);
+            builder.Add(r[x+1], 0.25f);
+            builder.Add(f0 + x, 0.25f);
+            builder.Add(f1 + x, 0.25f);
+            builder.End();
+        }
+    }
+
+    // edge-vertices along v
+    for (int y=0; y<h; ++y) {
+        int const * r0 = P + y*(w+1), * r1 = r0 + (w+1);
+        int f = g.faceOffset + y*w;
+        for (int x=1; x<w; ++x) {
+            builder.Begin(g.vEdgeOffset + y*(w-1) + x-1, false);
+            builder.Add(r0[x], 0.25f);
+            builder.Add(r1[x], 0.25f);
+            builder.Add(f + x-1, 0.25f);
+            builder.Add(f + x, 0.25f);
+            builder.End();
+        }
+    }
+
+    // vertex-vertices (valence 4 smooth rule)
+    for (int y=1; y<h; ++y) {
+        int const * r0 = P + (y-1)*(w+1), * r1 = r0 + (w+1), * r2 = r1 + (w+1);
+        int f0 = g.faceOffset + (y-1)*w, f1 = f0 + w;
+        for (int x=1; x<w; ++x) {
+            builder.Begin(g.vertOffset + (y-1)*(w-1) + x-1, false);
+            builder.Add(r1[x], 0.5f);
+            builder.Add(r1[x+1], 0.0625f);
+            builder.Add(r2[x], 0.0625f);
+            builder.Add(r1[x-1], 0.0625f);
+            builder.Add(r0[x], 0.0625f);
+            builder.Add(f1 + x, 0.0625f);
+            builder.Add(f1 + x-1, 0.0625f);
+            builder.Add(f0 + x-1, 0.0625f);
+            builder.Add(f0 + x, 0.0625f);
+            builder.End();
+        }
+    }
+}
+
+inline void
+FarSubdivisionMatrix::Apply( float const * coarse, float * vertices, int numElements ) const {
+
+    assert(coarse and vertices);
+
+    for (int i=0; i<GetNumRows(); ++i) {
+
+        float * dst = vertices + i*numElements;
+
+        for (int k=0; k<numElements; ++k)
+            dst[k] = 0.0f;
+
+        for (int j=_offsets[i]; j<_offsets[i+1]; ++j) {
+            float const * src = coarse + _indices[j]*numElements;
+            for (int k=0; k<numElements; ++k)
+                dst[k] += _weights[j] * src[k];
+        }
+    }
+}
+
+inline void
+FarSubdivisionMatrix::ApplyTranspose( float const * gradients, float * coarse, int numElements ) const {
+
+    assert(gradients and coarse);
+
+    for (int i=0; i<_numColumns*numElements; ++i)
+        coarse[i] = 0.0f;
+
+    for (int i=0; i<GetNumRows(); ++i) {
+
+        float const * src = gradients + i*numElements;
+
+        for (int j=_offsets[i]; j<_offsets[i+1]; ++j) {
+            float * dst = coarse + _indices[j]*numElements;
+            for (int k=0; k<numElements; ++k)
+                dst[k] += _weights[j] * src[k];
+        }
+    }
+}
+
+inline
+FarSubdivisionMatrix::Builder::Builder( int nrows, int ncols ) :
+    _rowIndices(nrows), _rowWeights(nrows), _values(ncols, 0.0f), _marks(ncols, -1), _dst(-1) {
+
+    for (int i=0; i<ncols; ++i) {
+        _rowIndices[i].push_back(i);
+        _rowWeights[i].push_back(1.0f);
+    }
+}
+
+inline void
+FarSubdivisionMatrix::Builder::Begin( int dst, bool accumulate ) {
+
+    assert(_dst==-1 and dst<(int)_rowIndices.size());
+
+    _dst = dst;
+
+    if (accumulate) {
+        for (int j=0; j<(int)_rowIndices[dst].size(); ++j) {
+            int col = _rowIndices[dst][j];
+            _marks[col] = dst;
+            _values[col] = _rowWeights[dst][j];
+            _columns.push_back(col);
+        }
+    }
+}
+
+inline void
+FarSubdivisionMatrix::Builder::Add( int src, float weight ) {
+
+    assert(_dst>=0 and src!=_dst);
+
+    if (weight==0.0f)
+        return;
+
+    std::vector<int> const & indices = _rowIndices[src];
+    std::vector<float> const & weights = _rowWeights[src];
+
+    for (int j=0; j<(int)indices.size(); ++j) {
+        int col = indices[j];
+        if (_marks[col]!=_dst) {
+            _marks[col] = _dst;
+            _values[col] = 0.0f;
+            _columns.push_back(col);
+        }
+        _values[col] += weight * weights[j];
+    }
+}
+
+inline void
+FarSubdivisionMatrix::Builder::End() {
+
+    assert(_dst>=0);
+
+    std::vector<int> & indices = _rowIndices[_dst];
+    std::vector<float> & weights = _rowWeights[_dst];
+
+    std::sort(_columns.begin(), _columns.end());
+
+    indices = _columns;
+    weights.resize(_columns.size());
+    for (int j=0; j<(int)_columns.size(); ++j) {
+        weights[j] = _values[_columns[j]];
+        // a vertex can be recomputed by several batches
+        _marks[_columns[j]] = -1;
+    }
+
+    _columns.clear();
+    _dst = -1;
+}
+
+inline void
+FarSubdivisionMatrix::Builder::Finalize( FarSubdivisionMatrix * matrix ) {
+
+    int nrows = (int)_rowIndices.size(), nnz = 0;
+    for (int i=0; i<nrows; ++i)
+        nnz += (int)_rowIndices[i].size();
+
+    matrix->_offsets.resize(nrows+1);
+    matrix->_indices.reserve(nnz);
+    matrix->_weights.reserve(nnz);
+
+    matrix->_offsets[0] = 0;
+    for (int i=0; i<nrows; ++i) {
+        matrix->_indices.insert(matrix->_indices.end(), _rowIndices[i].begin(), _rowIndices[i].end());
+        matrix->_weights.insert(matrix->_weights.end(), _rowWeights[i].begin(), _rowWeights[i].end());
+        matrix->_offsets[i+1] = (int)matrix->_indices.size();
+
+        // release the rows as they are copied
+        std::vector<int>().swap(_rowIndices[i]);
+        std::vector<float>().swap(_rowWeights[i]);
+    }
+}
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif /* FAR_SUBDIVISION_MATRIX_H */
@@ -28,6 +28,9 @@
 
 #include "../version.h"
 
+#include "../far/memoryUsage.h"
+#include "../far/structuredGrids.h"
+
 #include <cassert>
 #include <utility>
 #include <vector>
@@ -89,6 +92,9 @@ public:
     /// \brief Memory required to store the indexing tables
     int GetMemoryUsed() const;
 
+    /// \brief Itemized memory allocated by each of the indexing tables
+    FarMemoryUsage GetMemoryUsage() const;
+
     /// \brief Pointer back to the mesh owning the table
     FarMesh<U> * GetMesh() { return _mesh; }
 
@@ -129,6 +135,10 @@ public:
     /// \brief Returns the vertex vertices weights table
     std::vector<float> const &        Get_V_W() const { return _V_W; }
 
+    /// \brief Returns the structured grids refining the regular regions of
+    /// the mesh (Catmark only : empty unless requested from the FarMeshFactory)
+    FarStructuredGrids const &        GetStructuredGrids() const { return _structuredGrids; }
+
     /// \brief Returns the number of indexing tables needed to represent this particular
     /// subdivision scheme.
     virtual int GetNumTables() const { return 5; }
@@ -152,6 +162,8 @@ protected:
     std::vector<unsigned int> _V_IT;  // indices of adjacent vertices
     std::vector<float>        _V_W;   // weights
 
+    FarStructuredGrids        _structuredGrids; // table-free regular regions
+
     std::vector<int> _vertsOffsets; // offset to the first vertex of each level
 };
 
@@ -200,7 +212,23 @@ FarSubdivisionTables<U>::GetMemoryUsed() const {
                  _E_W.size() * sizeof(float) +
                  _V_ITa.size() * sizeof(int) +
                  _V_IT.size() * sizeof(unsigned int) +
-                 _V_W.size() * sizeof(float));
+                 _V_W.size() * sizeof(float) +
+                 _structuredGrids.GetMemoryUsage().GetTotal());
+}
+
+template <class U> FarMemoryUsage
+FarSubdivisionTables<U>::GetMemoryUsage() const {
+    FarMemoryUsage result;
+    result.AddVector("F_ITa", _F_ITa);
+    result.AddVector("F_IT", _F_IT);
+    result.AddVector("E_IT", _E_IT);
+    result.AddVector("E_W", _E_W);
+    result.AddVector("V_ITa", _V_ITa);
+    result.AddVector("V_IT", _V_IT);
+    result.AddVector("V_W", _V_W);
+    result.AddVector("vertsOffsets", _vertsOffsets);
+    result.Append("structuredGrids", _structuredGrids.GetMemoryUsage());
+    return result;
 }
 
 } // end namespace OPENSUBDIV_VERSION
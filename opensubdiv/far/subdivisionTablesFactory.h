@@ -29,6 +29,8 @@
 #include "../version.h"
 
 #include "../far/meshFactory.h"
+#include "../far/factoryStats.h"
+#include "../far/structuredGridsFactory.h"
 #include "../far/subdivisionTables.h"
 
 #include <cassert>
@@ -59,7 +61,11 @@ protected:
     // specialized subdivision scheme factories (Bilinear / Catmark / Loop).
     // It also populates the FarMeshFactory vertex remapping vector that ties the
     // Hbr vertex indices to the FarVertexEdit tables.
-    FarSubdivisionTablesFactory( HbrMesh<T> const * mesh, int maxlevel, std::vector<int> & remapTable );
+    // The vertices computed by structured grids (optional) are placed first in
+    // their respective lists, in grid order, and are not counted in the valence
+    // summations.
+    FarSubdivisionTablesFactory( HbrMesh<T> const * mesh, int maxlevel, std::vector<int> & remapTable,
+                                 FarStructuredGridsFactory<T,U> const * grids=0 );
 
     // Returns the number of coarse vertices found in the mesh
     int GetNumCoarseVertices() const { 
@@ -115,12 +121,19 @@ private:
     static int sumVertVertexValence(HbrVertex<T> * vertex);
 
     // Compares vertices based on their topological configuration 
-    // (see subdivisionTables::GetMaskRanking for more details)
+    // (see subdivisionTables::GetMaskRanking for more details) and valence
     static bool compareVertices( HbrVertex<T> const *x, HbrVertex<T> const *y );
+
+    // Compares face vertices based on the number of vertices of their parent face
+    static bool compareFaceVertices( HbrVertex<T> const *x, HbrVertex<T> const *y );
+
+    // Returns the group of ranks sharing the same sequence of compute kernels
+    static int getRankGroup( int rank );
 };
 
 template <class T, class U> 
-FarSubdivisionTablesFactory<T,U>::FarSubdivisionTablesFactory( HbrMesh<T> const * mesh, int maxlevel, std::vector<int> & remapTable ) :
+FarSubdivisionTablesFactory<T,U>::FarSubdivisionTablesFactory( HbrMesh<T> const * mesh, int maxlevel, std::vector<int> & remapTable,
+                                                               FarStructuredGridsFactory<T,U> const * grids ) :
     _faceVertIdx(maxlevel+1,0),
     _edgeVertIdx(maxlevel+1,0),
     _vertVertIdx(maxlevel+1,0),
@@ -131,6 +144,8 @@ FarSubdivisionTablesFactory<T,U>::FarSubdivisionTablesFactory( HbrMesh<T> const
     _vertVertsList(maxlevel+1)
  {
     assert( mesh );
+
+    FarFactoryStats::Scope scope("FarSubdivisionTablesFactory::remap");
     
     int numVertices = mesh->GetNumVertices();
  
@@ -157,14 +172,18 @@ FarSubdivisionTablesFactory<T,U>::FarSubdivisionTablesFactory( HbrMesh<T> const
         if (v->GetID()>maxvertid)
             maxvertid = v->GetID();
 
+        bool structured = grids and grids->IsStructured(v);
+
         if (v->GetParentFace()) {
             faceCounts[depth]++;
-            _faceVertsValenceSum += v->GetParentFace()->GetNumVertices();
+            if (not structured)
+                _faceVertsValenceSum += v->GetParentFace()->GetNumVertices();
         } else if (v->GetParentEdge())
             edgeCounts[depth]++;
         else if (v->GetParentVertex()) {
             vertCounts[depth]++;
-            _vertVertsValenceSum+=sumVertVertexValence(v);
+            if (not structured)
+                _vertVertsValenceSum+=sumVertVertexValence(v);
         }
     }
 
@@ -180,9 +199,12 @@ FarSubdivisionTablesFactory<T,U>::FarSubdivisionTablesFactory( HbrMesh<T> const
         _vertVertsList[l].reserve( vertCounts[l] );
     }
 
-    // reset counters
+    // reset counters (the edge vertices of the structured grids come first)
     faceCounts.assign(maxlevel+1,0);
     edgeCounts.assign(maxlevel+1,0);
+    if (grids)
+        for (int l=1; l<(maxlevel+1); ++l)
+            edgeCounts[l] = (int)grids->GetEdgeVertices(l).size();
 
     remapTable.resize( maxvertid+1, -1);
 
@@ -200,11 +222,15 @@ FarSubdivisionTablesFactory<T,U>::FarSubdivisionTablesFactory( HbrMesh<T> const
 
         assert( remapTable[ v->GetID() ] == -1 );
 
-        if (depth==0) {
+        if (grids and grids->IsStructured(v)) {
+            // structured vertices are inserted in grid order below
+            continue;
+        } else if (depth==0) {
             _vertVertsList[ depth ].push_back( v );
             remapTable[ v->GetID() ] = v->GetID();
         } else if (v->GetParentFace()) {
-            remapTable[ v->GetID() ]=_faceVertIdx[depth]+faceCounts[depth]++;
+            // face vertices are sorted by valence : the remapping step is
+            // done just after this
             _faceVertsList[ depth ].push_back( v );
         } else if (v->GetParentEdge()) {
             remapTable[ v->GetID() ]=_edgeVertIdx[depth]+edgeCounts[depth]++;
@@ -222,13 +248,35 @@ FarSubdivisionTablesFactory<T,U>::FarSubdivisionTablesFactory( HbrMesh<T> const
     for (size_t i=1; i<_vertVertsList.size(); ++i)
         std::sort( _vertVertsList[i].begin(), _vertVertsList[i].end(), compareVertices );
 
+    // Group the face vertices by the number of vertices of their parent face,
+    // so that each group can be processed by a kernel specialized for that
+    // valence (the Hbr order is otherwise preserved)
+    for (size_t i=1; i<_faceVertsList.size(); ++i)
+        std::stable_sort( _faceVertsList[i].begin(), _faceVertsList[i].end(), compareFaceVertices );
+
+    // The vertices computed by the structured grids come first
+    if (grids) {
+        for (int l=1; l<(maxlevel+1); ++l) {
+            std::vector<HbrVertex<T> *> const & faceVerts = grids->GetFaceVertices(l),
+                                              & edgeVerts = grids->GetEdgeVertices(l),
+                                              & vertVerts = grids->GetVertexVertices(l);
+
+            _faceVertsList[l].insert(_faceVertsList[l].begin(), faceVerts.begin(), faceVerts.end());
+            _edgeVertsList[l].insert(_edgeVertsList[l].begin(), edgeVerts.begin(), edgeVerts.end());
+            _vertVertsList[l].insert(_vertVertsList[l].begin(), vertVerts.begin(), vertVerts.end());
+
+            for (size_t i=0; i<edgeVerts.size(); ++i)
+                remapTable[ edgeVerts[i]->GetID() ]=_edgeVertIdx[l]+(int)i;
+        }
+    }
 
     // These vertices still need a remapped index
-    for (int l=1; l<(maxlevel+1); ++l)
+    for (int l=1; l<(maxlevel+1); ++l) {
+        for (size_t i=0; i<_faceVertsList[l].size(); ++i)
+            remapTable[ _faceVertsList[l][i]->GetID() ]=_faceVertIdx[l]+(int)i;
         for (size_t i=0; i<_vertVertsList[l].size(); ++i)
             remapTable[ _vertVertsList[l][i]->GetID() ]=_vertVertIdx[l]+(int)i;
-
-
+    }
 }
 
 
@@ -321,6 +369,10 @@ FarSubdivisionTablesFactory<T,U>::sumVertVertexValence(HbrVertex<T> * vertex) {
 //  - B handles the K_Smooth and K_Dart rules
 // The vertices should be sorted so as to minimize the number execution calls of
 // these kernels to match the 2 pass interpolation scheme used in Hbr.
+//
+// Ranks that are applied the same sequence of kernels are grouped together and
+// sorted by valence within each group : this keeps the ranges of kernels A and
+// B contiguous, while B can be split into valence-homogeneous batches.
 template <class T, class U> bool
 FarSubdivisionTablesFactory<T,U>::compareVertices( HbrVertex<T> const * x, HbrVertex<T> const * y ) {
 
@@ -328,11 +380,36 @@ FarSubdivisionTablesFactory<T,U>::compareVertices( HbrVertex<T> const * x, HbrVe
     HbrVertex<T> * px=x->GetParentVertex(),
                  * py=y->GetParentVertex();
 
-    assert( (GetMaskRanking(px->GetMask(false), px->GetMask(true) )!=0xFF) and
-            (GetMaskRanking(py->GetMask(false), py->GetMask(true) )!=0xFF) );
+    int rx = GetMaskRanking(px->GetMask(false), px->GetMask(true) ),
+        ry = GetMaskRanking(py->GetMask(false), py->GetMask(true) );
+
+    assert( (rx!=0xFF) and (ry!=0xFF) );
+
+    int gx = getRankGroup(rx),
+        gy = getRankGroup(ry);
+
+    if (gx!=gy)
+        return gx < gy;
+
+    return px->GetValence() < py->GetValence();
+}
+
+// Groups of ranks (see GetMaskRanking) : 
+//   0 : B only (ranks 0-2)
+//   1 : B then A pass 2 (ranks 3-6)
+//   2 : A pass 1 then A pass 2 (rank 7)
+//   3 : A pass 1 only (ranks 8-9)
+template <class T, class U> int
+FarSubdivisionTablesFactory<T,U>::getRankGroup( int rank ) {
+    static short groups[10] = { 0, 0, 0, 1, 1, 1, 1, 2, 3, 3 };
+    return groups[rank];
+}
+
+template <class T, class U> bool
+FarSubdivisionTablesFactory<T,U>::compareFaceVertices( HbrVertex<T> const * x, HbrVertex<T> const * y ) {
 
-    return GetMaskRanking(px->GetMask(false), px->GetMask(true) ) <
-           GetMaskRanking(py->GetMask(false), py->GetMask(true) );
+    return x->GetParentFace()->GetNumVertices() <
+           y->GetParentFace()->GetNumVertices();
 }
 
 
@@ -0,0 +1,481 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+//
+#ifndef FAR_TOPOLOGY_HASH_H
+#define FAR_TOPOLOGY_HASH_H
+
+#include "../version.h"
+
+#include "../hbr/mesh.h"
+#include "../hbr/bilinear.h"
+#include "../hbr/catmark.h"
+#include "../hbr/loop.h"
+#include "../hbr/cornerEdit.h"
+#include "../hbr/creaseEdit.h"
+#include "../hbr/faceEdit.h"
+#include "../hbr/fvarEdit.h"
+#include "../hbr/holeEdit.h"
+#include "../hbr/vertexEdit.h"
+
+#include <algorithm>
+#include <cassert>
+#include <stdint.h>
+#include <typeinfo>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+/// \brief A stable 64 bits hash of the topology of a coarse HbrMesh.
+///
+/// The hash covers everything FarMeshFactory reads from a coarse mesh
+/// besides the vertex data : the subdivision scheme, the face-vertex lists,
+/// holes, edge and vertex sharpness, the boundary interpolation rules, the
+/// face-varying layout and the hierarchical edits. Build options can be
+/// appended with the Add methods, so that the hash identifies a FarMesh.
+///
+/// A mesh appends the same values whether it is given as an HbrMesh or as
+/// the flat arrays of HbrMesh::NewFaces : the creases are appended as sorted
+/// pairs of vertex IDs and the sharpness is the one the mesh holds once
+/// finished (including the boundary edges and corners sharpened by the
+/// boundary interpolation rules), so that equivalent inputs hash alike.
+///
+/// The hash only depends on the IDs and values of the mesh (not on memory
+/// addresses or on the platform), so it can be used as a persistent key.
+/// It is a 64 bits FNV-1a hash : distinct topologies collide with a
+/// negligible but non-zero probability.
+///
+/// Note : the hash must be computed before the mesh is refined. The
+/// non-manifold vertices split by HbrMesh::Finish get new IDs, so the hash
+/// of a non-manifold HbrMesh differs from the one of its flat arrays.
+///
+class FarTopologyHash {
+
+public:
+    typedef uint64_t Value;
+
+    /// \brief Constructor
+    FarTopologyHash() : _value(0xcbf29ce484222325ULL) { }
+
+    /// \brief Returns the current value of the hash
+    Value GetValue() const { return _value; }
+
+    /// \brief Appends an integer
+    void Add( int value ) {
+        addBytes(&value, sizeof(int));
+    }
+
+    /// \brief Appends a float
+    void Add( float value ) {
+        addBytes(&value, sizeof(float));
+    }
+
+    /// \brief Appends the topology of a coarse mesh
+    ///
+    /// @param mesh          the unrefined mesh
+    ///
+    /// @param fvarData      also appends the face-varying values (when the
+    ///                      FarMesh is created with face-varying data)
+    ///
+    template <class T> void AddMesh( HbrMesh<T> * mesh, bool fvarData=false );
+
+    /// \brief Appends the topology of a coarse mesh given as the flat arrays
+    /// of HbrMesh::NewFaces. The value matches the hash of the HbrMesh built
+    /// from the same arrays (without face-varying data nor hierarchical
+    /// edits).
+    ///
+    /// @param subdivision          the subdivision rules of the mesh
+    ///
+    /// @param interpolateBoundary  the boundary interpolation rule
+    ///
+    /// @param nvertices            the number of vertices of the mesh
+    ///
+    /// @param nfaces               the number of faces
+    ///
+    /// @param nverts               the number of vertices of each face
+    ///
+    /// @param vtx                  the vertex IDs of the faces
+    ///
+    /// @param nholes               the number of hole faces
+    ///
+    /// @param holes                the IDs of the hole faces
+    ///
+    /// @param ncreases             the number of crease edges
+    ///
+    /// @param creases              the pairs of vertex IDs of the crease edges
+    ///
+    /// @param creasesharpness      the sharpness of the crease edges
+    ///
+    /// @param ncorners             the number of corner vertices
+    ///
+    /// @param corners              the vertex IDs of the corners
+    ///
+    /// @param cornersharpness      the sharpness of the corners
+    ///
+    template <class T> void AddFaces( HbrSubdivision<T> * subdivision,
+        typename HbrMesh<T>::InterpolateBoundaryMethod interpolateBoundary,
+        int nvertices, int nfaces, int const * nverts, int const * vtx,
+        int nholes=0, int const * holes=0,
+        int ncreases=0, int const * creases=0, float const * creasesharpness=0,
+        int ncorners=0, int const * corners=0, float const * cornersharpness=0 );
+
+private:
+
+    // hashes the bytes in little-endian order, so that the values match
+    // across platforms
+    void addBytes( void const * data, int size ) {
+        unsigned char const * bytes = static_cast<unsigned char const *>(data);
+        for (int i=0; i<size; ++i) {
+#if defined(__BIG_ENDIAN__) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__==__ORDER_BIG_ENDIAN__)
+            _value ^= bytes[size-1-i];
+#else
+            _value ^= bytes[i];
+#endif
+            _value *= 0x100000001b3ULL;
+        }
+    }
+
+    // a crease edge : the IDs of its vertices (v0<v1) and its sharpness
+    struct Crease {
+        int   v0, v1;
+        float sharpness;
+
+        bool operator < (Crease const & other) const {
+            return v0<other.v0 or (v0==other.v0 and v1<other.v1);
+        }
+    };
+
+    // the sections shared by AddMesh and AddFaces, in this order
+    template <class T> void addScheme( HbrSubdivision<T> * subdivision, int interpolateBoundary );
+
+    void addFaceVertices( int nvertices, int nfaces, int const * nverts, int const * vtx );
+
+    void addHoles( std::vector<int> const & holes );
+
+    void addSharpness( std::vector<Crease> const & creases,
+                       std::vector<float> const & vertexSharpness );
+
+    template <class T> void addEdit( HbrHierarchicalEdit<T> const * edit );
+
+    Value _value;
+};
+
+template <class T> void
+FarTopologyHash::addScheme( HbrSubdivision<T> * subdivision, int interpolateBoundary ) {
+
+    assert(subdivision);
+
+    int scheme = 0;
+    if (typeid(*subdivision)==typeid(HbrCatmarkSubdivision<T>))
+        scheme = 1;
+    else if (typeid(*subdivision)==typeid(HbrLoopSubdivision<T>))
+        scheme = 2;
+    Add(scheme);
+    Add((int)subdivision->GetCreaseSubdivisionMethod());
+
+    Add(interpolateBoundary);
+}
+
+inline void
+FarTopologyHash::addFaceVertices( int nvertices, int nfaces, int const * nverts, int const * vtx ) {
+
+    Add(nvertices);
+
+    Add(nfaces);
+    for (int i=0, ofs=0; i<nfaces; ofs+=nverts[i++]) {
+        Add(nverts[i]);
+        for (int j=0; j<nverts[i]; ++j)
+            Add(vtx[ofs+j]);
+    }
+}
+
+inline void
+FarTopologyHash::addHoles( std::vector<int> const & holes ) {
+
+    Add((int)holes.size());
+    for (int i=0; i<(int)holes.size(); ++i)
+        Add(holes[i]);
+}
+
+inline void
+FarTopologyHash::addSharpness( std::vector<Crease> const & creases,
+                               std::vector<float> const & vertexSharpness ) {
+
+    Add((int)creases.size());
+    for (int i=0; i<(int)creases.size(); ++i) {
+        Add(creases[i].v0);
+        Add(creases[i].v1);
+        Add(creases[i].sharpness);
+    }
+
+    int ncorners = 0;
+    for (int i=0; i<(int)vertexSharpness.size(); ++i)
+        if (vertexSharpness[i]>0.0f)
+            ++ncorners;
+    Add(ncorners);
+    for (int i=0; i<(int)vertexSharpness.size(); ++i) {
+        if (vertexSharpness[i]>0.0f) {
+            Add(i);
+            Add(vertexSharpness[i]);
+        }
+    }
+}
+
+template <class T> void
+FarTopologyHash::AddMesh( HbrMesh<T> * mesh, bool fvarData ) {
+
+    assert(mesh);
+
+    addScheme(mesh->GetSubdivision(), (int)mesh->GetInterpolateBoundaryMethod());
+
+    int nvertices = mesh->GetNumVertices(),
+        nfaces = mesh->GetNumCoarseFaces();
+
+    std::vector<int> nverts(nfaces), vtx, holes;
+    std::vector<Crease> creases;
+    for (int i=0; i<nfaces; ++i) {
+
+        HbrFace<T> * f = mesh->GetFace(i);
+        assert(f);
+
+        nverts[i] = f->GetNumVertices();
+        if (f->IsHole())
+            holes.push_back(i);
+
+        for (int j=0; j<nverts[i]; ++j) {
+            vtx.push_back(f->GetVertex(j)->GetID());
+
+            HbrHalfedge<T> * e = f->GetEdge(j);
+            if (e->GetSharpness()>0.0f) {
+                int org = e->GetOrgVertex()->GetID(),
+                    dst = e->GetDestVertex()->GetID();
+                Crease crease = { std::min(org, dst), std::max(org, dst), e->GetSharpness() };
+                creases.push_back(crease);
+            }
+        }
+    }
+    addFaceVertices(nvertices, nfaces, &nverts[0], vtx.empty() ? 0 : &vtx[0]);
+
+    addHoles(holes);
+
+    // both halfedges of an edge hold its sharpness
+    std::sort(creases.begin(), creases.end());
+    std::vector<Crease> edges;
+    for (int i=0; i<(int)creases.size(); ++i)
+        if (edges.empty() or edges.back()<creases[i])
+            edges.push_back(creases[i]);
+
+    std::vector<float> vertexSharpness(nvertices, 0.0f);
+    for (int i=0; i<nvertices; ++i)
+        if (HbrVertex<T> * v = mesh->GetVertex(i))
+            vertexSharpness[i] = v->GetSharpness();
+
+    addSharpness(edges, vertexSharpness);
+
+    int fvarcount = mesh->GetFVarCount();
+    Add(fvarcount);
+    if (fvarcount>0) {
+        Add((int)mesh->GetFVarInterpolateBoundaryMethod());
+        Add((int)mesh->GetFVarPropagateCorners());
+        for (int i=0; i<fvarcount; ++i) {
+            Add(mesh->GetFVarIndices()[i]);
+            Add(mesh->GetFVarWidths()[i]);
+        }
+    }
+
+    int fvarwidth = fvarData ? mesh->GetTotalFVarWidth() : 0;
+    Add(fvarwidth);
+    for (int i=0; fvarwidth>0 and i<nfaces; ++i) {
+        HbrFace<T> * f = mesh->GetFace(i);
+        for (int j=0; j<f->GetNumVertices(); ++j) {
+            float const * data = f->GetVertex(j)->GetFVarData(f).GetData(0);
+            for (int k=0; k<fvarwidth; ++k)
+                Add(data[k]);
+        }
+    }
+
+    // HbrMesh::Finish() terminates the edits with a null entry
+    std::vector<HbrHierarchicalEdit<T>*> const & edits = mesh->GetHierarchicalEdits();
+    int nedits = 0;
+    for (int i=0; i<(int)edits.size(); ++i)
+        if (edits[i])
+            ++nedits;
+    Add(nedits);
+    for (int i=0; i<(int)edits.size(); ++i)
+        if (edits[i])
+            addEdit(edits[i]);
+}
+
+template <class T> void
+FarTopologyHash::AddFaces( HbrSubdivision<T> * subdivision,
+                           typename HbrMesh<T>::InterpolateBoundaryMethod interpolateBoundary,
+                           int nvertices, int nfaces, int const * nverts, int const * vtx,
+                           int nholes, int const * holes,
+                           int ncreases, int const * creases, float const * creasesharpness,
+                           int ncorners, int const * corners, float const * cornersharpness ) {
+
+    addScheme(subdivision, (int)interpolateBoundary);
+
+    addFaceVertices(nvertices, nfaces, nverts, vtx);
+
+    std::vector<int> holeFaces(holes, holes+nholes);
+    std::sort(holeFaces.begin(), holeFaces.end());
+    holeFaces.erase(std::unique(holeFaces.begin(), holeFaces.end()), holeFaces.end());
+    addHoles(holeFaces);
+
+    // the edges of the faces : the boundary edges only appear once
+    std::vector<Crease> halfedges;
+    std::vector<int> valences(nvertices, 0);
+    for (int i=0, ofs=0; i<nfaces; ofs+=nverts[i++]) {
+        for (int j=0; j<nverts[i]; ++j) {
+            int org = vtx[ofs+j],
+                dst = vtx[ofs+(j+1)%nverts[i]];
+            Crease edge = { std::min(org, dst), std::max(org, dst), 0.0f };
+            halfedges.push_back(edge);
+            if (org>=0 and org<nvertices)
+                ++valences[org];
+        }
+    }
+    std::sort(halfedges.begin(), halfedges.end());
+
+    std::vector<Crease> edges;
+    std::vector<bool> boundary;
+    for (int i=0; i<(int)halfedges.size(); ++i) {
+        if (edges.empty() or edges.back()<halfedges[i]) {
+            edges.push_back(halfedges[i]);
+            boundary.push_back(true);
+        } else
+            boundary.back() = false;
+    }
+
+    // as in HbrMesh::NewFaces, the last sharpness given to an edge or a
+    // vertex wins (invalid IDs are left to NewFaces to reject), then
+    // HbrMesh::Finish sharpens the boundary
+    for (int i=0; i<ncreases; ++i) {
+        Crease edge = { std::min(creases[2*i], creases[2*i+1]),
+                        std::max(creases[2*i], creases[2*i+1]), 0.0f };
+        typename std::vector<Crease>::iterator it =
+            std::lower_bound(edges.begin(), edges.end(), edge);
+        if (it!=edges.end() and not (edge<*it))
+            it->sharpness = creasesharpness[i];
+    }
+
+    std::vector<float> vertexSharpness(nvertices, 0.0f);
+    for (int i=0; i<ncorners; ++i)
+        if (corners[i]>=0 and corners[i]<nvertices)
+            vertexSharpness[corners[i]] = cornersharpness[i];
+
+    if (interpolateBoundary==HbrMesh<T>::k_InterpolateBoundaryEdgeOnly or
+        interpolateBoundary==HbrMesh<T>::k_InterpolateBoundaryEdgeAndCorner) {
+        for (int i=0; i<(int)edges.size(); ++i)
+            if (boundary[i])
+                edges[i].sharpness = (float)HbrHalfedge<T>::k_InfinitelySharp;
+    }
+
+    // the vertices of a single face are the boundary vertices of valence 2
+    if (interpolateBoundary==HbrMesh<T>::k_InterpolateBoundaryEdgeAndCorner) {
+        for (int i=0; i<nvertices; ++i)
+            if (valences[i]==1)
+                vertexSharpness[i] = (float)HbrVertex<T>::k_InfinitelySharp;
+    }
+
+    std::vector<Crease> sharpEdges;
+    for (int i=0; i<(int)edges.size(); ++i)
+        if (edges[i].sharpness>0.0f)
+            sharpEdges.push_back(edges[i]);
+
+    addSharpness(sharpEdges, vertexSharpness);
+
+    // no face-varying layout nor data
+    Add(0);
+    Add(0);
+
+    // no hierarchical edits
+    Add(0);
+}
+
+template <class T> void
+FarTopologyHash::addEdit( HbrHierarchicalEdit<T> const * edit ) {
+
+    Add(edit->GetFaceID());
+    Add(edit->GetNSubfaces());
+    for (int i=0; i<edit->GetNSubfaces(); ++i)
+        Add((int)edit->GetSubface(i));
+
+    if (HbrVertexEdit<T> const * e = dynamic_cast<HbrVertexEdit<T> const *>(edit)) {
+        Add(1);
+        Add((int)e->GetVertexID());
+        Add(e->GetIndex());
+        Add(e->GetWidth());
+        Add((int)e->GetOperation());
+        for (int i=0; i<e->GetWidth(); ++i)
+            Add(e->GetEdit()[i]);
+    } else if (HbrMovingVertexEdit<T> const * e = dynamic_cast<HbrMovingVertexEdit<T> const *>(edit)) {
+        Add(2);
+        Add((int)e->GetVertexID());
+        Add(e->GetIndex());
+        Add(e->GetWidth());
+        Add((int)e->GetOperation());
+        // moving edits store a pair of values per element
+        for (int i=0; i<2*e->GetWidth(); ++i)
+            Add(e->GetEdit()[i]);
+    } else if (HbrCreaseEdit<T> const * e = dynamic_cast<HbrCreaseEdit<T> const *>(edit)) {
+        Add(3);
+        Add((int)e->GetEdgeID());
+        Add((int)e->GetOperation());
+        Add(e->GetSharpness());
+    } else if (HbrCornerEdit<T> const * e = dynamic_cast<HbrCornerEdit<T> const *>(edit)) {
+        Add(4);
+        Add((int)e->GetVertexID());
+        Add((int)e->GetOperation());
+        Add(e->GetSharpness());
+    } else if (dynamic_cast<HbrHoleEdit<T> const *>(edit)) {
+        Add(5);
+    } else if (HbrFVarEdit<T> const * e = dynamic_cast<HbrFVarEdit<T> const *>(edit)) {
+        Add(6);
+        Add((int)e->GetVertexID());
+        Add(e->GetIndex());
+        Add(e->GetWidth());
+        Add(e->GetOffset());
+        Add((int)e->GetOperation());
+        for (int i=0; i<e->GetWidth(); ++i)
+            Add(e->GetEdit()[i]);
+    } else if (HbrFaceEdit<T> const * e = dynamic_cast<HbrFaceEdit<T> const *>(edit)) {
+        Add(7);
+        Add(e->GetIndex());
+        Add(e->GetWidth());
+        Add((int)e->GetOperation());
+        for (int i=0; i<e->GetWidth(); ++i)
+            Add(e->GetEdit()[i]);
+    } else {
+        Add(0);
+    }
+}
+
+} // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+} // end namespace OpenSubdiv
+
+#endif /* FAR_TOPOLOGY_HASH_H */
@@ -28,6 +28,8 @@
 
 #include "../version.h"
 
+#include "../far/memoryUsage.h"
+
 #include <assert.h>
 #include <utility>
 #include <vector>
@@ -142,6 +144,13 @@ public:
         return _batches[index];
     }
 
+    /// \brief Memory required to store the edit tables
+    int GetMemoryUsed() const;
+
+    /// \brief Itemized memory allocated by the edit tables, summed across
+    /// all the batches
+    FarMemoryUsage GetMemoryUsage() const;
+
 private:
     template <class X, class Y> friend class FarVertexEditTablesFactory;
     template <class X, class Y> friend class FarMultiMeshFactory;
@@ -191,6 +200,34 @@ FarVertexEditTables<U>::FarVertexEditTables( FarMesh<U> * mesh ) :
     _mesh(mesh) {
 }
 
+template <class U> int
+FarVertexEditTables<U>::GetMemoryUsed() const {
+
+    int result = 0;
+    for (int i=0; i<(int)_batches.size(); ++i) {
+        result += (int)(_batches[i].GetVertexIndices().size() * sizeof(unsigned int) +
+                        _batches[i].GetValues().size() * sizeof(float));
+    }
+    return result;
+}
+
+template <class U> FarMemoryUsage
+FarVertexEditTables<U>::GetMemoryUsage() const {
+
+    size_t indices = 0,
+           values = 0;
+    for (int i=0; i<(int)_batches.size(); ++i) {
+        indices += _batches[i].GetVertexIndices().capacity() * sizeof(unsigned int);
+        values += _batches[i].GetValues().capacity() * sizeof(float);
+    }
+
+    FarMemoryUsage result;
+    result.AddVector("batches", _batches);
+    result.Add("vertexIndices", indices);
+    result.Add("values", values);
+    return result;
+}
+
 template <class U> void
 FarVertexEditTables<U>::computeVertexEdits(int tableIndex, int offset, int tableOffset, int start, int end, void *clientdata) const {
 
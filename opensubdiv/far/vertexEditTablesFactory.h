@@ -32,6 +32,7 @@
 
 #include "../far/vertexEditTables.h"
 #include "../far/kernelBatch.h"
+#include "../far/factoryStats.h"
 
 #include <cassert>
 #include <vector>
@@ -82,6 +83,8 @@ FarVertexEditTablesFactory<T,U>::Create( FarMeshFactory<T,U> const * factory, Fa
 
     assert( factory and mesh );
 
+    FarFactoryStats::Scope scope("FarVertexEditTablesFactory::Create");
+
     FarVertexEditTables<U> * result = new FarVertexEditTables<U>(mesh);
 
     std::vector<HbrHierarchicalEdit<T>*> const & hEdits = factory->_hbrMesh->GetHierarchicalEdits();
@@ -96,6 +99,13 @@ FarVertexEditTablesFactory<T,U>::Create( FarMeshFactory<T,U> const * factory, Fa
             if (editlevel > maxlevel)
                 continue;   // far table doesn't contain such level
 
+            // skip edits on faces that were not refined (sparse refinement)
+            HbrFace<T> * f = factory->_hbrMesh->GetFace(vedit->GetFaceID());
+            for (int j=0; f and j<editlevel; ++j)
+                f = f->GetChild(vedit->GetSubface(j));
+            if (not f)
+                continue;
+
             vertexEdits.push_back(vedit);
         }
     }
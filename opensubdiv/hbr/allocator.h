@@ -59,6 +59,21 @@ public:
 
     void SetMemStatsDecrement(void (*decrement)(size_t bytes)) { m_decrement = decrement; }
 
+    // Returns the number of objects currently handed out by the allocator
+    int GetNumLive() const { return m_nlive; }
+
+    // Returns the highest number of objects handed out simultaneously
+    int GetPeakNumLive() const { return m_peaklive; }
+
+    // Returns the number of bytes currently held in blocks
+    size_t GetMemoryUsed() const { return (size_t)m_nblocks * m_blocksize * m_elemsize; }
+
+    // Returns the highest number of bytes held in blocks
+    size_t GetPeakMemoryUsed() const { return m_peakmemory; }
+
+    // Resets the peak statistics to the current values
+    void ResetPeakStats() { m_peaklive = m_nlive; m_peakmemory = GetMemoryUsed(); }
+
 private:
     size_t *m_memorystat;
     const int m_blocksize;
@@ -75,6 +90,11 @@ private:
     int m_freecount;
     T * m_freelist;
 
+    // Number of live objects and high-water marks
+    int m_nlive;
+    int m_peaklive;
+    size_t m_peakmemory;
+
     // Memory statistics tracking routines
     HbrMemStatFunction m_increment;
     HbrMemStatFunction m_decrement;
@@ -82,7 +102,7 @@ private:
 
 template <typename T>
 HbrAllocator<T>::HbrAllocator(size_t *memorystat, int blocksize, void (*increment)(size_t bytes), void (*decrement)(size_t bytes), size_t elemsize)
-    : m_memorystat(memorystat), m_blocksize(blocksize), m_elemsize((int)elemsize), m_blocks(0), m_nblocks(0), m_blockCapacity(0), m_freecount(0), m_increment(increment), m_decrement(decrement) {
+    : m_memorystat(memorystat), m_blocksize(blocksize), m_elemsize((int)elemsize), m_blocks(0), m_nblocks(0), m_blockCapacity(0), m_freecount(0), m_nlive(0), m_peaklive(0), m_peakmemory(0), m_increment(increment), m_decrement(decrement) {
 }
 
 template <typename T>
@@ -110,6 +130,7 @@ void HbrAllocator<T>::Clear() {
     m_blockCapacity = 0;
     m_freecount = 0;
     m_freelist = NULL;
+    m_nlive = 0;
 }
 
 template <typename T>
@@ -147,11 +168,13 @@ HbrAllocator<T>::Allocate() {
         m_blocks[m_nblocks] = block;
         m_nblocks++;
         m_freecount += m_blocksize;
+        if (GetMemoryUsed() > m_peakmemory) m_peakmemory = GetMemoryUsed();
     }
     T* obj = m_freelist;
     m_freelist = obj->GetNext();
     obj->GetNext() = 0;
     m_freecount--;
+    if (++m_nlive > m_peaklive) m_peaklive = m_nlive;
     return obj;
 }
 
@@ -162,6 +185,7 @@ HbrAllocator<T>::Deallocate(T * obj) {
     obj->GetNext() = m_freelist;
     m_freelist = obj;
     m_freecount++;
+    m_nlive--;
 }
 
 } // end namespace OPENSUBDIV_VERSION
@@ -58,6 +58,15 @@ public:
 
     friend std::ostream& operator<< <T> (std::ostream& out, const HbrCreaseEdit<T>& path);
 
+    // Return the edge id (the last element in the path)
+    unsigned char GetEdgeID() const { return edgeid; }
+
+    // Get the type of operation
+    typename HbrHierarchicalEdit<T>::Operation GetOperation() const { return op; }
+
+    // Get the sharpness of the edit
+    float GetSharpness() const { return sharpness; }
+
     virtual void ApplyEditToFace(HbrFace<T>* face) {
         if (HbrHierarchicalEdit<T>::GetNSubfaces() == face->GetDepth()) {
             // Modify edge sharpness
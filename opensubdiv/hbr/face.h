@@ -120,7 +120,10 @@ private:
 
 public:
 
-    void Initialize(HbrMesh<T>* mesh, HbrFace<T>* parent, int childindex, int id, int uindex, int nvertices, HbrVertex<T>** vertices, int fvarwidth = 0, int depth = 0);
+    // If opposites is not null, it provides the opposite of each
+    // halfedge of the face (or null) instead of searching the incident
+    // edges of the vertices for them.
+    void Initialize(HbrMesh<T>* mesh, HbrFace<T>* parent, int childindex, int id, int uindex, int nvertices, HbrVertex<T>** vertices, int fvarwidth = 0, int depth = 0, HbrHalfedge<T>** opposites = 0);
     void Destroy();
 
     // Returns the mesh to which this face belongs
@@ -402,8 +405,9 @@ public:
         unsigned isCritical:1;
         unsigned isExtraordinary:1;
         unsigned isTagged:1;
+        unsigned isSingleCrease:1;
         
-        AdaptiveFlags() : patchType(0), transitionType(5), rots(0), brots(0), bverts(0), isCritical(0), isExtraordinary(0), isTagged(0) { }
+        AdaptiveFlags() : patchType(0), transitionType(5), rots(0), brots(0), bverts(0), isCritical(0), isExtraordinary(0), isTagged(0), isSingleCrease(0) { }
     };
     
     AdaptiveFlags _adaptiveFlags;
@@ -445,7 +449,7 @@ HbrFace<T>::HbrFace()
 
 template <class T>
 void
-HbrFace<T>::Initialize(HbrMesh<T>* m, HbrFace<T>* _parent, int childindex, int fid, int _uindex, int nv, HbrVertex<T>** vertices, int /* fvarwidth */, int _depth) {
+HbrFace<T>::Initialize(HbrMesh<T>* m, HbrFace<T>* _parent, int childindex, int fid, int _uindex, int nv, HbrVertex<T>** vertices, int /* fvarwidth */, int _depth, HbrHalfedge<T>** opposites) {
     mesh = m;
     id = fid;
     uindex = _uindex;
@@ -543,7 +547,8 @@ HbrFace<T>::Initialize(HbrMesh<T>* m, HbrFace<T>* _parent, int childindex, int f
     }
     for (i = 0, next = 1; i < nv; ++i, ++next) {
         if (next == nv) next = 0;
-        HbrHalfedge<T>* opposite = vertices[next]->GetEdge(vertices[i]->GetID());
+        HbrHalfedge<T>* opposite = opposites ? opposites[i] :
+            vertices[next]->GetEdge(vertices[i]->GetID());
         edge->Initialize(opposite, i, vertices[i], curfvarbits, this);
         if (opposite) opposite->SetOpposite(edge);
         if (fvarbits) {
@@ -111,6 +111,19 @@ public:
     // Create face from a list of vertices
     HbrFace<T>* NewFace(int nvertices, HbrVertex<T>** vtx, HbrFace<T>* parent, int childindex);
 
+    // Create faces in bulk from flat arrays of face vertex counts and
+    // vertex IDs, with optional crease edges (pairs of vertex IDs) and
+    // corner vertices. The halfedges are matched with a bucketing pass
+    // over their origin vertices instead of searching the vertex
+    // neighborhoods face by face. The faces must be the first faces of
+    // the mesh. The topology is validated before any face is created:
+    // returns false, without modifying the mesh, if a vertex does not
+    // exist, if an edge is degenerate, non-manifold or specified more
+    // than once, or if a crease edge does not exist.
+    bool NewFaces(int nfaces, const int *nverts, const int *vtx,
+                  int ncreases = 0, const int *creases = 0, const float *creasesharpness = 0,
+                  int ncorners = 0, const int *corners = 0, const float *cornersharpness = 0);
+
     // "Create" a new uniform index
     int NewUniformIndex() { return ++maxUniformIndex; }
 
@@ -198,6 +211,12 @@ public:
     // Returns memory statistics
     size_t GetMemStats() const { return m_memory; }
 
+    // Returns the per-type block allocators (number of live objects,
+    // current and peak bytes held)
+    const HbrAllocator<HbrFace<T> >& GetFaceAllocator() const { return m_faceAllocator; }
+    const HbrAllocator<HbrVertex<T> >& GetVertexAllocator() const { return m_vertexAllocator; }
+    const HbrAllocator<HbrFaceChildren<T> >& GetFaceChildrenAllocator() const { return m_faceChildrenAllocator; }
+
     // Interpolate boundary management
     enum InterpolateBoundaryMethod {
         k_InterpolateBoundaryNone,
@@ -681,6 +700,158 @@ HbrMesh<T>::NewFace(int nv, HbrVertex<T> **vtx, HbrFace<T>* parent, int childind
     return f;
 }
 
+template <class T>
+bool
+HbrMesh<T>::NewFaces(int nf, const int *nverts, const int *vtx,
+                     int ncreases, const int *creases, const float *creasesharpness,
+                     int ncorners, const int *corners, const float *cornersharpness) {
+    assert(maxFaceID == 0);
+    if (maxFaceID != 0) return false;
+
+    int i, f, h;
+
+    // Offsets of the halfedges of each face: halfedge h originates
+    // at vertex vtx[h]
+    std::vector<int> offsets(nf + 1);
+    offsets[0] = 0;
+    for (f = 0; f < nf; ++f) {
+        if (nverts[f] < 1) return false;
+        offsets[f + 1] = offsets[f] + nverts[f];
+    }
+    const int nedges = offsets[nf];
+
+    // Face and destination vertex of each halfedge
+    std::vector<int> edgeface(nedges), edgedest(nedges);
+    int nerrors = 0;
+    for (f = 0; f < nf; ++f) {
+        const int nv = nverts[f], offset = offsets[f];
+        for (int j = 0, next = 1; j < nv; ++j, ++next) {
+            if (next == nv) next = 0;
+            const int org = vtx[offset + j], dst = vtx[offset + next];
+            edgeface[offset + j] = f;
+            edgedest[offset + j] = dst;
+            if (org < 0 || !GetVertex(org) || org == dst) {
+                ++nerrors;
+            }
+        }
+    }
+    if (nerrors) return false;
+
+    // Bucket the halfedges by origin vertex
+    std::vector<int> vertoffsets(nvertices + 1, 0), vertedges(nedges);
+    for (h = 0; h < nedges; ++h) {
+        ++vertoffsets[vtx[h] + 1];
+    }
+    for (i = 0; i < nvertices; ++i) {
+        vertoffsets[i + 1] += vertoffsets[i];
+    }
+    {
+        std::vector<int> fill(vertoffsets.begin(), vertoffsets.end() - 1);
+        for (h = 0; h < nedges; ++h) {
+            vertedges[fill[vtx[h]]++] = h;
+        }
+    }
+
+    // Match each halfedge with its opposite. An edge is valid if no
+    // other halfedge has the same origin and destination: this also
+    // rejects edges incident to more than two faces.
+    std::vector<int> opposites(nedges);
+    for (h = 0; h < nedges; ++h) {
+        const int org = vtx[h], dst = edgedest[h];
+        for (int k = vertoffsets[org]; k < vertoffsets[org + 1]; ++k) {
+            if (vertedges[k] != h && edgedest[vertedges[k]] == dst) {
+                ++nerrors;
+            }
+        }
+        opposites[h] = -1;
+        for (int k = vertoffsets[dst]; k < vertoffsets[dst + 1]; ++k) {
+            if (edgedest[vertedges[k]] == org) {
+                opposites[h] = vertedges[k];
+                break;
+            }
+        }
+    }
+    if (nerrors) return false;
+
+    // Find the halfedges of the creases
+    std::vector<int> creaseedges(ncreases);
+    for (i = 0; i < ncreases; ++i) {
+        const int v = creases[2 * i], w = creases[2 * i + 1];
+        creaseedges[i] = -1;
+        if (v < 0 || v >= nvertices || w < 0 || w >= nvertices) return false;
+        for (int k = vertoffsets[v]; k < vertoffsets[v + 1]; ++k) {
+            if (edgedest[vertedges[k]] == w) {
+                creaseedges[i] = vertedges[k];
+                break;
+            }
+        }
+        if (creaseedges[i] < 0) {
+            for (int k = vertoffsets[w]; k < vertoffsets[w + 1]; ++k) {
+                if (edgedest[vertedges[k]] == v) {
+                    creaseedges[i] = vertedges[k];
+                    break;
+                }
+            }
+        }
+        if (creaseedges[i] < 0) return false;
+    }
+    for (i = 0; i < ncorners; ++i) {
+        if (corners[i] < 0 || !GetVertex(corners[i])) return false;
+    }
+
+    if (nfaces < nf) {
+        size_t oldsize = faces.size();
+        nfaces = nf;
+        faces.resize(nfaces);
+        if (s_memStatsIncrement) {
+            s_memStatsIncrement((faces.size() - oldsize) * sizeof(HbrFace<T>*));
+        }
+    }
+
+    // Create the faces in order: as with NewFace, the halfedges are
+    // linked to the opposite halfedges of the faces created before them
+    std::vector<HbrVertex<T>*> facevertices;
+    std::vector<HbrHalfedge<T>*> faceopposites;
+    for (f = 0; f < nf; ++f) {
+        const int nv = nverts[f], offset = offsets[f];
+        facevertices.resize(nv);
+        faceopposites.resize(nv);
+        for (int j = 0; j < nv; ++j) {
+            facevertices[j] = vertices[vtx[offset + j]];
+            const int opposite = opposites[offset + j];
+            if (opposite >= 0 && edgeface[opposite] < f) {
+                const int g = edgeface[opposite];
+                faceopposites[j] = faces[g]->GetEdge(opposite - offsets[g]);
+            } else {
+                faceopposites[j] = 0;
+            }
+        }
+        HbrFace<T> *face = faces[f];
+        if (face) {
+            face->Destroy();
+        } else {
+            face = m_faceAllocator.Allocate();
+        }
+        face->Initialize(this, NULL, -1, f, 0, nv, &facevertices[0], totalfvarwidth, 0, &faceopposites[0]);
+        faces[f] = face;
+
+        // If mesh is in transient mode, add face to transient list
+        if (m_transientMode) {
+            m_transientFaces.push_back(face);
+        }
+    }
+    maxFaceID = nf;
+
+    for (i = 0; i < ncreases; ++i) {
+        const int edge = creaseedges[i], g = edgeface[edge];
+        faces[g]->GetEdge(edge - offsets[g])->SetSharpness(creasesharpness[i]);
+    }
+    for (i = 0; i < ncorners; ++i) {
+        vertices[corners[i]]->SetSharpness(cornersharpness[i]);
+    }
+    return true;
+}
+
 template <class T>
 void
 HbrMesh<T>::Finish() {
@@ -24,6 +24,7 @@
 //
 
 #include "../far/mesh.h"
+#include "../osd/error.h"
 #include "../osd/clComputeContext.h"
 #include "../osd/clKernelBundle.h"
 
@@ -103,7 +104,7 @@ OsdCLHEditTable::GetPrimvarWidth() const {
 
 OsdCLComputeContext::OsdCLComputeContext(FarMesh<OsdVertex> const *farMesh,
                                           cl_context clContext)
-    : _clQueue(NULL), _kernelBundle(NULL) {
+    : _clQueue(NULL), _kernelBundle(NULL), _observer(NULL) {
 
     FarSubdivisionTables<OsdVertex> const * farTables =
         farMesh->GetSubdivisionTables();
@@ -202,6 +203,21 @@ OsdCLComputeContext::GetCommandQueue() const {
 OsdCLComputeContext *
 OsdCLComputeContext::Create(FarMesh<OsdVertex> const *farmesh, cl_context clContext) {
 
+    // no device kernel applies the structured grids yet
+    if (farmesh->GetSubdivisionTables()->GetStructuredGrids().GetNumGrids() > 0) {
+        OsdError(OSD_UNSUPPORTED_OPTION_ERROR,
+                 "Structured grids are not supported by this compute context\n");
+        return NULL;
+    }
+
+    // nor the B-spline end caps
+    if (farmesh->GetEndCapTables() and
+        farmesh->GetEndCapTables()->GetNumVertices() > 0) {
+        OsdError(OSD_UNSUPPORTED_OPTION_ERROR,
+                 "B-spline end caps are not supported by this compute context\n");
+        return NULL;
+    }
+
     return new OsdCLComputeContext(farmesh, clContext);
 }
 
@@ -42,6 +42,8 @@
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
+class FarKernelBatchObserver;
+
 class OsdCLKernelBundle;
 
 
@@ -106,6 +108,9 @@ public:
     ///
     /// @param clContext  a valid active OpenCL context
     ///
+    /// @return NULL if the FarMesh has structured grids or B-spline end
+    ///         caps, which have no device kernel yet
+    ///
     static OsdCLComputeContext * Create(FarMesh<OsdVertex> const *farmesh,
                                         cl_context clContext);
 
@@ -168,6 +173,14 @@ public:
 
     void SetCommandQueue(cl_command_queue queue);
 
+    /// Attaches an observer notified around each kernel batch queued by the
+    /// compute controller (see FarKernelBatchObserver). The context does not
+    /// take ownership of the observer (NULL detaches it).
+    void SetKernelBatchObserver(FarKernelBatchObserver * observer) { _observer = observer; }
+
+    /// Returns the kernel batch observer (NULL if none is attached)
+    FarKernelBatchObserver * GetKernelBatchObserver() const { return _observer; }
+
 protected:
     explicit OsdCLComputeContext(FarMesh<OsdVertex> const *farMesh,
                                  cl_context clContext);
@@ -182,6 +195,8 @@ private:
     cl_command_queue _clQueue;
 
     OsdCLKernelBundle *_kernelBundle;
+
+    FarKernelBatchObserver *_observer;
 };
 
 }  // end namespace OPENSUBDIV_VERSION
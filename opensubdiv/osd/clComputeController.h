@@ -43,6 +43,15 @@ namespace OPENSUBDIV_VERSION {
 
 class OsdCLKernelBundle;
 
+class OsdCLComputeController;
+
+// no device kernel applies the structured grids nor the B-spline end caps
+// yet (the compute context refuses the meshes that have them)
+template <> struct FarKernelSupport<OsdCLComputeController> {
+    static const bool structuredGrids = false;
+    static const bool endCaps = false;
+};
+
 /// \brief Compute controller for launching OpenCL subdivision kernels.
 ///
 /// OsdCLComputeController is a compute controller class to launch
@@ -96,7 +105,8 @@ public:
         FarDispatcher::Refine(this,
                               batches,
                               -1,
-                              context);
+                              context,
+                              context->GetKernelBatchObserver());
         context->Unbind();
     }
 
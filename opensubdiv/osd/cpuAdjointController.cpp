@@ -0,0 +1,298 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+//
+
+#include "../osd/cpuAdjointController.h"
+#include "../osd/cpuAdjointKernel.h"
+#include "../osd/cpuComputeContext.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+
+OsdCpuAdjointController::OsdCpuAdjointController() {
+}
+
+OsdCpuAdjointController::~OsdCpuAdjointController() {
+}
+
+void
+OsdCpuAdjointController::ApplyBilinearFaceVerticesKernel(
+    FarKernelBatch const &batch, void * clientdata) const {
+
+    OsdCpuComputeContext * context =
+        static_cast<OsdCpuComputeContext*>(clientdata);
+    assert(context);
+
+    OsdCpuAdjointFace(
+        context->GetVertexDescriptor(),
+        context->GetCurrentVertexBuffer(),
+        (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::F_IT)->GetBuffer(),
+        (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::F_ITa)->GetBuffer(),
+        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd());
+}
+
+void
+OsdCpuAdjointController::ApplyBilinearEdgeVerticesKernel(
+    FarKernelBatch const &batch, void * clientdata) const {
+
+    OsdCpuComputeContext * context =
+        static_cast<OsdCpuComputeContext*>(clientdata);
+    assert(context);
+
+    OsdCpuAdjointBilinearEdge(
+        context->GetVertexDescriptor(),
+        context->GetCurrentVertexBuffer(),
+        (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::E_IT)->GetBuffer(),
+        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd());
+}
+
+void
+OsdCpuAdjointController::ApplyBilinearVertexVerticesKernel(
+    FarKernelBatch const &batch, void * clientdata) const {
+
+    OsdCpuComputeContext * context =
+        static_cast<OsdCpuComputeContext*>(clientdata);
+    assert(context);
+
+    OsdCpuAdjointBilinearVertex(
+        context->GetVertexDescriptor(),
+        context->GetCurrentVertexBuffer(),
+        (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_ITa)->GetBuffer(),
+        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd());
+}
+
+void
+OsdCpuAdjointController::ApplyCatmarkFaceVerticesKernel(
+    FarKernelBatch const &batch, void * clientdata) const {
+
+    OsdCpuComputeContext * context =
+        static_cast<OsdCpuComputeContext*>(clientdata);
+    assert(context);
+
+    OsdCpuAdjointFace(
+        context->GetVertexDescriptor(),
+        context->GetCurrentVertexBuffer(),
+        (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::F_IT)->GetBuffer(),
+        (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::F_ITa)->GetBuffer(),
+        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd());
+}
+
+void
+OsdCpuAdjointController::ApplyCatmarkEdgeVerticesKernel(
+    FarKernelBatch const &batch, void * clientdata) const {
+
+    OsdCpuComputeContext * context =
+        static_cast<OsdCpuComputeContext*>(clientdata);
+    assert(context);
+
+    OsdCpuAdjointEdge(
+        context->GetVertexDescriptor(),
+        context->GetCurrentVertexBuffer(),
+        (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::E_IT)->GetBuffer(),
+        (const float*)context->GetTable(FarSubdivisionTables<OsdVertex>::E_W)->GetBuffer(),
+        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd());
+}
+
+void
+OsdCpuAdjointController::ApplyCatmarkVertexVerticesKernelB(
+    FarKernelBatch const &batch, void * clientdata) const {
+
+    OsdCpuComputeContext * context =
+        static_cast<OsdCpuComputeContext*>(clientdata);
+    assert(context);
+
+    OsdCpuAdjointVertexB(
+        context->GetVertexDescriptor(),
+        context->GetCurrentVertexBuffer(),
+        (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_ITa)->GetBuffer(),
+        (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_IT)->GetBuffer(),
+        (const float*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_W)->GetBuffer(),
+        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd());
+}
+
+void
+OsdCpuAdjointController::ApplyCatmarkVertexVerticesKernelA1(
+    FarKernelBatch const &batch, void * clientdata) const {
+
+    OsdCpuComputeContext * context =
+        static_cast<OsdCpuComputeContext*>(clientdata);
+    assert(context);
+
+    OsdCpuAdjointVertexA(
+        context->GetVertexDescriptor(),
+        context->GetCurrentVertexBuffer(),
+        (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_ITa)->GetBuffer(),
+        (const float*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_W)->GetBuffer(),
+        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd(), false);
+}
+
+void
+OsdCpuAdjointController::ApplyCatmarkVertexVerticesKernelA2(
+    FarKernelBatch const &batch, void * clientdata) const {
+
+    OsdCpuComputeContext * context =
+        static_cast<OsdCpuComputeContext*>(clientdata);
+    assert(context);
+
+    OsdCpuAdjointVertexA(
+        context->GetVertexDescriptor(),
+        context->GetCurrentVertexBuffer(),
+        (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_ITa)->GetBuffer(),
+        (const float*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_W)->GetBuffer(),
+        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd(), true);
+}
+
+void
+OsdCpuAdjointController::ApplyCatmarkStructuredGridKernel(
+    FarKernelBatch const &batch, void * clientdata) const {
+
+    OsdCpuComputeContext * context =
+        static_cast<OsdCpuComputeContext*>(clientdata);
+    assert(context);
+
+    OsdCpuAdjointStructuredGrid(
+        context->GetVertexDescriptor(),
+        context->GetCurrentVertexBuffer(),
+        (const FarStructuredGrids::Grid*)context->GetStructuredGrids()->GetBuffer(),
+        (const int*)context->GetStructuredGridIndices()->GetBuffer(),
+        batch.GetStart(), batch.GetEnd());
+}
+
+void
+OsdCpuAdjointController::ApplyEndCapKernel(
+    FarKernelBatch const &batch, void * clientdata) const {
+
+    OsdCpuComputeContext * context =
+        static_cast<OsdCpuComputeContext*>(clientdata);
+    assert(context);
+
+    OsdCpuAdjointEndCap(
+        context->GetVertexDescriptor(),
+        context->GetCurrentVertexBuffer(),
+        (const int*)context->GetEndCapOffsets()->GetBuffer(),
+        (const int*)context->GetEndCapIndices()->GetBuffer(),
+        (const float*)context->GetEndCapWeights()->GetBuffer(),
+        batch.GetVertexOffset(), batch.GetTableOffset(),
+        batch.GetStart(), batch.GetEnd());
+}
+
+void
+OsdCpuAdjointController::ApplyLoopEdgeVerticesKernel(
+    FarKernelBatch const &batch, void * clientdata) const {
+
+    OsdCpuComputeContext * context =
+        static_cast<OsdCpuComputeContext*>(clientdata);
+    assert(context);
+
+    OsdCpuAdjointEdge(
+        context->GetVertexDescriptor(),
+        context->GetCurrentVertexBuffer(),
+        (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::E_IT)->GetBuffer(),
+        (const float*)context->GetTable(FarSubdivisionTables<OsdVertex>::E_W)->GetBuffer(),
+        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd());
+}
+
+void
+OsdCpuAdjointController::ApplyLoopVertexVerticesKernelB(
+    FarKernelBatch const &batch, void * clientdata) const {
+
+    OsdCpuComputeContext * context =
+        static_cast<OsdCpuComputeContext*>(clientdata);
+    assert(context);
+
+    OsdCpuAdjointLoopVertexB(
+        context->GetVertexDescriptor(),
+        context->GetCurrentVertexBuffer(),
+        (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_ITa)->GetBuffer(),
+        (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_IT)->GetBuffer(),
+        (const float*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_W)->GetBuffer(),
+        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd());
+}
+
+void
+OsdCpuAdjointController::ApplyLoopVertexVerticesKernelA1(
+    FarKernelBatch const &batch, void * clientdata) const {
+
+    OsdCpuComputeContext * context =
+        static_cast<OsdCpuComputeContext*>(clientdata);
+    assert(context);
+
+    OsdCpuAdjointVertexA(
+        context->GetVertexDescriptor(),
+        context->GetCurrentVertexBuffer(),
+        (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_ITa)->GetBuffer(),
+        (const float*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_W)->GetBuffer(),
+        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd(), false);
+}
+
+void
+OsdCpuAdjointController::ApplyLoopVertexVerticesKernelA2(
+    FarKernelBatch const &batch, void * clientdata) const {
+
+    OsdCpuComputeContext * context =
+        static_cast<OsdCpuComputeContext*>(clientdata);
+    assert(context);
+
+    OsdCpuAdjointVertexA(
+        context->GetVertexDescriptor(),
+        context->GetCurrentVertexBuffer(),
+        (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_ITa)->GetBuffer(),
+        (const float*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_W)->GetBuffer(),
+        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd(), true);
+}
+
+void
+OsdCpuAdjointController::ApplyVertexEdits(
+    FarKernelBatch const &batch, void * clientdata) const {
+
+    OsdCpuComputeContext * context =
+        static_cast<OsdCpuComputeContext*>(clientdata);
+    assert(context);
+
+    const OsdCpuHEditTable *edit = context->GetEditTable(batch.GetTableIndex());
+    assert(edit);
+
+    // "add" edits are translations : they do not change the gradients
+    if (edit->GetOperation() == FarVertexEdit::Set) {
+        const OsdCpuTable * primvarIndices = edit->GetPrimvarIndices();
+
+        OsdCpuAdjointEditVertexSet(context->GetVertexDescriptor(),
+                                   context->GetCurrentVertexBuffer(),
+                                   edit->GetPrimvarOffset(),
+                                   edit->GetPrimvarWidth(),
+                                   batch.GetVertexOffset(),
+                                   batch.GetTableOffset(),
+                                   batch.GetStart(),
+                                   batch.GetEnd(),
+                                   static_cast<unsigned int*>(primvarIndices->GetBuffer()));
+    }
+}
+
+void
+OsdCpuAdjointController::Synchronize() {
+}
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
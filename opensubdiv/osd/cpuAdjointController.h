@@ -0,0 +1,141 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+//
+#ifndef OSD_CPU_ADJOINT_CONTROLLER_H
+#define OSD_CPU_ADJOINT_CONTROLLER_H
+
+#include "../version.h"
+
+#include "../far/dispatcher.h"
+#include "../osd/cpuComputeContext.h"
+
+#include <cassert>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+/// \brief Controller for launching the transposed CPU subdivision kernels.
+///
+/// Refinement is linear in the coarse vertices : OsdCpuAdjointController
+/// applies the transpose of the subdivision operator, so that the gradients
+/// of a loss with respect to the refined vertices can be back-propagated to
+/// the control cage (for instance to fit a cage to a target surface).
+///
+/// The kernel batches are walked in reverse order and each kernel scatters
+/// the gradients of the vertices of its batch to the vertices they were
+/// computed from. When OpenMP is available, the vertices of a batch are
+/// processed concurrently and the scatter-adds are atomic.
+///
+/// Note : only the vertex-interpolated data is back-propagated. The deformer
+/// of the context is not differentiated, "set" hierarchical edits block the
+/// gradients of the elements they overwrite and "add" edits are transparent.
+///
+/// See also FarSubdivisionMatrix for the explicit sparse matrix of the
+/// operator.
+///
+class OsdCpuAdjointController {
+public:
+    typedef OsdCpuComputeContext ComputeContext;
+
+    /// Constructor.
+    OsdCpuAdjointController();
+
+    /// Destructor.
+    ~OsdCpuAdjointController();
+
+    /// Back-propagates gradients through the subdivision kernels.
+    ///
+    /// @param  context         the OsdCpuContext the vertices were refined with
+    ///
+    /// @param  batches         vector of batches of vertices organized by
+    ///                         operative kernel
+    ///
+    /// @param  gradientBuffer  on input, the gradients of all the vertices
+    ///                         (coarse and refined) ; on output, the gradients
+    ///                         of the coarse vertices (the entries of the
+    ///                         refined vertices are reset to 0)
+    ///
+    template<class GRADIENT_BUFFER>
+    void Refine(OsdCpuComputeContext *context,
+                FarKernelBatchVector const & batches,
+                GRADIENT_BUFFER *gradientBuffer) {
+
+        if (batches.empty()) return;
+
+        assert(gradientBuffer);
+
+        context->Bind(gradientBuffer, (GRADIENT_BUFFER*)0);
+        FarDispatcher::RefineReverse(this,
+                                     batches,
+                                     -1,
+                                     context,
+                                     context->GetKernelBatchObserver());
+        context->Unbind();
+    }
+
+    /// Waits until all running kernels finish.
+    void Synchronize();
+
+protected:
+    friend class FarDispatcher;
+    void ApplyBilinearFaceVerticesKernel(FarKernelBatch const &batch, void * clientdata) const;
+
+    void ApplyBilinearEdgeVerticesKernel(FarKernelBatch const &batch, void * clientdata) const;
+
+    void ApplyBilinearVertexVerticesKernel(FarKernelBatch const &batch, void * clientdata) const;
+
+
+    void ApplyCatmarkFaceVerticesKernel(FarKernelBatch const &batch, void * clientdata) const;
+
+    void ApplyCatmarkEdgeVerticesKernel(FarKernelBatch const &batch, void * clientdata) const;
+
+    void ApplyCatmarkVertexVerticesKernelB(FarKernelBatch const &batch, void * clientdata) const;
+
+    void ApplyCatmarkVertexVerticesKernelA1(FarKernelBatch const &batch, void * clientdata) const;
+
+    void ApplyCatmarkVertexVerticesKernelA2(FarKernelBatch const &batch, void * clientdata) const;
+
+    void ApplyCatmarkStructuredGridKernel(FarKernelBatch const &batch, void * clientdata) const;
+
+
+    void ApplyLoopEdgeVerticesKernel(FarKernelBatch const &batch, void * clientdata) const;
+
+    void ApplyLoopVertexVerticesKernelB(FarKernelBatch const &batch, void * clientdata) const;
+
+    void ApplyLoopVertexVerticesKernelA1(FarKernelBatch const &batch, void * clientdata) const;
+
+    void ApplyLoopVertexVerticesKernelA2(FarKernelBatch const &batch, void * clientdata) const;
+
+
+    void ApplyVertexEdits(FarKernelBatch const &batch, void * clientdata) const;
+
+    void ApplyEndCapKernel(FarKernelBatch const &batch, void * clientdata) const;
+};
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OSD_CPU_ADJOINT_CONTROLLER_H
@@ -0,0 +1,374 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+//
+
+#include "../osd/cpuAdjointKernel.h"
+#include "../osd/cpuKernel.h"
+
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+// Applies "src += dst*weight" to the gradients : the vertices of a batch are
+// all computed from vertices outside of the batch, so only the sources can be
+// shared between threads.
+static inline void
+scatter(float *gradient, int numElements, int dstIndex, int srcIndex, float weight) {
+
+    const float *d = gradient + dstIndex * numElements;
+    float *s = gradient + srcIndex * numElements;
+
+    for (int k = 0; k < numElements; ++k) {
+#ifdef OPENSUBDIV_HAS_OPENMP
+        #pragma omp atomic
+#endif
+        s[k] += weight * d[k];
+    }
+}
+
+static inline void
+clear(float *gradient, int numElements, int index) {
+
+    float *d = gradient + index * numElements;
+    for (int k = 0; k < numElements; ++k)
+        d[k] = 0.0f;
+}
+
+void OsdCpuAdjointFace(
+    OsdVertexDescriptor const &vdesc, float *gradient,
+    const int *F_IT, const int *F_ITa, int vertexOffset, int tableOffset,
+    int start, int end) {
+
+    int numElements = vdesc.numVertexElements;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for
+#endif
+    for (int i = start + tableOffset; i < end + tableOffset; i++) {
+        int h = F_ITa[2*i];
+        int n = F_ITa[2*i+1];
+
+        float weight = 1.0f/n;
+
+        int dstIndex = i + vertexOffset - tableOffset;
+
+        for (int j = 0; j < n; ++j)
+            scatter(gradient, numElements, dstIndex, F_IT[h+j], weight);
+
+        clear(gradient, numElements, dstIndex);
+    }
+}
+
+void OsdCpuAdjointEdge(
+    OsdVertexDescriptor const &vdesc, float *gradient,
+    const int *E_IT, const float *E_W, int vertexOffset, int tableOffset,
+    int start, int end) {
+
+    int numElements = vdesc.numVertexElements;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for
+#endif
+    for (int i = start + tableOffset; i < end + tableOffset; i++) {
+        int eidx0 = E_IT[4*i+0];
+        int eidx1 = E_IT[4*i+1];
+        int eidx2 = E_IT[4*i+2];
+        int eidx3 = E_IT[4*i+3];
+
+        float vertWeight = E_W[i*2+0];
+
+        int dstIndex = i + vertexOffset - tableOffset;
+
+        scatter(gradient, numElements, dstIndex, eidx0, vertWeight);
+        scatter(gradient, numElements, dstIndex, eidx1, vertWeight);
+
+        if (eidx2 != -1) {
+            float faceWeight = E_W[i*2+1];
+
+            scatter(gradient, numElements, dstIndex, eidx2, faceWeight);
+            scatter(gradient, numElements, dstIndex, eidx3, faceWeight);
+        }
+
+        clear(gradient, numElements, dstIndex);
+    }
+}
+
+void OsdCpuAdjointVertexA(
+    OsdVertexDescriptor const &vdesc, float *gradient,
+    const int *V_ITa, const float *V_W, int vertexOffset, int tableOffset,
+    int start, int end, int pass) {
+
+    int numElements = vdesc.numVertexElements;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for
+#endif
+    for (int i = start + tableOffset; i < end + tableOffset; i++) {
+        int n     = V_ITa[5*i+1];
+        int p     = V_ITa[5*i+2];
+        int eidx0 = V_ITa[5*i+3];
+        int eidx1 = V_ITa[5*i+4];
+
+        float weight = (pass == 1) ? V_W[i] : 1.0f - V_W[i];
+
+        // same weight inversion as the forward kernel
+        if (weight > 0.0f && weight < 1.0f && n > 0)
+            weight = 1.0f - weight;
+
+        int dstIndex = i + vertexOffset - tableOffset;
+
+        if (eidx0 == -1 || (pass == 0 && (n == -1))) {
+            scatter(gradient, numElements, dstIndex, p, weight);
+        } else {
+            scatter(gradient, numElements, dstIndex, p, weight * 0.75f);
+            scatter(gradient, numElements, dstIndex, eidx0, weight * 0.125f);
+            scatter(gradient, numElements, dstIndex, eidx1, weight * 0.125f);
+        }
+
+        // the second pass accumulated onto the first one : the gradient
+        // still flows to the sources of the first pass
+        if (not pass)
+            clear(gradient, numElements, dstIndex);
+    }
+}
+
+void OsdCpuAdjointVertexB(
+    OsdVertexDescriptor const &vdesc, float *gradient,
+    const int *V_ITa, const int *V_IT, const float *V_W,
+    int vertexOffset, int tableOffset, int start, int end) {
+
+    int numElements = vdesc.numVertexElements;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for
+#endif
+    for (int i = start + tableOffset; i < end + tableOffset; i++) {
+        int h = V_ITa[5*i];
+        int n = V_ITa[5*i+1];
+        int p = V_ITa[5*i+2];
+
+        float weight = V_W[i];
+        float wp, wv;
+        OsdCpuGetCatmarkVertexWeights(n, &wp, &wv);
+
+        int dstIndex = i + vertexOffset - tableOffset;
+
+        scatter(gradient, numElements, dstIndex, p, weight * wv);
+
+        for (int j = 0; j < n; ++j) {
+            scatter(gradient, numElements, dstIndex, V_IT[h+j*2], weight * wp);
+            scatter(gradient, numElements, dstIndex, V_IT[h+j*2+1], weight * wp);
+        }
+
+        clear(gradient, numElements, dstIndex);
+    }
+}
+
+void OsdCpuAdjointLoopVertexB(
+    OsdVertexDescriptor const &vdesc, float *gradient,
+    const int *V_ITa, const int *V_IT, const float *V_W,
+    int vertexOffset, int tableOffset, int start, int end) {
+
+    int numElements = vdesc.numVertexElements;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for
+#endif
+    for (int i = start + tableOffset; i < end + tableOffset; i++) {
+        int h = V_ITa[5*i];
+        int n = V_ITa[5*i+1];
+        int p = V_ITa[5*i+2];
+
+        float weight = V_W[i];
+        float beta = OsdCpuGetLoopVertexWeight(n);
+
+        int dstIndex = i + vertexOffset - tableOffset;
+
+        scatter(gradient, numElements, dstIndex, p, weight * (1.0f - (beta * n)));
+
+        for (int j = 0; j < n; ++j)
+            scatter(gradient, numElements, dstIndex, V_IT[h+j], weight * beta);
+
+        clear(gradient, numElements, dstIndex);
+    }
+}
+
+void OsdCpuAdjointBilinearEdge(
+    OsdVertexDescriptor const &vdesc, float *gradient,
+    const int *E_IT, int vertexOffset, int tableOffset, int start, int end) {
+
+    int numElements = vdesc.numVertexElements;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for
+#endif
+    for (int i = start + tableOffset; i < end + tableOffset; i++) {
+        int dstIndex = i + vertexOffset - tableOffset;
+
+        scatter(gradient, numElements, dstIndex, E_IT[2*i+0], 0.5f);
+        scatter(gradient, numElements, dstIndex, E_IT[2*i+1], 0.5f);
+
+        clear(gradient, numElements, dstIndex);
+    }
+}
+
+void OsdCpuAdjointBilinearVertex(
+    OsdVertexDescriptor const &vdesc, float *gradient,
+    const int *V_ITa, int vertexOffset, int tableOffset, int start, int end) {
+
+    int numElements = vdesc.numVertexElements;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for
+#endif
+    for (int i = start + tableOffset; i < end + tableOffset; i++) {
+        int dstIndex = i + vertexOffset - tableOffset;
+
+        scatter(gradient, numElements, dstIndex, V_ITa[i], 1.0f);
+
+        clear(gradient, numElements, dstIndex);
+    }
+}
+
+// The refined vertices of a grid are only shared within the grid : the grids
+// run concurrently and their blocks of vertices are processed in the reverse
+// order of OsdCpuComputeStructuredGrid.
+void OsdCpuAdjointStructuredGrid(
+    OsdVertexDescriptor const &vdesc, float *gradient,
+    const FarStructuredGrids::Grid *grids, const int *indices,
+    int start, int end) {
+
+    int numElements = vdesc.numVertexElements;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for
+#endif
+    for (int i = start; i < end; i++) {
+        const FarStructuredGrids::Grid &g = grids[i];
+        int w = g.width, h = g.height;
+
+        std::vector<int> lattice((w+1)*(h+1));
+        for (int y = 0; y <= h; y++)
+            FarStructuredGrids::GetParentRow(grids, indices, i, y, &lattice[y*(w+1)]);
+
+        const int *P = &lattice[0];
+
+        // vertex-vertices (valence 4 smooth rule)
+        for (int y = 1; y < h; y++) {
+            const int *r0 = P + (y-1)*(w+1), *r1 = r0 + (w+1), *r2 = r1 + (w+1);
+            int f0 = g.faceOffset + (y-1)*w, f1 = f0 + w;
+            for (int x = 1; x < w; x++) {
+                int dstIndex = g.vertOffset + (y-1)*(w-1) + x-1;
+                scatter(gradient, numElements, dstIndex, r1[x], 0.5f);
+                scatter(gradient, numElements, dstIndex, r1[x+1], 0.0625f);
+                scatter(gradient, numElements, dstIndex, r2[x], 0.0625f);
+                scatter(gradient, numElements, dstIndex, r1[x-1], 0.0625f);
+                scatter(gradient, numElements, dstIndex, r0[x], 0.0625f);
+                scatter(gradient, numElements, dstIndex, f1 + x, 0.0625f);
+                scatter(gradient, numElements, dstIndex, f1 + x-1, 0.0625f);
+                scatter(gradient, numElements, dstIndex, f0 + x-1, 0.0625f);
+                scatter(gradient, numElements, dstIndex, f0 + x, 0.0625f);
+                clear(gradient, numElements, dstIndex);
+            }
+        }
+
+        // edge-vertices along v
+        for (int y = 0; y < h; y++) {
+            const int *r0 = P + y*(w+1), *r1 = r0 + (w+1);
+            int f = g.faceOffset + y*w;
+            for (int x = 1; x < w; x++) {
+                int dstIndex = g.vEdgeOffset + y*(w-1) + x-1;
+                scatter(gradient, numElements, dstIndex, r0[x], 0.25f);
+                scatter(gradient, numElements, dstIndex, r1[x], 0.25f);
+                scatter(gradient, numElements, dstIndex, f + x-1, 0.25f);
+                scatter(gradient, numElements, dstIndex, f + x, 0.25f);
+                clear(gradient, numElements, dstIndex);
+            }
+        }
+
+        // edge-vertices along u
+        for (int y = 1; y < h; y++) {
+            const int *r = P + y*(w+1);
+            int f0 = g.faceOffset + (y-1)*w, f1 = f0 + w;
+            for (int x = 0; x < w; x++) {
+                int dstIndex = g.hEdgeOffset + (y-1)*w + x;
+                scatter(gradient, numElements, dstIndex, r[x], 0.25f);
+                scatter(gradient, numElements, dstIndex, r[x+1], 0.25f);
+                scatter(gradient, numElements, dstIndex, f0 + x, 0.25f);
+                scatter(gradient, numElements, dstIndex, f1 + x, 0.25f);
+                clear(gradient, numElements, dstIndex);
+            }
+        }
+
+        // face-vertices
+        for (int y = 0; y < h; y++) {
+            const int *r0 = P + y*(w+1), *r1 = r0 + (w+1);
+            for (int x = 0; x < w; x++) {
+                int dstIndex = g.faceOffset + y*w + x;
+                scatter(gradient, numElements, dstIndex, r0[x], 0.25f);
+                scatter(gradient, numElements, dstIndex, r0[x+1], 0.25f);
+                scatter(gradient, numElements, dstIndex, r1[x+1], 0.25f);
+                scatter(gradient, numElements, dstIndex, r1[x], 0.25f);
+                clear(gradient, numElements, dstIndex);
+            }
+        }
+    }
+}
+
+void OsdCpuAdjointEndCap(
+    OsdVertexDescriptor const &vdesc, float *gradient,
+    const int *offsets, const int *indices, const float *weights,
+    int vertexOffset, int tableOffset, int start, int end) {
+
+    int numElements = vdesc.numVertexElements;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for
+#endif
+    for (int i = start + tableOffset; i < end + tableOffset; i++) {
+        int dstIndex = i + vertexOffset - tableOffset;
+
+        for (int j = offsets[i]; j < offsets[i+1]; ++j)
+            scatter(gradient, numElements, dstIndex, indices[j], weights[j]);
+
+        clear(gradient, numElements, dstIndex);
+    }
+}
+
+void OsdCpuAdjointEditVertexSet(
+    OsdVertexDescriptor const &vdesc, float *gradient,
+    int primVarOffset, int primVarWidth, int vertexOffset, int tableOffset,
+    int start, int end, const unsigned int *editIndices) {
+
+    for (int i = start+tableOffset; i < end+tableOffset; i++) {
+        float *d = gradient + (editIndices[i] + vertexOffset) * vdesc.numVertexElements
+                            + primVarOffset;
+        for (int k = 0; k < primVarWidth; ++k)
+            d[k] = 0.0f;
+    }
+}
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
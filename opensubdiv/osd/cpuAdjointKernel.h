@@ -0,0 +1,103 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+//
+#ifndef OSD_CPU_ADJOINT_KERNEL_H
+#define OSD_CPU_ADJOINT_KERNEL_H
+
+#include "../version.h"
+
+#include "../far/structuredGrids.h"
+#include "../osd/vertexDescriptor.h"
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+// Transposes of the subdivision kernels (see cpuKernel.h) : each kernel
+// reads the gradients of the vertices [start, end[ of its batch, scatters
+// them to the vertices they were computed from and resets them (except for
+// the second pass of the crease kernels, which accumulated onto the first
+// pass). The gradients share the layout of the vertex-interpolated data.
+//
+// The scatter-adds are atomic when the kernels run on OpenMP threads.
+
+void OsdCpuAdjointFace(OsdVertexDescriptor const &vdesc, float *gradient,
+                       const int *F_IT, const int *F_ITa,
+                       int vertexOffset, int tableOffset,
+                       int start, int end);
+
+void OsdCpuAdjointEdge(OsdVertexDescriptor const &vdesc, float *gradient,
+                       const int *E_IT, const float *E_W,
+                       int vertexOffset, int tableOffset,
+                       int start, int end);
+
+void OsdCpuAdjointVertexA(OsdVertexDescriptor const &vdesc, float *gradient,
+                          const int *V_ITa, const float *V_W,
+                          int vertexOffset, int tableOffset,
+                          int start, int end, int pass);
+
+void OsdCpuAdjointVertexB(OsdVertexDescriptor const &vdesc, float *gradient,
+                          const int *V_ITa, const int *V_IT, const float *V_W,
+                          int vertexOffset, int tableOffset,
+                          int start, int end);
+
+void OsdCpuAdjointLoopVertexB(OsdVertexDescriptor const &vdesc, float *gradient,
+                              const int *V_ITa, const int *V_IT, const float *V_W,
+                              int vertexOffset, int tableOffset,
+                              int start, int end);
+
+void OsdCpuAdjointBilinearEdge(OsdVertexDescriptor const &vdesc, float *gradient,
+                               const int *E_IT,
+                               int vertexOffset, int tableOffset,
+                               int start, int end);
+
+void OsdCpuAdjointBilinearVertex(OsdVertexDescriptor const &vdesc, float *gradient,
+                                 const int *V_ITa,
+                                 int vertexOffset, int tableOffset,
+                                 int start, int end);
+
+void OsdCpuAdjointStructuredGrid(OsdVertexDescriptor const &vdesc, float *gradient,
+                                 const FarStructuredGrids::Grid *grids,
+                                 const int *indices,
+                                 int start, int end);
+
+void OsdCpuAdjointEndCap(OsdVertexDescriptor const &vdesc, float *gradient,
+                         const int *offsets, const int *indices,
+                         const float *weights,
+                         int vertexOffset, int tableOffset,
+                         int start, int end);
+
+// "set" edits overwrite the edited elements : their gradients are reset ("add"
+// edits do not change the gradients)
+void OsdCpuAdjointEditVertexSet(OsdVertexDescriptor const &vdesc, float *gradient,
+                                int primVarOffset, int primVarWidth,
+                                int vertexOffset, int tableOffset,
+                                int start, int end,
+                                const unsigned int *editIndices);
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OSD_CPU_ADJOINT_KERNEL_H
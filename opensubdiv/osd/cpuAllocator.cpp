@@ -0,0 +1,317 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+//
+
+#include "../osd/cpuAllocator.h"
+#include "../osd/cpuNuma.h"
+
+#if defined(_WIN32)
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+    #include <malloc.h>
+#elif defined(__linux__)
+    #include <sys/mman.h>
+#endif
+
+#include <cassert>
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+// Blocks smaller than this are allocated from the heap : they span too few
+// pages for their placement or their page size to matter
+static const size_t kPageAllocationThreshold = 64*1024;
+
+static const size_t kHugePageSize = 2*1024*1024;
+
+static void *
+alignedAlloc(size_t size) {
+
+#if defined(_WIN32)
+    return _aligned_malloc(size ? size : 1, OsdCpuAllocator::kAlignment);
+#else
+    void * ptr = 0;
+    if (posix_memalign(&ptr, OsdCpuAllocator::kAlignment, size ? size : 1))
+        return 0;
+    return ptr;
+#endif
+}
+
+static void
+alignedFree(void * ptr) {
+
+#if defined(_WIN32)
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+// Maps "size" bytes of pages that have not been touched yet
+static void *
+mapPages(size_t size, OsdCpuPoolAllocator::HugePages hugePages) {
+
+#if defined(_WIN32)
+    (void)hugePages;
+    return VirtualAlloc(NULL, size, MEM_RESERVE|MEM_COMMIT, PAGE_READWRITE);
+#elif defined(__linux__)
+    void * ptr = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    if (hugePages==OsdCpuPoolAllocator::kHugePagesExplicit and (size % kHugePageSize)==0) {
+        ptr = mmap(NULL, size, PROT_READ|PROT_WRITE,
+                   MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+        // the reserved pool may be exhausted : fall back to regular pages
+        if (ptr!=MAP_FAILED)
+            return ptr;
+    }
+#endif
+
+    if (hugePages==OsdCpuPoolAllocator::kHugePagesTransparent and size>=kHugePageSize) {
+        // over-allocate so that the block can start on a huge page boundary,
+        // then unmap the unused head and tail
+        size_t mapped = size + kHugePageSize;
+        ptr = mmap(NULL, mapped, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+        if (ptr==MAP_FAILED)
+            return 0;
+
+        uintptr_t start = (uintptr_t)ptr,
+                  aligned = (start + kHugePageSize - 1) & ~(uintptr_t)(kHugePageSize - 1);
+        if (aligned > start)
+            munmap(ptr, aligned - start);
+        if (aligned + size < start + mapped)
+            munmap((void *)(aligned + size), start + mapped - (aligned + size));
+        ptr = (void *)aligned;
+#ifdef MADV_HUGEPAGE
+        madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+        return ptr;
+    }
+
+    ptr = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    return ptr==MAP_FAILED ? 0 : ptr;
+#else
+    (void)hugePages;
+    return alignedAlloc(size);
+#endif
+}
+
+static void
+unmapPages(void * ptr, size_t size) {
+
+#if defined(_WIN32)
+    (void)size;
+    VirtualFree(ptr, 0, MEM_RELEASE);
+#elif defined(__linux__)
+    munmap(ptr, size);
+#else
+    (void)size;
+    alignedFree(ptr);
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+OsdCpuAllocator *&
+OsdCpuAllocator::getCurrent() {
+
+    static OsdCpuAllocator * current = 0;
+    return current;
+}
+
+void
+OsdCpuAllocator::SetCurrent(OsdCpuAllocator * allocator) {
+
+    getCurrent() = allocator;
+}
+
+OsdCpuAllocator *
+OsdCpuAllocator::GetCurrent() {
+
+    static OsdCpuDefaultAllocator defaultAllocator;
+
+    OsdCpuAllocator * current = getCurrent();
+    return current ? current : &defaultAllocator;
+}
+
+// ----------------------------------------------------------------------------
+
+void *
+OsdCpuDefaultAllocator::Allocate(size_t size, bool readOnly) {
+
+    if (size < kPageAllocationThreshold)
+        return alignedAlloc(size);
+
+    void * ptr = mapPages(size, OsdCpuPoolAllocator::kHugePagesNone);
+    if (ptr)
+        OsdCpuNuma::Bind(ptr, size, readOnly);
+    return ptr;
+}
+
+void
+OsdCpuDefaultAllocator::Free(void * ptr, size_t size) {
+
+    if (not ptr)
+        return;
+
+    if (size < kPageAllocationThreshold) {
+        alignedFree(ptr);
+    } else {
+        unmapPages(ptr, size);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+OsdCpuPoolAllocator::OsdCpuPoolAllocator(HugePages hugePages, size_t maxPooledBytes) :
+    _hugePages(hugePages), _maxPooledBytes(maxPooledBytes), _pooledBytes(0),
+    _allocatedBytes(0), _numHits(0), _numMisses(0) {
+}
+
+OsdCpuPoolAllocator::~OsdCpuPoolAllocator() {
+
+    assert(_blocks.empty());
+    Trim();
+}
+
+size_t
+OsdCpuPoolAllocator::getBlockSize(size_t size) const {
+
+    if (size <= 4096)
+        return size ? (size + kAlignment - 1) & ~(size_t)(kAlignment - 1) : kAlignment;
+
+    // classes are spaced by 1/8th of the power of 2 below the size
+    size_t msb = 4096;
+    while ((msb << 1) <= size)
+        msb <<= 1;
+    size_t step = msb >> 3;
+    size_t blockSize = (size + step - 1) & ~(step - 1);
+
+    if (_hugePages!=kHugePagesNone and blockSize>=kHugePageSize)
+        blockSize = (blockSize + kHugePageSize - 1) & ~(kHugePageSize - 1);
+
+    return blockSize;
+}
+
+void *
+OsdCpuPoolAllocator::allocateBlock(size_t blockSize, bool readOnly) {
+
+    if (blockSize < kPageAllocationThreshold)
+        return alignedAlloc(blockSize);
+
+    void * ptr = mapPages(blockSize, _hugePages);
+    if (ptr)
+        OsdCpuNuma::Bind(ptr, blockSize, readOnly);
+    return ptr;
+}
+
+void
+OsdCpuPoolAllocator::releaseBlock(void * ptr, size_t blockSize) {
+
+    if (blockSize < kPageAllocationThreshold) {
+        alignedFree(ptr);
+    } else {
+        unmapPages(ptr, blockSize);
+    }
+}
+
+void *
+OsdCpuPoolAllocator::Allocate(size_t size, bool readOnly) {
+
+    size_t blockSize = getBlockSize(size);
+
+    OsdMutex::ScopedLock lock(_mutex);
+
+    Block block;
+    block.size = blockSize;
+    block.readOnly = readOnly;
+
+    void * ptr = 0;
+
+    FreeLists::iterator it = _freeLists.find(FreeListKey(blockSize, readOnly));
+    if (it!=_freeLists.end() and not it->second.empty()) {
+        ptr = it->second.back();
+        it->second.pop_back();
+        _pooledBytes -= blockSize;
+        ++_numHits;
+    } else {
+        ptr = allocateBlock(blockSize, readOnly);
+        if (not ptr)
+            return 0;
+        ++_numMisses;
+    }
+
+    _blocks[ptr] = block;
+    _allocatedBytes += blockSize;
+    return ptr;
+}
+
+void
+OsdCpuPoolAllocator::Free(void * ptr, size_t size) {
+
+    if (not ptr)
+        return;
+
+    OsdMutex::ScopedLock lock(_mutex);
+
+    std::map<void *, Block>::iterator it = _blocks.find(ptr);
+    assert(it!=_blocks.end() and it->second.size==getBlockSize(size));
+    if (it==_blocks.end())
+        return;
+
+    Block block = it->second;
+    _blocks.erase(it);
+    _allocatedBytes -= block.size;
+
+    if (_pooledBytes + block.size <= _maxPooledBytes) {
+        _freeLists[FreeListKey(block.size, block.readOnly)].push_back(ptr);
+        _pooledBytes += block.size;
+    } else {
+        releaseBlock(ptr, block.size);
+    }
+}
+
+void
+OsdCpuPoolAllocator::Trim() {
+
+    OsdMutex::ScopedLock lock(_mutex);
+
+    for (FreeLists::iterator it=_freeLists.begin(); it!=_freeLists.end(); ++it) {
+        for (int i=0; i<(int)it->second.size(); ++i) {
+            releaseBlock(it->second[i], it->first.first);
+        }
+    }
+    _freeLists.clear();
+    _pooledBytes = 0;
+}
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
@@ -0,0 +1,198 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+//
+#ifndef OSD_CPU_ALLOCATOR_H
+#define OSD_CPU_ALLOCATOR_H
+
+#include "../version.h"
+
+#include "../osd/mutex.h"
+
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+/// \brief Allocator hook for the storage of the CPU vertex buffers and tables.
+///
+/// OsdCpuVertexBuffer and OsdCpuTable request their storage from the current
+/// allocator when they are created, and return it to that same allocator when
+/// they are destroyed. Every block handed out is aligned on kAlignment bytes.
+///
+/// The allocator installed with SetCurrent() must outlive all the buffers and
+/// tables created while it is current.
+///
+class OsdCpuAllocator {
+public:
+    /// Alignment in bytes of the blocks returned by Allocate (one cache line)
+    enum { kAlignment = 64 };
+
+    /// Destructor
+    virtual ~OsdCpuAllocator() { }
+
+    /// Returns a block of at least "size" bytes aligned on kAlignment
+    ///
+    /// @param size      the size of the block in bytes
+    ///
+    /// @param readOnly  true if the block holds tables that are written once
+    ///                  and then shared by all the threads
+    ///
+    virtual void * Allocate(size_t size, bool readOnly) = 0;
+
+    /// Releases a block returned by Allocate
+    ///
+    /// @param ptr   the block
+    ///
+    /// @param size  the size that was passed to Allocate
+    ///
+    virtual void Free(void * ptr, size_t size) = 0;
+
+    /// Installs the allocator used by the buffers and tables created after the
+    /// call (0 restores the default allocator)
+    static void SetCurrent(OsdCpuAllocator * allocator);
+
+    /// Returns the current allocator (never NULL)
+    static OsdCpuAllocator * GetCurrent();
+
+private:
+    static OsdCpuAllocator *& getCurrent();
+};
+
+/// \brief Default allocator : aligned heap blocks for small requests, and
+/// pages placed according to the OsdCpuNuma policy for large ones.
+///
+class OsdCpuDefaultAllocator : public OsdCpuAllocator {
+public:
+    virtual void * Allocate(size_t size, bool readOnly);
+
+    virtual void Free(void * ptr, size_t size);
+};
+
+/// \brief Pooling allocator with optional huge pages.
+///
+/// Released blocks are kept in free lists keyed by size class (sizes are
+/// rounded up by at most 1/8th) and handed out again to later requests of the
+/// same class, so that creating and destroying buffers of similar sizes for
+/// every asset does not go back to the operating system.
+///
+/// Large blocks can be backed by 2MB pages to reduce the TLB misses of the
+/// kernels gathering from multi-GB buffers :
+///
+/// - kHugePagesTransparent : the blocks are aligned on 2MB and flagged with
+///                           madvise(MADV_HUGEPAGE)
+///
+/// - kHugePagesExplicit    : the blocks are mapped from the pre-reserved pool
+///                           of the system (MAP_HUGETLB), falling back to
+///                           regular pages when it is exhausted
+///
+/// Pooled blocks keep the NUMA placement of their first use. Huge pages are
+/// only supported on Linux. The allocator is thread-safe.
+///
+class OsdCpuPoolAllocator : public OsdCpuAllocator {
+public:
+    enum HugePages {
+        kHugePagesNone=0,
+        kHugePagesTransparent,
+        kHugePagesExplicit
+    };
+
+    /// Constructor
+    ///
+    /// @param hugePages       huge pages backing of the large blocks
+    ///
+    /// @param maxPooledBytes  released blocks beyond this total are returned
+    ///                        to the system instead of being pooled
+    ///
+    explicit OsdCpuPoolAllocator(HugePages hugePages=kHugePagesNone,
+                                 size_t maxPooledBytes=256*1024*1024);
+
+    /// Destructor : returns the pooled blocks to the system. All the blocks
+    /// handed out must have been released first.
+    virtual ~OsdCpuPoolAllocator();
+
+    virtual void * Allocate(size_t size, bool readOnly);
+
+    virtual void Free(void * ptr, size_t size);
+
+    /// Returns all the pooled blocks to the system
+    void Trim();
+
+    /// Returns the huge pages backing of the large blocks
+    HugePages GetHugePages() const { return _hugePages; }
+
+    /// Returns the number of bytes held in the free lists
+    size_t GetPooledBytes() const { return _pooledBytes; }
+
+    /// Returns the number of bytes currently handed out (rounded up to the
+    /// size classes)
+    size_t GetAllocatedBytes() const { return _allocatedBytes; }
+
+    /// Returns the number of requests served from the free lists
+    int GetNumHits() const { return _numHits; }
+
+    /// Returns the number of requests that allocated a new block
+    int GetNumMisses() const { return _numMisses; }
+
+private:
+    // size class of a request
+    size_t getBlockSize(size_t size) const;
+
+    void * allocateBlock(size_t blockSize, bool readOnly);
+
+    void releaseBlock(void * ptr, size_t blockSize);
+
+    struct Block {
+        size_t size;
+        bool   readOnly;
+    };
+
+    typedef std::pair<size_t, bool> FreeListKey;  // (size, readOnly)
+
+    typedef std::map<FreeListKey, std::vector<void *> > FreeLists;
+
+    HugePages _hugePages;
+
+    size_t _maxPooledBytes,
+           _pooledBytes,
+           _allocatedBytes;
+
+    int _numHits,
+        _numMisses;
+
+    FreeLists _freeLists;
+
+    std::map<void *, Block> _blocks;  // blocks currently handed out
+
+    OsdMutex _mutex;
+};
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OSD_CPU_ALLOCATOR_H
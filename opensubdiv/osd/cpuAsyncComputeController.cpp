@@ -0,0 +1,218 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+
+#include "../osd/cpuAsyncComputeController.h"
+#include "../osd/cpuComputeController.h"
+#include "../osd/cpuVertexBuffer.h"
+
+#include <algorithm>
+#include <cassert>
+
+#if defined(_WIN32)
+    #include <process.h>
+#endif
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+OsdCpuRefineHandle::OsdCpuRefineHandle() :
+    _complete(false) {
+}
+
+OsdCpuRefineHandle::~OsdCpuRefineHandle() {
+
+    Wait();
+}
+
+bool
+OsdCpuRefineHandle::IsComplete() const {
+
+    OsdMutex::ScopedLock lock(_mutex);
+    return _complete;
+}
+
+void
+OsdCpuRefineHandle::Wait() const {
+
+    OsdMutex::ScopedLock lock(_mutex);
+    while (not _complete)
+        _completed.Wait(_mutex);
+}
+
+void
+OsdCpuRefineHandle::signal() {
+
+    OsdMutex::ScopedLock lock(_mutex);
+    _complete = true;
+    _completed.Broadcast();
+}
+
+// ----------------------------------------------------------------------------
+
+OsdCpuAsyncComputeController::OsdCpuAsyncComputeController(int numThreads) :
+    _numPending(0), _quit(false) {
+
+    numThreads = std::max(numThreads, 1);
+
+    _threads.reserve(numThreads);
+    for (int i = 0; i < numThreads; ++i) {
+#if defined(_WIN32)
+        HANDLE thread = (HANDLE)_beginthreadex(0, 0, threadMain, this, 0, 0);
+        if (thread == 0)
+            break;
+#else
+        pthread_t thread;
+        if (pthread_create(&thread, 0, threadMain, this) != 0)
+            break;
+#endif
+        _threads.push_back(thread);
+    }
+    assert(not _threads.empty());
+}
+
+OsdCpuAsyncComputeController::~OsdCpuAsyncComputeController() {
+
+    Synchronize();
+
+    {
+        OsdMutex::ScopedLock lock(_mutex);
+        _quit = true;
+        _requestsChanged.Broadcast();
+    }
+
+    for (int i = 0; i < (int)_threads.size(); ++i) {
+#if defined(_WIN32)
+        WaitForSingleObject(_threads[i], INFINITE);
+        CloseHandle(_threads[i]);
+#else
+        pthread_join(_threads[i], 0);
+#endif
+    }
+}
+
+#if defined(_WIN32)
+unsigned __stdcall
+OsdCpuAsyncComputeController::threadMain(void * controller) {
+
+    static_cast<OsdCpuAsyncComputeController *>(controller)->work();
+    return 0;
+}
+#else
+void *
+OsdCpuAsyncComputeController::threadMain(void * controller) {
+
+    static_cast<OsdCpuAsyncComputeController *>(controller)->work();
+    return 0;
+}
+#endif
+
+OsdCpuRefineHandle *
+OsdCpuAsyncComputeController::enqueue(OsdCpuComputeContext *context,
+                                      FarKernelBatchVector const & batches,
+                                      float *vertex, int numVertexElements,
+                                      float *varying, int numVaryingElements) {
+
+    assert(context);
+
+    Request request;
+    request.context = context;
+    request.batches = &batches;
+    request.vertex = vertex;
+    request.varying = varying;
+    request.numVertexElements = numVertexElements;
+    request.numVaryingElements = numVaryingElements;
+    request.handle = new OsdCpuRefineHandle;
+
+    OsdMutex::ScopedLock lock(_mutex);
+    _requests.push_back(request);
+    ++_numPending;
+    _requestsChanged.Broadcast();
+
+    return request.handle;
+}
+
+void
+OsdCpuAsyncComputeController::Synchronize() {
+
+    OsdMutex::ScopedLock lock(_mutex);
+    while (_numPending > 0)
+        _idle.Wait(_mutex);
+}
+
+void
+OsdCpuAsyncComputeController::work() {
+
+    OsdMutex::ScopedLock lock(_mutex);
+
+    for (;;) {
+        // first request on a context that is not being refined
+        std::deque<Request>::iterator it = _requests.begin();
+        for (; it != _requests.end(); ++it) {
+            if (std::find(_busyContexts.begin(), _busyContexts.end(),
+                          it->context) == _busyContexts.end())
+                break;
+        }
+
+        if (it == _requests.end()) {
+            if (_quit)
+                break;
+            _requestsChanged.Wait(_mutex);
+            continue;
+        }
+
+        Request request = *it;
+        _requests.erase(it);
+        _busyContexts.push_back(request.context);
+
+        _mutex.Unlock();
+        execute(request);
+        request.handle->signal();
+        _mutex.Lock();
+
+        _busyContexts.erase(std::find(_busyContexts.begin(),
+                                      _busyContexts.end(), request.context));
+
+        // requests on the released context may now run
+        _requestsChanged.Broadcast();
+
+        if (--_numPending == 0)
+            _idle.Broadcast();
+    }
+}
+
+void
+OsdCpuAsyncComputeController::execute(Request const & request) {
+
+    OsdCpuBoundBuffer vertex(request.vertex, request.numVertexElements),
+                      varying(request.varying, request.numVaryingElements);
+
+    OsdCpuComputeController controller;
+    controller.Refine(request.context,
+                      *request.batches,
+                      request.vertex ? &vertex : 0,
+                      request.varying ? &varying : 0);
+}
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
@@ -0,0 +1,233 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+
+#ifndef OSD_CPU_ASYNC_COMPUTE_CONTROLLER_H
+#define OSD_CPU_ASYNC_COMPUTE_CONTROLLER_H
+
+#include "../version.h"
+
+#include "../far/kernelBatch.h"
+#include "../osd/cpuComputeContext.h"
+#include "../osd/mutex.h"
+#include "../osd/nonCopyable.h"
+
+#include <deque>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+/// \brief Completion handle of an asynchronous refinement.
+///
+/// Handles are returned by OsdCpuAsyncComputeController::RefineAsync and
+/// must be deleted by the caller. Deleting a handle waits for the completion
+/// of its refinement.
+///
+class OsdCpuRefineHandle : OsdNonCopyable<OsdCpuRefineHandle> {
+public:
+    /// Destructor (waits for the completion of the refinement)
+    ~OsdCpuRefineHandle();
+
+    /// Returns true if the refinement has completed
+    bool IsComplete() const;
+
+    /// Blocks until the refinement has completed
+    void Wait() const;
+
+private:
+    friend class OsdCpuAsyncComputeController;
+
+    OsdCpuRefineHandle();
+
+    void signal();
+
+    mutable OsdMutex _mutex;
+    mutable OsdCondition _completed;
+    bool _complete;
+};
+
+/// \brief Compute controller refining CPU vertex buffers on background threads.
+///
+/// OsdCpuAsyncComputeController enqueues refinement requests onto a pool of
+/// worker threads and returns immediately, so that the refinement of the
+/// next frame can overlap with the consumers reading the previous one (see
+/// OsdDoubleBuffer). Each request is executed by a single-threaded CPU
+/// controller : requests on different contexts run concurrently, requests on
+/// the same context run one after the other, in submission order.
+///
+/// The vertex buffers are bound when the request is enqueued. The context,
+/// the batches and the buffers must remain valid, and the buffers must not
+/// be accessed, until the refinement has completed. The FarKernelBatchObserver
+/// attached to a context is notified, and its OsdCpuPatchBounds refreshed, from
+/// the worker threads, one request at a time.
+///
+class OsdCpuAsyncComputeController : OsdNonCopyable<OsdCpuAsyncComputeController> {
+public:
+    typedef OsdCpuComputeContext ComputeContext;
+
+    /// Constructor.
+    ///
+    /// @param numThreads  the number of worker threads of the pool
+    ///
+    explicit OsdCpuAsyncComputeController(int numThreads=1);
+
+    /// Destructor (waits for the pending refinements).
+    ~OsdCpuAsyncComputeController();
+
+    /// Enqueues the refinement of the given vertex buffers.
+    ///
+    /// @param  context       the OsdCpuContext to apply refinement operations to
+    ///
+    /// @param  batches       vector of batches of vertices organized by operative 
+    ///                       kernel
+    ///
+    /// @param  vertexBuffer  vertex-interpolated data buffer
+    ///
+    /// @param  varyingBuffer varying-interpolated data buffer
+    ///
+    /// @return               the completion handle (to be deleted by the caller)
+    ///
+    template<class VERTEX_BUFFER, class VARYING_BUFFER>
+    OsdCpuRefineHandle * RefineAsync(OsdCpuComputeContext *context,
+                                     FarKernelBatchVector const & batches,
+                                     VERTEX_BUFFER *vertexBuffer,
+                                     VARYING_BUFFER *varyingBuffer) {
+
+        return enqueue(context, batches,
+                       vertexBuffer ? vertexBuffer->BindCpuBuffer() : 0,
+                       vertexBuffer ? vertexBuffer->GetNumElements() : 0,
+                       varyingBuffer ? varyingBuffer->BindCpuBuffer() : 0,
+                       varyingBuffer ? varyingBuffer->GetNumElements() : 0);
+    }
+
+    /// Enqueues the refinement of the given vertex buffer.
+    ///
+    /// @param  context       the OsdCpuContext to apply refinement operations to
+    ///
+    /// @param  batches       vector of batches of vertices organized by operative 
+    ///                       kernel
+    ///
+    /// @param  vertexBuffer  vertex-interpolated data buffer
+    ///
+    /// @return               the completion handle (to be deleted by the caller)
+    ///
+    template<class VERTEX_BUFFER>
+    OsdCpuRefineHandle * RefineAsync(OsdCpuComputeContext *context,
+                                     FarKernelBatchVector const & batches,
+                                     VERTEX_BUFFER *vertexBuffer) {
+        return RefineAsync(context, batches, vertexBuffer, (VERTEX_BUFFER*)0);
+    }
+
+    /// Launch subdivision kernels and apply to given vertex buffers, waiting
+    /// for their completion.
+    ///
+    /// @param  context       the OsdCpuContext to apply refinement operations to
+    ///
+    /// @param  batches       vector of batches of vertices organized by operative 
+    ///                       kernel
+    ///
+    /// @param  vertexBuffer  vertex-interpolated data buffer
+    ///
+    /// @param  varyingBuffer varying-interpolated data buffer
+    ///
+    template<class VERTEX_BUFFER, class VARYING_BUFFER>
+    void Refine(OsdCpuComputeContext *context,
+                FarKernelBatchVector const & batches,
+                VERTEX_BUFFER *vertexBuffer,
+                VARYING_BUFFER *varyingBuffer) {
+
+        delete RefineAsync(context, batches, vertexBuffer, varyingBuffer);
+    }
+
+    /// Launch subdivision kernels and apply to given vertex buffers, waiting
+    /// for their completion.
+    ///
+    /// @param  context       the OsdCpuContext to apply refinement operations to
+    ///
+    /// @param  batches       vector of batches of vertices organized by operative 
+    ///                       kernel
+    ///
+    /// @param  vertexBuffer  vertex-interpolated data buffer
+    ///
+    template<class VERTEX_BUFFER>
+    void Refine(OsdCpuComputeContext *context,
+                FarKernelBatchVector const & batches,
+                VERTEX_BUFFER *vertexBuffer) {
+        Refine(context, batches, vertexBuffer, (VERTEX_BUFFER*)0);
+    }
+
+    /// Waits until all the enqueued refinements have completed.
+    void Synchronize();
+
+    /// Returns the number of worker threads
+    int GetNumThreads() const { return (int)_threads.size(); }
+
+private:
+    struct Request {
+        OsdCpuComputeContext * context;
+        FarKernelBatchVector const * batches;
+        float * vertex,
+              * varying;
+        int numVertexElements,
+            numVaryingElements;
+        OsdCpuRefineHandle * handle;
+    };
+
+    OsdCpuRefineHandle * enqueue(OsdCpuComputeContext *context,
+                                 FarKernelBatchVector const & batches,
+                                 float *vertex, int numVertexElements,
+                                 float *varying, int numVaryingElements);
+
+    // Executes the requests until the controller is destroyed
+    void work();
+
+    // Refines a request with a single-threaded CPU controller
+    static void execute(Request const & request);
+
+#if defined(_WIN32)
+    static unsigned __stdcall threadMain(void * controller);
+
+    std::vector<HANDLE> _threads;
+#else
+    static void * threadMain(void * controller);
+
+    std::vector<pthread_t> _threads;
+#endif
+
+    OsdMutex _mutex;
+    OsdCondition _requestsChanged,   // a request was enqueued or a context released
+                 _idle;              // all the requests have completed
+
+    std::deque<Request> _requests;   // requests waiting for a worker
+    std::vector<OsdCpuComputeContext const *> _busyContexts; // contexts being refined
+    int _numPending;                 // requests enqueued and not completed
+    bool _quit;
+};
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OSD_CPU_ASYNC_COMPUTE_CONTROLLER_H
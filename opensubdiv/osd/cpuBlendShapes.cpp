@@ -0,0 +1,225 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+//
+
+#include "../osd/cpuBlendShapes.h"
+#include "../far/subdivisionMatrix.h"
+
+#include <cassert>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #include <xmmintrin.h>
+    #define OSD_BLEND_SHAPES_SSE
+#endif
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+OsdCpuBlendShapes *
+OsdCpuBlendShapes::Create(FarMesh<OsdVertex> const * farmesh,
+                          int numElements, int numShapes,
+                          int const * offsets, int const * vertices,
+                          float const * deltas) {
+
+    if (not farmesh or numElements <= 0 or numShapes <= 0 or not offsets)
+        return NULL;
+
+    return new OsdCpuBlendShapes(farmesh, numElements, numShapes, offsets,
+                                 vertices, deltas);
+}
+
+OsdCpuBlendShapes::OsdCpuBlendShapes(FarMesh<OsdVertex> const * farmesh,
+                                     int numElements, int numShapes,
+                                     int const * offsets,
+                                     int const * vertices,
+                                     float const * deltas) :
+    _numElements(numElements),
+    _numShapes(numShapes),
+    _deltaStride((numElements+3) & ~3) {
+
+    FarSubdivisionMatrix matrix(*farmesh);
+
+    int nrows = matrix.GetNumRows(),
+        ncols = matrix.GetNumColumns();
+
+    // transpose the matrix : the refined vertices influenced by each coarse
+    // vertex
+    std::vector<int> colOffsets(ncols+1, 0), colRows(matrix.GetNumNonZeros());
+    std::vector<float> colWeights(matrix.GetNumNonZeros());
+
+    std::vector<int> const & rowOffsets = matrix.GetOffsets(),
+                           & rowIndices = matrix.GetIndices();
+    std::vector<float> const & rowWeights = matrix.GetWeights();
+
+    for (int j = 0; j < matrix.GetNumNonZeros(); ++j)
+        ++colOffsets[rowIndices[j]+1];
+    for (int i = 0; i < ncols; ++i)
+        colOffsets[i+1] += colOffsets[i];
+
+    std::vector<int> fill(colOffsets.begin(), colOffsets.end()-1);
+    for (int i = 0; i < nrows; ++i) {
+        for (int j = rowOffsets[i]; j < rowOffsets[i+1]; ++j) {
+            int k = fill[rowIndices[j]]++;
+            colRows[k] = i;
+            colWeights[k] = rowWeights[j];
+        }
+    }
+
+    // refine the deltas of each shape into a sparse accumulator
+    std::vector<int>   entryRows, entryShapes, marks(nrows, -1), touched;
+    std::vector<float> entryDeltas, accum(nrows*numElements);
+
+    for (int s = 0; s < numShapes; ++s) {
+
+        for (int v = offsets[s]; v < offsets[s+1]; ++v) {
+
+            int col = vertices[v];
+            assert(col >= 0 and col < ncols);
+
+            float const * d = deltas + v*numElements;
+
+            for (int j = colOffsets[col]; j < colOffsets[col+1]; ++j) {
+                int row = colRows[j];
+                float * dst = &accum[row*numElements];
+                if (marks[row] != s) {
+                    marks[row] = s;
+                    touched.push_back(row);
+                    for (int k = 0; k < numElements; ++k)
+                        dst[k] = 0.0f;
+                }
+                for (int k = 0; k < numElements; ++k)
+                    dst[k] += colWeights[j] * d[k];
+            }
+        }
+
+        for (int i = 0; i < (int)touched.size(); ++i) {
+            float const * src = &accum[touched[i]*numElements];
+
+            bool zero = true;
+            for (int k = 0; k < numElements; ++k)
+                zero = zero and src[k] == 0.0f;
+            if (zero)
+                continue;
+
+            entryRows.push_back(touched[i]);
+            entryShapes.push_back(s);
+            entryDeltas.insert(entryDeltas.end(), src, src + numElements);
+        }
+        touched.clear();
+    }
+
+    // sort the deltas by vertex
+    std::vector<int> rowCounts(nrows+1, 0);
+    for (int i = 0; i < (int)entryRows.size(); ++i)
+        ++rowCounts[entryRows[i]+1];
+
+    std::vector<int> rowSlots(nrows, -1);
+    _offsets.push_back(0);
+    for (int i = 0; i < nrows; ++i) {
+        if (rowCounts[i+1] == 0)
+            continue;
+        rowSlots[i] = _offsets.back();
+        _vertices.push_back(i);
+        _offsets.push_back(_offsets.back() + rowCounts[i+1]);
+    }
+
+    _shapes.resize(entryRows.size());
+    _deltas.resize(entryRows.size()*_deltaStride, 0.0f);
+
+    // the shapes of a vertex stay in ascending order
+    for (int i = 0; i < (int)entryRows.size(); ++i) {
+        int slot = rowSlots[entryRows[i]]++;
+        _shapes[slot] = entryShapes[i];
+        for (int k = 0; k < numElements; ++k)
+            _deltas[slot*_deltaStride+k] = entryDeltas[i*numElements+k];
+    }
+}
+
+OsdCpuBlendShapes::~OsdCpuBlendShapes() {
+}
+
+void
+OsdCpuBlendShapes::Apply(float const * weights, float * vertices, int stride) const {
+
+    assert(weights and vertices and stride >= _numElements);
+
+    int nverts = GetNumVertices();
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for
+#endif
+    for (int i = 0; i < nverts; ++i) {
+
+        float * dst = vertices + _vertices[i]*stride;
+
+        int first = _offsets[i],
+            last = _offsets[i+1];
+
+        for (int c = 0; c < _deltaStride; c += 4) {
+
+            float sum[4];
+
+#ifdef OSD_BLEND_SHAPES_SSE
+            __m128 r = _mm_setzero_ps();
+
+            for (int j = first; j < last; ++j) {
+                float w = weights[_shapes[j]];
+                if (w == 0.0f)
+                    continue;
+                r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(w),
+                                             _mm_loadu_ps(&_deltas[j*_deltaStride+c])));
+            }
+            _mm_storeu_ps(sum, r);
+#else
+            sum[0] = sum[1] = sum[2] = sum[3] = 0.0f;
+
+            for (int j = first; j < last; ++j) {
+                float w = weights[_shapes[j]];
+                if (w == 0.0f)
+                    continue;
+                float const * d = &_deltas[j*_deltaStride+c];
+                for (int k = 0; k < 4; ++k)
+                    sum[k] += w * d[k];
+            }
+#endif
+
+            for (int k = c; k < c+4 and k < _numElements; ++k)
+                dst[k] += sum[k-c];
+        }
+    }
+}
+
+FarMemoryUsage
+OsdCpuBlendShapes::GetMemoryUsage() const {
+
+    FarMemoryUsage result;
+    result.AddVector("vertices", _vertices);
+    result.AddVector("offsets", _offsets);
+    result.AddVector("shapes", _shapes);
+    result.AddVector("deltas", _deltas);
+    return result;
+}
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
@@ -0,0 +1,148 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+//
+#ifndef OSD_CPU_BLEND_SHAPES_H
+#define OSD_CPU_BLEND_SHAPES_H
+
+#include "../version.h"
+
+#include "../far/mesh.h"
+#include "../far/memoryUsage.h"
+#include "../osd/nonCopyable.h"
+#include "../osd/vertex.h"
+
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+/// \brief Blend shapes applied directly to the refined vertices.
+///
+/// Refinement is linear : a blend shape (a set of deltas on the coarse
+/// vertices) moves the refined vertices by the refinement of its deltas.
+/// OsdCpuBlendShapes refines the deltas of every shape once (see
+/// FarSubdivisionMatrix) and keeps only the refined vertices each shape
+/// influences. At runtime, the weighted deltas are added straight into a
+/// refined vertex buffer, so that animation driven only by shape weights
+/// does not need to run the subdivision kernels : refine the neutral cage
+/// once, then copy the refined neutral pose into the vertex buffer and Apply
+/// the weights of each frame.
+///
+/// The refined deltas are stored per vertex, so that the vertices can be
+/// blended concurrently (with OpenMP) and the deltas of a vertex summed with
+/// SSE.
+///
+/// Note : the deltas of the coarse vertices are included (the coarse vertices
+/// are part of the vertex buffer). Hierarchical edits do not change the
+/// deltas, except for "set" edits which are not accounted for.
+///
+class OsdCpuBlendShapes : OsdNonCopyable<OsdCpuBlendShapes> {
+public:
+    /// Refines a set of blend shapes
+    ///
+    /// @param farmesh      the FarMesh the vertex buffers are refined with
+    ///
+    /// @param numElements  the number of floats of the deltas (the first
+    ///                     numElements elements of each vertex are blended)
+    ///
+    /// @param numShapes    the number of blend shapes
+    ///
+    /// @param offsets      the CSR offsets of the deltas of the shapes
+    ///                     (numShapes+1) : the coarse vertices moved by shape
+    ///                     s are found in the range [offsets[s], offsets[s+1])
+    ///                     of the vertices array
+    ///
+    /// @param vertices     the indices of the coarse vertices moved by the
+    ///                     shapes
+    ///
+    /// @param deltas       numElements floats per entry of the vertices array
+    ///
+    static OsdCpuBlendShapes * Create(FarMesh<OsdVertex> const * farmesh,
+                                      int numElements, int numShapes,
+                                      int const * offsets,
+                                      int const * vertices,
+                                      float const * deltas);
+
+    /// Destructor
+    ~OsdCpuBlendShapes();
+
+    /// Returns the number of blend shapes
+    int GetNumShapes() const { return _numShapes; }
+
+    /// Returns the number of floats of the deltas
+    int GetNumElements() const { return _numElements; }
+
+    /// Returns the number of vertices influenced by at least one shape
+    int GetNumVertices() const { return (int)_vertices.size(); }
+
+    /// Returns the number of refined deltas stored for all the shapes
+    int GetNumDeltas() const { return (int)_shapes.size(); }
+
+    /// Adds the weighted deltas of the shapes to a refined vertex buffer
+    ///
+    /// @param weights       numShapes weights (shapes of weight 0 are skipped)
+    ///
+    /// @param vertexBuffer  vertex buffer holding the refined vertices
+    ///
+    template<class VERTEX_BUFFER>
+    void Apply(float const * weights, VERTEX_BUFFER * vertexBuffer) const {
+        Apply(weights, vertexBuffer->BindCpuBuffer(), vertexBuffer->GetNumElements());
+    }
+
+    /// Adds the weighted deltas of the shapes to refined vertices
+    ///
+    /// @param weights   numShapes weights (shapes of weight 0 are skipped)
+    ///
+    /// @param vertices  the refined vertices
+    ///
+    /// @param stride    the number of floats per vertex (at least numElements)
+    ///
+    void Apply(float const * weights, float * vertices, int stride) const;
+
+    /// Returns the itemized memory allocated by the shapes
+    FarMemoryUsage GetMemoryUsage() const;
+
+protected:
+    OsdCpuBlendShapes(FarMesh<OsdVertex> const * farmesh,
+                      int numElements, int numShapes, int const * offsets,
+                      int const * vertices, float const * deltas);
+
+private:
+    int _numElements,
+        _numShapes,
+        _deltaStride;  // numElements padded to a multiple of 4
+
+    std::vector<int>   _vertices, // refined vertices influenced by the shapes
+                       _offsets,  // CSR deltas of each vertex
+                       _shapes;   // shape of each delta
+
+    std::vector<float> _deltas;   // _deltaStride floats per delta
+};
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OSD_CPU_BLEND_SHAPES_H
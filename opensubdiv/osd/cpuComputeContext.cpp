@@ -30,6 +30,7 @@
 
 #include "../osd/cpuComputeContext.h"
 #include "../osd/cpuKernel.h"
+#include "../osd/cpuAllocator.h"
 #include "../osd/vertexDescriptor.h"
 #include "../osd/error.h"
 
@@ -41,14 +42,16 @@ namespace OPENSUBDIV_VERSION {
 void
 OsdCpuTable::createCpuBuffer(size_t size, const void *ptr) {
 
-    _devicePtr = new unsigned char[size];
-    memcpy(_devicePtr, ptr, size);
+    _allocator = OsdCpuAllocator::GetCurrent();
+    _devicePtr = _allocator->Allocate(size, /*readOnly=*/true);
+    if (_devicePtr)
+        memcpy(_devicePtr, ptr, size);
 }
 
 OsdCpuTable::~OsdCpuTable() {
 
-    if (_devicePtr) 
-        delete [] (unsigned char *)_devicePtr;
+    if (_devicePtr and _ownsBuffer)
+        _allocator->Free(_devicePtr, _size);
 }
 
 void *
@@ -57,12 +60,36 @@ OsdCpuTable::GetBuffer() const {
     return _devicePtr;
 }
 
+bool
+OsdCpuTable::OwnsBuffer() const {
+
+    return _ownsBuffer;
+}
+
+size_t
+OsdCpuTable::GetSize() const {
+
+    return _size;
+}
+
+size_t
+OsdCpuTable::GetMemoryUsed() const {
+
+    return _ownsBuffer ? _size : 0;
+}
+
+bool
+OsdCpuTable::IsAllocated() const {
+
+    return _devicePtr or _size==0;
+}
+
 // ----------------------------------------------------------------------------
 
 OsdCpuHEditTable::OsdCpuHEditTable(
-    const FarVertexEditTables<OsdVertex>::VertexEditBatch &batch)
-    : _primvarIndicesTable(new OsdCpuTable(batch.GetVertexIndices())),
-      _editValuesTable(new OsdCpuTable(batch.GetValues())) {
+    const FarVertexEditTables<OsdVertex>::VertexEditBatch &batch, bool reference)
+    : _primvarIndicesTable(new OsdCpuTable(batch.GetVertexIndices(), reference)),
+      _editValuesTable(new OsdCpuTable(batch.GetValues(), reference)) {
 
     _operation = batch.GetOperation();
     _primvarOffset = batch.GetPrimvarIndex();
@@ -105,7 +132,13 @@ OsdCpuHEditTable::GetPrimvarWidth() const {
     return _primvarWidth;
 }
 
-OsdCpuComputeContext::OsdCpuComputeContext(FarMesh<OsdVertex> const *farMesh) {
+OsdCpuComputeContext::OsdCpuComputeContext(FarMesh<OsdVertex> const *farMesh,
+                                           bool referenceFarTables) :
+    _structuredGrids(0), _structuredGridIndices(0),
+    _limitVertices(0), _limitOffsets(0), _limitIndices(0), _limitWeights(0),
+    _numLimitVertices(0),
+    _endCapOffsets(0), _endCapIndices(0), _endCapWeights(0), _endCapVaryingIndices(0),
+    _deformer(0), _observer(0), _patchBounds(0) {
 
     FarSubdivisionTables<OsdVertex> const * farTables =
         farMesh->GetSubdivisionTables();
@@ -113,15 +146,41 @@ OsdCpuComputeContext::OsdCpuComputeContext(FarMesh<OsdVertex> const *farMesh) {
     // allocate 5 or 7 tables
     _tables.resize(farTables->GetNumTables(), 0);
 
-    _tables[FarSubdivisionTables<OsdVertex>::E_IT]  = new OsdCpuTable(farTables->Get_E_IT());
-    _tables[FarSubdivisionTables<OsdVertex>::V_IT]  = new OsdCpuTable(farTables->Get_V_IT());
-    _tables[FarSubdivisionTables<OsdVertex>::V_ITa] = new OsdCpuTable(farTables->Get_V_ITa());
-    _tables[FarSubdivisionTables<OsdVertex>::E_W]   = new OsdCpuTable(farTables->Get_E_W());
-    _tables[FarSubdivisionTables<OsdVertex>::V_W]   = new OsdCpuTable(farTables->Get_V_W());
+    _tables[FarSubdivisionTables<OsdVertex>::E_IT]  = new OsdCpuTable(farTables->Get_E_IT(), referenceFarTables);
+    _tables[FarSubdivisionTables<OsdVertex>::V_IT]  = new OsdCpuTable(farTables->Get_V_IT(), referenceFarTables);
+    _tables[FarSubdivisionTables<OsdVertex>::V_ITa] = new OsdCpuTable(farTables->Get_V_ITa(), referenceFarTables);
+    _tables[FarSubdivisionTables<OsdVertex>::E_W]   = new OsdCpuTable(farTables->Get_E_W(), referenceFarTables);
+    _tables[FarSubdivisionTables<OsdVertex>::V_W]   = new OsdCpuTable(farTables->Get_V_W(), referenceFarTables);
 
     if (farTables->GetNumTables() > 5) {
-        _tables[FarSubdivisionTables<OsdVertex>::F_IT]  = new OsdCpuTable(farTables->Get_F_IT());
-        _tables[FarSubdivisionTables<OsdVertex>::F_ITa] = new OsdCpuTable(farTables->Get_F_ITa());
+        _tables[FarSubdivisionTables<OsdVertex>::F_IT]  = new OsdCpuTable(farTables->Get_F_IT(), referenceFarTables);
+        _tables[FarSubdivisionTables<OsdVertex>::F_ITa] = new OsdCpuTable(farTables->Get_F_ITa(), referenceFarTables);
+    }
+
+    // create structured grid tables
+    FarStructuredGrids const & grids = farTables->GetStructuredGrids();
+    if (grids.GetNumGrids() > 0) {
+        _structuredGrids = new OsdCpuTable(grids.GetGrids(), referenceFarTables);
+        _structuredGridIndices = new OsdCpuTable(grids.GetIndices(), referenceFarTables);
+    }
+
+    // create limit mask tables
+    FarLimitTables const * limitTables = farMesh->GetLimitTables();
+    if (limitTables and limitTables->GetNumVertices() > 0) {
+        _limitVertices = new OsdCpuTable(limitTables->GetVertices(), referenceFarTables);
+        _limitOffsets = new OsdCpuTable(limitTables->GetOffsets(), referenceFarTables);
+        _limitIndices = new OsdCpuTable(limitTables->GetIndices(), referenceFarTables);
+        _limitWeights = new OsdCpuTable(limitTables->GetWeights(), referenceFarTables);
+        _numLimitVertices = limitTables->GetNumVertices();
+    }
+
+    // create end cap stencil tables
+    FarEndCapTables const * endCapTables = farMesh->GetEndCapTables();
+    if (endCapTables and endCapTables->GetNumVertices() > 0) {
+        _endCapOffsets = new OsdCpuTable(endCapTables->GetOffsets(), referenceFarTables);
+        _endCapIndices = new OsdCpuTable(endCapTables->GetIndices(), referenceFarTables);
+        _endCapWeights = new OsdCpuTable(endCapTables->GetWeights(), referenceFarTables);
+        _endCapVaryingIndices = new OsdCpuTable(endCapTables->GetVaryingIndices(), referenceFarTables);
     }
 
     // create hedit tables
@@ -133,7 +192,7 @@ OsdCpuComputeContext::OsdCpuComputeContext(FarMesh<OsdVertex> const *farMesh) {
             const FarVertexEditTables<OsdVertex>::VertexEditBatch & edit =
                 editTables->GetBatch(i);
 
-            _editTables.push_back(new OsdCpuHEditTable(edit));
+            _editTables.push_back(new OsdCpuHEditTable(edit, referenceFarTables));
         }
     }
     _currentVertexBuffer = 0;
@@ -148,6 +207,16 @@ OsdCpuComputeContext::~OsdCpuComputeContext() {
     for (size_t i = 0; i < _editTables.size(); ++i) {
         delete _editTables[i];
     }
+    delete _structuredGrids;
+    delete _structuredGridIndices;
+    delete _limitVertices;
+    delete _limitOffsets;
+    delete _limitIndices;
+    delete _limitWeights;
+    delete _endCapOffsets;
+    delete _endCapIndices;
+    delete _endCapWeights;
+    delete _endCapVaryingIndices;
 }
 
 const OsdCpuTable *
@@ -168,6 +237,72 @@ OsdCpuComputeContext::GetEditTable(int tableIndex) const {
     return _editTables[tableIndex];
 }
 
+const OsdCpuTable *
+OsdCpuComputeContext::GetStructuredGrids() const {
+
+    return _structuredGrids;
+}
+
+const OsdCpuTable *
+OsdCpuComputeContext::GetStructuredGridIndices() const {
+
+    return _structuredGridIndices;
+}
+
+int
+OsdCpuComputeContext::GetNumLimitVertices() const {
+
+    return _numLimitVertices;
+}
+
+const OsdCpuTable *
+OsdCpuComputeContext::GetLimitVertices() const {
+
+    return _limitVertices;
+}
+
+const OsdCpuTable *
+OsdCpuComputeContext::GetLimitOffsets() const {
+
+    return _limitOffsets;
+}
+
+const OsdCpuTable *
+OsdCpuComputeContext::GetLimitIndices() const {
+
+    return _limitIndices;
+}
+
+const OsdCpuTable *
+OsdCpuComputeContext::GetLimitWeights() const {
+
+    return _limitWeights;
+}
+
+const OsdCpuTable *
+OsdCpuComputeContext::GetEndCapOffsets() const {
+
+    return _endCapOffsets;
+}
+
+const OsdCpuTable *
+OsdCpuComputeContext::GetEndCapIndices() const {
+
+    return _endCapIndices;
+}
+
+const OsdCpuTable *
+OsdCpuComputeContext::GetEndCapWeights() const {
+
+    return _endCapWeights;
+}
+
+const OsdCpuTable *
+OsdCpuComputeContext::GetEndCapVaryingIndices() const {
+
+    return _endCapVaryingIndices;
+}
+
 float *
 OsdCpuComputeContext::GetCurrentVertexBuffer() const {
 
@@ -180,10 +315,81 @@ OsdCpuComputeContext::GetCurrentVaryingBuffer() const {
     return _currentVaryingBuffer;
 }
 
+FarMemoryUsage
+OsdCpuComputeContext::GetMemoryUsage() const {
+
+    // names of the tables, in FarSubdivisionTables::TableType order
+    static char const * tableNames[FarSubdivisionTables<OsdVertex>::TABLE_TYPES_COUNT] =
+        { "E_IT", "E_W", "V_ITa", "V_IT", "V_W", "F_ITa", "F_IT" };
+
+    FarMemoryUsage result;
+    for (int i = 0; i < (int)_tables.size(); ++i) {
+        result.Add(tableNames[i], _tables[i] ? _tables[i]->GetMemoryUsed() : 0);
+    }
+
+    size_t editBytes = 0;
+    for (int i = 0; i < (int)_editTables.size(); ++i) {
+        editBytes += _editTables[i]->GetPrimvarIndices()->GetMemoryUsed() +
+                     _editTables[i]->GetEditValues()->GetMemoryUsed();
+    }
+    result.Add("editTables", editBytes);
+
+    if (_structuredGrids) {
+        result.Add("structuredGrids", _structuredGrids->GetMemoryUsed() +
+                                      _structuredGridIndices->GetMemoryUsed());
+    }
+
+    if (_limitVertices) {
+        result.Add("limitTables", _limitVertices->GetMemoryUsed() +
+                                  _limitOffsets->GetMemoryUsed() +
+                                  _limitIndices->GetMemoryUsed() +
+                                  _limitWeights->GetMemoryUsed());
+    }
+
+    if (_endCapOffsets) {
+        result.Add("endCapTables", _endCapOffsets->GetMemoryUsed() +
+                                   _endCapIndices->GetMemoryUsed() +
+                                   _endCapWeights->GetMemoryUsed() +
+                                   _endCapVaryingIndices->GetMemoryUsed());
+    }
+    return result;
+}
+
+bool
+OsdCpuComputeContext::isAllocated() const {
+
+    OsdCpuTable const * tables[] = { _structuredGrids, _structuredGridIndices,
+                                     _limitVertices, _limitOffsets, _limitIndices, _limitWeights,
+                                     _endCapOffsets, _endCapIndices, _endCapWeights, _endCapVaryingIndices };
+
+    for (int i = 0; i < (int)(sizeof(tables)/sizeof(tables[0])); ++i) {
+        if (tables[i] and not tables[i]->IsAllocated())
+            return false;
+    }
+    for (size_t i = 0; i < _tables.size(); ++i) {
+        if (_tables[i] and not _tables[i]->IsAllocated())
+            return false;
+    }
+    for (size_t i = 0; i < _editTables.size(); ++i) {
+        if (not _editTables[i]->GetPrimvarIndices()->IsAllocated() or
+            not _editTables[i]->GetEditValues()->IsAllocated())
+            return false;
+    }
+    return true;
+}
+
 OsdCpuComputeContext *
-OsdCpuComputeContext::Create(FarMesh<OsdVertex> const *farmesh) {
+OsdCpuComputeContext::Create(FarMesh<OsdVertex> const *farmesh,
+                             bool referenceFarTables) {
 
-    return new OsdCpuComputeContext(farmesh);
+    OsdCpuComputeContext *result =
+        new OsdCpuComputeContext(farmesh, referenceFarTables);
+
+    if (not result->isAllocated()) {
+        delete result;
+        return NULL;
+    }
+    return result;
 }
 
 }  // end namespace OPENSUBDIV_VERSION
@@ -27,6 +27,7 @@
 
 #include "../version.h"
 
+#include "../far/memoryUsage.h"
 #include "../far/subdivisionTables.h"
 #include "../far/vertexEditTables.h"
 #include "../osd/vertex.h"
@@ -39,28 +40,65 @@ namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
 struct OsdVertexDescriptor;
+class OsdCpuAllocator;
+class OsdCpuDeformer;
+class OsdCpuPatchBounds;
+class FarKernelBatchObserver;
 
 class OsdCpuTable : OsdNonCopyable<OsdCpuTable> {
 public:
+    /// Constructor
+    ///
+    /// @param table      the Far table to upload
+    ///
+    /// @param reference  if true, the table points directly at the storage of
+    ///                   the Far vector instead of copying it : the vector must
+    ///                   then outlive the OsdCpuTable and remain unmodified
+    ///
     template<typename T>
-    explicit OsdCpuTable(const std::vector<T> &table) {
-        createCpuBuffer(table.size() * sizeof(T), table.empty() ? NULL : &table[0]);
+    explicit OsdCpuTable(const std::vector<T> &table, bool reference=false) :
+        _devicePtr(0), _size(table.size() * sizeof(T)), _ownsBuffer(not reference), _allocator(0) {
+
+        if (reference) {
+            _devicePtr = table.empty() ? NULL : const_cast<T *>(&table[0]);
+        } else {
+            createCpuBuffer(table.size() * sizeof(T), table.empty() ? NULL : &table[0]);
+        }
     }
 
     virtual ~OsdCpuTable();
 
     void * GetBuffer() const;
 
+    /// True if the table owns a copy of its data
+    bool OwnsBuffer() const;
+
+    /// Returns the size of the table data in bytes
+    size_t GetSize() const;
+
+    /// Returns the number of bytes allocated by the table (0 if the table
+    /// references the Far data)
+    size_t GetMemoryUsed() const;
+
+    /// Returns false if the copy of the table data could not be allocated
+    bool IsAllocated() const;
+
 private:
     void createCpuBuffer(size_t size, const void *ptr);
 
     void *_devicePtr;
+
+    size_t _size;
+
+    bool _ownsBuffer;
+
+    OsdCpuAllocator *_allocator;  // allocator the buffer was obtained from
 };
 
 class OsdCpuHEditTable : OsdNonCopyable<OsdCpuHEditTable> {
 public:
     OsdCpuHEditTable(const FarVertexEditTables<OsdVertex>::
-                      VertexEditBatch &batch);
+                      VertexEditBatch &batch, bool reference=false);
 
     virtual ~OsdCpuHEditTable();
 
@@ -97,9 +135,17 @@ class OsdCpuComputeContext : OsdNonCopyable<OsdCpuComputeContext> {
 public:
     /// Creates an OsdCpuComputeContext instance
     ///
-    /// @param farmesh the FarMesh used for this Context.
+    /// @param farmesh             the FarMesh used for this Context.
     ///
-    static OsdCpuComputeContext * Create(FarMesh<OsdVertex> const *farmesh);
+    /// @param referenceFarTables  if true, the context does not copy the
+    ///                            subdivision and vertex edit tables, but reads
+    ///                            them in place from the FarMesh : the FarMesh
+    ///                            must then outlive the context.
+    ///
+    /// Returns NULL if the tables could not be allocated.
+    ///
+    static OsdCpuComputeContext * Create(FarMesh<OsdVertex> const *farmesh,
+                                         bool referenceFarTables=false);
 
     /// Destructor
     virtual ~OsdCpuComputeContext();
@@ -153,19 +199,107 @@ public:
     ///
     const OsdCpuHEditTable * GetEditTable(int tableIndex) const;
 
+    /// Returns the structured grid descriptors (NULL if the FarMesh has none)
+    const OsdCpuTable * GetStructuredGrids() const;
+
+    /// Returns the parent lattice indices of the structured grids (NULL if the
+    /// FarMesh has none)
+    const OsdCpuTable * GetStructuredGridIndices() const;
+
+    /// Returns the number of limit masks (0 if the FarMesh has no limit tables)
+    int GetNumLimitVertices() const;
+
+    /// Returns the indices of the vertices projected by the limit masks
+    const OsdCpuTable * GetLimitVertices() const;
+
+    /// Returns the offsets of the limit masks in the limit indices table
+    const OsdCpuTable * GetLimitOffsets() const;
+
+    /// Returns the ring vertices of the limit masks
+    const OsdCpuTable * GetLimitIndices() const;
+
+    /// Returns the interleaved position and tangent weights of the limit masks
+    const OsdCpuTable * GetLimitWeights() const;
+
+    /// Returns the offsets of the end cap stencils in the end cap indices
+    /// table (NULL if the FarMesh has no B-spline end caps)
+    const OsdCpuTable * GetEndCapOffsets() const;
+
+    /// Returns the vertices gathered by the end cap stencils
+    const OsdCpuTable * GetEndCapIndices() const;
+
+    /// Returns the weights of the end cap stencils
+    const OsdCpuTable * GetEndCapWeights() const;
+
+    /// Returns the vertices the varying data of the end caps is copied from
+    const OsdCpuTable * GetEndCapVaryingIndices() const;
+
+    /// Attaches a coarse vertex deformer : the CPU compute controllers run it
+    /// on the bound vertex buffer before the first subdivision batch. The
+    /// context does not take ownership of the deformer (NULL detaches it).
+    void SetDeformer(OsdCpuDeformer const * deformer) { _deformer = deformer; }
+
+    /// Returns the coarse vertex deformer (NULL if none is attached)
+    OsdCpuDeformer const * GetDeformer() const { return _deformer; }
+
+    /// Attaches an observer notified around each kernel batch applied to this
+    /// context by the compute controllers (see FarKernelBatchObserver). The
+    /// context does not take ownership of the observer (NULL detaches it).
+    void SetKernelBatchObserver(FarKernelBatchObserver * observer) { _observer = observer; }
+
+    /// Returns the kernel batch observer (NULL if none is attached)
+    FarKernelBatchObserver * GetKernelBatchObserver() const { return _observer; }
+
+    /// Attaches patch bounds : the CPU compute controllers refresh them from
+    /// the bound vertex buffer after the last subdivision batch. The bounds
+    /// must have been created from the patch tables of the FarMesh of this
+    /// context, which does not take ownership of them (NULL detaches them).
+    void SetPatchBounds(OsdCpuPatchBounds * bounds) { _patchBounds = bounds; }
+
+    /// Returns the patch bounds (NULL if none are attached)
+    OsdCpuPatchBounds * GetPatchBounds() const { return _patchBounds; }
+
     /// Returns a pointer to the vertex-interpolated data
     float * GetCurrentVertexBuffer() const;
 
     /// Returns a pointer to the varying-interpolated data
     float * GetCurrentVaryingBuffer() const;
 
+    /// Returns the itemized memory allocated by the context tables. Tables
+    /// that reference the FarMesh data report 0 bytes.
+    FarMemoryUsage GetMemoryUsage() const;
+
 protected:
-    explicit OsdCpuComputeContext(FarMesh<OsdVertex> const *farMesh);
+    OsdCpuComputeContext(FarMesh<OsdVertex> const *farMesh, bool referenceFarTables);
+
+    // Returns false if the allocation of one of the tables failed
+    bool isAllocated() const;
 
 private:
     std::vector<OsdCpuTable*> _tables;
     std::vector<OsdCpuHEditTable*> _editTables;
 
+    OsdCpuTable *_structuredGrids,
+                *_structuredGridIndices;
+
+    OsdCpuTable *_limitVertices,
+                *_limitOffsets,
+                *_limitIndices,
+                *_limitWeights;
+
+    int _numLimitVertices;
+
+    OsdCpuTable *_endCapOffsets,
+                *_endCapIndices,
+                *_endCapWeights,
+                *_endCapVaryingIndices;
+
+    OsdCpuDeformer const *_deformer;
+
+    FarKernelBatchObserver *_observer;
+
+    OsdCpuPatchBounds *_patchBounds;
+
     float *_currentVertexBuffer, 
           *_currentVaryingBuffer;
 
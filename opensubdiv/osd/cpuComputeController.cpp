@@ -25,6 +25,8 @@
 
 #include "../osd/cpuComputeContext.h"
 #include "../osd/cpuComputeController.h"
+#include "../osd/cpuDeformer.h"
+#include "../osd/cpuPatchBounds.h"
 #include "../osd/cpuKernel.h"
 
 namespace OpenSubdiv {
@@ -51,7 +53,8 @@ OsdCpuComputeController::ApplyBilinearFaceVerticesKernel(
         context->GetCurrentVaryingBuffer(),
         (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::F_IT)->GetBuffer(),
         (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::F_ITa)->GetBuffer(),
-        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd());
+        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd(),
+        batch.GetValence());
 }
 
 void
@@ -100,7 +103,8 @@ OsdCpuComputeController::ApplyCatmarkFaceVerticesKernel(
         context->GetCurrentVaryingBuffer(),
         (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::F_IT)->GetBuffer(),
         (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::F_ITa)->GetBuffer(),
-        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd());
+        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd(),
+        batch.GetValence());
 }
 
 void
@@ -135,7 +139,8 @@ OsdCpuComputeController::ApplyCatmarkVertexVerticesKernelB(
         (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_ITa)->GetBuffer(),
         (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_IT)->GetBuffer(),
         (const float*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_W)->GetBuffer(),
-        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd());
+        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd(),
+        batch.GetValence());
 }
 
 void
@@ -172,6 +177,61 @@ OsdCpuComputeController::ApplyCatmarkVertexVerticesKernelA2(
         batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd(), true);
 }
 
+void
+OsdCpuComputeController::ApplyCatmarkStructuredGridKernel(
+    FarKernelBatch const &batch, void * clientdata) const {
+
+    OsdCpuComputeContext * context =
+        static_cast<OsdCpuComputeContext*>(clientdata);
+    assert(context);
+
+    OsdCpuComputeStructuredGrid(
+        context->GetVertexDescriptor(),
+        context->GetCurrentVertexBuffer(),
+        context->GetCurrentVaryingBuffer(),
+        (const FarStructuredGrids::Grid*)context->GetStructuredGrids()->GetBuffer(),
+        (const int*)context->GetStructuredGridIndices()->GetBuffer(),
+        batch.GetStart(), batch.GetEnd());
+}
+
+void
+OsdCpuComputeController::ApplyEndCapKernel(
+    FarKernelBatch const &batch, void * clientdata) const {
+
+    OsdCpuComputeContext * context =
+        static_cast<OsdCpuComputeContext*>(clientdata);
+    assert(context);
+
+    OsdCpuComputeEndCap(
+        context->GetVertexDescriptor(),
+        context->GetCurrentVertexBuffer(),
+        context->GetCurrentVaryingBuffer(),
+        (const int*)context->GetEndCapOffsets()->GetBuffer(),
+        (const int*)context->GetEndCapIndices()->GetBuffer(),
+        (const float*)context->GetEndCapWeights()->GetBuffer(),
+        (const int*)context->GetEndCapVaryingIndices()->GetBuffer(),
+        batch.GetVertexOffset(), batch.GetTableOffset(),
+        batch.GetStart(), batch.GetEnd());
+}
+
+void
+OsdCpuComputeController::ApplyLimitKernel(
+    OsdCpuComputeContext const *context, float *position,
+    float *tangent1, float *tangent2) const {
+
+    assert(context);
+
+    OsdCpuComputeLimit(
+        context->GetVertexDescriptor(),
+        context->GetCurrentVertexBuffer(),
+        position, tangent1, tangent2,
+        (const int*)context->GetLimitVertices()->GetBuffer(),
+        (const int*)context->GetLimitOffsets()->GetBuffer(),
+        (const int*)context->GetLimitIndices()->GetBuffer(),
+        (const float*)context->GetLimitWeights()->GetBuffer(),
+        0, context->GetNumLimitVertices());
+}
+
 void
 OsdCpuComputeController::ApplyLoopEdgeVerticesKernel(
     FarKernelBatch const &batch, void * clientdata) const {
@@ -204,7 +264,8 @@ OsdCpuComputeController::ApplyLoopVertexVerticesKernelB(
         (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_ITa)->GetBuffer(),
         (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_IT)->GetBuffer(),
         (const float*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_W)->GetBuffer(),
-        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd());
+        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd(),
+        batch.GetValence());
 }
 
 void
@@ -280,6 +341,30 @@ OsdCpuComputeController::ApplyVertexEdits(
     }
 }
 
+void
+OsdCpuComputeController::ApplyDeformer(
+    OsdCpuComputeContext const *context) const {
+
+    assert(context);
+
+    OsdCpuDeformer const * deformer = context->GetDeformer();
+    deformer->Deform(context->GetVertexDescriptor(),
+                     context->GetCurrentVertexBuffer(),
+                     0, deformer->GetNumVertices());
+}
+
+void
+OsdCpuComputeController::ApplyPatchBounds(
+    OsdCpuComputeContext const *context) const {
+
+    assert(context);
+
+    OsdCpuPatchBounds * bounds = context->GetPatchBounds();
+    bounds->Update(context->GetCurrentVertexBuffer(),
+                   context->GetVertexDescriptor().numVertexElements,
+                   0, bounds->GetNumPatches());
+}
+
 void
 OsdCpuComputeController::Synchronize() {
 }
@@ -30,6 +30,8 @@
 #include "../far/dispatcher.h"
 #include "../osd/cpuComputeContext.h"
 
+#include <cassert>
+
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
@@ -70,13 +72,19 @@ public:
                 VERTEX_BUFFER *vertexBuffer,
                 VARYING_BUFFER *varyingBuffer) {
 
-        if (batches.empty()) return;
+        // without batches, the coarse vertices still bound the patches
+        if (batches.empty() and not context->GetPatchBounds()) return;
 
         context->Bind(vertexBuffer, varyingBuffer);
+        if (context->GetDeformer() and not batches.empty())
+            ApplyDeformer(context);
         FarDispatcher::Refine(this,
                               batches,
                               -1,
-                              context);
+                              context,
+                              context->GetKernelBatchObserver());
+        if (context->GetPatchBounds() and vertexBuffer)
+            ApplyPatchBounds(context);
         context->Unbind();
     }
 
@@ -96,6 +104,50 @@ public:
         Refine(context, batches, vertexBuffer, (VERTEX_BUFFER*)0);
     }
 
+    /// Projects the refined vertices of the finest level onto the limit surface
+    /// and computes their tangents in a single sweep (see FarLimitTables). The
+    /// context must have been created from a FarMesh with limit tables.
+    ///
+    /// @param  context         the OsdCpuContext holding the limit masks
+    ///
+    /// @param  vertexBuffer    refined vertex-interpolated data buffer
+    ///
+    /// @param  positionBuffer  destination of the limit positions (can be NULL)
+    ///
+    /// @param  tangent1Buffer  destination of the first tangents (can be NULL)
+    ///
+    /// @param  tangent2Buffer  destination of the second tangents (can be NULL)
+    ///
+    /// Note : the output buffers have the layout of the vertex buffer and
+    /// only the entries of the vertices of the finest level are written. The
+    /// limit masks read the refined vertices around each vertex, so the
+    /// output buffers must not alias the vertex buffer.
+    ///
+    template<class VERTEX_BUFFER, class OUTPUT_BUFFER>
+    void ComputeLimit(OsdCpuComputeContext *context,
+                      VERTEX_BUFFER *vertexBuffer,
+                      OUTPUT_BUFFER *positionBuffer,
+                      OUTPUT_BUFFER *tangent1Buffer=0,
+                      OUTPUT_BUFFER *tangent2Buffer=0) {
+
+        if (context->GetNumLimitVertices()==0) return;
+
+        assert(not positionBuffer or positionBuffer->GetNumElements()==vertexBuffer->GetNumElements());
+        assert(not tangent1Buffer or tangent1Buffer->GetNumElements()==vertexBuffer->GetNumElements());
+        assert(not tangent2Buffer or tangent2Buffer->GetNumElements()==vertexBuffer->GetNumElements());
+
+        assert((void *)positionBuffer!=(void *)vertexBuffer and
+               (void *)tangent1Buffer!=(void *)vertexBuffer and
+               (void *)tangent2Buffer!=(void *)vertexBuffer);
+
+        context->Bind(vertexBuffer, (VERTEX_BUFFER*)0);
+        ApplyLimitKernel(context,
+                         positionBuffer ? positionBuffer->BindCpuBuffer() : 0,
+                         tangent1Buffer ? tangent1Buffer->BindCpuBuffer() : 0,
+                         tangent2Buffer ? tangent2Buffer->BindCpuBuffer() : 0);
+        context->Unbind();
+    }
+
     /// Waits until all running subdivision kernels finish.
     void Synchronize();
 
@@ -118,6 +170,8 @@ protected:
 
     void ApplyCatmarkVertexVerticesKernelA2(FarKernelBatch const &batch, void * clientdata) const;
 
+    void ApplyCatmarkStructuredGridKernel(FarKernelBatch const &batch, void * clientdata) const;
+
 
     void ApplyLoopEdgeVerticesKernel(FarKernelBatch const &batch, void * clientdata) const;
 
@@ -130,6 +184,17 @@ protected:
 
     void ApplyVertexEdits(FarKernelBatch const &batch, void * clientdata) const;
 
+    void ApplyEndCapKernel(FarKernelBatch const &batch, void * clientdata) const;
+
+    // writes the deformed coarse vertices into the bound vertex buffer
+    void ApplyDeformer(OsdCpuComputeContext const *context) const;
+
+    // refreshes the patch bounds from the refined vertices of the bound buffer
+    void ApplyPatchBounds(OsdCpuComputeContext const *context) const;
+
+    void ApplyLimitKernel(OsdCpuComputeContext const *context, float *position,
+                          float *tangent1, float *tangent2) const;
+
 };
 
 }  // end namespace OPENSUBDIV_VERSION
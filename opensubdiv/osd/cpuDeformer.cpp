@@ -0,0 +1,169 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+//
+
+#include "../osd/cpuDeformer.h"
+
+#include <cassert>
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #include <xmmintrin.h>
+    #define OSD_DEFORMER_SSE
+#endif
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+OsdCpuSkinningDeformer *
+OsdCpuSkinningDeformer::Create(int numElements, int numVertices,
+                               float const * restPose, int const * offsets,
+                               int const * joints, float const * weights,
+                               int numJoints) {
+
+    if (numElements < 3 or numVertices <= 0 or numJoints <= 0 or
+        not restPose or not offsets)
+        return NULL;
+
+    return new OsdCpuSkinningDeformer(numElements, numVertices, restPose,
+                                      offsets, joints, weights, numJoints);
+}
+
+OsdCpuSkinningDeformer::OsdCpuSkinningDeformer(int numElements, int numVertices,
+                                               float const * restPose,
+                                               int const * offsets,
+                                               int const * joints,
+                                               float const * weights,
+                                               int numJoints) :
+    _numElements(numElements),
+    _restPose(restPose, restPose + numVertices*numElements),
+    _offsets(offsets, offsets + numVertices+1),
+    _matrices(numJoints*12, 0.0f) {
+
+    int ninfluences = _offsets[numVertices] - _offsets[0];
+    if (ninfluences > 0) {
+        _joints.assign(joints + _offsets[0], joints + _offsets[numVertices]);
+        _weights.assign(weights + _offsets[0], weights + _offsets[numVertices]);
+    }
+
+    // rebase the offsets in case the caller passed a sub-range of its arrays
+    for (int i = numVertices; i >= 0; --i)
+        _offsets[i] -= _offsets[0];
+
+    // joints start at identity
+    for (int i = 0; i < numJoints; ++i) {
+        float * m = &_matrices[i*12];
+        m[0] = m[5] = m[10] = 1.0f;
+    }
+}
+
+OsdCpuSkinningDeformer::~OsdCpuSkinningDeformer() {
+}
+
+void
+OsdCpuSkinningDeformer::SetJointMatrices(float const * matrices) {
+
+    memcpy(&_matrices[0], matrices, _matrices.size()*sizeof(float));
+}
+
+void
+OsdCpuSkinningDeformer::SetRestPose(float const * restPose) {
+
+    memcpy(&_restPose[0], restPose, _restPose.size()*sizeof(float));
+}
+
+void
+OsdCpuSkinningDeformer::Deform(OsdVertexDescriptor const & vdesc, float * vertex,
+                               int start, int end) const {
+
+    assert(vdesc.numVertexElements == _numElements);
+    assert(start >= 0 and end <= GetNumVertices());
+
+    int stride = vdesc.numVertexElements;
+
+    float const * matrices = &_matrices[0];
+
+    for (int i = start; i < end; ++i) {
+
+        float const * src = &_restPose[i*_numElements];
+        float * dst = vertex + i*stride;
+
+        int first = _offsets[i],
+            last = _offsets[i+1];
+
+        // blend the joint matrices, then transform the rest position once
+#ifdef OSD_DEFORMER_SSE
+        __m128 r0 = _mm_setzero_ps(),
+               r1 = _mm_setzero_ps(),
+               r2 = _mm_setzero_ps();
+
+        for (int j = first; j < last; ++j) {
+            float const * m = matrices + _joints[j]*12;
+            __m128 w = _mm_set1_ps(_weights[j]);
+            r0 = _mm_add_ps(r0, _mm_mul_ps(w, _mm_loadu_ps(m)));
+            r1 = _mm_add_ps(r1, _mm_mul_ps(w, _mm_loadu_ps(m+4)));
+            r2 = _mm_add_ps(r2, _mm_mul_ps(w, _mm_loadu_ps(m+8)));
+        }
+
+        float b[12];
+        _mm_storeu_ps(b, r0);
+        _mm_storeu_ps(b+4, r1);
+        _mm_storeu_ps(b+8, r2);
+#else
+        float b[12] = { 0.0f, 0.0f, 0.0f, 0.0f,
+                        0.0f, 0.0f, 0.0f, 0.0f,
+                        0.0f, 0.0f, 0.0f, 0.0f };
+
+        for (int j = first; j < last; ++j) {
+            float const * m = matrices + _joints[j]*12;
+            float w = _weights[j];
+            for (int k = 0; k < 12; ++k)
+                b[k] += w * m[k];
+        }
+#endif
+
+        float x = src[0], y = src[1], z = src[2];
+        dst[0] = b[0]*x + b[1]*y + b[2]*z  + b[3];
+        dst[1] = b[4]*x + b[5]*y + b[6]*z  + b[7];
+        dst[2] = b[8]*x + b[9]*y + b[10]*z + b[11];
+
+        for (int k = 3; k < _numElements; ++k)
+            dst[k] = src[k];
+    }
+}
+
+FarMemoryUsage
+OsdCpuSkinningDeformer::GetMemoryUsage() const {
+
+    FarMemoryUsage result;
+    result.AddVector("restPose", _restPose);
+    result.AddVector("offsets", _offsets);
+    result.AddVector("joints", _joints);
+    result.AddVector("weights", _weights);
+    result.AddVector("matrices", _matrices);
+    return result;
+}
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
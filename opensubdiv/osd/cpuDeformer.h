@@ -0,0 +1,160 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+//
+#ifndef OSD_CPU_DEFORMER_H
+#define OSD_CPU_DEFORMER_H
+
+#include "../version.h"
+
+#include "../far/memoryUsage.h"
+#include "../osd/nonCopyable.h"
+#include "../osd/vertexDescriptor.h"
+
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+/// \brief Coarse vertex deformation stage of the CPU compute controllers.
+///
+/// A deformer attached to an OsdCpuComputeContext (see SetDeformer) is run by
+/// the Refine function of the CPU, OpenMP and GCD compute controllers right
+/// before the first subdivision batch : it writes the deformed coarse vertices
+/// directly into the bound vertex buffer, which saves a separate pass over the
+/// coarse vertices and an UpdateData call per frame.
+///
+/// Implementations must allow Deform to be called concurrently on disjoint
+/// ranges of vertices.
+///
+class OsdCpuDeformer {
+public:
+    /// Destructor
+    virtual ~OsdCpuDeformer() { }
+
+    /// Returns the number of coarse vertices written by the deformer
+    virtual int GetNumVertices() const = 0;
+
+    /// Writes the deformed coarse vertices [start, end) into the vertex buffer
+    ///
+    /// @param vdesc   the format of the bound vertex data
+    ///
+    /// @param vertex  the bound vertex-interpolated data
+    ///
+    /// @param start   index of the first vertex to deform
+    ///
+    /// @param end     index past the last vertex to deform
+    ///
+    virtual void Deform(OsdVertexDescriptor const & vdesc, float * vertex,
+                        int start, int end) const = 0;
+};
+
+/// \brief Linear blend skinning of the coarse vertices.
+///
+/// Deforms the first 3 elements of each vertex of a rest pose with a weighted
+/// sum of joint matrices. The influences of the vertices are stored in CSR
+/// form : the joints and weights of vertex i are found in the range
+/// [offsets[i], offsets[i+1]) of the joints and weights arrays. The remaining
+/// elements of the vertices are copied from the rest pose.
+///
+/// Joint matrices are affine 3x4 matrices stored in row-major order (12
+/// floats per joint).
+///
+class OsdCpuSkinningDeformer : public OsdCpuDeformer, OsdNonCopyable<OsdCpuSkinningDeformer> {
+public:
+    /// Creates a skinning deformer
+    ///
+    /// @param numElements  the number of floats per vertex of the rest pose
+    ///                     (must match the vertex buffer, at least 3)
+    ///
+    /// @param numVertices  the number of coarse vertices
+    ///
+    /// @param restPose     the rest pose (numVertices * numElements floats)
+    ///
+    /// @param offsets      the CSR offsets of the influences (numVertices+1)
+    ///
+    /// @param joints       the joint index of each influence
+    ///
+    /// @param weights      the weight of each influence
+    ///
+    /// @param numJoints    the number of joint matrices
+    ///
+    static OsdCpuSkinningDeformer * Create(int numElements, int numVertices,
+                                           float const * restPose,
+                                           int const * offsets,
+                                           int const * joints,
+                                           float const * weights,
+                                           int numJoints);
+
+    /// Destructor
+    virtual ~OsdCpuSkinningDeformer();
+
+    /// Sets the joint matrices applied by the next Deform calls
+    ///
+    /// @param matrices  numJoints 3x4 row-major matrices
+    ///
+    void SetJointMatrices(float const * matrices);
+
+    /// Replaces the rest pose
+    ///
+    /// @param restPose  numVertices * numElements floats
+    ///
+    void SetRestPose(float const * restPose);
+
+    /// Returns the number of joint matrices
+    int GetNumJoints() const { return (int)_matrices.size()/12; }
+
+    /// Returns the number of coarse vertices written by the deformer
+    virtual int GetNumVertices() const { return (int)_offsets.size()-1; }
+
+    /// Writes the skinned coarse vertices [start, end) into the vertex buffer
+    virtual void Deform(OsdVertexDescriptor const & vdesc, float * vertex,
+                        int start, int end) const;
+
+    /// Returns the itemized memory allocated by the deformer
+    FarMemoryUsage GetMemoryUsage() const;
+
+protected:
+    OsdCpuSkinningDeformer(int numElements, int numVertices,
+                           float const * restPose, int const * offsets,
+                           int const * joints, float const * weights,
+                           int numJoints);
+
+private:
+    int _numElements;
+
+    std::vector<float> _restPose;
+
+    std::vector<int>   _offsets,  // CSR influences
+                       _joints;
+    std::vector<float> _weights;
+
+    std::vector<float> _matrices;
+};
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OSD_CPU_DEFORMER_H
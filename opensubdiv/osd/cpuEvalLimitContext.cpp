@@ -24,6 +24,7 @@
 //
 
 #include "../osd/cpuEvalLimitContext.h"
+#include "../osd/error.h"
 #include "../osd/vertexDescriptor.h"
 
 #include <string.h>
@@ -35,69 +36,109 @@ namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
 OsdCpuEvalLimitContext *
-OsdCpuEvalLimitContext::Create(FarMesh<OsdVertex> const * farmesh, bool requireFVarData) {
+OsdCpuEvalLimitContext::Create(FarMesh<OsdVertex> const * farmesh,
+                               bool requireFVarData,
+                               bool referenceFarTables,
+                               bool compressPatchTable) {
 
     assert(farmesh);
     
     // we do not support uniform yet
     if (not farmesh->GetPatchTables())
         return NULL;
+
+    // the referenced Far tables are never compressed
+    if (referenceFarTables and compressPatchTable) {
+        OsdError(OSD_INTERNAL_CODING_ERROR,
+                 "The referenced Far tables cannot be compressed\n");
+        return NULL;
+    }
                                           
-    return new OsdCpuEvalLimitContext(farmesh, requireFVarData);
+    return new OsdCpuEvalLimitContext(farmesh, requireFVarData, referenceFarTables, compressPatchTable);
 }
 
-OsdCpuEvalLimitContext::OsdCpuEvalLimitContext(FarMesh<OsdVertex> const * farmesh, bool requireFVarData) :
-    OsdEvalLimitContext(farmesh) {
+OsdCpuEvalLimitContext::OsdCpuEvalLimitContext(FarMesh<OsdVertex> const * farmesh,
+                                               bool requireFVarData,
+                                               bool referenceFarTables,
+                                               bool compressPatchTable) :
+    OsdEvalLimitContext(farmesh), _compressedPatchTable(0), _fvarwidth(0) {
     
     FarPatchTables const * patchTables = farmesh->GetPatchTables();
     assert(patchTables);
 
-    // copy the data from the FarTables
-    _patches = patchTables->GetPatchTable();
-
-    _patchArrays = patchTables->GetPatchArrayVector();
-    
-    _vertexValenceTable = patchTables->GetVertexValenceTable();
-    
-    _quadOffsetTable = patchTables->GetQuadOffsetTable();
-    
-    _maxValence = patchTables->GetMaxValence();
-    
-    // Copy the bitfields, the faceId will be the key to our map
-    int npatches = patchTables->GetNumPatches();
-    
-    _patchBitFields.reserve(npatches);
+    if (requireFVarData)
+        _fvarwidth = farmesh->GetTotalFVarWidth();
 
-    FarPatchTables::PatchParamTable const & ptxTable =
-        patchTables->GetPatchParamTable();
+    if (referenceFarTables) {
+
+        _patchTables = patchTables;
+        _ownsPatchTables = false;
+
+    } else {
+
+        // the control vertices are either compressed or copied with the
+        // rest of the tables
+        if (compressPatchTable)
+            _compressedPatchTable = new FarCompressedPatchTable( *patchTables );
+
+        // copy the data from the FarTables (the face-varying table only if
+        // necessary) : only the bit fields of the patch params are copied
+        _patchTables = new FarPatchTables( patchTables->GetPatchArrayVector(),
+                                           compressPatchTable ? FarPatchTables::PTable() :
+                                                                patchTables->GetPatchTable(),
+                                          &patchTables->GetVertexValenceTable(),
+                                          &patchTables->GetQuadOffsetTable(),
+                                           0,
+                                           _fvarwidth>0 ? &patchTables->GetFVarDataTable() : 0,
+                                           patchTables->GetMaxValence(),
+                                          &patchTables->GetSharpnessTable(),
+                                           patchTables->IsVertexValenceTableSparse() );
+        _ownsPatchTables = true;
+
+        copyPatchBitFields(patchTables->GetPatchParamTable());
+    }
 
-    if ( not ptxTable.empty() ) {
+    // the faceId is the key to the map
+    _patchMap = new FarPatchMap( *patchTables );
+}
 
-        FarPatchParam const * pptr = &ptxTable[0];
+void
+OsdCpuEvalLimitContext::copyPatchBitFields(FarPatchTables::PatchParamTable const & paramTable) const {
 
-        for (int arrayId = 0; arrayId < (int)_patchArrays.size(); ++arrayId) {
+    _patchBitFields.resize(paramTable.size());
+    for (int i=0; i<(int)paramTable.size(); ++i)
+        _patchBitFields[i] = paramTable[i].bitField;
+}
 
-            FarPatchTables::PatchArray const & pa = _patchArrays[arrayId];
+const std::vector<FarPatchParam::BitField> &
+OsdCpuEvalLimitContext::GetPatchBitFields() const {
 
-            for (unsigned int j=0; j < pa.GetNumPatches(); ++j) {
-                _patchBitFields.push_back( pptr++->bitField );
-            }
-        }
-    }
-    
-    // Copy the face-varying table if necessary    
-    if (requireFVarData) {
-        _fvarwidth = farmesh->GetTotalFVarWidth();
-        if (_fvarwidth>0) {
-            _fvarData = patchTables->GetFVarDataTable();
-        }
-    }
-    
-    _patchMap = new FarPatchMap( *patchTables );
+    if (not _ownsPatchTables and _patchBitFields.empty())
+        copyPatchBitFields(_patchTables->GetPatchParamTable());
+    return _patchBitFields;
 }
 
 OsdCpuEvalLimitContext::~OsdCpuEvalLimitContext() {
+
     delete _patchMap;
+
+    delete _compressedPatchTable;
+
+    if (_ownsPatchTables)
+        delete _patchTables;
+}
+
+FarMemoryUsage
+OsdCpuEvalLimitContext::GetMemoryUsage() const {
+
+    FarMemoryUsage result;
+    if (_ownsPatchTables)
+        result.Append("patchTables", _patchTables->GetMemoryUsage());
+    result.AddVector("patchBitFields", _patchBitFields);
+    if (_compressedPatchTable)
+        result.Append("compressedPatchTable", _compressedPatchTable->GetMemoryUsage());
+    result.Append("patchMap", _patchMap->GetMemoryUsage());
+    return result;
 }
 
 void 
@@ -27,11 +27,14 @@
 
 #include "../version.h"
 
+#include "../osd/cpuPatchBounds.h"
 #include "../osd/evalLimitContext.h"
 #include "../osd/vertexDescriptor.h"
 #include "../far/patchTables.h"
+#include "../far/compressedPatchTable.h"
 #include "../far/patchMap.h"
 
+#include <cassert>
 #include <map>
 #include <stdio.h>
 
@@ -50,8 +53,24 @@ public:
     ///
     /// @param requireFVarData  flag for generating face-varying data
     ///
+    /// @param referenceFarTables  if true, the context does not copy the patch
+    ///                         tables but reads them in place from the farmesh :
+    ///                         the farmesh must then outlive the context
+    ///
+    /// @param compressPatchTable  if true, the private copy of the patch tables
+    ///                         stores the control vertices of the patches in a
+    ///                         FarCompressedPatchTable instead of a PTable : the
+    ///                         Far tables cannot be both referenced and compressed,
+    ///                         and GetControlVertices is not available (the
+    ///                         control vertices are read with GetPatchVertices)
+    ///
+    /// @return NULL if the farmesh has no patch tables or if both
+    ///         referenceFarTables and compressPatchTable are set
+    ///
     static OsdCpuEvalLimitContext * Create(FarMesh<OsdVertex> const * farmesh, 
-                                           bool requireFVarData=false);
+                                           bool requireFVarData=false,
+                                           bool referenceFarTables=false,
+                                           bool compressPatchTable=false);
 
     virtual ~OsdCpuEvalLimitContext();
 
@@ -106,6 +125,9 @@ public:
 
     /// Vertex-interpolated streams
     struct VertexData {
+
+        /// Constructor
+        VertexData() : bounds(0) { }
     
         /// input vertex-interpolated data descriptor
         OsdVertexBufferDescriptor inDesc;
@@ -120,6 +142,10 @@ public:
         OutputDataStream out,
                          outDu,
                          outDv;
+
+        /// patch bounds refreshed from the input stream when it is bound
+        /// (see OsdCpuEvalLimitContext::SetPatchBounds)
+        OsdCpuPatchBounds * bounds;
                    
         /// Binds the vertex-interpolated data streams
         ///
@@ -147,6 +173,9 @@ public:
             out.Bind( outQ );
             outDu.Bind( outdQu );
             outDv.Bind( outdQv );
+
+            if (bounds and in.IsBound())
+                bounds->Update( in.GetData() + inDesc.offset, inDesc.stride );
         }
         
         /// True if both the mandatory input and output streams have been bound
@@ -164,6 +193,21 @@ public:
         return _vertexData;
     }
 
+    /// Attaches patch bounds : they are refreshed from the control vertices
+    /// each time the vertex-interpolated data is bound, before any sample is
+    /// evaluated. The bounds must have been created from the patch tables of
+    /// the FarMesh of this context, which does not take ownership of them
+    /// (NULL detaches them).
+    void SetPatchBounds(OsdCpuPatchBounds * bounds) {
+        assert(not bounds or bounds->GetNumPatches()==GetNumPatches());
+        _vertexData.bounds = bounds;
+    }
+
+    /// Returns the patch bounds (NULL if none are attached)
+    OsdCpuPatchBounds * GetPatchBounds() const {
+        return _vertexData.bounds;
+    }
+
 
 
 
@@ -271,32 +315,95 @@ public:
 
     /// Returns the vector of patch arrays
     const FarPatchTables::PatchArrayVector & GetPatchArrayVector() const {
-        return _patchArrays;
+        return _patchTables->GetPatchArrayVector();
     }
     
+    /// Returns the number of patches
+    int GetNumPatches() const {
+        int result = 0;
+        FarPatchTables::PatchArrayVector const & parrays = GetPatchArrayVector();
+        for (int i=0; i<(int)parrays.size(); ++i)
+            result += parrays[i].GetNumPatches();
+        return result;
+    }
+
+    /// Returns the parametric data of a patch : read in place from the Far
+    /// tables if the context references them, from the private copy of the
+    /// bit fields otherwise
+    ///
+    /// @param patchIdx  the index of the patch returned by the patch map
+    ///
+    FarPatchParam::BitField const & GetPatchBitField(int patchIdx) const {
+        return _ownsPatchTables ? _patchBitFields[patchIdx] :
+                                  _patchTables->GetPatchParamTable()[patchIdx].bitField;
+    }
+
+    /// \deprecated Use GetPatchBitField : if the context references the Far
+    /// tables, the first call copies the bit fields of all the patches (and is
+    /// not thread safe).
+    ///
     /// Returns the vector of per-patch parametric data
-    const std::vector<FarPatchParam::BitField> & GetPatchBitFields() const {
-        return _patchBitFields;
+    const std::vector<FarPatchParam::BitField> & GetPatchBitFields() const;
+
+    /// The ordered array of control vertex indices for all the patches (not
+    /// available if the context compresses its patch table : use
+    /// GetPatchVertices instead)
+    const FarPatchTables::PTable & GetControlVertices() const {
+        assert(not _compressedPatchTable);
+        return _patchTables->GetPatchTable();
     }
 
-    /// The ordered array of control vertex indices for all the patches
-    const std::vector<unsigned int> & GetControlVertices() const {
-        return _patches;
+    /// Returns the control vertex indices of a patch : if the patch table is
+    /// compressed, the indices are decoded into 'storage', which must be able
+    /// to hold the control vertices of any patch (16 indices)
+    ///
+    /// @param parray   the patch array containing the patch
+    ///
+    /// @param handle   the handle of the patch returned by the patch map
+    ///
+    /// @param storage  destination of the decoded indices
+    ///
+    unsigned int const * GetPatchVertices(FarPatchTables::PatchArray const & parray,
+                                          FarPatchMap::Handle const & handle,
+                                          unsigned int * storage) const {
+        if (_compressedPatchTable) {
+            _compressedPatchTable->GetPatchVertices(handle.patchIdx,
+                parray.GetVertIndex() + handle.vertexOffset,
+                parray.GetDescriptor().GetNumControlVertices(), storage);
+            return storage;
+        }
+        return &_patchTables->GetPatchTable()[ parray.GetVertIndex() + handle.vertexOffset ];
+    }
+
+    /// Returns the compressed control vertex indices (NULL if the patch table
+    /// is not compressed)
+    FarCompressedPatchTable const * GetCompressedPatchTable() const {
+        return _compressedPatchTable;
     }
 
     /// Returns the vertex-valence buffer used for Gregory patch computations
     FarPatchTables::VertexValenceTable const & GetVertexValenceTable() const {
-        return _vertexValenceTable;
+        return _patchTables->GetVertexValenceTable();
+    }
+
+    /// True if the vertex-valence buffer uses the sparse layout
+    bool IsVertexValenceTableSparse() const {
+        return _patchTables->IsVertexValenceTableSparse();
     }
 
     /// Returns the Quad-Offsets buffer used for Gregory patch computations
     FarPatchTables::QuadOffsetTable const & GetQuadOffsetTable() const {
-        return _quadOffsetTable;
+        return _patchTables->GetQuadOffsetTable();
     }
     
+    /// Returns the crease sharpness of the single crease patches
+    FarPatchTables::SharpnessTable const & GetSharpnessTable() const {
+        return _patchTables->GetSharpnessTable();
+    }
+
     /// Returns the face-varying data patch table
     FarPatchTables::FVarDataTable const & GetFVarData() const {
-        return _fvarData;
+        return _patchTables->GetFVarDataTable();
     }
     
     /// Returns the number of floats in a datum of the face-varying data table
@@ -311,23 +418,41 @@ public:
 
     /// Returns the highest valence of the vertices in the buffers
     int GetMaxValence() const {
-        return _maxValence;
+        return _patchTables->GetMaxValence();
     }
 
+    /// True if the context reads the patch tables in place from the FarMesh
+    bool IsReferencingFarTables() const {
+        return not _ownsPatchTables;
+    }
+
+    /// Returns the itemized memory allocated by the context : the patch tables
+    /// are only accounted for if the context owns a copy of them.
+    FarMemoryUsage GetMemoryUsage() const;
+
 protected:
-    explicit OsdCpuEvalLimitContext(FarMesh<OsdVertex> const * farmesh, bool requireFVarData);
+    OsdCpuEvalLimitContext(FarMesh<OsdVertex> const * farmesh, 
+                           bool requireFVarData,
+                           bool referenceFarTables,
+                           bool compressPatchTable);
 
 private:
 
-    // Topology data for a mesh
-    FarPatchTables::PatchArrayVector     _patchArrays;    // patch descriptor for each patch in the mesh
-    FarPatchTables::PTable               _patches;        // patch control vertices
-    std::vector<FarPatchParam::BitField> _patchBitFields; // per-patch parametric info
-    
-    FarPatchTables::VertexValenceTable   _vertexValenceTable; // extra Gregory patch data buffers
-    FarPatchTables::QuadOffsetTable      _quadOffsetTable;
+    void copyPatchBitFields(FarPatchTables::PatchParamTable const & paramTable) const;
+
+    // Topology data for a mesh : either a private copy of the tables or the
+    // tables owned by the FarMesh
+    FarPatchTables const * _patchTables;
+
+    bool _ownsPatchTables;
+
+    // Per-patch parametric data : the private copy of the tables only holds
+    // the bit fields, the face indices are only needed by the patch map
+    mutable std::vector<FarPatchParam::BitField> _patchBitFields;
 
-    FarPatchTables::FVarDataTable        _fvarData;
+    // Control vertices of the patches when the private copy of the tables
+    // does not hold a PTable
+    FarCompressedPatchTable * _compressedPatchTable;
 
     FarPatchMap * _patchMap;           // map of the sub-patches given a face index
 
@@ -335,8 +460,7 @@ private:
     VaryingData      _varyingData;     // varying-interpolated data descriptor 
     FaceVaryingData  _faceVaryingData; // face-varying-interpolated data descriptor 
 
-    int _maxValence, 
-        _fvarwidth;
+    int _fvarwidth;
 };
 
 
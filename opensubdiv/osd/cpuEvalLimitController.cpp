@@ -50,7 +50,7 @@ OsdCpuEvalLimitController::_EvalLimitSample( OpenSubdiv::OsdEvalCoords const & c
     if (not handle)
         return 0;
 
-    FarPatchParam::BitField bits = context->GetPatchBitFields()[ handle->patchIdx ];
+    FarPatchParam::BitField bits = context->GetPatchBitField( handle->patchIdx );
     
     bits.Normalize( u, v );
 
@@ -58,7 +58,8 @@ OsdCpuEvalLimitController::_EvalLimitSample( OpenSubdiv::OsdEvalCoords const & c
 
     FarPatchTables::PatchArray const & parray = context->GetPatchArrayVector()[ handle->patchArrayIdx ];
     
-    unsigned int const * cvs = &context->GetControlVertices()[ parray.GetVertIndex() + handle->vertexOffset ];
+    unsigned int decodedCVs[16];
+    unsigned int const * cvs = context->GetPatchVertices( parray, *handle, decodedCVs );
     
     OsdCpuEvalLimitContext::VertexData & vertexData = context->GetVertexData();
 
@@ -105,6 +106,7 @@ OsdCpuEvalLimitController::_EvalLimitSample( OpenSubdiv::OsdEvalCoords const & c
                                                              &context->GetVertexValenceTable()[0],
                                                              &context->GetQuadOffsetTable()[ parray.GetQuadOffsetIndex() + handle->vertexOffset ],  
                                                              context->GetMaxValence(),
+                                                             context->IsVertexValenceTableSparse(),
                                                              vertexData.inDesc,
                                                              vertexData.in.GetData(),
                                                              vertexData.outDesc,
@@ -119,6 +121,7 @@ OsdCpuEvalLimitController::_EvalLimitSample( OpenSubdiv::OsdEvalCoords const & c
                                                                     &context->GetVertexValenceTable()[0],
                                                                     &context->GetQuadOffsetTable()[ parray.GetQuadOffsetIndex() + handle->vertexOffset ],
                                                                     context->GetMaxValence(),
+                                                                    context->IsVertexValenceTableSparse(),
                                                                     vertexData.inDesc,
                                                                     vertexData.in.GetData(),
                                                                     vertexData.outDesc,
@@ -127,6 +130,19 @@ OsdCpuEvalLimitController::_EvalLimitSample( OpenSubdiv::OsdEvalCoords const & c
                                                                     vertexData.outDv.GetData()+offset );
                                             } break;
 
+            case FarPatchTables::SINGLE_CREASE :
+                                            if (vertexData.IsBound()) {
+                                                evalSingleCrease( v, u,
+                                                                  context->GetSharpnessTable()[ handle->patchIdx ],
+                                                                  cvs,
+                                                                  vertexData.inDesc,
+                                                                  vertexData.in.GetData(),
+                                                                  vertexData.outDesc,
+                                                                  vertexData.out.GetData()+offset,
+                                                                  vertexData.outDu.GetData()+offset,
+                                                                  vertexData.outDv.GetData()+offset );
+                                            } break;
+
             default:
                 assert(0);
         }
@@ -136,11 +152,12 @@ OsdCpuEvalLimitController::_EvalLimitSample( OpenSubdiv::OsdEvalCoords const & c
 
     if (varyingData.IsBound()) {
 
-        static int indices[5][4] = { {5, 6,10, 9},  // regular
+        static int indices[6][4] = { {5, 6,10, 9},  // regular
                                      {1, 2, 6, 5},  // boundary
                                      {1, 2, 5, 4},  // corner
                                      {0, 1, 2, 3},  // gregory
-                                     {0, 1, 2, 3} };// gregory boundary
+                                     {0, 1, 2, 3},  // gregory boundary
+                                     {5, 6,10, 9} };// single crease
 
         int type = (int)(parray.GetDescriptor().GetType() - FarPatchTables::REGULAR);
 
@@ -376,6 +376,152 @@ evalCorner(float u, float v,
 }
 
 
+// Evaluates the cubic B-spline basis functions across a semi-sharp crease
+// running along the second row of control vertices (u=0) : the curve is
+// subdivided towards u until the crease has become smooth, or until u
+// leaves the neighborhood of the crease.
+inline void
+evalCubicBSplineCrease(float u, float sharpness, float B[4], float BU[4]) {
+
+    if (sharpness>=10.0f) {
+
+        // infinitely sharp crease : mirror the first vertex across the crease
+        evalCubicBSpline(u, B, BU);
+
+        B[1] += 2.0f*B[0];
+        B[2] -= B[0];
+        B[0] = 0.0f;
+
+        if (BU) {
+            BU[1] += 2.0f*BU[0];
+            BU[2] -= BU[0];
+            BU[0] = 0.0f;
+        }
+        return;
+    }
+
+    // weights of the subdivided control vertices
+    float M[4][4] = { { 1.0f, 0.0f, 0.0f, 0.0f },
+                      { 0.0f, 1.0f, 0.0f, 0.0f },
+                      { 0.0f, 0.0f, 1.0f, 0.0f },
+                      { 0.0f, 0.0f, 0.0f, 1.0f } },
+          scale = 1.0f;
+
+    while (sharpness>0.0f) {
+
+        // semi-sharp vertex rule : blend the crease and smooth rules
+        float c = std::min(sharpness, 1.0f);
+
+        float E0[4], V1[4], E1[4], V2[4], E2[4];
+        for (int i=0; i<4; ++i) {
+            E0[i] = 0.5f*(M[0][i]+M[1][i]);
+            V1[i] = c*M[1][i] + (1.0f-c)*0.125f*(M[0][i]+6.0f*M[1][i]+M[2][i]);
+            E1[i] = 0.5f*(M[1][i]+M[2][i]);
+            V2[i] = 0.125f*(M[1][i]+6.0f*M[2][i]+M[3][i]);
+            E2[i] = 0.5f*(M[2][i]+M[3][i]);
+        }
+
+        scale *= 2.0f;
+
+        if (u<0.5f) {
+            // the crease is still on the second row of the sub-segment
+            memcpy(M[0], E0, 4*sizeof(float));
+            memcpy(M[1], V1, 4*sizeof(float));
+            memcpy(M[2], E1, 4*sizeof(float));
+            memcpy(M[3], V2, 4*sizeof(float));
+            u = 2.0f*u;
+            sharpness -= 1.0f;
+        } else {
+            // the sub-segment is a regular B-spline segment
+            memcpy(M[0], V1, 4*sizeof(float));
+            memcpy(M[1], E1, 4*sizeof(float));
+            memcpy(M[2], V2, 4*sizeof(float));
+            memcpy(M[3], E2, 4*sizeof(float));
+            u = 2.0f*u - 1.0f;
+            break;
+        }
+    }
+
+    float b[4], d[4];
+    evalCubicBSpline(u, b, BU ? d : 0);
+
+    for (int i=0; i<4; ++i) {
+        B[i] = b[0]*M[0][i] + b[1]*M[1][i] + b[2]*M[2][i] + b[3]*M[3][i];
+        if (BU)
+            BU[i] = scale*(d[0]*M[0][i] + d[1]*M[1][i] + d[2]*M[2][i] + d[3]*M[3][i]);
+    }
+}
+
+
+
+void
+evalSingleCrease(float u, float v, float sharpness,
+                 unsigned int const * vertexIndices,
+                 OsdVertexBufferDescriptor const & inDesc,
+                 float const * inQ, 
+                 OsdVertexBufferDescriptor const & outDesc,
+                 float * outQ, 
+                 float * outDQU,
+                 float * outDQV ) {
+
+    // make sure that we have enough space to store results
+    assert( inDesc.length <= (outDesc.stride-outDesc.offset) );
+
+    bool evalDeriv = (outDQU or outDQV);
+
+    float B[4], D[4],
+          *BU=(float*)alloca(inDesc.length*4*sizeof(float)),
+          *DU=(float*)alloca(inDesc.length*4*sizeof(float));
+    
+    memset(BU, 0, inDesc.length*4*sizeof(float));
+    memset(DU, 0, inDesc.length*4*sizeof(float));
+
+    // the crease runs along the second row of the patch
+    evalCubicBSplineCrease(u, sharpness, B, evalDeriv ? D : 0);
+
+    float const * inOffset = inQ + inDesc.offset;
+
+    for (int i=0; i<4; ++i) {
+        for (int j=0; j<4; ++j) {
+        
+            float const * in = inOffset + vertexIndices[i+j*4]*inDesc.stride;
+            
+            for (int k=0; k<inDesc.length; ++k) {
+            
+                BU[i*inDesc.length+k] += in[k] * B[j];
+                
+                if (evalDeriv)
+                    DU[i*inDesc.length+k] += in[k] * D[j];                
+            }
+        }
+    }
+
+    evalCubicBSpline(v, B, evalDeriv ? D : 0);
+
+    float * Q = outQ + outDesc.offset,
+          * dQU = outDQU + outDesc.offset,
+          * dQV = outDQV + outDesc.offset;
+
+    // clear result 
+    memset(Q, 0, inDesc.length*sizeof(float));
+    if (evalDeriv) {
+        memset(dQU, 0, inDesc.length*sizeof(float));
+        memset(dQV, 0, inDesc.length*sizeof(float));
+    }
+
+    for (int i=0; i<4; ++i) {
+        for (int k=0; k<inDesc.length; ++k) {
+            Q[k] += BU[inDesc.length*i+k] * B[i];
+            
+            if (evalDeriv) {
+                dQU[k] += DU[inDesc.length*i+k] * B[i];
+                dQV[k] += BU[inDesc.length*i+k] * D[i];
+            }
+        }
+    }    
+}
+
+
 static float ef_small[7] = {
     0.813008f, 0.500000f, 0.363636f, 0.287505f,
     0.238692f, 0.204549f, 0.179211f };
@@ -414,6 +560,14 @@ univar4x4(float u, float B[4], float D[4])
     }
 }
 
+// Returns the valence record of a vertex : records are either stored with a
+// fixed stride, or located through the per-vertex offsets of a sparse table
+inline int const *
+getValenceRecord(int const * vertexValenceBuffer, int vertexID, int maxValence, bool sparseValence)
+{
+    return vertexValenceBuffer + (sparseValence ? vertexValenceBuffer[vertexID] : vertexID * (2*maxValence+1));
+}
+
 inline float 
 csf(unsigned int n, unsigned int j)
 {
@@ -431,6 +585,7 @@ evalGregory(float u, float v,
             int const * vertexValenceBuffer,
             unsigned int const  * quadOffsetBuffer,
             int maxValence,
+            bool sparseValence,
             OsdVertexBufferDescriptor const & inDesc,
             float const * inQ, 
             OsdVertexBufferDescriptor const & outDesc,
@@ -463,7 +618,7 @@ evalGregory(float u, float v,
     
         int vertexID = vertexIndices[vid];
         
-        const int *valenceTable = vertexValenceBuffer + vertexID * (2*maxValence+1);
+        const int *valenceTable = getValenceRecord(vertexValenceBuffer, vertexID, maxValence, sparseValence);
         int valence = abs(*valenceTable);
         assert(valence<=maxValence);
         valences[vid] = valence;
@@ -683,6 +838,7 @@ evalGregoryBoundary(float u, float v,
                     int const * vertexValenceBuffer,
                     unsigned int const  * quadOffsetBuffer,
                     int maxValence,
+                    bool sparseValence,
                     OsdVertexBufferDescriptor const & inDesc,
                     float const * inQ,
                     OsdVertexBufferDescriptor const & outDesc,
@@ -716,7 +872,7 @@ evalGregoryBoundary(float u, float v,
 
         int vertexID = vertexIndices[vid];
 
-        const int *valenceTable = vertexValenceBuffer + vertexID * (2*maxValence+1);
+        const int *valenceTable = getValenceRecord(vertexValenceBuffer, vertexID, maxValence, sparseValence);
         int valence = *valenceTable,
             ivalence = abs(valence);
 
@@ -745,7 +901,7 @@ evalGregoryBoundary(float u, float v,
             int idx_neighbor_m = valenceTable[2*im + 0 + 1];
             int idx_diagonal_m = valenceTable[2*im + 1 + 1];
 
-            int valenceNeighbor = vertexValenceBuffer[idx_neighbor * (2*maxValence+1)]; 
+            int valenceNeighbor = *getValenceRecord(vertexValenceBuffer, idx_neighbor, maxValence, sparseValence);
             if (valenceNeighbor < 0) {
                 boundaryEdgeNeighbors[currNeighbor++] = idx_neighbor;
                 if (currNeighbor == 1)    {
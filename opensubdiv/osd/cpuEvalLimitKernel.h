@@ -70,12 +70,23 @@ evalCorner(float u, float v,
            float * outDQU,
            float * outDQV );
 
+void
+evalSingleCrease(float u, float v, float sharpness,
+                 unsigned int const * vertexIndices,
+                 OsdVertexBufferDescriptor const & inDesc,
+                 float const * inQ, 
+                 OsdVertexBufferDescriptor const & outDesc,
+                 float * outQ, 
+                 float * outDQU,
+                 float * outDQV );
+
 void
 evalGregory(float u, float v,
             unsigned int const * vertexIndices,
             int const * vertexValenceBuffer,
             unsigned int const  * quadOffsetBuffer,
             int maxValence,
+            bool sparseValence,
             OsdVertexBufferDescriptor const & inDesc,
             float const * inQ, 
             OsdVertexBufferDescriptor const & outDesc,
@@ -89,6 +100,7 @@ evalGregoryBoundary(float u, float v,
                     int const * vertexValenceBuffer,
                     unsigned int const  * quadOffsetBuffer,
                     int maxValence,
+                    bool sparseValence,
                     OsdVertexBufferDescriptor const & inDesc,
                     float const * inQ,
                     OsdVertexBufferDescriptor const & outDesc,
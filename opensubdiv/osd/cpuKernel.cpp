@@ -27,15 +27,160 @@
 #include "../osd/vertexDescriptor.h"
 
 #include <math.h>
+#include <vector>
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
-void OsdCpuComputeFace(
+// Smooth vertex rule weights, tabulated once for the common valences
+class OsdCpuValenceWeights {
+public:
+    enum { kMaxValence = 64 };
+
+    OsdCpuValenceWeights() {
+        for (int n = 1; n <= kMaxValence; ++n) {
+            computeCatmark(n, &_catmarkWp[n], &_catmarkWv[n]);
+            _loopBeta[n] = computeLoop(n);
+        }
+    }
+
+    void GetCatmark(int n, float *wp, float *wv) const {
+        if (n > 0 && n <= kMaxValence) {
+            *wp = _catmarkWp[n];
+            *wv = _catmarkWv[n];
+        } else
+            computeCatmark(n, wp, wv);
+    }
+
+    float GetLoop(int n) const {
+        return (n > 0 && n <= kMaxValence) ? _loopBeta[n] : computeLoop(n);
+    }
+
+private:
+    static void computeCatmark(int n, float *wp, float *wv) {
+        *wp = 1.0f/static_cast<float>(n*n);
+        *wv = (n-2.0f) * n * (*wp);
+    }
+
+    static float computeLoop(int n) {
+        float wp = 1.0f/static_cast<float>(n);
+        float beta = 0.25f * cosf(static_cast<float>(M_PI) * 2.0f * wp) + 0.375f;
+        beta = beta * beta;
+        return (0.625f - beta) * wp;
+    }
+
+    float _catmarkWp[kMaxValence+1],
+          _catmarkWv[kMaxValence+1],
+          _loopBeta[kMaxValence+1];
+};
+
+static const OsdCpuValenceWeights &
+getValenceWeights() {
+    static OsdCpuValenceWeights weights;
+    return weights;
+}
+
+// Forces the table to be built before any kernel runs concurrently
+static const OsdCpuValenceWeights & g_valenceWeights = getValenceWeights();
+
+void OsdCpuGetCatmarkVertexWeights(int valence, float *wp, float *wv) {
+    g_valenceWeights.GetCatmark(valence, wp, wv);
+}
+
+float OsdCpuGetLoopVertexWeight(int valence) {
+    return g_valenceWeights.GetLoop(valence);
+}
+
+// Kernels specialized for a constant valence N : the inner loops have a
+// constant trip count and are unrolled by the compiler.
+template <int N> static void
+computeFace(
     OsdVertexDescriptor const &vdesc, float * vertex, float * varying,
     const int *F_IT, const int *F_ITa, int vertexOffset, int tableOffset,
     int start, int end) {
 
+    const float weight = 1.0f/N;
+
+    for (int i = start + tableOffset; i < end + tableOffset; i++) {
+        const int *h = F_IT + F_ITa[2*i];
+
+        int dstIndex = i + vertexOffset - tableOffset;
+        vdesc.Clear(vertex, varying, dstIndex);
+
+        for (int j = 0; j < N; ++j) {
+            vdesc.AddWithWeight(vertex, dstIndex, h[j], weight);
+            vdesc.AddVaryingWithWeight(varying, dstIndex, h[j], weight);
+        }
+    }
+}
+
+template <int N> static void
+computeVertexB(
+    OsdVertexDescriptor const &vdesc, float *vertex, float *varying,
+    const int *V_ITa, const int *V_IT, const float *V_W,
+    int vertexOffset, int tableOffset, int start, int end) {
+
+    float wp, wv;
+    OsdCpuGetCatmarkVertexWeights(N, &wp, &wv);
+
+    for (int i = start + tableOffset; i < end + tableOffset; i++) {
+        const int *h = V_IT + V_ITa[5*i];
+        int p = V_ITa[5*i+2];
+
+        float weight = V_W[i];
+
+        int dstIndex = i + vertexOffset - tableOffset;
+        vdesc.Clear(vertex, varying, dstIndex);
+
+        vdesc.AddWithWeight(vertex, dstIndex, p, weight * wv);
+
+        for (int j = 0; j < N; ++j) {
+            vdesc.AddWithWeight(vertex, dstIndex, h[j*2], weight * wp);
+            vdesc.AddWithWeight(vertex, dstIndex, h[j*2+1], weight * wp);
+        }
+        vdesc.AddVaryingWithWeight(varying, dstIndex, p, 1.0f);
+    }
+}
+
+template <int N> static void
+computeLoopVertexB(
+    OsdVertexDescriptor const &vdesc, float *vertex, float *varying,
+    const int *V_ITa, const int *V_IT, const float *V_W,
+    int vertexOffset, int tableOffset, int start, int end) {
+
+    float beta = OsdCpuGetLoopVertexWeight(N);
+
+    for (int i = start + tableOffset; i < end + tableOffset; i++) {
+        const int *h = V_IT + V_ITa[5*i];
+        int p = V_ITa[5*i+2];
+
+        float weight = V_W[i];
+
+        int dstIndex = i + vertexOffset - tableOffset;
+        vdesc.Clear(vertex, varying, dstIndex);
+
+        vdesc.AddWithWeight(vertex, dstIndex, p, weight * (1.0f - (beta * N)));
+
+        for (int j = 0; j < N; ++j)
+            vdesc.AddWithWeight(vertex, dstIndex, h[j], weight * beta);
+
+        vdesc.AddVaryingWithWeight(varying, dstIndex, p, 1.0f);
+    }
+}
+
+void OsdCpuComputeFace(
+    OsdVertexDescriptor const &vdesc, float * vertex, float * varying,
+    const int *F_IT, const int *F_ITa, int vertexOffset, int tableOffset,
+    int start, int end, int valence) {
+
+    switch (valence) {
+        case 3 : computeFace<3>(vdesc, vertex, varying, F_IT, F_ITa,
+                                vertexOffset, tableOffset, start, end); return;
+        case 4 : computeFace<4>(vdesc, vertex, varying, F_IT, F_ITa,
+                                vertexOffset, tableOffset, start, end); return;
+        default : break;
+    }
+
     for (int i = start + tableOffset; i < end + tableOffset; i++) {
         int h = F_ITa[2*i];
         int n = F_ITa[2*i+1];
@@ -127,7 +272,19 @@ void OsdCpuComputeVertexA(
 void OsdCpuComputeVertexB(
     OsdVertexDescriptor const &vdesc, float *vertex, float *varying,
     const int *V_ITa, const int *V_IT, const float *V_W,
-    int vertexOffset, int tableOffset, int start, int end) {
+    int vertexOffset, int tableOffset, int start, int end, int valence) {
+
+#define OSD_CPU_VERTEX_B(N) \
+        case N : computeVertexB<N>(vdesc, vertex, varying, V_ITa, V_IT, V_W, \
+                                   vertexOffset, tableOffset, start, end); return;
+    switch (valence) {
+        OSD_CPU_VERTEX_B(3)
+        OSD_CPU_VERTEX_B(4)
+        OSD_CPU_VERTEX_B(5)
+        OSD_CPU_VERTEX_B(6)
+        default : break;
+    }
+#undef OSD_CPU_VERTEX_B
 
     for (int i = start + tableOffset; i < end + tableOffset; i++) {
         int h = V_ITa[5*i];
@@ -135,8 +292,8 @@ void OsdCpuComputeVertexB(
         int p = V_ITa[5*i+2];
 
         float weight = V_W[i];
-        float wp = 1.0f/static_cast<float>(n*n);
-        float wv = (n-2.0f) * n * wp;
+        float wp, wv;
+        OsdCpuGetCatmarkVertexWeights(n, &wp, &wv);
 
         int dstIndex = i + vertexOffset - tableOffset;
         vdesc.Clear(vertex, varying, dstIndex);
@@ -154,7 +311,19 @@ void OsdCpuComputeVertexB(
 void OsdCpuComputeLoopVertexB(
     OsdVertexDescriptor const &vdesc, float *vertex, float *varying,
     const int *V_ITa, const int *V_IT, const float *V_W,
-    int vertexOffset, int tableOffset, int start, int end) {
+    int vertexOffset, int tableOffset, int start, int end, int valence) {
+
+#define OSD_CPU_LOOP_VERTEX_B(N) \
+        case N : computeLoopVertexB<N>(vdesc, vertex, varying, V_ITa, V_IT, V_W, \
+                                       vertexOffset, tableOffset, start, end); return;
+    switch (valence) {
+        OSD_CPU_LOOP_VERTEX_B(4)
+        OSD_CPU_LOOP_VERTEX_B(5)
+        OSD_CPU_LOOP_VERTEX_B(6)
+        OSD_CPU_LOOP_VERTEX_B(7)
+        default : break;
+    }
+#undef OSD_CPU_LOOP_VERTEX_B
 
     for (int i = start + tableOffset; i < end + tableOffset; i++) {
         int h = V_ITa[5*i];
@@ -162,10 +331,7 @@ void OsdCpuComputeLoopVertexB(
         int p = V_ITa[5*i+2];
 
         float weight = V_W[i];
-        float wp = 1.0f/static_cast<float>(n);
-        float beta = 0.25f * cosf(static_cast<float>(M_PI) * 2.0f * wp) + 0.375f;
-        beta = beta * beta;
-        beta = (0.625f - beta) * wp;
+        float beta = OsdCpuGetLoopVertexWeight(n);
 
         int dstIndex = i + vertexOffset - tableOffset;
         vdesc.Clear(vertex, varying, dstIndex);
@@ -213,6 +379,148 @@ void OsdCpuComputeBilinearVertex(
     }
 }
 
+// The grids only cover smooth regular regions : all the weights are constant
+// and the indices are implicit, except for the parent lattice that is
+// expanded once per grid.
+void OsdCpuComputeStructuredGrid(
+    OsdVertexDescriptor const &vdesc, float *vertex, float *varying,
+    const FarStructuredGrids::Grid *grids, const int *indices,
+    int start, int end) {
+
+    std::vector<int> lattice;
+
+    for (int i = start; i < end; i++) {
+        const FarStructuredGrids::Grid &g = grids[i];
+        int w = g.width, h = g.height;
+
+        lattice.resize((w+1)*(h+1));
+        for (int y = 0; y <= h; y++)
+            FarStructuredGrids::GetParentRow(grids, indices, i, y, &lattice[y*(w+1)]);
+
+        const int *P = &lattice[0];
+
+        // face-vertices
+        for (int y = 0; y < h; y++) {
+            const int *r0 = P + y*(w+1), *r1 = r0 + (w+1);
+            for (int x = 0; x < w; x++) {
+                int dstIndex = g.faceOffset + y*w + x;
+                vdesc.Clear(vertex, varying, dstIndex);
+                vdesc.AddWithWeight(vertex, dstIndex, r0[x], 0.25f);
+                vdesc.AddWithWeight(vertex, dstIndex, r0[x+1], 0.25f);
+                vdesc.AddWithWeight(vertex, dstIndex, r1[x+1], 0.25f);
+                vdesc.AddWithWeight(vertex, dstIndex, r1[x], 0.25f);
+                vdesc.AddVaryingWithWeight(varying, dstIndex, r0[x], 0.25f);
+                vdesc.AddVaryingWithWeight(varying, dstIndex, r0[x+1], 0.25f);
+                vdesc.AddVaryingWithWeight(varying, dstIndex, r1[x+1], 0.25f);
+                vdesc.AddVaryingWithWeight(varying, dstIndex, r1[x], 0.25f);
+            }
+        }
+
+        // edge-vertices along u
+        for (int y = 1; y < h; y++) {
+            const int *r = P + y*(w+1);
+            int f0 = g.faceOffset + (y-1)*w, f1 = f0 + w;
+            for (int x = 0; x < w; x++) {
+                int dstIndex = g.hEdgeOffset + (y-1)*w + x;
+                vdesc.Clear(vertex, varying, dstIndex);
+                vdesc.AddWithWeight(vertex, dstIndex, r[x], 0.25f);
+                vdesc.AddWithWeight(vertex, dstIndex, r[x+1], 0.25f);
+                vdesc.AddWithWeight(vertex, dstIndex, f0 + x, 0.25f);
+                vdesc.AddWithWeight(vertex, dstIndex, f1 + x, 0.25f);
+                vdesc.AddVaryingWithWeight(varying, dstIndex, r[x], 0.5f);
+                vdesc.AddVaryingWithWeight(varying, dstIndex, r[x+1], 0.5f);
+            }
+        }
+
+        // edge-vertices along v
+        for (int y = 0; y < h; y++) {
+            const int *r0 = P + y*(w+1), *r1 = r0 + (w+1);
+            int f = g.faceOffset + y*w;
+            for (int x = 1; x < w; x++) {
+                int dstIndex = g.vEdgeOffset + y*(w-1) + x-1;
+                vdesc.Clear(vertex, varying, dstIndex);
+                vdesc.AddWithWeight(vertex, dstIndex, r0[x], 0.25f);
+                vdesc.AddWithWeight(vertex, dstIndex, r1[x], 0.25f);
+                vdesc.AddWithWeight(vertex, dstIndex, f + x-1, 0.25f);
+                vdesc.AddWithWeight(vertex, dstIndex, f + x, 0.25f);
+                vdesc.AddVaryingWithWeight(varying, dstIndex, r0[x], 0.5f);
+                vdesc.AddVaryingWithWeight(varying, dstIndex, r1[x], 0.5f);
+            }
+        }
+
+        // vertex-vertices (valence 4 smooth rule)
+        for (int y = 1; y < h; y++) {
+            const int *r0 = P + (y-1)*(w+1), *r1 = r0 + (w+1), *r2 = r1 + (w+1);
+            int f0 = g.faceOffset + (y-1)*w, f1 = f0 + w;
+            for (int x = 1; x < w; x++) {
+                int dstIndex = g.vertOffset + (y-1)*(w-1) + x-1;
+                vdesc.Clear(vertex, varying, dstIndex);
+                vdesc.AddWithWeight(vertex, dstIndex, r1[x], 0.5f);
+                vdesc.AddWithWeight(vertex, dstIndex, r1[x+1], 0.0625f);
+                vdesc.AddWithWeight(vertex, dstIndex, r2[x], 0.0625f);
+                vdesc.AddWithWeight(vertex, dstIndex, r1[x-1], 0.0625f);
+                vdesc.AddWithWeight(vertex, dstIndex, r0[x], 0.0625f);
+                vdesc.AddWithWeight(vertex, dstIndex, f1 + x, 0.0625f);
+                vdesc.AddWithWeight(vertex, dstIndex, f1 + x-1, 0.0625f);
+                vdesc.AddWithWeight(vertex, dstIndex, f0 + x-1, 0.0625f);
+                vdesc.AddWithWeight(vertex, dstIndex, f0 + x, 0.0625f);
+                vdesc.AddVaryingWithWeight(varying, dstIndex, r1[x], 1.0f);
+            }
+        }
+    }
+}
+
+void OsdCpuComputeEndCap(
+    OsdVertexDescriptor const &vdesc, float *vertex, float *varying,
+    const int *offsets, const int *indices, const float *weights,
+    const int *varyingIndices, int vertexOffset, int tableOffset,
+    int start, int end) {
+
+    for (int i = start + tableOffset; i < end + tableOffset; i++) {
+        int dstIndex = i + vertexOffset - tableOffset;
+        vdesc.Clear(vertex, varying, dstIndex);
+
+        for (int j = offsets[i]; j < offsets[i+1]; ++j)
+            vdesc.AddWithWeight(vertex, dstIndex, indices[j], weights[j]);
+
+        vdesc.AddVaryingWithWeight(varying, dstIndex, varyingIndices[i], 1.0f);
+    }
+}
+
+void OsdCpuComputeLimit(
+    OsdVertexDescriptor const &vdesc, const float *vertex,
+    float *position, float *tangent1, float *tangent2,
+    const int *vertices, const int *offsets,
+    const int *indices, const float *weights,
+    int start, int end) {
+
+    int n = vdesc.numVertexElements;
+
+    for (int i = start; i < end; i++) {
+        int dst = vertices[i] * n;
+
+        float *p  = position ? position + dst : 0,
+              *t1 = tangent1 ? tangent1 + dst : 0,
+              *t2 = tangent2 ? tangent2 + dst : 0;
+
+        for (int k = 0; k < n; ++k) {
+            if (p)  p[k] = 0.0f;
+            if (t1) t1[k] = 0.0f;
+            if (t2) t2[k] = 0.0f;
+        }
+
+        for (int j = offsets[i]; j < offsets[i+1]; ++j) {
+            const float *src = vertex + indices[j] * n,
+                        *w = weights + j * 3;
+            for (int k = 0; k < n; ++k) {
+                if (p)  p[k]  += w[0] * src[k];
+                if (t1) t1[k] += w[1] * src[k];
+                if (t2) t2[k] += w[2] * src[k];
+            }
+        }
+    }
+}
+
 void OsdCpuEditVertexAdd(
     OsdVertexDescriptor const &vdesc, float *vertex,
     int primVarOffset, int primVarWidth, int vertexOffset, int tableOffset,
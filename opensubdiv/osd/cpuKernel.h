@@ -27,6 +27,7 @@
 
 #include "../version.h"
 
+#include "../far/structuredGrids.h"
 #include "../osd/vertexDescriptor.h"
 
 namespace OpenSubdiv {
@@ -34,11 +35,23 @@ namespace OPENSUBDIV_VERSION {
 
 struct OsdVertexDescriptor;
 
+// Returns the weights of the Catmull-Clark smooth vertex rule for the given
+// valence (the common valences are tabulated)
+void OsdCpuGetCatmarkVertexWeights(int valence, float *wp, float *wv);
+
+// Returns the weight of the Loop smooth vertex rule for the given valence
+// (the common valences are tabulated)
+float OsdCpuGetLoopVertexWeight(int valence);
+
+// Note : 'valence' is the valence shared by all the vertices of the batch
+// (see FarKernelBatch::GetValence) : the common valences are dispatched to
+// kernels unrolled for that valence, 0 falls back to the generic kernel.
+
 void OsdCpuComputeFace(OsdVertexDescriptor const &vdesc,
                        float * vertex, float * varying,
                        const int *F_IT, const int *F_ITa,
                        int vertexOffset, int tableOffset,
-                       int start, int end);
+                       int start, int end, int valence=0);
 
 void OsdCpuComputeEdge(OsdVertexDescriptor const &vdesc,
                        float *vertex, float * varying,
@@ -56,14 +69,14 @@ void OsdCpuComputeVertexB(OsdVertexDescriptor const &vdesc,
                           float *vertex, float * varying,
                           const int *V_ITa, const int *V_IT, const float *V_W,
                           int vertexOffset, int tableOffset,
-                          int start, int end);
+                          int start, int end, int valence=0);
 
 void OsdCpuComputeLoopVertexB(OsdVertexDescriptor const &vdesc,
                               float *vertex, float * varying,
                               const int *V_ITa, const int *V_IT,
                               const float *V_W,
                               int vertexOffset, int tableOffset,
-                              int start, int end);
+                              int start, int end, int valence=0);
 
 void OsdCpuComputeBilinearEdge(OsdVertexDescriptor const &vdesc,
                                float *vertex, float * varying,
@@ -77,6 +90,33 @@ void OsdCpuComputeBilinearVertex(OsdVertexDescriptor const &vdesc,
                                  int vertexOffset, int tableOffset,
                                  int start, int end);
 
+// Refines the structured grids [start, end[ (see FarStructuredGrids)
+void OsdCpuComputeStructuredGrid(OsdVertexDescriptor const &vdesc,
+                                 float *vertex, float * varying,
+                                 const FarStructuredGrids::Grid *grids,
+                                 const int *indices,
+                                 int start, int end);
+
+// Computes the control vertices of the B-spline end caps [start, end[ from
+// their stencils (see FarEndCapTables)
+void OsdCpuComputeEndCap(OsdVertexDescriptor const &vdesc,
+                         float *vertex, float * varying,
+                         const int *offsets, const int *indices,
+                         const float *weights, const int *varyingIndices,
+                         int vertexOffset, int tableOffset,
+                         int start, int end);
+
+// Projects the vertices of the limit masks [start, end[ onto the limit surface
+// and computes their tangents in the same sweep (see FarLimitTables). The
+// results are written at the index of each vertex in the output buffers, which
+// share the layout of the vertex-interpolated data. Any output can be NULL.
+void OsdCpuComputeLimit(OsdVertexDescriptor const &vdesc,
+                        const float *vertex,
+                        float *position, float *tangent1, float *tangent2,
+                        const int *vertices, const int *offsets,
+                        const int *indices, const float *weights,
+                        int start, int end);
+
 void OsdCpuEditVertexAdd(OsdVertexDescriptor const &vdesc, float *vertex,
                          int primVarOffset, int primVarWidth,
                          int vertexOffset, int tableOffset,
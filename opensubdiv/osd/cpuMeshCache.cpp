@@ -0,0 +1,410 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+//
+
+#include "../osd/cpuMeshCache.h"
+#include "../osd/error.h"
+
+#include <cassert>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+// the HbrMesh of the flat topologies only read their subdivision rules
+static HbrBilinearSubdivision<OsdVertex> g_bilinear;
+static HbrCatmarkSubdivision<OsdVertex>  g_catmark;
+static HbrLoopSubdivision<OsdVertex>     g_loop;
+
+OsdCpuMeshCache &
+OsdCpuMeshCache::GetInstance() {
+
+    static OsdCpuMeshCache cache;
+    return cache;
+}
+
+OsdCpuMeshCache::OsdCpuMeshCache() :
+    _memoryBudget(0), _memoryUsed(0), _clock(0),
+    _numHits(0), _numMisses(0), _numEvictions(0) {
+}
+
+OsdCpuMeshCache::~OsdCpuMeshCache() {
+
+    for (EntryMap::iterator it = _entries.begin(); it != _entries.end(); ++it)
+        deleteEntry(it->second);
+}
+
+void
+OsdCpuMeshCache::addOptions(FarTopologyHash & hash, Options const & options) {
+
+    hash.Add(options.maxLevel);
+    hash.Add((int)options.adaptive);
+    hash.Add(options.firstLevel);
+    hash.Add((int)options.structuredGrids);
+    hash.Add((int)options.singleCreasePatch);
+    hash.Add((int)options.bsplineEndCaps);
+    hash.Add((int)options.sparseValenceTable);
+    hash.Add((int)options.requireFVarData);
+    hash.Add((int)options.limitTables);
+
+    if (options.faceLevels) {
+        hash.Add((int)options.faceLevels->size());
+        for (int i = 0; i < (int)options.faceLevels->size(); ++i)
+            hash.Add((*options.faceLevels)[i]);
+    } else {
+        hash.Add(-1);
+    }
+}
+
+FarTopologyHash::Value
+OsdCpuMeshCache::ComputeHash(HbrMesh<OsdVertex> * hmesh, Options const & options) {
+
+    FarTopologyHash hash;
+    hash.AddMesh(hmesh, options.requireFVarData);
+    addOptions(hash, options);
+
+    return hash.GetValue();
+}
+
+HbrSubdivision<OsdVertex> *
+OsdCpuMeshCache::getSubdivision(Topology::Scheme scheme) {
+
+    switch (scheme) {
+        case Topology::kBilinear : return &g_bilinear;
+        case Topology::kLoop     : return &g_loop;
+        default                  : return &g_catmark;
+    }
+}
+
+FarTopologyHash::Value
+OsdCpuMeshCache::ComputeHash(Topology const & topology, Options const & options) {
+
+    FarTopologyHash hash;
+    hash.AddFaces(getSubdivision(topology.scheme), topology.interpolateBoundary,
+                  topology.numVertices, topology.numFaces,
+                  topology.numVertsPerFace, topology.vertIndices,
+                  topology.numHoles, topology.holes,
+                  topology.numCreases, topology.creases, topology.creaseSharpness,
+                  topology.numCorners, topology.corners, topology.cornerSharpness);
+    addOptions(hash, options);
+
+    return hash.GetValue();
+}
+
+OsdCpuMeshCache::Entry const *
+OsdCpuMeshCache::Acquire(FarTopologyHash::Value hash) {
+
+    OsdMutex::ScopedLock lock(_mutex);
+
+    EntryMap::iterator it = _entries.find(hash);
+    if (it == _entries.end())
+        return NULL;
+
+    Entry * entry = it->second;
+    ++entry->_refCount;
+    entry->_lastUse = ++_clock;
+    ++_numHits;
+    return entry;
+}
+
+OsdCpuMeshCache::Entry const *
+OsdCpuMeshCache::find(FarTopologyHash::Value hash,
+                      int numVertices, int numFaces, int numFaceVertices) {
+
+    OsdMutex::ScopedLock lock(_mutex);
+
+    EntryMap::iterator it = _entries.find(hash);
+    if (it == _entries.end())
+        return NULL;
+
+    // a different topology with the same hash is a miss
+    Entry * entry = it->second;
+    if (entry->_numVertices != numVertices or
+        entry->_numFaces != numFaces or
+        entry->_numFaceVertices != numFaceVertices)
+        return NULL;
+
+    ++entry->_refCount;
+    entry->_lastUse = ++_clock;
+    ++_numHits;
+    return entry;
+}
+
+OsdCpuMeshCache::Entry const *
+OsdCpuMeshCache::Acquire(HbrMesh<OsdVertex> * hmesh, Options const & options) {
+
+    assert(hmesh);
+
+    FarTopologyHash::Value hash = ComputeHash(hmesh, options);
+
+    int numVertices = hmesh->GetNumVertices(),
+        numFaces = hmesh->GetNumCoarseFaces(),
+        numFaceVertices = 0;
+    for (int i = 0; i < numFaces; ++i)
+        numFaceVertices += hmesh->GetFace(i)->GetNumVertices();
+
+    if (Entry const * entry = find(hash, numVertices, numFaces, numFaceVertices))
+        return entry;
+
+    return build(hmesh, options, hash, numVertices, numFaces, numFaceVertices);
+}
+
+OsdCpuMeshCache::Entry const *
+OsdCpuMeshCache::Acquire(Topology const & topology, Options const & options) {
+
+    FarTopologyHash::Value hash = ComputeHash(topology, options);
+
+    int numFaceVertices = 0;
+    for (int i = 0; i < topology.numFaces; ++i)
+        numFaceVertices += topology.numVertsPerFace[i];
+
+    if (Entry const * entry = find(hash, topology.numVertices, topology.numFaces, numFaceVertices))
+        return entry;
+
+    for (int i = 0; topology.scheme == Topology::kLoop and i < topology.numFaces; ++i) {
+        if (topology.numVertsPerFace[i] != 3) {
+            OsdError(OSD_INTERNAL_CODING_ERROR,
+                     "Loop meshes only have triangle faces\n");
+            return NULL;
+        }
+    }
+
+    HbrMesh<OsdVertex> hmesh(getSubdivision(topology.scheme));
+
+    OsdVertex v;
+    for (int i = 0; i < topology.numVertices; ++i)
+        hmesh.NewVertex(i, v);
+
+    if (topology.numFaces > 0 and
+        not hmesh.NewFaces(topology.numFaces, topology.numVertsPerFace, topology.vertIndices,
+                           topology.numCreases, topology.creases, topology.creaseSharpness,
+                           topology.numCorners, topology.corners, topology.cornerSharpness)) {
+        OsdError(OSD_INTERNAL_CODING_ERROR,
+                 "Invalid topology : nonexistent vertex, degenerate or non-manifold edge, "
+                 "or crease on a nonexistent edge\n");
+        return NULL;
+    }
+
+    for (int i = 0; i < topology.numHoles; ++i) {
+        if (topology.holes[i] < 0 or topology.holes[i] >= topology.numFaces) {
+            OsdError(OSD_INTERNAL_CODING_ERROR, "Invalid topology : nonexistent hole face\n");
+            return NULL;
+        }
+        hmesh.GetFace(topology.holes[i])->SetHole();
+    }
+
+    // the non-quad faces of the quad schemes have a ptex face per vertex
+    for (int i = 0, ptexIndex = 0; i < topology.numFaces; ++i) {
+        hmesh.GetFace(i)->SetPtexIndex(ptexIndex);
+        int nv = topology.numVertsPerFace[i];
+        ptexIndex += (topology.scheme != Topology::kLoop and nv != 4) ? nv : 1;
+    }
+
+    hmesh.SetInterpolateBoundaryMethod(topology.interpolateBoundary);
+    hmesh.Finish();
+
+    return build(&hmesh, options, hash, topology.numVertices, topology.numFaces, numFaceVertices);
+}
+
+OsdCpuMeshCache::Entry const *
+OsdCpuMeshCache::build(HbrMesh<OsdVertex> * hmesh, Options const & options,
+                       FarTopologyHash::Value hash,
+                       int numVertices, int numFaces, int numFaceVertices) {
+
+    // build the entry without holding the lock : the factories can take a
+    // while and other topologies can be acquired meanwhile
+    Entry * entry = new Entry;
+    entry->_hash = hash;
+    entry->_numVertices = numVertices;
+    entry->_numFaces = numFaces;
+    entry->_numFaceVertices = numFaceVertices;
+
+    FarMeshFactory<OsdVertex> factory(hmesh, options.maxLevel, options);
+
+    entry->_farMesh = factory.Create(options.requireFVarData);
+    if (not entry->_farMesh) {
+        delete entry;
+        return NULL;
+    }
+
+    // the context reads the tables of the FarMesh it shares the entry with
+    entry->_computeContext = OsdCpuComputeContext::Create(entry->_farMesh, true);
+
+    entry->_memoryUsed = entry->_farMesh->GetMemoryUsage().GetTotal() +
+                         entry->_computeContext->GetMemoryUsage().GetTotal();
+
+    OsdMutex::ScopedLock lock(_mutex);
+
+    ++_numMisses;
+
+    // another thread may have built the same topology meanwhile, or a
+    // different topology with the same hash is cached : the entry is then
+    // private to the caller
+    EntryMap::iterator it = _entries.find(hash);
+    if (it == _entries.end()) {
+        entry->_cached = true;
+        _entries[hash] = entry;
+        _memoryUsed += entry->_memoryUsed;
+    } else if (it->second->_numVertices == numVertices and
+               it->second->_numFaces == numFaces and
+               it->second->_numFaceVertices == numFaceVertices) {
+        deleteEntry(entry);
+        entry = it->second;
+    }
+
+    ++entry->_refCount;
+    entry->_lastUse = ++_clock;
+
+    evict();
+
+    return entry;
+}
+
+void
+OsdCpuMeshCache::Release(Entry const * entry) {
+
+    if (not entry)
+        return;
+
+    OsdMutex::ScopedLock lock(_mutex);
+
+    Entry * e = const_cast<Entry *>(entry);
+    assert(e->_refCount > 0);
+    --e->_refCount;
+
+    if (not e->_cached) {
+        if (e->_refCount == 0)
+            deleteEntry(e);
+        return;
+    }
+
+    evict();
+}
+
+void
+OsdCpuMeshCache::SetMemoryBudget(size_t budget) {
+
+    OsdMutex::ScopedLock lock(_mutex);
+
+    _memoryBudget = budget;
+    evict();
+}
+
+size_t
+OsdCpuMeshCache::GetMemoryBudget() const {
+
+    OsdMutex::ScopedLock lock(_mutex);
+    return _memoryBudget;
+}
+
+size_t
+OsdCpuMeshCache::GetMemoryUsed() const {
+
+    OsdMutex::ScopedLock lock(_mutex);
+    return _memoryUsed;
+}
+
+int
+OsdCpuMeshCache::GetNumEntries() const {
+
+    OsdMutex::ScopedLock lock(_mutex);
+    return (int)_entries.size();
+}
+
+int
+OsdCpuMeshCache::GetNumHits() const {
+
+    OsdMutex::ScopedLock lock(_mutex);
+    return _numHits;
+}
+
+int
+OsdCpuMeshCache::GetNumMisses() const {
+
+    OsdMutex::ScopedLock lock(_mutex);
+    return _numMisses;
+}
+
+int
+OsdCpuMeshCache::GetNumEvictions() const {
+
+    OsdMutex::ScopedLock lock(_mutex);
+    return _numEvictions;
+}
+
+void
+OsdCpuMeshCache::Clear() {
+
+    OsdMutex::ScopedLock lock(_mutex);
+
+    for (EntryMap::iterator it = _entries.begin(); it != _entries.end(); ) {
+        Entry * entry = it->second;
+        if (entry->_refCount == 0) {
+            _memoryUsed -= entry->_memoryUsed;
+            deleteEntry(entry);
+            _entries.erase(it++);
+        } else {
+            ++it;
+        }
+    }
+
+    _numHits = _numMisses = _numEvictions = 0;
+}
+
+void
+OsdCpuMeshCache::evict() {
+
+    if (_memoryBudget == 0)
+        return;
+
+    while (_memoryUsed > _memoryBudget) {
+
+        EntryMap::iterator lru = _entries.end();
+        for (EntryMap::iterator it = _entries.begin(); it != _entries.end(); ++it) {
+            if (it->second->_refCount == 0 and
+                (lru == _entries.end() or it->second->_lastUse < lru->second->_lastUse))
+                lru = it;
+        }
+
+        // all the remaining entries are in use
+        if (lru == _entries.end())
+            break;
+
+        _memoryUsed -= lru->second->_memoryUsed;
+        deleteEntry(lru->second);
+        _entries.erase(lru);
+        ++_numEvictions;
+    }
+}
+
+void
+OsdCpuMeshCache::deleteEntry(Entry * entry) {
+
+    // the context references the tables of the FarMesh
+    delete entry->_computeContext;
+    delete entry->_farMesh;
+    delete entry;
+}
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
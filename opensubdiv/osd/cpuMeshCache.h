@@ -0,0 +1,286 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+//
+#ifndef OSD_CPU_MESH_CACHE_H
+#define OSD_CPU_MESH_CACHE_H
+
+#include "../version.h"
+
+#include "../far/meshFactory.h"  // need to define HBR_ADAPTIVE
+#include "../far/topologyHash.h"
+#include "../osd/cpuComputeContext.h"
+#include "../osd/mutex.h"
+#include "../osd/nonCopyable.h"
+#include "../osd/vertex.h"
+
+#include <map>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+/// \brief Process-wide cache of FarMesh and OsdCpuComputeContext instances
+/// keyed by the hash of their topology.
+///
+/// The same cage topology often reappears across the meshes of a process
+/// (variants, crowd agents...) : Acquire hashes the topology of a coarse
+/// HbrMesh and the build options (see FarTopologyHash) and returns the
+/// FarMesh and the compute context built for the first mesh with the same
+/// hash, so that the Far factories only run on a cache miss. The topology can
+/// also be given as flat face-vertex arrays, in which case the HbrMesh is only
+/// built on a cache miss : both forms of a topology share their entry. The
+/// number of vertices, faces and face-vertices of
+/// an entry are checked on a hit : a mesh colliding with a cached entry gets a
+/// private entry instead of the cached FarMesh.
+///
+/// Entries are reference counted : an acquired entry must be released once
+/// its user is done with it. When the memory used by the cache exceeds its
+/// budget, the least recently used entries that are not acquired anymore
+/// are evicted.
+///
+/// Note : the cached objects are shared. A compute context binds the vertex
+/// buffers of the Refine calls, so the users of an entry must not refine
+/// concurrently with its context.
+///
+class OsdCpuMeshCache : OsdNonCopyable<OsdCpuMeshCache> {
+public:
+
+    /// \brief Build options of the cached meshes (see FarMeshFactory)
+    struct Options : FarMeshFactoryOptions {
+
+        Options() : maxLevel(0), requireFVarData(false) { }
+
+        int  maxLevel;
+
+        bool requireFVarData;
+    };
+
+    /// \brief Topology of a coarse mesh given as the flat arrays of
+    /// HbrMesh::NewFaces, and its holes (no face-varying data nor
+    /// hierarchical edits)
+    struct Topology {
+
+        enum Scheme {
+            kBilinear,
+            kCatmark,
+            kLoop
+        };
+
+        Topology() : scheme(kCatmark),
+            interpolateBoundary(HbrMesh<OsdVertex>::k_InterpolateBoundaryEdgeOnly),
+            numVertices(0), numFaces(0), numVertsPerFace(0), vertIndices(0),
+            numHoles(0), holes(0),
+            numCreases(0), creases(0), creaseSharpness(0),
+            numCorners(0), corners(0), cornerSharpness(0) { }
+
+        Scheme scheme;
+
+        HbrMesh<OsdVertex>::InterpolateBoundaryMethod interpolateBoundary;
+
+        int numVertices,
+            numFaces;
+
+        int const * numVertsPerFace,  // the number of vertices of each face
+                  * vertIndices;      // the vertex indices of the faces
+
+        int numHoles;
+        int const * holes;            // face indices
+
+        int numCreases;
+        int const * creases;          // pairs of vertex indices
+        float const * creaseSharpness;
+
+        int numCorners;
+        int const * corners;          // vertex indices
+        float const * cornerSharpness;
+    };
+
+    /// \brief A cached FarMesh and its compute context
+    class Entry {
+    public:
+        /// Returns the hash of the topology and build options of the entry
+        FarTopologyHash::Value GetHash() const { return _hash; }
+
+        /// Returns the cached FarMesh
+        FarMesh<OsdVertex> const * GetFarMesh() const { return _farMesh; }
+
+        /// Returns the cached compute context
+        OsdCpuComputeContext * GetComputeContext() const { return _computeContext; }
+
+        /// Returns the memory used by the FarMesh and the context
+        size_t GetMemoryUsed() const { return _memoryUsed; }
+
+    private:
+        friend class OsdCpuMeshCache;
+
+        Entry() : _hash(0), _numVertices(0), _numFaces(0), _numFaceVertices(0),
+                  _farMesh(0), _computeContext(0), _memoryUsed(0),
+                  _refCount(0), _lastUse(0), _cached(false) { }
+
+        FarTopologyHash::Value _hash;
+
+        // size of the coarse topology, checked on a hash hit
+        int _numVertices,
+            _numFaces,
+            _numFaceVertices;
+
+        FarMesh<OsdVertex>   * _farMesh;
+        OsdCpuComputeContext * _computeContext;
+
+        size_t _memoryUsed;
+
+        int _refCount;
+
+        long _lastUse;
+
+        bool _cached;   // false for the private entries of colliding meshes
+    };
+
+    /// Returns the process-wide cache
+    static OsdCpuMeshCache & GetInstance();
+
+    /// Destructor
+    ~OsdCpuMeshCache();
+
+    /// Returns the hash identifying a mesh in the cache
+    ///
+    /// @param hmesh    the coarse mesh (unrefined)
+    ///
+    /// @param options  the build options
+    ///
+    static FarTopologyHash::Value ComputeHash(HbrMesh<OsdVertex> * hmesh,
+                                              Options const & options);
+
+    /// Returns the hash identifying a mesh given as flat arrays in the cache
+    /// (the same as the hash of the HbrMesh built from the arrays)
+    ///
+    /// @param topology  the coarse topology
+    ///
+    /// @param options   the build options
+    ///
+    static FarTopologyHash::Value ComputeHash(Topology const & topology,
+                                              Options const & options);
+
+    /// Returns the entry matching the topology of a mesh, building it on a
+    /// cache miss. The entry must be released with Release.
+    ///
+    /// @param hmesh    the coarse mesh (unrefined) : the mesh is refined by
+    ///                 the Far factories on a cache miss
+    ///
+    /// @param options  the build options
+    ///
+    Entry const * Acquire(HbrMesh<OsdVertex> * hmesh, Options const & options);
+
+    /// Returns the entry matching the topology of a mesh given as flat
+    /// arrays, building its HbrMesh and the entry on a cache miss. The entry
+    /// must be released with Release.
+    ///
+    /// @param topology  the coarse topology
+    ///
+    /// @param options   the build options
+    ///
+    /// @return NULL if the topology is not valid (see HbrMesh::NewFaces)
+    ///
+    Entry const * Acquire(Topology const & topology, Options const & options);
+
+    /// Returns the entry matching a hash (see ComputeHash) if it is cached,
+    /// NULL otherwise. The entry must be released with Release.
+    ///
+    /// Note : the size of the topology is not checked against the entry.
+    ///
+    Entry const * Acquire(FarTopologyHash::Value hash);
+
+    /// Releases an entry returned by Acquire
+    void Release(Entry const * entry);
+
+    /// Sets the memory budget of the cache, in bytes (0 : no limit) and evicts
+    /// entries to fit it
+    void SetMemoryBudget(size_t budget);
+
+    /// Returns the memory budget of the cache, in bytes (0 : no limit)
+    size_t GetMemoryBudget() const;
+
+    /// Returns the memory used by the cached entries, in bytes
+    size_t GetMemoryUsed() const;
+
+    /// Returns the number of cached entries
+    int GetNumEntries() const;
+
+    /// Returns the number of Acquire calls that found their entry
+    int GetNumHits() const;
+
+    /// Returns the number of Acquire calls that built their entry
+    int GetNumMisses() const;
+
+    /// Returns the number of entries evicted to fit the memory budget
+    int GetNumEvictions() const;
+
+    /// Evicts all the entries that are not acquired and resets the counters
+    void Clear();
+
+protected:
+    OsdCpuMeshCache();
+
+private:
+    typedef std::map<FarTopologyHash::Value, Entry *> EntryMap;
+
+    static void addOptions(FarTopologyHash & hash, Options const & options);
+
+    static HbrSubdivision<OsdVertex> * getSubdivision(Topology::Scheme scheme);
+
+    // returns the cached entry of a hash if the size of its topology matches
+    Entry const * find(FarTopologyHash::Value hash,
+                       int numVertices, int numFaces, int numFaceVertices);
+
+    // builds the entry of a coarse mesh and adds it to the cache
+    Entry const * build(HbrMesh<OsdVertex> * hmesh, Options const & options,
+                        FarTopologyHash::Value hash,
+                        int numVertices, int numFaces, int numFaceVertices);
+
+    // evicts the least recently used entries until the budget is met
+    // (the mutex must be locked)
+    void evict();
+
+    static void deleteEntry(Entry * entry);
+
+    mutable OsdMutex _mutex;
+
+    EntryMap _entries;
+
+    size_t _memoryBudget,
+           _memoryUsed;
+
+    long _clock;
+
+    int _numHits,
+        _numMisses,
+        _numEvictions;
+};
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OSD_CPU_MESH_CACHE_H
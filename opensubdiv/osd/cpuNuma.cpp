@@ -0,0 +1,193 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+//
+
+#include "../osd/cpuNuma.h"
+
+#if defined(_WIN32)
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#elif defined(__linux__)
+    #include <dirent.h>
+    #include <sched.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#else
+    #include <unistd.h>
+#endif
+
+#include <stdlib.h>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+#if defined(__linux__)
+// Returns the mask of the online NUMA nodes and the index of the highest one
+static int
+getNodeMask(unsigned long * mask, int maskWords) {
+
+    for (int i=0; i<maskWords; ++i)
+        mask[i] = 0;
+
+    int maxNode = -1;
+    DIR * dir = opendir("/sys/devices/system/node");
+    if (dir) {
+        struct dirent * entry;
+        while ((entry = readdir(dir))) {
+            char const * name = entry->d_name;
+            if (name[0]!='n' or name[1]!='o' or name[2]!='d' or name[3]!='e' or
+                name[4]<'0' or name[4]>'9')
+                continue;
+            int node = atoi(name+4);
+            if (node < maskWords*(int)sizeof(unsigned long)*8) {
+                mask[node/(sizeof(unsigned long)*8)] |= 1UL << (node%(sizeof(unsigned long)*8));
+                if (node>maxNode)
+                    maxNode = node;
+            }
+        }
+        closedir(dir);
+    }
+    return maxNode;
+}
+#endif
+
+OsdCpuNuma::Placement &
+OsdCpuNuma::getPlacement() {
+
+    static Placement placement = kPlacementDefault;
+    return placement;
+}
+
+void
+OsdCpuNuma::SetPlacement(Placement placement) {
+
+    getPlacement() = placement;
+}
+
+OsdCpuNuma::Placement
+OsdCpuNuma::GetPlacement() {
+
+    return getPlacement();
+}
+
+int
+OsdCpuNuma::GetNumNodes() {
+
+#if defined(_WIN32)
+    ULONG highest = 0;
+    if (GetNumaHighestNodeNumber(&highest))
+        return (int)highest+1;
+    return 1;
+#elif defined(__linux__)
+    unsigned long mask[16];
+    int maxNode = getNodeMask(mask, 16);
+    return maxNode<0 ? 1 : maxNode+1;
+#else
+    return 1;
+#endif
+}
+
+void
+OsdCpuNuma::GetAllowedCpus(std::vector<int> & cpus) {
+
+    cpus.clear();
+#if defined(_WIN32)
+    DWORD_PTR processMask, systemMask;
+    if (GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)) {
+        for (int i=0; i<(int)sizeof(DWORD_PTR)*8; ++i)
+            if (processMask & ((DWORD_PTR)1 << i))
+                cpus.push_back(i);
+    }
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set)==0) {
+        for (int i=0; i<CPU_SETSIZE; ++i)
+            if (CPU_ISSET(i, &set))
+                cpus.push_back(i);
+    }
+#endif
+    if (cpus.empty()) {
+#if defined(_WIN32)
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        int ncpus = (int)info.dwNumberOfProcessors;
+#else
+        int ncpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+        for (int i=0; i<ncpus; ++i)
+            cpus.push_back(i);
+    }
+}
+
+bool
+OsdCpuNuma::PinThread(int cpu) {
+
+#if defined(_WIN32)
+    if (cpu<0 or cpu>=(int)sizeof(DWORD_PTR)*8)
+        return false;
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu)!=0;
+#elif defined(__linux__)
+    if (cpu<0 or cpu>=CPU_SETSIZE)
+        return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    // on Linux, a pid of 0 designates the calling thread
+    return sched_setaffinity(0, sizeof(set), &set)==0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+void
+OsdCpuNuma::Bind(void * ptr, size_t size, bool readOnly) {
+
+#if defined(__linux__)
+    Placement placement = GetPlacement();
+    if (placement==kPlacementInterleave or
+        (placement==kPlacementFirstTouch and readOnly)) {
+
+        unsigned long mask[16];
+        int maxNode = getNodeMask(mask, 16);
+        if (maxNode>0) {
+            // MPOL_INTERLEAVE : failure leaves the default policy in place
+            syscall(SYS_mbind, ptr, size, 3, mask, (unsigned long)maxNode+2, 0);
+        }
+    }
+#else
+    (void)ptr;
+    (void)size;
+    (void)readOnly;
+#endif
+}
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
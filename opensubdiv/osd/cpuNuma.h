@@ -0,0 +1,108 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+//
+#ifndef OSD_CPU_NUMA_H
+#define OSD_CPU_NUMA_H
+
+#include "../version.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+/// \brief NUMA placement of the CPU buffers and thread affinity helpers.
+///
+/// On multi-socket machines, the pages of a buffer are by default placed on
+/// the node of the thread that first writes to them : a vertex buffer filled by
+/// a single thread ends up entirely on one socket, and the kernels running on
+/// the other sockets then read remote memory.
+///
+/// The placement policy set here applies to the page-sized blocks that the
+/// OsdCpuAllocator implementations hand out to OsdCpuVertexBuffer and
+/// OsdCpuTable after the call :
+///
+/// - kPlacementDefault    : the operating system default (previous behavior)
+///
+/// - kPlacementInterleave : pages are interleaved round-robin across all the
+///                          nodes the process is allowed to use
+///
+/// - kPlacementFirstTouch : vertex buffers are left untouched so that their
+///                          pages are placed by the first parallel write (see
+///                          OsdOmpComputeController::FirstTouch), while the
+///                          read-only tables are interleaved
+///
+/// Explicit placement is only implemented on Linux : on other platforms the
+/// buffers are allocated with the default policy.
+///
+class OsdCpuNuma {
+public:
+    enum Placement {
+        kPlacementDefault=0,
+        kPlacementInterleave,
+        kPlacementFirstTouch
+    };
+
+    /// Sets the placement policy of the buffers allocated after the call
+    static void SetPlacement(Placement placement);
+
+    /// Returns the current placement policy
+    static Placement GetPlacement();
+
+    /// Returns the number of NUMA nodes of the machine (1 if unknown)
+    static int GetNumNodes();
+
+    /// Returns the indices of the CPUs the process is allowed to run on
+    static void GetAllowedCpus(std::vector<int> & cpus);
+
+    /// Pins the calling thread to a single CPU. Returns false if thread
+    /// affinity is not supported on this platform or the call failed.
+    ///
+    /// @param cpu  the index of the CPU
+    ///
+    static bool PinThread(int cpu);
+
+    /// Applies the placement policy to a range of pages that have not been
+    /// touched yet
+    ///
+    /// @param ptr       the page-aligned start of the range
+    ///
+    /// @param size      the size of the range in bytes
+    ///
+    /// @param readOnly  true if the range holds tables that are written once
+    ///                  and then shared by all the threads
+    ///
+    static void Bind(void * ptr, size_t size, bool readOnly);
+
+private:
+    static Placement & getPlacement();
+};
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OSD_CPU_NUMA_H
@@ -0,0 +1,329 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+//
+
+#include "../osd/cpuPatchBounds.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #include <omp.h>
+#endif
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #include <xmmintrin.h>
+    #define OSD_PATCH_BOUNDS_SSE
+#endif
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+// Appends the faces of a rows x cols lattice of control vertices
+static void
+appendLatticeQuads(std::vector<int> & quads, unsigned int const * cvs, int rows, int cols) {
+
+    for (int r = 0; r < rows-1; ++r) {
+        for (int c = 0; c < cols-1; ++c) {
+            quads.push_back(cvs[r*cols + c]);
+            quads.push_back(cvs[r*cols + c+1]);
+            quads.push_back(cvs[(r+1)*cols + c+1]);
+            quads.push_back(cvs[(r+1)*cols + c]);
+        }
+    }
+}
+
+OsdCpuPatchBounds::OsdCpuPatchBounds(FarPatchTables const * patchTables,
+                                     bool normalCones) {
+
+    assert(patchTables);
+
+    int npatches = patchTables->GetNumPatches();
+
+    _boxes.resize(npatches);
+    if (normalCones)
+        _cones.resize(npatches);
+
+    _hullOffsets.resize(npatches+1, 0);
+    _hullIndices.reserve(patchTables->GetNumControlVertices());
+    if (normalCones)
+        _quadOffsets.resize(npatches+1, 0);
+
+    FarPatchTables::PTable const & ptable = patchTables->GetPatchTable();
+    FarPatchTables::VertexValenceTable const & valences = patchTables->GetVertexValenceTable();
+
+    // gather the hull vertices (and faces) in patch param order
+    std::vector<std::vector<int> > hulls(npatches), quads(normalCones ? npatches : 0);
+
+    FarPatchTables::PatchArrayVector const & parrays = patchTables->GetPatchArrayVector();
+    for (int i = 0; i < (int)parrays.size(); ++i) {
+
+        FarPatchTables::PatchArray const & parray = parrays[i];
+        FarPatchTables::Type type = parray.GetDescriptor().GetType();
+
+        int ncvs = parray.GetDescriptor().GetNumControlVertices();
+        if (ncvs <= 0)
+            continue;
+
+        for (int j = 0; j < (int)parray.GetNumPatches(); ++j) {
+
+            int patch = parray.GetPatchIndex() + j;
+            unsigned int const * cvs = &ptable[parray.GetVertIndex() + j*ncvs];
+
+            std::vector<int> & hull = hulls[patch];
+            hull.assign(cvs, cvs+ncvs);
+
+            bool gregory = (type==FarPatchTables::GREGORY or
+                            type==FarPatchTables::GREGORY_BOUNDARY);
+
+            // the hull of a Gregory patch spans the one-ring of its corners
+            if (gregory and (not valences.empty())) {
+                for (int k = 0; k < 4; ++k) {
+                    int const * ring = patchTables->GetVertexValences(cvs[k]);
+                    int valence = abs(ring[0]);
+                    hull.insert(hull.end(), ring+1, ring+1+2*valence);
+                }
+            }
+
+            if (not normalCones)
+                continue;
+
+            std::vector<int> & q = quads[patch];
+            switch (type) {
+                case FarPatchTables::REGULAR  :
+                case FarPatchTables::SINGLE_CREASE : appendLatticeQuads(q, cvs, 4, 4); break;
+                case FarPatchTables::BOUNDARY : appendLatticeQuads(q, cvs, 3, 4); break;
+                case FarPatchTables::CORNER   : appendLatticeQuads(q, cvs, 3, 3); break;
+                case FarPatchTables::QUADS    : q.assign(cvs, cvs+4); break;
+                case FarPatchTables::TRIANGLES: q.assign(cvs, cvs+3); q.push_back(cvs[2]); break;
+                case FarPatchTables::GREGORY  :
+                case FarPatchTables::GREGORY_BOUNDARY : {
+                    q.assign(cvs, cvs+4);
+                    if (valences.empty())
+                        break;
+
+                    // faces around the corners : (v, N_i, D_i, N_i+1)
+                    for (int k = 0; k < 4; ++k) {
+                        int const * ring = patchTables->GetVertexValences(cvs[k]);
+                        int valence = abs(ring[0]),
+                            nfaces = ring[0] < 0 ? valence-1 : valence;
+                        for (int f = 0; f < nfaces; ++f) {
+                            q.push_back(cvs[k]);
+                            q.push_back(ring[1 + 2*f]);
+                            q.push_back(ring[2 + 2*f]);
+                            q.push_back(ring[1 + 2*((f+1)%valence)]);
+                        }
+                    }
+                } break;
+                default : break;
+            }
+        }
+    }
+
+    // flatten
+    for (int i = 0; i < npatches; ++i) {
+        _hullIndices.insert(_hullIndices.end(), hulls[i].begin(), hulls[i].end());
+        _hullOffsets[i+1] = (int)_hullIndices.size();
+        if (normalCones) {
+            _quadIndices.insert(_quadIndices.end(), quads[i].begin(), quads[i].end());
+            _quadOffsets[i+1] = (int)_quadIndices.size();
+        }
+    }
+}
+
+OsdCpuPatchBounds::~OsdCpuPatchBounds() {
+}
+
+OsdCpuPatchBounds *
+OsdCpuPatchBounds::Create(FarPatchTables const * patchTables, bool normalCones) {
+
+    return new OsdCpuPatchBounds(patchTables, normalCones);
+}
+
+// Computes the box of the vertices [begin, end[ of a hull
+static inline void
+computeBox(float const * vertices, int stride, int const * begin, int const * end,
+           OsdCpuPatchBounds::Box & box) {
+
+    if (begin == end) {
+        box.min[0] = box.min[1] = box.min[2] = 0.0f;
+        box.max[0] = box.max[1] = box.max[2] = 0.0f;
+        return;
+    }
+
+#ifdef OSD_PATCH_BOUNDS_SSE
+    float const * p = vertices + (*begin) * stride;
+    __m128 lo = _mm_setr_ps(p[0], p[1], p[2], 0.0f),
+           hi = lo;
+
+    for (int const * i = begin+1; i < end; ++i) {
+        p = vertices + (*i) * stride;
+        __m128 v = _mm_setr_ps(p[0], p[1], p[2], 0.0f);
+        lo = _mm_min_ps(lo, v);
+        hi = _mm_max_ps(hi, v);
+    }
+
+    float tmp[4];
+    _mm_storeu_ps(tmp, lo);
+    box.min[0] = tmp[0]; box.min[1] = tmp[1]; box.min[2] = tmp[2];
+    _mm_storeu_ps(tmp, hi);
+    box.max[0] = tmp[0]; box.max[1] = tmp[1]; box.max[2] = tmp[2];
+#else
+    float const * p = vertices + (*begin) * stride;
+    for (int k = 0; k < 3; ++k)
+        box.min[k] = box.max[k] = p[k];
+
+    for (int const * i = begin+1; i < end; ++i) {
+        p = vertices + (*i) * stride;
+        for (int k = 0; k < 3; ++k) {
+            box.min[k] = p[k] < box.min[k] ? p[k] : box.min[k];
+            box.max[k] = p[k] > box.max[k] ? p[k] : box.max[k];
+        }
+    }
+#endif
+}
+
+// Computes the cone bounding the normals of the quads [begin, end[ of a hull
+static inline void
+computeCone(float const * vertices, int stride, int const * begin, int const * end,
+            OsdCpuPatchBounds::Cone & cone) {
+
+    cone.axis[0] = cone.axis[1] = cone.axis[2] = 0.0f;
+    cone.cosAngle = -1.0f;
+
+    // accumulate the unit normals
+    for (int const * q = begin; q < end; q += 4) {
+        float const * a = vertices + q[0] * stride,
+                    * b = vertices + q[1] * stride,
+                    * c = vertices + q[2] * stride,
+                    * d = vertices + q[3] * stride;
+
+        float d0[3] = { c[0]-a[0], c[1]-a[1], c[2]-a[2] },
+              d1[3] = { d[0]-b[0], d[1]-b[1], d[2]-b[2] },
+              n[3] = { d0[1]*d1[2]-d0[2]*d1[1],
+                       d0[2]*d1[0]-d0[0]*d1[2],
+                       d0[0]*d1[1]-d0[1]*d1[0] };
+
+        float len = sqrtf(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+        if (len > 0.0f) {
+            cone.axis[0] += n[0]/len;
+            cone.axis[1] += n[1]/len;
+            cone.axis[2] += n[2]/len;
+        }
+    }
+
+    float len = sqrtf(cone.axis[0]*cone.axis[0] +
+                      cone.axis[1]*cone.axis[1] +
+                      cone.axis[2]*cone.axis[2]);
+    if (len <= 1e-6f)
+        return;
+
+    cone.axis[0] /= len;
+    cone.axis[1] /= len;
+    cone.axis[2] /= len;
+
+    // widen the cone to the normal furthest from the axis
+    float cosAngle = 1.0f;
+    for (int const * q = begin; q < end; q += 4) {
+        float const * a = vertices + q[0] * stride,
+                    * b = vertices + q[1] * stride,
+                    * c = vertices + q[2] * stride,
+                    * d = vertices + q[3] * stride;
+
+        float d0[3] = { c[0]-a[0], c[1]-a[1], c[2]-a[2] },
+              d1[3] = { d[0]-b[0], d[1]-b[1], d[2]-b[2] },
+              n[3] = { d0[1]*d1[2]-d0[2]*d1[1],
+                       d0[2]*d1[0]-d0[0]*d1[2],
+                       d0[0]*d1[1]-d0[1]*d1[0] };
+
+        float nlen = sqrtf(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+        if (nlen > 0.0f) {
+            float cosn = (n[0]*cone.axis[0] + n[1]*cone.axis[1] + n[2]*cone.axis[2]) / nlen;
+            cosAngle = cosn < cosAngle ? cosn : cosAngle;
+        }
+    }
+    cone.cosAngle = cosAngle;
+}
+
+void
+OsdCpuPatchBounds::Update(float const * vertices, int stride) {
+
+    int npatches = GetNumPatches();
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    // one contiguous range of patches per thread
+    #pragma omp parallel
+    {
+        int numThreads = omp_get_num_threads(),
+            thread = omp_get_thread_num();
+
+        int start = (int)((long long)npatches * thread / numThreads),
+            end = (int)((long long)npatches * (thread+1) / numThreads);
+
+        if (start < end)
+            Update(vertices, stride, start, end);
+    }
+#else
+    Update(vertices, stride, 0, npatches);
+#endif
+}
+
+void
+OsdCpuPatchBounds::Update(float const * vertices, int stride, int start, int end) {
+
+    assert(vertices and stride >= 3);
+    assert(start >= 0 and end <= GetNumPatches());
+
+    int const * hulls = _hullIndices.empty() ? 0 : &_hullIndices[0];
+    for (int i = start; i < end; ++i) {
+        computeBox(vertices, stride, hulls + _hullOffsets[i],
+                   hulls + _hullOffsets[i+1], _boxes[i]);
+    }
+
+    if (_cones.empty())
+        return;
+
+    int const * quads = _quadIndices.empty() ? 0 : &_quadIndices[0];
+    for (int i = start; i < end; ++i) {
+        computeCone(vertices, stride, quads + _quadOffsets[i],
+                    quads + _quadOffsets[i+1], _cones[i]);
+    }
+}
+
+FarMemoryUsage
+OsdCpuPatchBounds::GetMemoryUsage() const {
+
+    FarMemoryUsage result;
+    result.AddVector("hullOffsets", _hullOffsets);
+    result.AddVector("hullIndices", _hullIndices);
+    result.AddVector("quadOffsets", _quadOffsets);
+    result.AddVector("quadIndices", _quadIndices);
+    result.AddVector("boxes", _boxes);
+    result.AddVector("cones", _cones);
+    return result;
+}
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
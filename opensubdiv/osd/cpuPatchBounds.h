@@ -0,0 +1,144 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+//
+#ifndef OSD_CPU_PATCH_BOUNDS_H
+#define OSD_CPU_PATCH_BOUNDS_H
+
+#include "../version.h"
+
+#include "../far/memoryUsage.h"
+#include "../far/patchTables.h"
+#include "../osd/nonCopyable.h"
+
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+/// \brief Bounding volumes of the patches of a FarPatchTables.
+///
+/// Holds an axis-aligned bounding box of the control hull of each patch and,
+/// optionally, a cone bounding the normals of the faces of the hull. The hull
+/// of a Gregory patch includes the one-ring of its corner vertices.
+///
+/// The volumes are indexed like the patch param table and are refreshed from a
+/// refined vertex buffer (uniform or feature adaptive), so that culling and BVH
+/// refits can consume them directly. Once attached to an OsdCpuComputeContext,
+/// the CPU compute controllers refresh them at the end of each Refine, while
+/// the refined vertices are still in cache ; once attached to an
+/// OsdCpuEvalLimitContext, they are refreshed when the vertex data is bound.
+/// The position of a vertex is read from its first 3 elements.
+///
+/// Note : the normal cones are built from the faces of the control hulls and
+/// are only an estimate of the normals of the limit surface.
+///
+class OsdCpuPatchBounds : OsdNonCopyable<OsdCpuPatchBounds> {
+public:
+    /// \brief Axis-aligned bounding box
+    struct Box {
+        float min[3],
+              max[3];
+    };
+
+    /// \brief Cone of normals : all the normals n verify dot(n, axis) >=
+    /// cosAngle (cosAngle is -1 if the normals are not bounded)
+    struct Cone {
+        float axis[3],
+              cosAngle;
+    };
+
+    /// Creates the bounding volumes of the patches
+    ///
+    /// @param patchTables  the patches to bound
+    ///
+    /// @param normalCones  if true, the normal cones are computed along with
+    ///                     the boxes
+    ///
+    static OsdCpuPatchBounds * Create(FarPatchTables const * patchTables,
+                                      bool normalCones=false);
+
+    /// Destructor
+    ~OsdCpuPatchBounds();
+
+    /// Refreshes the bounding volumes from the control vertices.
+    ///
+    /// @param vertexBuffer  the refined vertex buffer
+    ///
+    template<class VERTEX_BUFFER>
+    void Update(VERTEX_BUFFER * vertexBuffer) {
+        Update(vertexBuffer->BindCpuBuffer(), vertexBuffer->GetNumElements());
+    }
+
+    /// Refreshes the bounding volumes from the control vertices.
+    ///
+    /// @param vertices  the refined vertex data
+    ///
+    /// @param stride    the number of floats per vertex
+    ///
+    void Update(float const * vertices, int stride);
+
+    /// Refreshes a range of the bounding volumes from the control vertices
+    /// (single threaded).
+    ///
+    /// @param vertices  the refined vertex data
+    ///
+    /// @param stride    the number of floats per vertex
+    ///
+    /// @param start     the first patch to refresh
+    ///
+    /// @param end       the patch after the last one to refresh
+    ///
+    void Update(float const * vertices, int stride, int start, int end);
+
+    /// Returns the number of patches
+    int GetNumPatches() const { return (int)_boxes.size(); }
+
+    /// Returns the bounding boxes of the patches
+    Box const * GetBoxes() const { return _boxes.empty() ? 0 : &_boxes[0]; }
+
+    /// Returns the normal cones of the patches (NULL if they were not requested)
+    Cone const * GetCones() const { return _cones.empty() ? 0 : &_cones[0]; }
+
+    /// Returns the itemized memory allocated by the bounding volumes
+    FarMemoryUsage GetMemoryUsage() const;
+
+protected:
+    OsdCpuPatchBounds(FarPatchTables const * patchTables, bool normalCones);
+
+private:
+    std::vector<int> _hullOffsets,  // hull vertices of each patch
+                     _hullIndices,
+                     _quadOffsets,  // hull faces of each patch (4 indices each)
+                     _quadIndices;
+
+    std::vector<Box>  _boxes;
+    std::vector<Cone> _cones;
+};
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OSD_CPU_PATCH_BOUNDS_H
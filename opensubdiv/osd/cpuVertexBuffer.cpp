@@ -24,6 +24,7 @@
 //
 
 #include "../osd/cpuVertexBuffer.h"
+#include "../osd/cpuAllocator.h"
 
 #include <string.h>
 
@@ -33,20 +34,23 @@ namespace OPENSUBDIV_VERSION {
 OsdCpuVertexBuffer::OsdCpuVertexBuffer(int numElements, int numVertices)
     : _numElements(numElements),
       _numVertices(numVertices),
-      _cpuBuffer(NULL) {
-
-    _cpuBuffer = new float[numElements * numVertices];
+      _cpuBuffer(NULL),
+      _allocator(OsdCpuAllocator::GetCurrent()) {
 }
 
 OsdCpuVertexBuffer::~OsdCpuVertexBuffer() {
 
-    delete[] _cpuBuffer;
+    _allocator->Free(_cpuBuffer, _numElements * _numVertices * sizeof(float));
 }
 
 OsdCpuVertexBuffer *
 OsdCpuVertexBuffer::Create(int numElements, int numVertices) {
 
-    return new OsdCpuVertexBuffer(numElements, numVertices);
+    OsdCpuVertexBuffer *instance =
+        new OsdCpuVertexBuffer(numElements, numVertices);
+    if (instance->allocate()) return instance;
+    delete instance;
+    return NULL;
 }
 
 void
@@ -74,6 +78,18 @@ OsdCpuVertexBuffer::BindCpuBuffer() {
     return _cpuBuffer;
 }
 
+bool
+OsdCpuVertexBuffer::allocate() {
+
+    size_t size = _numElements * _numVertices * sizeof(float);
+
+    // the pool and huge page allocators return NULL when the pages cannot
+    // be mapped
+    _cpuBuffer = (float *)_allocator->Allocate(size, /*readOnly=*/false);
+
+    return _cpuBuffer or size==0;
+}
+
 }  // end namespace OPENSUBDIV_VERSION
 }  // end namespace OpenSubdiv
 
@@ -30,6 +30,8 @@
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
+class OsdCpuAllocator;
+
 /// \brief Concrete vertex buffer class for cpu subvision.
 ///
 /// OsdCpuVertexBuffer implements the OsdVertexBufferInterface. An instance
@@ -60,12 +62,36 @@ protected:
     /// Constructor.
     OsdCpuVertexBuffer(int numElements, int numVertices);
 
+    /// Allocates the CPU buffer. Returns false if the allocation failed.
+    bool allocate();
+
 private:
     int _numElements;
     int _numVertices;
     float *_cpuBuffer;
+
+    OsdCpuAllocator *_allocator;  // allocator the buffer was obtained from
 };
 
+/// \brief Vertex buffer interface to CPU data bound ahead of a refinement.
+///
+/// Controllers that defer the refinement of the buffers they are given
+/// (OsdCpuAsyncComputeController, OsdOmpRefineScheduler) bind them when the
+/// request is made, and refine this wrapper of the bound data later.
+///
+class OsdCpuBoundBuffer {
+public:
+    OsdCpuBoundBuffer(float *data, int numElements) :
+        _data(data), _numElements(numElements) { }
+
+    float * BindCpuBuffer() const { return _data; }
+
+    int GetNumElements() const { return _numElements; }
+
+private:
+    float *_data;
+    int _numElements;
+};
 
 }  // end namespace OPENSUBDIV_VERSION
 using namespace OPENSUBDIV_VERSION;
@@ -24,6 +24,7 @@
 //
 
 #include "../far/mesh.h"
+#include "../osd/error.h"
 #include "../osd/cudaComputeContext.h"
 
 #include <cuda_runtime.h>
@@ -124,7 +125,7 @@ OsdCudaHEditTable::GetPrimvarWidth() const {
 // ----------------------------------------------------------------------------
 
 OsdCudaComputeContext::OsdCudaComputeContext() :
-    _currentVertexBuffer(NULL), _currentVaryingBuffer(NULL) {
+    _currentVertexBuffer(NULL), _currentVaryingBuffer(NULL), _observer(NULL) {
 }
 
 OsdCudaComputeContext::~OsdCudaComputeContext() {
@@ -218,6 +219,21 @@ OsdCudaComputeContext::GetCurrentVaryingBuffer() const {
 OsdCudaComputeContext *
 OsdCudaComputeContext::Create(FarMesh<OsdVertex> const *farmesh) {
 
+    // no device kernel applies the structured grids yet
+    if (farmesh->GetSubdivisionTables()->GetStructuredGrids().GetNumGrids() > 0) {
+        OsdError(OSD_UNSUPPORTED_OPTION_ERROR,
+                 "Structured grids are not supported by this compute context\n");
+        return NULL;
+    }
+
+    // nor the B-spline end caps
+    if (farmesh->GetEndCapTables() and
+        farmesh->GetEndCapTables()->GetNumVertices() > 0) {
+        OsdError(OSD_UNSUPPORTED_OPTION_ERROR,
+                 "B-spline end caps are not supported by this compute context\n");
+        return NULL;
+    }
+
     OsdCudaComputeContext *result = new OsdCudaComputeContext();
 
     if (result->initialize(farmesh) == false) {
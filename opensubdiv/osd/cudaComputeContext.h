@@ -38,6 +38,8 @@
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
+class FarKernelBatchObserver;
+
 class OsdCudaTable : OsdNonCopyable<OsdCudaTable> {
 public:
     template<typename T>
@@ -106,6 +108,9 @@ public:
     ///
     /// @param farmesh the FarMesh used for this Context.
     ///
+    /// @return NULL if the FarMesh has structured grids or B-spline end
+    ///         caps, which have no device kernel yet
+    ///
     static OsdCudaComputeContext * Create(FarMesh<OsdVertex> const *farmesh);
 
     /// Destructor
@@ -174,6 +179,14 @@ public:
         return _vdesc;
     }
 
+    /// Attaches an observer notified around each kernel batch queued by the
+    /// compute controller (see FarKernelBatchObserver). The context does not
+    /// take ownership of the observer (NULL detaches it).
+    void SetKernelBatchObserver(FarKernelBatchObserver * observer) { _observer = observer; }
+
+    /// Returns the kernel batch observer (NULL if none is attached)
+    FarKernelBatchObserver * GetKernelBatchObserver() const { return _observer; }
+
 
 protected:
     OsdCudaComputeContext();
@@ -189,6 +202,8 @@ private:
           *_currentVaryingBuffer;
 
     OsdVertexDescriptor _vdesc;
+
+    FarKernelBatchObserver *_observer;
 };
 
 }  // end namespace OPENSUBDIV_VERSION
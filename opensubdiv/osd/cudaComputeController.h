@@ -33,6 +33,15 @@
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
+class OsdCudaComputeController;
+
+// no device kernel applies the structured grids nor the B-spline end caps
+// yet (the compute context refuses the meshes that have them)
+template <> struct FarKernelSupport<OsdCudaComputeController> {
+    static const bool structuredGrids = false;
+    static const bool endCaps = false;
+};
+
 /// \brief Compute controller for launching CUDA subdivision kernels.
 ///
 /// OsdCudaComputeController is a compute controller class to launch
@@ -76,7 +85,8 @@ public:
         FarDispatcher::Refine(this,
                               batches,
                               -1,
-                              context);
+                              context,
+                              context->GetKernelBatchObserver());
         context->Unbind();
     }
 
@@ -148,7 +148,7 @@ OsdD3D11ComputeHEditTable::GetPrimvarWidth() const {
 OsdD3D11ComputeContext::OsdD3D11ComputeContext(
     FarMesh<OsdVertex> const *farMesh, ID3D11DeviceContext *deviceContext)
     : _deviceContext(deviceContext),
-      _currentVertexBufferUAV(0), _currentVaryingBufferUAV(0) {
+      _currentVertexBufferUAV(0), _currentVaryingBufferUAV(0), _observer(NULL) {
 
     FarSubdivisionTables<OsdVertex> const * farTables =
         farMesh->GetSubdivisionTables();
@@ -252,6 +252,21 @@ OsdD3D11ComputeContext::SetDeviceContext(ID3D11DeviceContext *deviceContext) {
 OsdD3D11ComputeContext *
 OsdD3D11ComputeContext::Create(FarMesh<OsdVertex> const *farmesh, ID3D11DeviceContext *deviceContext) {
 
+    // no device kernel applies the structured grids yet
+    if (farmesh->GetSubdivisionTables()->GetStructuredGrids().GetNumGrids() > 0) {
+        OsdError(OSD_UNSUPPORTED_OPTION_ERROR,
+                 "Structured grids are not supported by this compute context\n");
+        return NULL;
+    }
+
+    // nor the B-spline end caps
+    if (farmesh->GetEndCapTables() and
+        farmesh->GetEndCapTables()->GetNumVertices() > 0) {
+        OsdError(OSD_UNSUPPORTED_OPTION_ERROR,
+                 "B-spline end caps are not supported by this compute context\n");
+        return NULL;
+    }
+
     return new OsdD3D11ComputeContext(farmesh, deviceContext);
 }
 
@@ -44,6 +44,8 @@ struct ID3D11ShaderResourceView;
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
+class FarKernelBatchObserver;
+
 class OsdD3D11ComputeKernelBundle;
 
 class OsdD3D11ComputeTable : OsdNonCopyable<OsdD3D11ComputeTable> {
@@ -108,6 +110,9 @@ public:
     ///
     /// @param deviceContext  D3D device
     ///
+    /// @return NULL if the FarMesh has structured grids or B-spline end
+    ///         caps, which have no device kernel yet
+    ///
     static OsdD3D11ComputeContext * Create(FarMesh<OsdVertex> const *farmesh,
                                            ID3D11DeviceContext *deviceContext);
 
@@ -183,6 +188,14 @@ public:
 
     void UnbindEditShaderStorageBuffers();
 
+    /// Attaches an observer notified around each kernel batch queued by the
+    /// compute controller (see FarKernelBatchObserver). The context does not
+    /// take ownership of the observer (NULL detaches it).
+    void SetKernelBatchObserver(FarKernelBatchObserver * observer) { _observer = observer; }
+
+    /// Returns the kernel batch observer (NULL if none is attached)
+    FarKernelBatchObserver * GetKernelBatchObserver() const { return _observer; }
+
 protected:
     explicit OsdD3D11ComputeContext(FarMesh<OsdVertex> const *farMesh, ID3D11DeviceContext *deviceContext);
 
@@ -202,6 +215,8 @@ private:
                               * _currentVaryingBufferUAV;
 
     OsdD3D11ComputeKernelBundle * _kernelBundle;
+
+    FarKernelBatchObserver *_observer;
 };
 
 }  // end namespace OPENSUBDIV_VERSION
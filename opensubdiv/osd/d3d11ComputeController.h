@@ -40,6 +40,15 @@ namespace OPENSUBDIV_VERSION {
 
 class OsdD3D11ComputeKernelBundle;
 
+class OsdD3D11ComputeController;
+
+// no device kernel applies the structured grids nor the B-spline end caps
+// yet (the compute context refuses the meshes that have them)
+template <> struct FarKernelSupport<OsdD3D11ComputeController> {
+    static const bool structuredGrids = false;
+    static const bool endCaps = false;
+};
+
 /// \brief Compute controller for launching D3D11Compute transform feedback
 /// subdivision kernels.
 ///
@@ -91,7 +100,8 @@ public:
         FarDispatcher::Refine(this,
                               batches,
                               -1,
-                              context);
+                              context,
+                              context->GetKernelBatchObserver());
         context->Unbind();
     }
 
@@ -26,6 +26,7 @@
 #include "../far/dispatcher.h"
 #include "../far/loopSubdivisionTables.h"
 #include "../osd/d3d11DrawContext.h"
+#include "../osd/error.h"
 
 #include <D3D11.h>
 
@@ -67,6 +68,12 @@ OsdD3D11DrawContext::Create(FarPatchTables const *patchTables,
                             ID3D11DeviceContext *pd3d11DeviceContext,
                             bool requireFVarData)
 {
+    if (not SupportsPatchTables(patchTables)) {
+        OsdError(OSD_UNSUPPORTED_OPTION_ERROR,
+                 "Single crease patches are not supported by the draw shaders\n");
+        return NULL;
+    }
+
     OsdD3D11DrawContext * result = new OsdD3D11DrawContext();
     if (result->create(patchTables, pd3d11DeviceContext, requireFVarData))
         return result;
@@ -87,7 +94,8 @@ OsdD3D11DrawContext::create(FarPatchTables const *patchTables,
     pd3d11DeviceContext->GetDevice(&pd3d11Device);
     assert(pd3d11Device);
 
-    ConvertPatchArrays(patchTables->GetPatchArrayVector(), patchArrays, patchTables->GetMaxValence(), 0);
+    ConvertPatchArrays(patchTables->GetPatchArrayVector(), patchArrays, patchTables->GetMaxValence(), 0,
+                       patchTables->IsVertexValenceTableSparse());
 
     FarPatchTables::PTable const & ptables = patchTables->GetPatchTable();
     FarPatchTables::PatchParamTable const & ptexCoordTables = patchTables->GetPatchParamTable();
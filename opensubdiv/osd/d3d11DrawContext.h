@@ -73,6 +73,7 @@ public:
     /// @param requireFVarData      set to true to enable face-varying data to be 
     ///                             carried over from the Far data structures.
     ///
+    /// @return NULL if the patch tables contain single crease patches
     ///
     static OsdD3D11DrawContext *Create(FarPatchTables const *patchTables,
                                        ID3D11DeviceContext *pd3d11DeviceContext,
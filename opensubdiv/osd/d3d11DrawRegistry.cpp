@@ -73,6 +73,9 @@ OsdD3D11DrawRegistryBase::_CreateDrawSourceConfig(
         ss << (int)desc.GetNumElements();
         sconfig->commonShader.AddDefine("OSD_NUM_ELEMENTS", ss.str());
     }
+    if (desc.IsSparseValence()) {
+        sconfig->commonShader.AddDefine("OSD_SPARSE_VALENCE");
+    }
 
     if (desc.GetPattern() == FarPatchTables::NON_TRANSITION) {
         switch (desc.GetType()) {
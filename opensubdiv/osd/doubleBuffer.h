@@ -0,0 +1,118 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+
+#ifndef OSD_DOUBLE_BUFFER_H
+#define OSD_DOUBLE_BUFFER_H
+
+#include "../version.h"
+
+#include "../osd/nonCopyable.h"
+
+#include <algorithm>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+/// \brief Pair of vertex buffers refined in alternation.
+///
+/// Consumers read the front buffer while the back buffer is being refined
+/// (see OsdCpuAsyncComputeController) : once the refinement of the back
+/// buffer has completed, the buffers are swapped.
+///
+/// \code
+///     back = buffers->GetBackBuffer();
+///     back->UpdateData(coarse, 0, numCoarseVertices);
+///     handle = controller.RefineAsync(context, batches, back);
+///
+///     draw(buffers->GetFrontBuffer());
+///
+///     delete handle;      // waits for the refinement
+///     buffers->Swap();
+/// \endcode
+///
+template <class VERTEX_BUFFER>
+class OsdDoubleBuffer : OsdNonCopyable<OsdDoubleBuffer<VERTEX_BUFFER> > {
+public:
+    /// Creator. Returns NULL if error.
+    ///
+    /// @param numElements  the number of elements of each vertex
+    ///
+    /// @param numVertices  the number of vertices of each buffer
+    ///
+    static OsdDoubleBuffer * Create(int numElements, int numVertices) {
+
+        VERTEX_BUFFER * front = VERTEX_BUFFER::Create(numElements, numVertices),
+                      * back = VERTEX_BUFFER::Create(numElements, numVertices);
+        if (not front or not back) {
+            delete front;
+            delete back;
+            return 0;
+        }
+        return new OsdDoubleBuffer(front, back);
+    }
+
+    /// Creator taking the ownership of 2 buffers of the same format (for
+    /// buffers that need more arguments to be created). If either buffer is
+    /// NULL, the other one is deleted and NULL is returned.
+    ///
+    static OsdDoubleBuffer * Create(VERTEX_BUFFER * front, VERTEX_BUFFER * back) {
+
+        if (not front or not back) {
+            delete front;
+            delete back;
+            return 0;
+        }
+        return new OsdDoubleBuffer(front, back);
+    }
+
+    /// Destructor.
+    ~OsdDoubleBuffer() {
+        delete _front;
+        delete _back;
+    }
+
+    /// Returns the buffer read by the consumers
+    VERTEX_BUFFER * GetFrontBuffer() const { return _front; }
+
+    /// Returns the buffer being updated and refined
+    VERTEX_BUFFER * GetBackBuffer() const { return _back; }
+
+    /// Exchanges the front and back buffers : the refinement of the back
+    /// buffer must have completed.
+    void Swap() { std::swap(_front, _back); }
+
+private:
+    OsdDoubleBuffer(VERTEX_BUFFER * front, VERTEX_BUFFER * back) :
+        _front(front), _back(back) { }
+
+    VERTEX_BUFFER * _front,
+                  * _back;
+};
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OSD_DOUBLE_BUFFER_H
@@ -30,10 +30,22 @@ namespace OPENSUBDIV_VERSION {
 
 OsdDrawContext::~OsdDrawContext() {}
 
+bool
+OsdDrawContext::SupportsPatchTables(FarPatchTables const * patchTables) {
+
+    FarPatchTables::PatchArrayVector const & parrays = patchTables->GetPatchArrayVector();
+    for (int i = 0; i < (int)parrays.size(); ++i) {
+        if (parrays[i].GetDescriptor().GetType() == FarPatchTables::SINGLE_CREASE and
+            parrays[i].GetNumPatches() > 0)
+            return false;
+    }
+    return true;
+}
+
 void
 OsdDrawContext::ConvertPatchArrays(FarPatchTables::PatchArrayVector const &farPatchArrays,
                                    OsdDrawContext::PatchArrayVector &osdPatchArrays,
-                                   int maxValence, int numElements)
+                                   int maxValence, int numElements, bool sparseValence)
 {
     // create patch arrays for drawing (while duplicating subpatches for transition patch arrays)
     static int subPatchCounts[] = { 1, 3, 4, 4, 4, 2 }; // number of subpatches for patterns
@@ -56,7 +68,7 @@ OsdDrawContext::ConvertPatchArrays(FarPatchTables::PatchArrayVector const &farPa
         FarPatchTables::Descriptor srcDesc = parray.GetDescriptor();
 
         for (int j = 0; j < numSubPatches; ++j) {
-            PatchDescriptor desc(srcDesc, maxValence, j, numElements);
+            PatchDescriptor desc(srcDesc, maxValence, j, numElements, sparseValence);
 
             osdPatchArrays.push_back(PatchArray(desc, parray.GetArrayRange()));
         }
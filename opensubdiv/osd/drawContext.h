@@ -69,9 +69,13 @@ public:
         /// @param numElements  The size of the vertex and varying data per-vertex
         ///                     (in floats)
         ///
+        /// @param sparseValence  The vertex valence buffer read by Gregory
+        ///                     patches uses the sparse layout
+        ///
         PatchDescriptor(FarPatchTables::Descriptor farDesc, unsigned char maxValence,
-                    unsigned char subPatch, unsigned char numElements) :
-            _farDesc(farDesc), _maxValence(maxValence), _subPatch(subPatch), _numElements(numElements) { }
+                    unsigned char subPatch, unsigned char numElements, bool sparseValence=false) :
+            _farDesc(farDesc), _maxValence(maxValence), _subPatch(subPatch), _numElements(numElements),
+            _sparseValence(sparseValence) { }
 
 
         /// Returns the type of the patch
@@ -100,6 +104,11 @@ public:
             return _maxValence;
         }
 
+        /// Returns true if the vertex valence buffer uses the sparse layout
+        bool IsSparseValence() const {
+            return _sparseValence;
+        }
+
         /// Returns the subpatch id
         int GetSubPatch() const {
             return _subPatch;
@@ -126,6 +135,7 @@ public:
         unsigned char _maxValence;
         unsigned char _subPatch;
         unsigned char _numElements;
+        bool _sparseValence;
     };
 
     class PatchArray {
@@ -204,11 +214,15 @@ public:
     /// subdivision
     bool IsAdaptive() const { return _isAdaptive; }
 
+    /// Returns true if the draw shaders can render every patch of the tables :
+    /// the single crease patches have no draw shader yet
+    static bool SupportsPatchTables(FarPatchTables const * patchTables);
+
     // processes FarPatchArrays and inserts requisite sub-patches for the arrays
     // containing transition patches
     static void ConvertPatchArrays(FarPatchTables::PatchArrayVector const &farPatchArrays,
                                    OsdDrawContext::PatchArrayVector &osdPatchArrays,
-                                   int maxValence, int numElements);
+                                   int maxValence, int numElements, bool sparseValence=false);
 
 public:  
     // XXXX: move to private member
@@ -226,7 +240,8 @@ OsdDrawContext::PatchDescriptor::operator < ( PatchDescriptor const other ) cons
     return _farDesc < other._farDesc or (_farDesc == other._farDesc and
           (_subPatch < other._subPatch or ((_subPatch == other._subPatch) and
           (_maxValence < other._maxValence or ((_maxValence == other._maxValence) and
-          (_numElements < other._numElements))))));
+          (_numElements < other._numElements or ((_numElements == other._numElements) and
+          (_sparseValence < other._sparseValence))))))));
 }
 
 // True if the descriptors are identical
@@ -236,7 +251,8 @@ OsdDrawContext::PatchDescriptor::operator == ( PatchDescriptor const other ) con
     return _farDesc == other._farDesc and
            _subPatch == other._subPatch and
            _maxValence == other._maxValence and
-           _numElements == other._numElements;
+           _numElements == other._numElements and
+           _sparseValence == other._sparseValence;
 }
 
 
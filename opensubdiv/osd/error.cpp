@@ -46,7 +46,8 @@ static char const * errors[] = {
     "OSD_D3D11_COMPILE_ERROR",
     "OSD_D3D11_COMPUTE_BUFFER_CREATE_ERROR",
     "OSD_D3D11_VERTEX_BUFFER_CREATE_ERROR",
-    "OSD_D3D11_BUFFER_MAP_ERROR"
+    "OSD_D3D11_BUFFER_MAP_ERROR",
+    "OSD_UNSUPPORTED_OPTION_ERROR"
 };
 
 void OsdSetErrorCallback(OsdErrorCallbackFunc func) {
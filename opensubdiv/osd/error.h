@@ -44,6 +44,7 @@ typedef enum {
     OSD_D3D11_COMPUTE_BUFFER_CREATE_ERROR,
     OSD_D3D11_VERTEX_BUFFER_CREATE_ERROR,
     OSD_D3D11_BUFFER_MAP_ERROR,
+    OSD_UNSUPPORTED_OPTION_ERROR,
 } OsdErrorType;
 
 
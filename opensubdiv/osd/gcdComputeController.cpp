@@ -25,8 +25,12 @@
 
 #include "../osd/cpuComputeContext.h"
 #include "../osd/gcdComputeController.h"
+#include "../osd/cpuDeformer.h"
+#include "../osd/cpuPatchBounds.h"
 #include "../osd/gcdKernel.h"
 
+#include <algorithm>
+
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
@@ -50,6 +54,7 @@ OsdGcdComputeController::ApplyBilinearFaceVerticesKernel(
         (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::F_IT)->GetBuffer(),
         (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::F_ITa)->GetBuffer(),
         batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd(),
+        batch.GetValence(),
 	_gcd_queue);
 }
 
@@ -102,6 +107,7 @@ OsdGcdComputeController::ApplyCatmarkFaceVerticesKernel(
         (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::F_IT)->GetBuffer(),
         (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::F_ITa)->GetBuffer(),
         batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd(),
+        batch.GetValence(),
         _gcd_queue);
 }
 
@@ -139,6 +145,7 @@ OsdGcdComputeController::ApplyCatmarkVertexVerticesKernelB(
         (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_IT)->GetBuffer(),
         (const float*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_W)->GetBuffer(),
         batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd(),
+        batch.GetValence(),
         _gcd_queue);
 }
 
@@ -178,6 +185,45 @@ OsdGcdComputeController::ApplyCatmarkVertexVerticesKernelA2(
         _gcd_queue);
 }
 
+void
+OsdGcdComputeController::ApplyCatmarkStructuredGridKernel(
+    FarKernelBatch const &batch, void * clientdata) const {
+
+    OsdCpuComputeContext * context =
+        static_cast<OsdCpuComputeContext*>(clientdata);
+    assert(context);
+
+    OsdGcdComputeStructuredGrid(
+        context->GetVertexDescriptor(),
+        context->GetCurrentVertexBuffer(),
+        context->GetCurrentVaryingBuffer(),
+        (const FarStructuredGrids::Grid*)context->GetStructuredGrids()->GetBuffer(),
+        (const int*)context->GetStructuredGridIndices()->GetBuffer(),
+        batch.GetStart(), batch.GetEnd(),
+        _gcd_queue);
+}
+
+void
+OsdGcdComputeController::ApplyEndCapKernel(
+    FarKernelBatch const &batch, void * clientdata) const {
+
+    OsdCpuComputeContext * context =
+        static_cast<OsdCpuComputeContext*>(clientdata);
+    assert(context);
+
+    OsdGcdComputeEndCap(
+        context->GetVertexDescriptor(),
+        context->GetCurrentVertexBuffer(),
+        context->GetCurrentVaryingBuffer(),
+        (const int*)context->GetEndCapOffsets()->GetBuffer(),
+        (const int*)context->GetEndCapIndices()->GetBuffer(),
+        (const float*)context->GetEndCapWeights()->GetBuffer(),
+        (const int*)context->GetEndCapVaryingIndices()->GetBuffer(),
+        batch.GetVertexOffset(), batch.GetTableOffset(),
+        batch.GetStart(), batch.GetEnd(),
+        _gcd_queue);
+}
+
 void
 OsdGcdComputeController::ApplyLoopEdgeVerticesKernel(
     FarKernelBatch const &batch, void * clientdata) const {
@@ -212,6 +258,7 @@ OsdGcdComputeController::ApplyLoopVertexVerticesKernelB(
         (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_IT)->GetBuffer(),
         (const float*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_W)->GetBuffer(),
         batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd(),
+        batch.GetValence(),
         _gcd_queue);
 }
 
@@ -292,6 +339,44 @@ OsdGcdComputeController::ApplyVertexEdits(
     }
 }
 
+void
+OsdGcdComputeController::ApplyDeformer(
+    OsdCpuComputeContext const *context) const {
+
+    assert(context);
+
+    OsdCpuDeformer const * deformer = context->GetDeformer();
+    OsdVertexDescriptor const & vdesc = context->GetVertexDescriptor();
+    float * vertex = context->GetCurrentVertexBuffer();
+    const int numVertices = deformer->GetNumVertices();
+
+    const int workStride = 256;
+    dispatch_apply((numVertices + workStride - 1)/workStride, _gcd_queue, ^(size_t blockIdx){
+        const int start_i = blockIdx*workStride;
+        const int end_i = std::min(start_i + workStride, numVertices);
+        deformer->Deform(vdesc, vertex, start_i, end_i);
+    });
+}
+
+void
+OsdGcdComputeController::ApplyPatchBounds(
+    OsdCpuComputeContext const *context) const {
+
+    assert(context);
+
+    OsdCpuPatchBounds * bounds = context->GetPatchBounds();
+    float const * vertex = context->GetCurrentVertexBuffer();
+    const int stride = context->GetVertexDescriptor().numVertexElements;
+    const int numPatches = bounds->GetNumPatches();
+
+    const int workStride = 256;
+    dispatch_apply((numPatches + workStride - 1)/workStride, _gcd_queue, ^(size_t blockIdx){
+        const int start_i = blockIdx*workStride;
+        const int end_i = std::min(start_i + workStride, numPatches);
+        bounds->Update(vertex, stride, start_i, end_i);
+    });
+}
+
 void
 OsdGcdComputeController::Synchronize() {
 }
@@ -70,13 +70,19 @@ public:
                 VERTEX_BUFFER *vertexBuffer,
                 VARYING_BUFFER *varyingBuffer) {
 
-        if (batches.empty()) return;
+        // without batches, the coarse vertices still bound the patches
+        if (batches.empty() and not context->GetPatchBounds()) return;
 
         context->Bind(vertexBuffer, varyingBuffer);
+        if (context->GetDeformer() and not batches.empty())
+            ApplyDeformer(context);
         FarDispatcher::Refine(this,
                               batches,
                               -1,
-                              context);
+                              context,
+                              context->GetKernelBatchObserver());
+        if (context->GetPatchBounds() and vertexBuffer)
+            ApplyPatchBounds(context);
         context->Unbind();
     }
 
@@ -118,6 +124,8 @@ protected:
 
     void ApplyCatmarkVertexVerticesKernelA2(FarKernelBatch const &batch, void * clientdata) const;
 
+    void ApplyCatmarkStructuredGridKernel(FarKernelBatch const &batch, void * clientdata) const;
+
 
     void ApplyLoopEdgeVerticesKernel(FarKernelBatch const &batch, void * clientdata) const;
 
@@ -130,6 +138,14 @@ protected:
 
     void ApplyVertexEdits(FarKernelBatch const &batch, void * clientdata) const;
 
+    void ApplyEndCapKernel(FarKernelBatch const &batch, void * clientdata) const;
+
+    // writes the deformed coarse vertices into the bound vertex buffer
+    void ApplyDeformer(OsdCpuComputeContext const *context) const;
+
+    // refreshes the patch bounds from the refined vertices of the bound buffer
+    void ApplyPatchBounds(OsdCpuComputeContext const *context) const;
+
 private:
     dispatch_queue_t _gcd_queue;
 };
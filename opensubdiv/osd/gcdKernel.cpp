@@ -38,7 +38,7 @@ const int GCD_WORK_STRIDE = 32;
 void OsdGcdComputeFace(
     OsdVertexDescriptor const &vdesc, float * vertex, float * varying,
     const int *F_IT, const int *F_ITa,
-    int vertexOffset, int tableOffset, int start, int end,
+    int vertexOffset, int tableOffset, int start, int end, int valence,
     dispatch_queue_t gcdq) {
 
     const int workSize = end-start;
@@ -46,13 +46,13 @@ void OsdGcdComputeFace(
         const int start_i = start + blockIdx*GCD_WORK_STRIDE;
         const int end_i = start_i + GCD_WORK_STRIDE;
         OsdCpuComputeFace(vdesc, vertex, varying, F_IT, F_ITa,
-                          vertexOffset, tableOffset, start_i, end_i);
+                          vertexOffset, tableOffset, start_i, end_i, valence);
     });
     const int start_e = end - workSize%GCD_WORK_STRIDE;
     const int end_e = end;
     if (start_e < end_e)
         OsdCpuComputeFace(vdesc, vertex, varying, F_IT, F_ITa,
-                          vertexOffset, tableOffset, start_e, end_e);
+                          vertexOffset, tableOffset, start_e, end_e, valence);
 }
 
 void OsdGcdComputeEdge(
@@ -98,7 +98,7 @@ void OsdGcdComputeVertexA(
 void OsdGcdComputeVertexB(
     OsdVertexDescriptor const &vdesc, float * vertex, float * varying,
     const int *V_ITa, const int *V_IT, const float *V_W,
-    int vertexOffset, int tableOffset, int start, int end,
+    int vertexOffset, int tableOffset, int start, int end, int valence,
     dispatch_queue_t gcdq) {
 
     const int workSize = end-start;
@@ -106,43 +106,33 @@ void OsdGcdComputeVertexB(
         const int start_i = start + blockIdx*GCD_WORK_STRIDE;
         const int end_i = start_i + GCD_WORK_STRIDE;
         OsdCpuComputeVertexB(vdesc, vertex, varying, V_ITa, V_IT, V_W,
-                             vertexOffset, tableOffset, start_i, end_i);
+                             vertexOffset, tableOffset, start_i, end_i, valence);
     });
     const int start_e = end - workSize%GCD_WORK_STRIDE;
     const int end_e = end;
     if (start_e < end_e)
         OsdCpuComputeVertexB(vdesc, vertex, varying, V_ITa, V_IT, V_W,
-                             vertexOffset, tableOffset, start_e, end_e);
+                             vertexOffset, tableOffset, start_e, end_e, valence);
 }
 
 void OsdGcdComputeLoopVertexB(
     OsdVertexDescriptor const &vdesc, float * vertex, float * varying,
     const int *V_ITa, const int *V_IT, const float *V_W,
-    int vertexOffset, int tableOffset, int start, int end,
+    int vertexOffset, int tableOffset, int start, int end, int valence,
     dispatch_queue_t gcdq) {
 
-    dispatch_apply(end-start, gcdq, ^(size_t blockIdx){
-        int i = start+blockIdx+tableOffset;
-        int h = V_ITa[5*i];
-        int n = V_ITa[5*i+1];
-        int p = V_ITa[5*i+2];
-
-        float weight = V_W[i];
-        float wp = 1.0f/static_cast<float>(n);
-        float beta = 0.25f * cosf(static_cast<float>(M_PI) * 2.0f * wp) + 0.375f;
-        beta = beta * beta;
-        beta = (0.625f - beta) * wp;
-
-        int dstIndex = vertexOffset + i - tableOffset;
-        vdesc.Clear(vertex, varying, dstIndex);
-
-        vdesc.AddWithWeight(vertex, dstIndex, p, weight * (1.0f - (beta * n)));
-
-        for (int j = 0; j < n; ++j)
-            vdesc.AddWithWeight(vertex, dstIndex, V_IT[h+j], weight * beta);
-
-        vdesc.AddVaryingWithWeight(varying, dstIndex, p, 1.0f);
+    const int workSize = end-start;
+    dispatch_apply(workSize/GCD_WORK_STRIDE, gcdq, ^(size_t blockIdx){
+        const int start_i = start + blockIdx*GCD_WORK_STRIDE;
+        const int end_i = start_i + GCD_WORK_STRIDE;
+        OsdCpuComputeLoopVertexB(vdesc, vertex, varying, V_ITa, V_IT, V_W,
+                                 vertexOffset, tableOffset, start_i, end_i, valence);
     });
+    const int start_e = end - workSize%GCD_WORK_STRIDE;
+    const int end_e = end;
+    if (start_e < end_e)
+        OsdCpuComputeLoopVertexB(vdesc, vertex, varying, V_ITa, V_IT, V_W,
+                                 vertexOffset, tableOffset, start_e, end_e, valence);
 }
 
 void OsdGcdComputeBilinearEdge(
@@ -185,6 +175,40 @@ void OsdGcdComputeBilinearVertex(
     });
 }
 
+// the grids of a level are independent : one work item per grid
+void OsdGcdComputeStructuredGrid(
+    OsdVertexDescriptor const &vdesc, float * vertex, float * varying,
+    const FarStructuredGrids::Grid *grids, const int *indices,
+    int start, int end,
+    dispatch_queue_t gcdq) {
+
+    dispatch_apply(end-start, gcdq, ^(size_t blockIdx){
+        const int grid = start + (int)blockIdx;
+        OsdCpuComputeStructuredGrid(vdesc, vertex, varying, grids, indices,
+                                    grid, grid+1);
+    });
+}
+
+void OsdGcdComputeEndCap(
+    OsdVertexDescriptor const &vdesc, float * vertex, float * varying,
+    const int *offsets, const int *indices, const float *weights,
+    const int *varyingIndices, int vertexOffset, int tableOffset,
+    int start, int end,
+    dispatch_queue_t gcdq) {
+
+    dispatch_apply(end-start, gcdq, ^(size_t blockIdx){
+        int i = start+blockIdx+tableOffset;
+
+        int dstIndex = vertexOffset + i - tableOffset;
+        vdesc.Clear(vertex, varying, dstIndex);
+
+        for (int j = offsets[i]; j < offsets[i+1]; ++j)
+            vdesc.AddWithWeight(vertex, dstIndex, indices[j], weights[j]);
+
+        vdesc.AddVaryingWithWeight(varying, dstIndex, varyingIndices[i], 1.0f);
+    });
+}
+
 void OsdGcdEditVertexAdd(
     OsdVertexDescriptor const &vdesc, float * vertex,
     int primVarOffset, int primVarWidth,
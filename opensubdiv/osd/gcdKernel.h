@@ -27,6 +27,8 @@
 
 #include "../version.h"
 
+#include "../far/structuredGrids.h"
+
 #include <dispatch/dispatch.h>
 
 namespace OpenSubdiv {
@@ -38,7 +40,7 @@ void OsdGcdComputeFace(OsdVertexDescriptor const &vdesc,
                        float * vertex, float * varying,
                        const int *F_IT, const int *F_ITa,
                        int vertexOffset, int tableOffset,
-                       int start, int end,
+                       int start, int end, int valence,
                        dispatch_queue_t gcdq);
 
 void OsdGcdComputeEdge(OsdVertexDescriptor const &vdesc,
@@ -59,7 +61,7 @@ void OsdGcdComputeVertexB(OsdVertexDescriptor const &vdesc,
                           float *vertex, float * varying,
                           const int *V_ITa, const int *V_IT, const float *V_W,
                           int vertexOffset, int tableOffset,
-                          int start, int end,
+                          int start, int end, int valence,
                           dispatch_queue_t gcdq);
 
 void OsdGcdComputeLoopVertexB(OsdVertexDescriptor const &vdesc,
@@ -67,7 +69,7 @@ void OsdGcdComputeLoopVertexB(OsdVertexDescriptor const &vdesc,
                               const int *V_ITa, const int *V_IT,
                               const float *V_W,
                               int vertexOffset, int tableOffset,
-                              int start, int end,
+                              int start, int end, int valence,
                               dispatch_queue_t gcdq);
 
 void OsdGcdComputeBilinearEdge(OsdVertexDescriptor const &vdesc,
@@ -84,6 +86,21 @@ void OsdGcdComputeBilinearVertex(OsdVertexDescriptor const &vdesc,
                                  int start, int end,
                                  dispatch_queue_t gcdq);
 
+void OsdGcdComputeStructuredGrid(OsdVertexDescriptor const &vdesc,
+                                 float *vertex, float * varying,
+                                 const FarStructuredGrids::Grid *grids,
+                                 const int *indices,
+                                 int start, int end,
+                                 dispatch_queue_t gcdq);
+
+void OsdGcdComputeEndCap(OsdVertexDescriptor const &vdesc,
+                         float *vertex, float * varying,
+                         const int *offsets, const int *indices,
+                         const float *weights, const int *varyingIndices,
+                         int vertexOffset, int tableOffset,
+                         int start, int end,
+                         dispatch_queue_t gcdq);
+
 void OsdGcdEditVertexAdd(OsdVertexDescriptor const &vdesc, float *vertex,
                          int primVarOffset, int primVarWidth,
                          int vertexOffset, int tableOffset,
@@ -25,6 +25,7 @@
 
 #include "../far/dispatcher.h"
 #include "../far/loopSubdivisionTables.h"
+#include "../osd/error.h"
 #include "../osd/glDrawRegistry.h"
 #include "../osd/glDrawContext.h"
 
@@ -90,6 +91,12 @@ OsdGLDrawContext *
 OsdGLDrawContext::Create(FarPatchTables const * patchTables, bool requireFVarData) {
 
     if (patchTables) {
+
+        if (not SupportsPatchTables(patchTables)) {
+            OsdError(OSD_UNSUPPORTED_OPTION_ERROR,
+                     "Single crease patches are not supported by the draw shaders\n");
+            return NULL;
+        }
         
         OsdGLDrawContext * result = new OsdGLDrawContext();
         
@@ -119,7 +126,8 @@ OsdGLDrawContext::create(FarPatchTables const * patchTables, bool requireFVarDat
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     
     OsdDrawContext::ConvertPatchArrays(patchTables->GetPatchArrayVector(),
-        patchArrays, patchTables->GetMaxValence(), 0);
+        patchArrays, patchTables->GetMaxValence(), 0,
+        patchTables->IsVertexValenceTableSparse());
 
 /*    
 #if defined(GL_ES_VERSION_2_0)
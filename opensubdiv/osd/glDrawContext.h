@@ -62,6 +62,8 @@ public:
     /// @param requireFVarData  set to true to enable face-varying data to be 
     ///                         carried over from the Far data structures.
     ///
+    /// @return NULL if the patch tables contain single crease patches
+    ///
     static OsdGLDrawContext * Create(FarPatchTables const * patchTables, bool requireFVarData);
 
     /// Set vbo as a vertex texture (for gregory patch drawing)
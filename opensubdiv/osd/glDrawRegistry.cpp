@@ -70,6 +70,9 @@ OsdGLDrawRegistryBase::_CreateDrawSourceConfig(OsdDrawContext::PatchDescriptor c
         ss << (int)desc.GetNumElements();
         sconfig->commonShader.AddDefine("OSD_NUM_ELEMENTS", ss.str());
     }
+    if (desc.IsSparseValence()) {
+        sconfig->commonShader.AddDefine("OSD_SPARSE_VALENCE");
+    }
 
     if (desc.GetPattern() == FarPatchTables::NON_TRANSITION) {
         switch (desc.GetType()) {
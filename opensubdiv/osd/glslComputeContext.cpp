@@ -112,7 +112,7 @@ OsdGLSLComputeHEditTable::GetPrimvarWidth() const {
 
 OsdGLSLComputeContext::OsdGLSLComputeContext(
     FarMesh<OsdVertex> const *farMesh)
-    : _vertexTexture(0), _varyingTexture(0) {
+    : _vertexTexture(0), _varyingTexture(0), _observer(NULL) {
 
     FarSubdivisionTables<OsdVertex> const * farTables =
         farMesh->GetSubdivisionTables();
@@ -208,6 +208,21 @@ OsdGLSLComputeContext::SetKernelBundle(
 OsdGLSLComputeContext *
 OsdGLSLComputeContext::Create(FarMesh<OsdVertex> const *farmesh) {
 
+    // no device kernel applies the structured grids yet
+    if (farmesh->GetSubdivisionTables()->GetStructuredGrids().GetNumGrids() > 0) {
+        OsdError(OSD_UNSUPPORTED_OPTION_ERROR,
+                 "Structured grids are not supported by this compute context\n");
+        return NULL;
+    }
+
+    // nor the B-spline end caps
+    if (farmesh->GetEndCapTables() and
+        farmesh->GetEndCapTables()->GetNumVertices() > 0) {
+        OsdError(OSD_UNSUPPORTED_OPTION_ERROR,
+                 "B-spline end caps are not supported by this compute context\n");
+        return NULL;
+    }
+
     return new OsdGLSLComputeContext(farmesh);
 }
 
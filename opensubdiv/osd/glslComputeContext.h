@@ -39,6 +39,8 @@
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
+class FarKernelBatchObserver;
+
 class OsdGLSLComputeKernelBundle;
 
 
@@ -103,6 +105,9 @@ public:
     ///
     /// @param farmesh the FarMesh used for this Context.
     ///
+    /// @return NULL if the FarMesh has structured grids or B-spline end
+    ///         caps, which have no device kernel yet
+    ///
     static OsdGLSLComputeContext * Create(FarMesh<OsdVertex> const *farmesh);
 
     /// Destructor
@@ -195,6 +200,14 @@ public:
 
     void UnbindEditShaderStorageBuffers();
 
+    /// Attaches an observer notified around each kernel batch queued by the
+    /// compute controller (see FarKernelBatchObserver). The context does not
+    /// take ownership of the observer (NULL detaches it).
+    void SetKernelBatchObserver(FarKernelBatchObserver * observer) { _observer = observer; }
+
+    /// Returns the kernel batch observer (NULL if none is attached)
+    FarKernelBatchObserver * GetKernelBatchObserver() const { return _observer; }
+
 protected:
     explicit OsdGLSLComputeContext(FarMesh<OsdVertex> const *farMesh);
 
@@ -215,6 +228,8 @@ private:
            _currentVaryingBuffer;
 
     OsdGLSLComputeKernelBundle * _kernelBundle;
+
+    FarKernelBatchObserver *_observer;
 };
 
 }  // end namespace OPENSUBDIV_VERSION
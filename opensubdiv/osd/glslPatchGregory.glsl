@@ -61,6 +61,13 @@ float csf(uint n, uint j)
 uniform samplerBuffer OsdVertexBuffer;
 uniform isamplerBuffer OsdValenceBuffer;
 
+// the sparse valence buffer starts with the offset of the record of each vertex
+#ifdef OSD_SPARSE_VALENCE
+#define OSD_VALENCE_RECORD(vID) texelFetch(OsdValenceBuffer, int(vID)).x
+#else
+#define OSD_VALENCE_RECORD(vID) int((vID) * (2*OSD_MAX_VALENCE+1))
+#endif
+
 layout (location=0) in vec4 position;
 OSD_USER_VARYING_ATTRIBUTE_DECLARE
 
@@ -77,7 +84,7 @@ void main()
     OSD_PATCH_CULL_COMPUTE_CLIPFLAGS(position);
     OSD_USER_VARYING_PER_VERTEX();
 
-    int ivalence = texelFetch(OsdValenceBuffer,int(vID * (2 * OSD_MAX_VALENCE + 1))).x;
+    int ivalence = texelFetch(OsdValenceBuffer,int(OSD_VALENCE_RECORD(vID))).x;
     outpt.v.valence = ivalence;
     uint valence = uint(abs(ivalence));
 
@@ -97,11 +104,11 @@ void main()
         uint im=(i+valence-1)%valence; 
         uint ip=(i+1)%valence; 
 
-        uint idx_neighbor = uint(texelFetch(OsdValenceBuffer, int(vID * (2*OSD_MAX_VALENCE+1) + 2*i + 0 + 1)).x);
+        uint idx_neighbor = uint(texelFetch(OsdValenceBuffer, int(OSD_VALENCE_RECORD(vID) + 2*i + 0 + 1)).x);
 
 #ifdef OSD_PATCH_GREGORY_BOUNDARY
         bool isBoundaryNeighbor = false;
-        int valenceNeighbor = texelFetch(OsdValenceBuffer,int(idx_neighbor * (2*OSD_MAX_VALENCE+1))).x;
+        int valenceNeighbor = texelFetch(OsdValenceBuffer,int(OSD_VALENCE_RECORD(idx_neighbor))).x;
 
         if (valenceNeighbor < 0) {
             isBoundaryNeighbor = true;
@@ -125,28 +132,28 @@ void main()
                  texelFetch(OsdVertexBuffer, int(OSD_NUM_ELEMENTS*idx_neighbor+1)).x,
                  texelFetch(OsdVertexBuffer, int(OSD_NUM_ELEMENTS*idx_neighbor+2)).x);
 
-        uint idx_diagonal = uint(texelFetch(OsdValenceBuffer, int(vID * (2*OSD_MAX_VALENCE+1) + 2*i + 1 + 1)).x);
+        uint idx_diagonal = uint(texelFetch(OsdValenceBuffer, int(OSD_VALENCE_RECORD(vID) + 2*i + 1 + 1)).x);
 
         vec3 diagonal =
             vec3(texelFetch(OsdVertexBuffer, int(OSD_NUM_ELEMENTS*idx_diagonal)).x,
                  texelFetch(OsdVertexBuffer, int(OSD_NUM_ELEMENTS*idx_diagonal+1)).x,
                  texelFetch(OsdVertexBuffer, int(OSD_NUM_ELEMENTS*idx_diagonal+2)).x);
 
-        uint idx_neighbor_p = uint(texelFetch(OsdValenceBuffer, int(vID * (2*OSD_MAX_VALENCE+1) + 2*ip + 0 + 1)).x);
+        uint idx_neighbor_p = uint(texelFetch(OsdValenceBuffer, int(OSD_VALENCE_RECORD(vID) + 2*ip + 0 + 1)).x);
 
         vec3 neighbor_p =
             vec3(texelFetch(OsdVertexBuffer, int(OSD_NUM_ELEMENTS*idx_neighbor_p)).x,
                  texelFetch(OsdVertexBuffer, int(OSD_NUM_ELEMENTS*idx_neighbor_p+1)).x,
                  texelFetch(OsdVertexBuffer, int(OSD_NUM_ELEMENTS*idx_neighbor_p+2)).x);
 
-        uint idx_neighbor_m = uint(texelFetch(OsdValenceBuffer, int(vID * (2*OSD_MAX_VALENCE+1) + 2*im + 0 + 1)).x);
+        uint idx_neighbor_m = uint(texelFetch(OsdValenceBuffer, int(OSD_VALENCE_RECORD(vID) + 2*im + 0 + 1)).x);
 
         vec3 neighbor_m =
             vec3(texelFetch(OsdVertexBuffer, int(OSD_NUM_ELEMENTS*idx_neighbor_m)).x,
                  texelFetch(OsdVertexBuffer, int(OSD_NUM_ELEMENTS*idx_neighbor_m+1)).x,
                  texelFetch(OsdVertexBuffer, int(OSD_NUM_ELEMENTS*idx_neighbor_m+2)).x);
 
-        uint idx_diagonal_m = uint(texelFetch(OsdValenceBuffer, int(vID * (2*OSD_MAX_VALENCE+1) + 2*im + 1 + 1)).x);
+        uint idx_diagonal_m = uint(texelFetch(OsdValenceBuffer, int(OSD_VALENCE_RECORD(vID) + 2*im + 1 + 1)).x);
 
         vec3 diagonal_m =
             vec3(texelFetch(OsdVertexBuffer, int(OSD_NUM_ELEMENTS*idx_diagonal_m)).x,
@@ -212,7 +219,7 @@ void main()
         float beta_0 = s/(3.0f*k + c); 
 
 
-        int idx_diagonal = texelFetch(OsdValenceBuffer,int((vID) * (2*OSD_MAX_VALENCE+1) + 2*zerothNeighbor + 1 + 1)).x;
+        int idx_diagonal = texelFetch(OsdValenceBuffer,int(OSD_VALENCE_RECORD(vID) + 2*zerothNeighbor + 1 + 1)).x;
         idx_diagonal = abs(idx_diagonal);
         vec3 diagonal =
                 vec3(texelFetch(OsdVertexBuffer, int(OSD_NUM_ELEMENTS*idx_diagonal)).x,
@@ -233,7 +240,7 @@ void main()
             float alpha = (4.0f*sin((M_PI * float(x))/k))/(3.0f*k+c);
             float beta = (sin((M_PI * float(x))/k) + sin((M_PI * float(x+1))/k))/(3.0f*k+c);
 
-            int idx_neighbor = texelFetch(OsdValenceBuffer, int((vID) * (2*OSD_MAX_VALENCE+1) + 2*curri + 0 + 1)).x;
+            int idx_neighbor = texelFetch(OsdValenceBuffer, int(OSD_VALENCE_RECORD(vID) + 2*curri + 0 + 1)).x;
             idx_neighbor = abs(idx_neighbor);
 
             vec3 neighbor =
@@ -241,7 +248,7 @@ void main()
                      texelFetch(OsdVertexBuffer, int(OSD_NUM_ELEMENTS*idx_neighbor+1)).x,
                      texelFetch(OsdVertexBuffer, int(OSD_NUM_ELEMENTS*idx_neighbor+2)).x);
 
-            idx_diagonal = texelFetch(OsdValenceBuffer, int((vID) * (2*OSD_MAX_VALENCE+1) + 2*curri + 1 + 1)).x;
+            idx_diagonal = texelFetch(OsdValenceBuffer, int(OSD_VALENCE_RECORD(vID) + 2*curri + 1 + 1)).x;
 
             diagonal =
                 vec3(texelFetch(OsdVertexBuffer, int(OSD_NUM_ELEMENTS*idx_diagonal)).x,
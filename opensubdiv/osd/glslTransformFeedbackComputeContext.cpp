@@ -28,6 +28,7 @@
 #include "../far/mesh.h"
 #include "../far/subdivisionTables.h"
 #include "../osd/debug.h"
+#include "../osd/error.h"
 #include "../osd/glslTransformFeedbackComputeContext.h"
 #include "../osd/glslTransformFeedbackKernelBundle.h"
 
@@ -119,7 +120,7 @@ OsdGLSLTransformFeedbackHEditTable::GetPrimvarWidth() const {
 
 OsdGLSLTransformFeedbackComputeContext::OsdGLSLTransformFeedbackComputeContext(
     FarMesh<OsdVertex> const *farMesh) :
-    _vertexTexture(0), _varyingTexture(0) {
+    _vertexTexture(0), _varyingTexture(0), _observer(NULL) {
 
     FarSubdivisionTables<OsdVertex> const * farTables =
         farMesh->GetSubdivisionTables();
@@ -212,6 +213,21 @@ OsdGLSLTransformFeedbackComputeContext::SetKernelBundle(OsdGLSLTransformFeedback
 OsdGLSLTransformFeedbackComputeContext *
 OsdGLSLTransformFeedbackComputeContext::Create(FarMesh<OsdVertex> const *farmesh) {
 
+    // no device kernel applies the structured grids yet
+    if (farmesh->GetSubdivisionTables()->GetStructuredGrids().GetNumGrids() > 0) {
+        OsdError(OSD_UNSUPPORTED_OPTION_ERROR,
+                 "Structured grids are not supported by this compute context\n");
+        return NULL;
+    }
+
+    // nor the B-spline end caps
+    if (farmesh->GetEndCapTables() and
+        farmesh->GetEndCapTables()->GetNumVertices() > 0) {
+        OsdError(OSD_UNSUPPORTED_OPTION_ERROR,
+                 "B-spline end caps are not supported by this compute context\n");
+        return NULL;
+    }
+
     return new OsdGLSLTransformFeedbackComputeContext(farmesh);
 }
 
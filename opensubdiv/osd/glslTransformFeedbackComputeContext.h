@@ -39,6 +39,8 @@
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
+class FarKernelBatchObserver;
+
 class OsdGLSLTransformFeedbackKernelBundle;
 
 class OsdGLSLTransformFeedbackTable : OsdNonCopyable<OsdGLSLTransformFeedbackTable> {
@@ -100,6 +102,9 @@ public:
     ///
     /// @param farmesh the FarMesh used for this Context.
     ///
+    /// @return NULL if the FarMesh has structured grids or B-spline end
+    ///         caps, which have no device kernel yet
+    ///
     static OsdGLSLTransformFeedbackComputeContext * Create(FarMesh<OsdVertex> const *farmesh);
 
     /// Destructor
@@ -169,6 +174,14 @@ public:
 
     void UnbindEditTextures();
 
+    /// Attaches an observer notified around each kernel batch queued by the
+    /// compute controller (see FarKernelBatchObserver). The context does not
+    /// take ownership of the observer (NULL detaches it).
+    void SetKernelBatchObserver(FarKernelBatchObserver * observer) { _observer = observer; }
+
+    /// Returns the kernel batch observer (NULL if none is attached)
+    FarKernelBatchObserver * GetKernelBatchObserver() const { return _observer; }
+
 protected:
     explicit OsdGLSLTransformFeedbackComputeContext(FarMesh<OsdVertex> const *farMesh);
 
@@ -193,6 +206,8 @@ private:
            _currentVaryingBuffer;
 
     OsdGLSLTransformFeedbackKernelBundle * _kernelBundle;
+
+    FarKernelBatchObserver *_observer;
 };
 
 }  // end namespace OPENSUBDIV_VERSION
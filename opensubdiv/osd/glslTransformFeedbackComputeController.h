@@ -37,6 +37,15 @@ namespace OPENSUBDIV_VERSION {
 
 class OsdGLSLTransformFeedbackKernelBundle;
 
+class OsdGLSLTransformFeedbackComputeController;
+
+// no device kernel applies the structured grids nor the B-spline end caps
+// yet (the compute context refuses the meshes that have them)
+template <> struct FarKernelSupport<OsdGLSLTransformFeedbackComputeController> {
+    static const bool structuredGrids = false;
+    static const bool endCaps = false;
+};
+
 /// \brief Compute controller for launching GLSLTransformFeedback transform feedback
 /// subdivision kernels.
 ///
@@ -86,7 +95,8 @@ public:
         FarDispatcher::Refine(this,
                               batches,
                               -1,
-                              context);
+                              context,
+                              context->GetKernelBatchObserver());
         context->Unbind();
     }
 
@@ -60,6 +60,13 @@ float csf(uint n, uint j)
 Buffer<float> OsdVertexBuffer : register( t0 );
 Buffer<int> OsdValenceBuffer : register( t1 );
 
+// the sparse valence buffer starts with the offset of the record of each vertex
+#ifdef OSD_SPARSE_VALENCE
+#define OSD_VALENCE_RECORD(vID) OsdValenceBuffer[int(vID)]
+#else
+#define OSD_VALENCE_RECORD(vID) int((vID) * (2*OSD_MAX_VALENCE+1))
+#endif
+
 void vs_main_patches( in InputVertex input,
                       uint vID : SV_VertexID,
                       out GregHullVertex output )
@@ -67,7 +74,7 @@ void vs_main_patches( in InputVertex input,
     output.hullPosition = mul(ModelViewMatrix, input.position).xyz;
     OSD_PATCH_CULL_COMPUTE_CLIPFLAGS(input.position);
 
-    int ivalence = OsdValenceBuffer[int(vID * (2 * OSD_MAX_VALENCE + 1))];
+    int ivalence = OsdValenceBuffer[int(OSD_VALENCE_RECORD(vID))];
     output.valence = ivalence;
     uint valence = uint(abs(ivalence));
 
@@ -87,11 +94,11 @@ void vs_main_patches( in InputVertex input,
         uint im=(i+valence-1)%valence; 
         uint ip=(i+1)%valence; 
 
-        uint idx_neighbor = uint(OsdValenceBuffer[int(vID * (2*OSD_MAX_VALENCE+1) + 2*i + 0 + 1)]);
+        uint idx_neighbor = uint(OsdValenceBuffer[int(OSD_VALENCE_RECORD(vID) + 2*i + 0 + 1)]);
 
 #ifdef OSD_PATCH_GREGORY_BOUNDARY
         bool isBoundaryNeighbor = false;
-        int valenceNeighbor = OsdValenceBuffer[int(idx_neighbor * (2*OSD_MAX_VALENCE+1))];
+        int valenceNeighbor = OsdValenceBuffer[int(OSD_VALENCE_RECORD(idx_neighbor))];
 
         if (valenceNeighbor < 0) {
             isBoundaryNeighbor = true;
@@ -115,28 +122,28 @@ void vs_main_patches( in InputVertex input,
                    OsdVertexBuffer[int(OSD_NUM_ELEMENTS*idx_neighbor+1)],
                    OsdVertexBuffer[int(OSD_NUM_ELEMENTS*idx_neighbor+2)]);
 
-        uint idx_diagonal = uint(OsdValenceBuffer[int(vID * (2*OSD_MAX_VALENCE+1) + 2*i + 1 + 1)]);
+        uint idx_diagonal = uint(OsdValenceBuffer[int(OSD_VALENCE_RECORD(vID) + 2*i + 1 + 1)]);
 
         float3 diagonal =
             float3(OsdVertexBuffer[int(OSD_NUM_ELEMENTS*idx_diagonal)],
                    OsdVertexBuffer[int(OSD_NUM_ELEMENTS*idx_diagonal+1)],
                    OsdVertexBuffer[int(OSD_NUM_ELEMENTS*idx_diagonal+2)]);
 
-        uint idx_neighbor_p = uint(OsdValenceBuffer[int(vID * (2*OSD_MAX_VALENCE+1) + 2*ip + 0 + 1)]);
+        uint idx_neighbor_p = uint(OsdValenceBuffer[int(OSD_VALENCE_RECORD(vID) + 2*ip + 0 + 1)]);
 
         float3 neighbor_p =
             float3(OsdVertexBuffer[int(OSD_NUM_ELEMENTS*idx_neighbor_p)],
                    OsdVertexBuffer[int(OSD_NUM_ELEMENTS*idx_neighbor_p+1)],
                    OsdVertexBuffer[int(OSD_NUM_ELEMENTS*idx_neighbor_p+2)]);
 
-        uint idx_neighbor_m = uint(OsdValenceBuffer[int(vID * (2*OSD_MAX_VALENCE+1) + 2*im + 0 + 1)]);
+        uint idx_neighbor_m = uint(OsdValenceBuffer[int(OSD_VALENCE_RECORD(vID) + 2*im + 0 + 1)]);
 
         float3 neighbor_m =
             float3(OsdVertexBuffer[int(OSD_NUM_ELEMENTS*idx_neighbor_m)],
                    OsdVertexBuffer[int(OSD_NUM_ELEMENTS*idx_neighbor_m+1)],
                    OsdVertexBuffer[int(OSD_NUM_ELEMENTS*idx_neighbor_m+2)]);
 
-        uint idx_diagonal_m = uint(OsdValenceBuffer[int(vID * (2*OSD_MAX_VALENCE+1) + 2*im + 1 + 1)]);
+        uint idx_diagonal_m = uint(OsdValenceBuffer[int(OSD_VALENCE_RECORD(vID) + 2*im + 1 + 1)]);
 
         float3 diagonal_m =
             float3(OsdVertexBuffer[int(OSD_NUM_ELEMENTS*idx_diagonal_m)],
@@ -202,7 +209,7 @@ void vs_main_patches( in InputVertex input,
         float beta_0 = s/(3.0f*k + c); 
 
 
-        int idx_diagonal = OsdValenceBuffer[int((vID) * (2*OSD_MAX_VALENCE+1) + 2*zerothNeighbor + 1 + 1)];
+        int idx_diagonal = OsdValenceBuffer[int(OSD_VALENCE_RECORD(vID) + 2*zerothNeighbor + 1 + 1)];
         idx_diagonal = abs(idx_diagonal);
         float3 diagonal =
                 float3(OsdVertexBuffer[int(OSD_NUM_ELEMENTS*idx_diagonal)],
@@ -223,7 +230,7 @@ void vs_main_patches( in InputVertex input,
             float alpha = (4.0f*sin((M_PI * float(x))/k))/(3.0f*k+c);
             float beta = (sin((M_PI * float(x))/k) + sin((M_PI * float(x+1))/k))/(3.0f*k+c);
 
-            int idx_neighbor = OsdValenceBuffer[int((vID) * (2*OSD_MAX_VALENCE+1) + 2*curri + 0 + 1)];
+            int idx_neighbor = OsdValenceBuffer[int(OSD_VALENCE_RECORD(vID) + 2*curri + 0 + 1)];
             idx_neighbor = abs(idx_neighbor);
 
             float3 neighbor =
@@ -231,7 +238,7 @@ void vs_main_patches( in InputVertex input,
                        OsdVertexBuffer[int(OSD_NUM_ELEMENTS*idx_neighbor+1)],
                        OsdVertexBuffer[int(OSD_NUM_ELEMENTS*idx_neighbor+2)]);
 
-            idx_diagonal = OsdValenceBuffer[int((vID) * (2*OSD_MAX_VALENCE+1) + 2*curri + 1 + 1)];
+            idx_diagonal = OsdValenceBuffer[int(OSD_VALENCE_RECORD(vID) + 2*curri + 1 + 1)];
 
             diagonal =
                 float3(OsdVertexBuffer[int(OSD_NUM_ELEMENTS*idx_diagonal)],
@@ -0,0 +1,177 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+//
+#ifndef OSD_MUTEX_H
+#define OSD_MUTEX_H
+
+#include "../version.h"
+
+#include "../osd/nonCopyable.h"
+
+#if defined(_WIN32)
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <pthread.h>
+#endif
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+class OsdCondition;
+
+/// \brief Minimal mutex wrapping the native threading primitives.
+///
+class OsdMutex : OsdNonCopyable<OsdMutex> {
+public:
+    /// Constructor
+    OsdMutex() {
+#if defined(_WIN32)
+        InitializeCriticalSection(&_mutex);
+#else
+        pthread_mutex_init(&_mutex, 0);
+#endif
+    }
+
+    /// Destructor
+    ~OsdMutex() {
+#if defined(_WIN32)
+        DeleteCriticalSection(&_mutex);
+#else
+        pthread_mutex_destroy(&_mutex);
+#endif
+    }
+
+    /// Blocks until the mutex is acquired
+    void Lock() {
+#if defined(_WIN32)
+        EnterCriticalSection(&_mutex);
+#else
+        pthread_mutex_lock(&_mutex);
+#endif
+    }
+
+    /// Releases the mutex
+    void Unlock() {
+#if defined(_WIN32)
+        LeaveCriticalSection(&_mutex);
+#else
+        pthread_mutex_unlock(&_mutex);
+#endif
+    }
+
+    /// \brief Holds a mutex for the lifetime of the scope
+    class ScopedLock {
+    public:
+        explicit ScopedLock(OsdMutex & mutex) : _mutex(mutex) { _mutex.Lock(); }
+
+        ~ScopedLock() { _mutex.Unlock(); }
+
+    private:
+        ScopedLock(ScopedLock const &);
+        ScopedLock & operator = (ScopedLock const &);
+
+        OsdMutex & _mutex;
+    };
+
+private:
+    friend class OsdCondition;
+
+#if defined(_WIN32)
+    CRITICAL_SECTION _mutex;
+#else
+    pthread_mutex_t _mutex;
+#endif
+};
+
+/// \brief Minimal condition variable, used with an OsdMutex.
+///
+class OsdCondition : OsdNonCopyable<OsdCondition> {
+public:
+    /// Constructor
+    OsdCondition() {
+#if defined(_WIN32)
+        InitializeConditionVariable(&_condition);
+#else
+        pthread_cond_init(&_condition, 0);
+#endif
+    }
+
+    /// Destructor
+    ~OsdCondition() {
+#ifndef _WIN32
+        // (win32 condition variables need no destruction)
+        pthread_cond_destroy(&_condition);
+#endif
+    }
+
+    /// Releases the mutex (which must be locked by the caller) and blocks
+    /// until the condition is signaled : the mutex is locked again on return.
+    /// Spurious wake-ups are possible, so the caller must test its predicate
+    /// in a loop.
+    void Wait(OsdMutex & mutex) {
+#if defined(_WIN32)
+        SleepConditionVariableCS(&_condition, &mutex._mutex, INFINITE);
+#else
+        pthread_cond_wait(&_condition, &mutex._mutex);
+#endif
+    }
+
+    /// Wakes up one of the waiting threads
+    void Signal() {
+#if defined(_WIN32)
+        WakeConditionVariable(&_condition);
+#else
+        pthread_cond_signal(&_condition);
+#endif
+    }
+
+    /// Wakes up all the waiting threads
+    void Broadcast() {
+#if defined(_WIN32)
+        WakeAllConditionVariable(&_condition);
+#else
+        pthread_cond_broadcast(&_condition);
+#endif
+    }
+
+private:
+#if defined(_WIN32)
+    CONDITION_VARIABLE _condition;
+#else
+    pthread_cond_t _condition;
+#endif
+};
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OSD_MUTEX_H
@@ -25,7 +25,12 @@
 
 #include "../osd/cpuComputeContext.h"
 #include "../osd/ompComputeController.h"
+#include "../osd/cpuDeformer.h"
+#include "../osd/cpuPatchBounds.h"
 #include "../osd/ompKernel.h"
+#include "../osd/cpuNuma.h"
+
+#include <cstring>
 
 #ifdef OPENSUBDIV_HAS_OPENMP
     #include <omp.h>
@@ -35,11 +40,56 @@ namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
 
-OsdOmpComputeController::OsdOmpComputeController(int numThreads) {
+OsdOmpComputeController::OsdOmpComputeController(int numThreads, bool pinThreads) :
+    _pinThreads(pinThreads), _threadsPinned(false) {
 
     _numThreads = (numThreads == -1) ? omp_get_num_procs() : numThreads;
 }
 
+void
+OsdOmpComputeController::pinThreads() {
+
+    std::vector<int> cpus;
+    OsdCpuNuma::GetAllowedCpus(cpus);
+    if (cpus.empty())
+        return;
+
+    // the openmp runtime keeps its worker threads alive between parallel
+    // regions, so the threads only need to be pinned once
+#pragma omp parallel
+    {
+        int thread = omp_get_thread_num();
+        OsdCpuNuma::PinThread(cpus[thread % cpus.size()]);
+    }
+    _threadsPinned = true;
+}
+
+void
+OsdOmpComputeController::firstTouch(FarKernelBatchVector const & batches,
+                                    float * buffer, int numElements) {
+
+    if (not buffer)
+        return;
+
+    for (int i = 0; i < (int)batches.size(); ++i) {
+        FarKernelBatch const & batch = batches[i];
+
+        // the start and end of a structured grid batch index grid
+        // descriptors rather than vertices : the grid kernel parallelizes
+        // over the rows of each grid and touches its own pages
+        if (batch.GetKernelType() == FarKernelBatch::HIERARCHICAL_EDIT or
+            batch.GetKernelType() == FarKernelBatch::CATMARK_STRUCTURED_GRID)
+            continue;
+
+        // same iteration space & schedule as the OsdOmpCompute* kernels
+        int offset = batch.GetVertexOffset();
+#pragma omp parallel for
+        for (int j = batch.GetStart(); j < batch.GetEnd(); j++) {
+            memset(buffer + (offset + j) * numElements, 0, numElements * sizeof(float));
+        }
+    }
+}
+
 
 void
 OsdOmpComputeController::ApplyBilinearFaceVerticesKernel(
@@ -55,7 +105,8 @@ OsdOmpComputeController::ApplyBilinearFaceVerticesKernel(
         context->GetCurrentVaryingBuffer(),
         (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::F_IT)->GetBuffer(),
         (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::F_ITa)->GetBuffer(),
-        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd());
+        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd(),
+        batch.GetValence());
 }
 
 void
@@ -104,7 +155,8 @@ OsdOmpComputeController::ApplyCatmarkFaceVerticesKernel(
         context->GetCurrentVaryingBuffer(),
         (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::F_IT)->GetBuffer(),
         (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::F_ITa)->GetBuffer(),
-        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd());
+        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd(),
+        batch.GetValence());
 }
 
 void
@@ -139,7 +191,8 @@ OsdOmpComputeController::ApplyCatmarkVertexVerticesKernelB(
         (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_ITa)->GetBuffer(),
         (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_IT)->GetBuffer(),
         (const float*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_W)->GetBuffer(),
-        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd());
+        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd(),
+        batch.GetValence());
 }
 
 void
@@ -176,6 +229,43 @@ OsdOmpComputeController::ApplyCatmarkVertexVerticesKernelA2(
         batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd(), true);
 }
 
+void
+OsdOmpComputeController::ApplyCatmarkStructuredGridKernel(
+    FarKernelBatch const &batch, void *clientdata) const {
+
+    OsdCpuComputeContext * context =
+        static_cast<OsdCpuComputeContext*>(clientdata);
+    assert(context);
+
+    OsdOmpComputeStructuredGrid(
+        context->GetVertexDescriptor(),
+        context->GetCurrentVertexBuffer(),
+        context->GetCurrentVaryingBuffer(),
+        (const FarStructuredGrids::Grid*)context->GetStructuredGrids()->GetBuffer(),
+        (const int*)context->GetStructuredGridIndices()->GetBuffer(),
+        batch.GetStart(), batch.GetEnd());
+}
+
+void
+OsdOmpComputeController::ApplyEndCapKernel(
+    FarKernelBatch const &batch, void * clientdata) const {
+
+    OsdCpuComputeContext * context =
+        static_cast<OsdCpuComputeContext*>(clientdata);
+    assert(context);
+
+    OsdOmpComputeEndCap(
+        context->GetVertexDescriptor(),
+        context->GetCurrentVertexBuffer(),
+        context->GetCurrentVaryingBuffer(),
+        (const int*)context->GetEndCapOffsets()->GetBuffer(),
+        (const int*)context->GetEndCapIndices()->GetBuffer(),
+        (const float*)context->GetEndCapWeights()->GetBuffer(),
+        (const int*)context->GetEndCapVaryingIndices()->GetBuffer(),
+        batch.GetVertexOffset(), batch.GetTableOffset(),
+        batch.GetStart(), batch.GetEnd());
+}
+
 void
 OsdOmpComputeController::ApplyLoopEdgeVerticesKernel(
     FarKernelBatch const &batch, void *clientdata) const {
@@ -208,7 +298,8 @@ OsdOmpComputeController::ApplyLoopVertexVerticesKernelB(
         (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_ITa)->GetBuffer(),
         (const int*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_IT)->GetBuffer(),
         (const float*)context->GetTable(FarSubdivisionTables<OsdVertex>::V_W)->GetBuffer(),
-        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd());
+        batch.GetVertexOffset(), batch.GetTableOffset(), batch.GetStart(), batch.GetEnd(),
+        batch.GetValence());
 }
 
 void
@@ -284,6 +375,56 @@ OsdOmpComputeController::ApplyVertexEdits(
     }
 }
 
+void
+OsdOmpComputeController::ApplyDeformer(
+    OsdCpuComputeContext const *context) const {
+
+    assert(context);
+
+    OsdCpuDeformer const * deformer = context->GetDeformer();
+    OsdVertexDescriptor const & vdesc = context->GetVertexDescriptor();
+    float * vertex = context->GetCurrentVertexBuffer();
+    int numVertices = deformer->GetNumVertices();
+
+    // one contiguous range of coarse vertices per thread
+#pragma omp parallel
+    {
+        int numThreads = omp_get_num_threads(),
+            thread = omp_get_thread_num();
+
+        int start = (int)((long long)numVertices * thread / numThreads),
+            end = (int)((long long)numVertices * (thread+1) / numThreads);
+
+        if (start < end)
+            deformer->Deform(vdesc, vertex, start, end);
+    }
+}
+
+void
+OsdOmpComputeController::ApplyPatchBounds(
+    OsdCpuComputeContext const *context) const {
+
+    assert(context);
+
+    OsdCpuPatchBounds * bounds = context->GetPatchBounds();
+    float const * vertex = context->GetCurrentVertexBuffer();
+    int stride = context->GetVertexDescriptor().numVertexElements,
+        numPatches = bounds->GetNumPatches();
+
+    // one contiguous range of patches per thread
+#pragma omp parallel
+    {
+        int numThreads = omp_get_num_threads(),
+            thread = omp_get_thread_num();
+
+        int start = (int)((long long)numPatches * thread / numThreads),
+            end = (int)((long long)numPatches * (thread+1) / numThreads);
+
+        if (start < end)
+            bounds->Update(vertex, stride, start, end);
+    }
+}
+
 void
 OsdOmpComputeController::Synchronize() {
     // XXX: 
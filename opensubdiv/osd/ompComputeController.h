@@ -56,7 +56,12 @@ public:
     /// @param numThreads specifies how many openmp parallel threads to use.
     ///                   -1 attempts to use all available processors.
     ///
-    explicit OsdOmpComputeController(int numThreads=-1);
+    /// @param pinThreads if true, each openmp thread is pinned to one of the
+    ///                   CPUs the process is allowed to run on before the
+    ///                   first refinement, so that the pages it first-touches
+    ///                   stay local to it (see OsdCpuNuma)
+    ///
+    explicit OsdOmpComputeController(int numThreads=-1, bool pinThreads=false);
 
     /// Launch subdivision kernels and apply to given vertex buffers.
     ///
@@ -75,15 +80,24 @@ public:
                 VERTEX_BUFFER * vertexBuffer,
                 VARYING_BUFFER * varyingBuffer) {
 
-        if (batches.empty()) return;
+        // without batches, the coarse vertices still bound the patches
+        if (batches.empty() and not context->GetPatchBounds()) return;
 
         omp_set_num_threads(_numThreads);
 
+        if (_pinThreads and not _threadsPinned)
+            pinThreads();
+
         context->Bind(vertexBuffer, varyingBuffer);
+        if (context->GetDeformer() and not batches.empty())
+            ApplyDeformer(context);
         FarDispatcher::Refine(this,
                               batches,
                               -1,
-                              context);
+                              context,
+                              context->GetKernelBatchObserver());
+        if (context->GetPatchBounds() and vertexBuffer)
+            ApplyPatchBounds(context);
         context->Unbind();
     }
 
@@ -106,6 +120,47 @@ public:
     /// Waits until all running subdivision kernels finish.
     void Synchronize();
 
+    /// Writes zeros to the refined vertices of freshly allocated buffers
+    /// using the same static openmp schedule as the subdivision kernels :
+    /// with the OsdCpuNuma::kPlacementFirstTouch policy, every page of the
+    /// buffers then lands on the node of the thread that refines it. The
+    /// vertices of structured grid batches are left to the grid kernel.
+    ///
+    /// @param  batches       the batches that will be applied to the buffers
+    ///
+    /// @param  vertexBuffer  vertex-interpolated data buffer
+    ///
+    /// @param  varyingBuffer varying-interpolated data buffer
+    ///
+    template<class VERTEX_BUFFER, class VARYING_BUFFER>
+    void FirstTouch(FarKernelBatchVector const & batches,
+                    VERTEX_BUFFER * vertexBuffer,
+                    VARYING_BUFFER * varyingBuffer) {
+
+        omp_set_num_threads(_numThreads);
+
+        if (_pinThreads and not _threadsPinned)
+            pinThreads();
+
+        if (vertexBuffer)
+            firstTouch(batches, vertexBuffer->BindCpuBuffer(), vertexBuffer->GetNumElements());
+        if (varyingBuffer)
+            firstTouch(batches, varyingBuffer->BindCpuBuffer(), varyingBuffer->GetNumElements());
+    }
+
+    /// Writes zeros to the refined vertices of a freshly allocated buffer
+    /// using the same static openmp schedule as the subdivision kernels.
+    ///
+    /// @param  batches       the batches that will be applied to the buffer
+    ///
+    /// @param  vertexBuffer  vertex-interpolated data buffer
+    ///
+    template<class VERTEX_BUFFER>
+    void FirstTouch(FarKernelBatchVector const & batches,
+                    VERTEX_BUFFER * vertexBuffer) {
+        FirstTouch(batches, vertexBuffer, (VERTEX_BUFFER*)0);
+    }
+
 protected:
     friend class FarDispatcher;
 
@@ -126,6 +181,8 @@ protected:
 
     void ApplyCatmarkVertexVerticesKernelA2(FarKernelBatch const &batch, void * clientdata) const;
 
+    void ApplyCatmarkStructuredGridKernel(FarKernelBatch const &batch, void * clientdata) const;
+
 
     void ApplyLoopEdgeVerticesKernel(FarKernelBatch const &batch, void * clientdata) const;
 
@@ -137,7 +194,24 @@ protected:
 
     void ApplyVertexEdits(FarKernelBatch const &batch, void * clientdata) const;
 
+    void ApplyEndCapKernel(FarKernelBatch const &batch, void * clientdata) const;
+
+    // writes the deformed coarse vertices into the bound vertex buffer
+    void ApplyDeformer(OsdCpuComputeContext const *context) const;
+
+    // refreshes the patch bounds from the refined vertices of the bound buffer
+    void ApplyPatchBounds(OsdCpuComputeContext const *context) const;
+
     int _numThreads;
+
+private:
+    // pins each openmp thread to one of the allowed CPUs
+    void pinThreads();
+
+    void firstTouch(FarKernelBatchVector const & batches, float * buffer, int numElements);
+
+    bool _pinThreads,
+         _threadsPinned;
 };
 
 }  // end namespace OPENSUBDIV_VERSION
@@ -24,18 +24,107 @@
 //
 
 #include "../osd/ompKernel.h"
+#include "../osd/cpuKernel.h"
 #include "../osd/vertexDescriptor.h"
 
 #include <math.h>
 #include <omp.h>
+#include <vector>
 
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
-void OsdOmpComputeFace(
+// Kernels specialized for a constant valence N (see cpuKernel.cpp)
+template <int N> static void
+computeFace(
     OsdVertexDescriptor const &vdesc, float * vertex, float * varying,
     const int *F_IT, const int *F_ITa, int offset, int tableOffset, int start, int end) {
 
+    const float weight = 1.0f/N;
+
+#pragma omp parallel for
+    for (int i = start + tableOffset; i < end + tableOffset; i++) {
+        const int *h = F_IT + F_ITa[2*i];
+
+        int dstIndex = offset + i - tableOffset;
+        vdesc.Clear(vertex, varying, dstIndex);
+
+        for (int j = 0; j < N; ++j) {
+            vdesc.AddWithWeight(vertex, dstIndex, h[j], weight);
+            vdesc.AddVaryingWithWeight(varying, dstIndex, h[j], weight);
+        }
+    }
+}
+
+template <int N> static void
+computeVertexB(
+    OsdVertexDescriptor const &vdesc, float *vertex, float *varying,
+    const int *V_ITa, const int *V_IT, const float *V_W,
+    int offset, int tableOffset, int start, int end) {
+
+    float wp, wv;
+    OsdCpuGetCatmarkVertexWeights(N, &wp, &wv);
+
+#pragma omp parallel for
+    for (int i = start + tableOffset; i < end + tableOffset; i++) {
+        const int *h = V_IT + V_ITa[5*i];
+        int p = V_ITa[5*i+2];
+
+        float weight = V_W[i];
+
+        int dstIndex = offset + i - tableOffset;
+        vdesc.Clear(vertex, varying, dstIndex);
+
+        vdesc.AddWithWeight(vertex, dstIndex, p, weight * wv);
+
+        for (int j = 0; j < N; ++j) {
+            vdesc.AddWithWeight(vertex, dstIndex, h[j*2], weight * wp);
+            vdesc.AddWithWeight(vertex, dstIndex, h[j*2+1], weight * wp);
+        }
+        vdesc.AddVaryingWithWeight(varying, dstIndex, p, 1.0f);
+    }
+}
+
+template <int N> static void
+computeLoopVertexB(
+    OsdVertexDescriptor const &vdesc, float *vertex, float *varying,
+    const int *V_ITa, const int *V_IT, const float *V_W,
+    int vertexOffset, int tableOffset, int start, int end) {
+
+    float beta = OsdCpuGetLoopVertexWeight(N);
+
+#pragma omp parallel for
+    for (int i = start + tableOffset; i < end + tableOffset; i++) {
+        const int *h = V_IT + V_ITa[5*i];
+        int p = V_ITa[5*i+2];
+
+        float weight = V_W[i];
+
+        int dstIndex = i + vertexOffset - tableOffset;
+        vdesc.Clear(vertex, varying, dstIndex);
+
+        vdesc.AddWithWeight(vertex, dstIndex, p, weight * (1.0f - (beta * N)));
+
+        for (int j = 0; j < N; ++j)
+            vdesc.AddWithWeight(vertex, dstIndex, h[j], weight * beta);
+
+        vdesc.AddVaryingWithWeight(varying, dstIndex, p, 1.0f);
+    }
+}
+
+void OsdOmpComputeFace(
+    OsdVertexDescriptor const &vdesc, float * vertex, float * varying,
+    const int *F_IT, const int *F_ITa, int offset, int tableOffset, int start, int end,
+    int valence) {
+
+    switch (valence) {
+        case 3 : computeFace<3>(vdesc, vertex, varying, F_IT, F_ITa,
+                                offset, tableOffset, start, end); return;
+        case 4 : computeFace<4>(vdesc, vertex, varying, F_IT, F_ITa,
+                                offset, tableOffset, start, end); return;
+        default : break;
+    }
+
 #pragma omp parallel for
     for (int i = start + tableOffset; i < end + tableOffset; i++) {
         int h = F_ITa[2*i];
@@ -127,7 +216,19 @@ void OsdOmpComputeVertexA(
 void OsdOmpComputeVertexB(
     OsdVertexDescriptor const &vdesc, float *vertex, float *varying,
     const int *V_ITa, const int *V_IT, const float *V_W,
-    int offset, int tableOffset, int start, int end) {
+    int offset, int tableOffset, int start, int end, int valence) {
+
+#define OSD_OMP_VERTEX_B(N) \
+        case N : computeVertexB<N>(vdesc, vertex, varying, V_ITa, V_IT, V_W, \
+                                   offset, tableOffset, start, end); return;
+    switch (valence) {
+        OSD_OMP_VERTEX_B(3)
+        OSD_OMP_VERTEX_B(4)
+        OSD_OMP_VERTEX_B(5)
+        OSD_OMP_VERTEX_B(6)
+        default : break;
+    }
+#undef OSD_OMP_VERTEX_B
 
 #pragma omp parallel for
     for (int i = start + tableOffset; i < end + tableOffset; i++) {
@@ -136,8 +237,8 @@ void OsdOmpComputeVertexB(
         int p = V_ITa[5*i+2];
 
         float weight = V_W[i];
-        float wp = 1.0f/static_cast<float>(n*n);
-        float wv = (n-2.0f) * n * wp;
+        float wp, wv;
+        OsdCpuGetCatmarkVertexWeights(n, &wp, &wv);
 
         int dstIndex = offset + i - tableOffset;
         vdesc.Clear(vertex, varying, dstIndex);
@@ -155,7 +256,19 @@ void OsdOmpComputeVertexB(
 void OsdOmpComputeLoopVertexB(
     OsdVertexDescriptor const &vdesc, float *vertex, float *varying,
     const int *V_ITa, const int *V_IT, const float *V_W,
-    int vertexOffset, int tableOffset, int start, int end) {
+    int vertexOffset, int tableOffset, int start, int end, int valence) {
+
+#define OSD_OMP_LOOP_VERTEX_B(N) \
+        case N : computeLoopVertexB<N>(vdesc, vertex, varying, V_ITa, V_IT, V_W, \
+                                       vertexOffset, tableOffset, start, end); return;
+    switch (valence) {
+        OSD_OMP_LOOP_VERTEX_B(4)
+        OSD_OMP_LOOP_VERTEX_B(5)
+        OSD_OMP_LOOP_VERTEX_B(6)
+        OSD_OMP_LOOP_VERTEX_B(7)
+        default : break;
+    }
+#undef OSD_OMP_LOOP_VERTEX_B
 
 #pragma omp parallel for
     for (int i = start + tableOffset; i < end + tableOffset; i++) {
@@ -164,10 +277,7 @@ void OsdOmpComputeLoopVertexB(
         int p = V_ITa[5*i+2];
 
         float weight = V_W[i];
-        float wp = 1.0f/static_cast<float>(n);
-        float beta = 0.25f * cosf(static_cast<float>(M_PI) * 2.0f * wp) + 0.375f;
-        beta = beta * beta;
-        beta = (0.625f - beta) * wp;
+        float beta = OsdCpuGetLoopVertexWeight(n);
 
         int dstIndex = i + vertexOffset - tableOffset;
         vdesc.Clear(vertex, varying, dstIndex);
@@ -217,6 +327,123 @@ void OsdOmpComputeBilinearVertex(
     }
 }
 
+// Each phase is parallelized over the rows of the grid : the implicit
+// barriers order the face-vertices before the edge and vertex-vertices.
+void OsdOmpComputeStructuredGrid(
+    OsdVertexDescriptor const &vdesc, float *vertex, float *varying,
+    const FarStructuredGrids::Grid *grids, const int *indices,
+    int start, int end) {
+
+    std::vector<int> lattice;
+
+    for (int i = start; i < end; i++) {
+        const FarStructuredGrids::Grid &g = grids[i];
+        int w = g.width, h = g.height;
+
+        lattice.resize((w+1)*(h+1));
+
+#pragma omp parallel
+        {
+#pragma omp for
+            for (int y = 0; y <= h; y++)
+                FarStructuredGrids::GetParentRow(grids, indices, i, y, &lattice[y*(w+1)]);
+
+            const int *P = &lattice[0];
+
+            // face-vertices
+#pragma omp for
+            for (int y = 0; y < h; y++) {
+                const int *r0 = P + y*(w+1), *r1 = r0 + (w+1);
+                for (int x = 0; x < w; x++) {
+                    int dstIndex = g.faceOffset + y*w + x;
+                    vdesc.Clear(vertex, varying, dstIndex);
+                    vdesc.AddWithWeight(vertex, dstIndex, r0[x], 0.25f);
+                    vdesc.AddWithWeight(vertex, dstIndex, r0[x+1], 0.25f);
+                    vdesc.AddWithWeight(vertex, dstIndex, r1[x+1], 0.25f);
+                    vdesc.AddWithWeight(vertex, dstIndex, r1[x], 0.25f);
+                    vdesc.AddVaryingWithWeight(varying, dstIndex, r0[x], 0.25f);
+                    vdesc.AddVaryingWithWeight(varying, dstIndex, r0[x+1], 0.25f);
+                    vdesc.AddVaryingWithWeight(varying, dstIndex, r1[x+1], 0.25f);
+                    vdesc.AddVaryingWithWeight(varying, dstIndex, r1[x], 0.25f);
+                }
+            }
+
+            // edge-vertices along u
+#pragma omp for
+            for (int y = 1; y < h; y++) {
+                const int *r = P + y*(w+1);
+                int f0 = g.faceOffset + (y-1)*w, f1 = f0 + w;
+                for (int x = 0; x < w; x++) {
+                    int dstIndex = g.hEdgeOffset + (y-1)*w + x;
+                    vdesc.Clear(vertex, varying, dstIndex);
+                    vdesc.AddWithWeight(vertex, dstIndex, r[x], 0.25f);
+                    vdesc.AddWithWeight(vertex, dstIndex, r[x+1], 0.25f);
+                    vdesc.AddWithWeight(vertex, dstIndex, f0 + x, 0.25f);
+                    vdesc.AddWithWeight(vertex, dstIndex, f1 + x, 0.25f);
+                    vdesc.AddVaryingWithWeight(varying, dstIndex, r[x], 0.5f);
+                    vdesc.AddVaryingWithWeight(varying, dstIndex, r[x+1], 0.5f);
+                }
+            }
+
+            // edge-vertices along v
+#pragma omp for
+            for (int y = 0; y < h; y++) {
+                const int *r0 = P + y*(w+1), *r1 = r0 + (w+1);
+                int f = g.faceOffset + y*w;
+                for (int x = 1; x < w; x++) {
+                    int dstIndex = g.vEdgeOffset + y*(w-1) + x-1;
+                    vdesc.Clear(vertex, varying, dstIndex);
+                    vdesc.AddWithWeight(vertex, dstIndex, r0[x], 0.25f);
+                    vdesc.AddWithWeight(vertex, dstIndex, r1[x], 0.25f);
+                    vdesc.AddWithWeight(vertex, dstIndex, f + x-1, 0.25f);
+                    vdesc.AddWithWeight(vertex, dstIndex, f + x, 0.25f);
+                    vdesc.AddVaryingWithWeight(varying, dstIndex, r0[x], 0.5f);
+                    vdesc.AddVaryingWithWeight(varying, dstIndex, r1[x], 0.5f);
+                }
+            }
+
+            // vertex-vertices (valence 4 smooth rule)
+#pragma omp for
+            for (int y = 1; y < h; y++) {
+                const int *r0 = P + (y-1)*(w+1), *r1 = r0 + (w+1), *r2 = r1 + (w+1);
+                int f0 = g.faceOffset + (y-1)*w, f1 = f0 + w;
+                for (int x = 1; x < w; x++) {
+                    int dstIndex = g.vertOffset + (y-1)*(w-1) + x-1;
+                    vdesc.Clear(vertex, varying, dstIndex);
+                    vdesc.AddWithWeight(vertex, dstIndex, r1[x], 0.5f);
+                    vdesc.AddWithWeight(vertex, dstIndex, r1[x+1], 0.0625f);
+                    vdesc.AddWithWeight(vertex, dstIndex, r2[x], 0.0625f);
+                    vdesc.AddWithWeight(vertex, dstIndex, r1[x-1], 0.0625f);
+                    vdesc.AddWithWeight(vertex, dstIndex, r0[x], 0.0625f);
+                    vdesc.AddWithWeight(vertex, dstIndex, f1 + x, 0.0625f);
+                    vdesc.AddWithWeight(vertex, dstIndex, f1 + x-1, 0.0625f);
+                    vdesc.AddWithWeight(vertex, dstIndex, f0 + x-1, 0.0625f);
+                    vdesc.AddWithWeight(vertex, dstIndex, f0 + x, 0.0625f);
+                    vdesc.AddVaryingWithWeight(varying, dstIndex, r1[x], 1.0f);
+                }
+            }
+        }
+    }
+}
+
+void OsdOmpComputeEndCap(
+    OsdVertexDescriptor const &vdesc, float *vertex, float *varying,
+    const int *offsets, const int *indices, const float *weights,
+    const int *varyingIndices, int vertexOffset, int tableOffset,
+    int start, int end) {
+
+#pragma omp parallel for
+    for (int i = start + tableOffset; i < end + tableOffset; i++) {
+        int dstIndex = i + vertexOffset - tableOffset;
+        vdesc.Clear(vertex, varying, dstIndex);
+
+        for (int j = offsets[i]; j < offsets[i+1]; ++j)
+            vdesc.AddWithWeight(vertex, dstIndex, indices[j], weights[j]);
+
+        vdesc.AddVaryingWithWeight(varying, dstIndex, varyingIndices[i], 1.0f);
+    }
+}
+
 void OsdOmpEditVertexAdd(
     OsdVertexDescriptor const &vdesc, float *vertex,
     int primVarOffset, int primVarWidth, int vertexOffset, int tableOffset,
@@ -27,16 +27,21 @@
 
 #include "../version.h"
 
+#include "../far/structuredGrids.h"
+
 namespace OpenSubdiv {
 namespace OPENSUBDIV_VERSION {
 
 struct OsdVertexDescriptor;
 
+// Note : 'valence' is the valence shared by all the vertices of the batch
+// (see OsdCpuComputeFace)
+
 void OsdOmpComputeFace(OsdVertexDescriptor const &vdesc,
                        float * vertex, float * varying,
                        const int *F_IT, const int *F_ITa,
                        int vertexOffset, int tableOffset,
-                       int start, int end);
+                       int start, int end, int valence=0);
 
 void OsdOmpComputeEdge(OsdVertexDescriptor const &vdesc,
                        float *vertex, float * varying,
@@ -54,14 +59,14 @@ void OsdOmpComputeVertexB(OsdVertexDescriptor const &vdesc,
                           float *vertex, float * varying,
                           const int *V_ITa, const int *V_IT, const float *V_W,
                           int vertexOffset, int tableOffset,
-                          int start, int end);
+                          int start, int end, int valence=0);
 
 void OsdOmpComputeLoopVertexB(OsdVertexDescriptor const &vdesc,
                               float *vertex, float * varying,
                               const int *V_ITa, const int *V_IT,
                               const float *V_W,
                               int vertexOffset, int tableOffset,
-                              int start, int end);
+                              int start, int end, int valence=0);
 
 void OsdOmpComputeBilinearEdge(OsdVertexDescriptor const &vdesc,
                                float *vertex, float * varying,
@@ -75,6 +80,22 @@ void OsdOmpComputeBilinearVertex(OsdVertexDescriptor const &vdesc,
                                  int vertexOffset, int tableOffset,
                                  int start, int end);
 
+// Refines the structured grids [start, end[ (see FarStructuredGrids)
+void OsdOmpComputeStructuredGrid(OsdVertexDescriptor const &vdesc,
+                                 float *vertex, float * varying,
+                                 const FarStructuredGrids::Grid *grids,
+                                 const int *indices,
+                                 int start, int end);
+
+// Computes the control vertices of the B-spline end caps [start, end[ (see
+// FarEndCapTables)
+void OsdOmpComputeEndCap(OsdVertexDescriptor const &vdesc,
+                         float *vertex, float * varying,
+                         const int *offsets, const int *indices,
+                         const float *weights, const int *varyingIndices,
+                         int vertexOffset, int tableOffset,
+                         int start, int end);
+
 void OsdOmpEditVertexAdd(OsdVertexDescriptor const &vdesc, float *vertex,
                          int primVarOffset, int primVarWidth,
                          int vertexOffset, int tableOffset,
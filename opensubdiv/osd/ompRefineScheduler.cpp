@@ -0,0 +1,176 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+//
+
+#include "../osd/ompRefineScheduler.h"
+#include "../osd/cpuComputeController.h"
+#include "../osd/ompComputeController.h"
+#include "../osd/cpuVertexBuffer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <map>
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #include <omp.h>
+#endif
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+OsdOmpRefineScheduler::OsdOmpRefineScheduler(int numThreads, int minSplitVertices) :
+    _minSplitVertices(minSplitVertices), _numTasks(0), _numSplitTasks(0) {
+
+    _numThreads = (numThreads == -1) ? omp_get_num_procs() : std::max(numThreads, 1);
+}
+
+void
+OsdOmpRefineScheduler::addJob(OsdCpuComputeContext *context,
+                              FarKernelBatchVector const & batches,
+                              float *vertex, int numVertexElements,
+                              float *varying, int numVaryingElements) {
+
+    assert(context);
+
+    Job job;
+    job.context = context;
+    job.batches = &batches;
+    job.vertex = vertex;
+    job.varying = varying;
+    job.numVertexElements = numVertexElements;
+    job.numVaryingElements = numVaryingElements;
+    _jobs.push_back(job);
+}
+
+void
+OsdOmpRefineScheduler::Clear() {
+
+    _jobs.clear();
+}
+
+void
+OsdOmpRefineScheduler::Refine() {
+
+    // gather the jobs of each context into a task
+    std::vector<Task> tasks;
+    std::map<OsdCpuComputeContext const *, int> taskIndices;
+
+    double totalCost = 0.0;
+    for (int i = 0; i < (int)_jobs.size(); ++i) {
+        Job const & job = _jobs[i];
+
+        std::map<OsdCpuComputeContext const *, int>::iterator it =
+            taskIndices.find(job.context);
+        if (it == taskIndices.end()) {
+            it = taskIndices.insert(std::make_pair(job.context, (int)tasks.size())).first;
+            tasks.push_back(Task());
+            tasks.back().numVertices = 0;
+            tasks.back().cost = 0.0;
+        }
+        Task & task = tasks[it->second];
+
+        int numVertices = 0;
+        for (int j = 0; j < (int)job.batches->size(); ++j) {
+            FarKernelBatch const & batch = (*job.batches)[j];
+            numVertices += batch.GetEnd() - batch.GetStart();
+        }
+
+        double cost = (double)numVertices *
+                      (job.numVertexElements + job.numVaryingElements);
+
+        task.jobs.push_back(i);
+        task.numVertices += numVertices;
+        task.cost += cost;
+        totalCost += cost;
+    }
+
+    // separate the tasks worth splitting across the threads
+    std::vector<Task> serialTasks,
+                      splitTasks;
+    for (int i = 0; i < (int)tasks.size(); ++i) {
+        Task const & task = tasks[i];
+        if (_numThreads > 1 and
+            task.numVertices >= _minSplitVertices and
+            task.cost * _numThreads >= totalCost) {
+            splitTasks.push_back(task);
+        } else {
+            serialTasks.push_back(task);
+        }
+    }
+
+    // most expensive tasks first
+    std::stable_sort(serialTasks.begin(), serialTasks.end());
+
+    for (int i = 0; i < (int)splitTasks.size(); ++i)
+        refineSplit(splitTasks[i]);
+
+    int numSerialTasks = (int)serialTasks.size();
+#pragma omp parallel for schedule(dynamic, 1) num_threads(_numThreads)
+    for (int i = 0; i < numSerialTasks; ++i)
+        refineSerial(serialTasks[i]);
+
+    _numTasks = (int)tasks.size();
+    _numSplitTasks = (int)splitTasks.size();
+
+    _jobs.clear();
+}
+
+void
+OsdOmpRefineScheduler::refineSerial(Task const & task) const {
+
+    OsdCpuComputeController controller;
+
+    for (int i = 0; i < (int)task.jobs.size(); ++i) {
+        Job const & job = _jobs[task.jobs[i]];
+
+        OsdCpuBoundBuffer vertex(job.vertex, job.numVertexElements),
+                          varying(job.varying, job.numVaryingElements);
+
+        controller.Refine(job.context,
+                          *job.batches,
+                          job.vertex ? &vertex : 0,
+                          job.varying ? &varying : 0);
+    }
+}
+
+void
+OsdOmpRefineScheduler::refineSplit(Task const & task) const {
+
+    OsdOmpComputeController controller(_numThreads);
+
+    for (int i = 0; i < (int)task.jobs.size(); ++i) {
+        Job const & job = _jobs[task.jobs[i]];
+
+        OsdCpuBoundBuffer vertex(job.vertex, job.numVertexElements),
+                          varying(job.varying, job.numVaryingElements);
+
+        controller.Refine(job.context,
+                          *job.batches,
+                          job.vertex ? &vertex : 0,
+                          job.varying ? &varying : 0);
+    }
+}
+
+}  // end namespace OPENSUBDIV_VERSION
+}  // end namespace OpenSubdiv
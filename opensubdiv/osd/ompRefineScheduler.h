@@ -0,0 +1,182 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+//
+#ifndef OSD_OMP_REFINE_SCHEDULER_H
+#define OSD_OMP_REFINE_SCHEDULER_H
+
+#include "../version.h"
+
+#include "../far/kernelBatch.h"
+#include "../osd/cpuComputeContext.h"
+#include "../osd/nonCopyable.h"
+
+#include <vector>
+
+namespace OpenSubdiv {
+namespace OPENSUBDIV_VERSION {
+
+/// \brief Refines many meshes concurrently with OpenMP.
+///
+/// OsdOmpComputeController parallelizes the refinement within each kernel
+/// batch, which gets little out of meshes with a few hundred faces : crowds
+/// and set dressing refine thousands of such meshes. OsdOmpRefineScheduler
+/// collects refinement jobs and runs them as concurrent tasks instead, one
+/// mesh per task :
+///
+/// - the jobs sharing a compute context are refined one after the other, in
+///   the order they were added, within the same task
+///
+/// - the tasks that account for more than the share of one thread of the
+///   total cost (the number of refined vertices times the number of
+///   elements of the buffers) and refine at least minSplitVertices vertices
+///   are split : they are refined one at a time with the batches spread over
+///   all the threads (as OsdOmpComputeController does)
+///
+/// - the other tasks are refined by a single thread each, scheduled from the
+///   most to the least expensive so that the threads end up evenly loaded
+///
+/// The vertex buffers are bound when the job is added. The contexts, the
+/// batches and the buffers must remain valid until Refine returns. The
+/// FarKernelBatchObserver attached to a context is notified from the OpenMP
+/// thread refining its task, so contexts refined concurrently need separate
+/// observers.
+///
+class OsdOmpRefineScheduler : OsdNonCopyable<OsdOmpRefineScheduler> {
+public:
+    typedef OsdCpuComputeContext ComputeContext;
+
+    /// Constructor.
+    ///
+    /// @param numThreads        the number of openmp threads to use. -1 uses
+    ///                          all available processors.
+    ///
+    /// @param minSplitVertices  the minimum number of refined vertices of a
+    ///                          task split across the threads
+    ///
+    explicit OsdOmpRefineScheduler(int numThreads=-1, int minSplitVertices=16384);
+
+    /// Adds the refinement of the given vertex buffers.
+    ///
+    /// @param  context       the OsdCpuContext to apply refinement operations to
+    ///
+    /// @param  batches       vector of batches of vertices organized by operative 
+    ///                       kernel
+    ///
+    /// @param  vertexBuffer  vertex-interpolated data buffer
+    ///
+    /// @param  varyingBuffer varying-interpolated data buffer
+    ///
+    template<class VERTEX_BUFFER, class VARYING_BUFFER>
+    void AddJob(OsdCpuComputeContext *context,
+                FarKernelBatchVector const & batches,
+                VERTEX_BUFFER *vertexBuffer,
+                VARYING_BUFFER *varyingBuffer) {
+
+        addJob(context, batches,
+               vertexBuffer ? vertexBuffer->BindCpuBuffer() : 0,
+               vertexBuffer ? vertexBuffer->GetNumElements() : 0,
+               varyingBuffer ? varyingBuffer->BindCpuBuffer() : 0,
+               varyingBuffer ? varyingBuffer->GetNumElements() : 0);
+    }
+
+    /// Adds the refinement of the given vertex buffer.
+    ///
+    /// @param  context       the OsdCpuContext to apply refinement operations to
+    ///
+    /// @param  batches       vector of batches of vertices organized by operative 
+    ///                       kernel
+    ///
+    /// @param  vertexBuffer  vertex-interpolated data buffer
+    ///
+    template<class VERTEX_BUFFER>
+    void AddJob(OsdCpuComputeContext *context,
+                FarKernelBatchVector const & batches,
+                VERTEX_BUFFER *vertexBuffer) {
+        AddJob(context, batches, vertexBuffer, (VERTEX_BUFFER*)0);
+    }
+
+    /// Refines all the jobs added since the last call and removes them
+    void Refine();
+
+    /// Removes the jobs without refining them
+    void Clear();
+
+    /// Returns the number of jobs waiting for Refine
+    int GetNumJobs() const { return (int)_jobs.size(); }
+
+    /// Returns the number of tasks run by the last Refine
+    int GetNumTasks() const { return _numTasks; }
+
+    /// Returns the number of tasks split across the threads by the last Refine
+    int GetNumSplitTasks() const { return _numSplitTasks; }
+
+    /// Returns the number of openmp threads
+    int GetNumThreads() const { return _numThreads; }
+
+private:
+    struct Job {
+        OsdCpuComputeContext * context;
+        FarKernelBatchVector const * batches;
+        float * vertex,
+              * varying;
+        int numVertexElements,
+            numVaryingElements;
+    };
+
+    // The jobs of a compute context
+    struct Task {
+        std::vector<int> jobs;
+        int numVertices;   // refined vertices
+        double cost;
+
+        bool operator < (Task const & other) const {
+            return cost > other.cost;
+        }
+    };
+
+    void addJob(OsdCpuComputeContext *context,
+                FarKernelBatchVector const & batches,
+                float *vertex, int numVertexElements,
+                float *varying, int numVaryingElements);
+
+    // Refines a task with a single-threaded CPU controller
+    void refineSerial(Task const & task) const;
+
+    // Refines a task with the batches spread over the threads
+    void refineSplit(Task const & task) const;
+
+    std::vector<Job> _jobs;
+
+    int _numThreads,
+        _minSplitVertices,
+        _numTasks,
+        _numSplitTasks;
+};
+
+}  // end namespace OPENSUBDIV_VERSION
+using namespace OPENSUBDIV_VERSION;
+
+}  // end namespace OpenSubdiv
+
+#endif  // OSD_OMP_REFINE_SCHEDULER_H
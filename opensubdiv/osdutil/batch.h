@@ -311,7 +311,8 @@ inline void
 createEntries(OsdUtilMeshBatchEntryVector &result,
               std::vector<FarPatchTables::PatchArrayVector> const & multiFarPatchArray,
               int maxValence,
-              std::vector<FarMesh<OsdVertex> const * > const & meshVector) {
+              std::vector<FarMesh<OsdVertex> const * > const & meshVector,
+              bool sparseValence=false) {
 
     // create osd patch array per mesh (note: numVertexElements will be updated later)
     int numEntries = (int)multiFarPatchArray.size();
@@ -319,7 +320,7 @@ createEntries(OsdUtilMeshBatchEntryVector &result,
     for (int i = 0; i < numEntries; ++i) {
         OsdDrawContext::ConvertPatchArrays(multiFarPatchArray[i],
                                            result[i].patchArrays,
-                                           maxValence, 0);
+                                           maxValence, 0, sparseValence);
     }
 
     // set entries
@@ -424,7 +425,8 @@ OsdUtilMeshBatch<VERTEX_BUFFER, DRAW_CONTEXT, COMPUTE_CONTROLLER>::Create(Comput
 
     // create entries
     OsdUtilMeshBatchEntryVector entries;
-    createEntries(entries, multiFarPatchArray, patchTables->GetMaxValence(), meshVector);
+    createEntries(entries, multiFarPatchArray, patchTables->GetMaxValence(), meshVector,
+                  patchTables->IsVertexValenceTableSparse());
 
     OsdUtilMeshBatch<VERTEX_BUFFER, DRAW_CONTEXT, COMPUTE_CONTROLLER> *batch =
         new OsdUtilMeshBatch<VERTEX_BUFFER, DRAW_CONTEXT, COMPUTE_CONTROLLER>();
@@ -220,7 +220,8 @@ OsdUtilMeshBatch<VERTEX_BUFFER, DRAW_CONTEXT, OsdCLComputeController>::Create(Co
 
     // create entries
     OsdUtilMeshBatchEntryVector entries;
-    createEntries(entries, multiFarPatchArray, patchTables->GetMaxValence(), meshVector);
+    createEntries(entries, multiFarPatchArray, patchTables->GetMaxValence(), meshVector,
+                  patchTables->IsVertexValenceTableSparse());
 
     OsdUtilMeshBatch<VERTEX_BUFFER, DRAW_CONTEXT, OsdCLComputeController> *batch =
         new OsdUtilMeshBatch<VERTEX_BUFFER, DRAW_CONTEXT, OsdCLComputeController>();
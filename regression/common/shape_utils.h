@@ -34,8 +34,22 @@
 #include <hbr/holeEdit.h>
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #include <omp.h>
+#endif
+
 #include <list>
 #include <string>
 #include <sstream>
@@ -312,8 +326,8 @@ shape * shape::parseShape(char const * shapestr, int axis ) {
     bool done = false;
     while( not done )
     {   done = sgets(line, sizeof(line), &str)==0;
-        char* end = &line[strlen(line)-1];
-        if (*end == '\n') *end = '\0'; // strip trailing nl
+        size_t len = strlen(line);
+        if (len>0 and line[len-1] == '\n') line[len-1] = '\0'; // strip trailing nl
         float x, y, z, u, v;
         switch (line[0]) {
             case 'v': switch (line[1])
@@ -346,8 +360,8 @@ shape * shape::parseShape(char const * shapestr, int axis ) {
                               while( (nitems=sscanf(cp, "%d/%d/%d", &vi, &ti, &ni))>0) {
                                   nverts++;
                                   s->faceverts.push_back(vi-1);
-                                  if(nitems >= 1) s->faceuvs.push_back(ti-1);
-                                  if(nitems >= 2) s->facenormals.push_back(ni-1);
+                                  if(nitems >= 2) s->faceuvs.push_back(ti-1);
+                                  if(nitems >= 3) s->facenormals.push_back(ni-1);
                                   while (*cp && *cp != ' ') cp++;
                                   while (*cp == ' ') cp++;
                               }
@@ -365,13 +379,263 @@ shape * shape::parseShape(char const * shapestr, int axis ) {
 }
 
 //------------------------------------------------------------------------------
+// Parses a single line of an obj shape (without its end of line) : same
+// syntax as shape::parseShape, without the line length limit
+inline void parseShapeLine( char const * line, int axis, shape * s ) {
+
+    char * cp;
+    float x, y, z;
+    switch (line[0]) {
+        case 'v': switch (line[1]) {
+                      case ' ': x = strtof(&line[2], &cp);
+                                if (cp==&line[2]) break;
+                                { char const * c = cp; y = strtof(c, &cp); if (cp==c) break; }
+                                { char const * c = cp; z = strtof(c, &cp); if (cp==c) break; }
+                                s->verts.push_back(x);
+                                switch( axis ) {
+                                    case 0 : s->verts.push_back(-z);
+                                             s->verts.push_back(y); break;
+                                    case 1 : s->verts.push_back(y);
+                                             s->verts.push_back(z); break;
+                                }
+                                break;
+                      case 't': x = strtof(&line[2], &cp);
+                                if (cp==&line[2]) break;
+                                { char const * c = cp; y = strtof(c, &cp); if (cp==c) break; }
+                                s->uvs.push_back(x);
+                                s->uvs.push_back(y);
+                                break;
+                      case 'n': x = strtof(&line[2], &cp);
+                                if (cp==&line[2]) break;
+                                { char const * c = cp; y = strtof(c, &cp); if (cp==c) break; }
+                                { char const * c = cp; z = strtof(c, &cp); if (cp==c) break; }
+                                s->normals.push_back(x);
+                                s->normals.push_back(y);
+                                s->normals.push_back(z);
+                                break;
+                  }
+                  break;
+        case 'f': if (line[1] == ' ') {
+                      char const * c = &line[2];
+                      while (*c == ' ') c++;
+                      int nverts = 0;
+                      for (;;) {
+                          // items of a "vi/ti/ni" face vertex, as sscanf would
+                          int vi = (int)strtol(c, &cp, 10);
+                          if (cp==c) break;
+                          nverts++;
+                          s->faceverts.push_back(vi-1);
+                          if (*cp=='/') {
+                              char const * ct = cp+1;
+                              int ti = (int)strtol(ct, &cp, 10);
+                              if (cp!=ct) {
+                                  s->faceuvs.push_back(ti-1);
+                                  if (*cp=='/') {
+                                      char const * cn = cp+1;
+                                      int ni = (int)strtol(cn, &cp, 10);
+                                      if (cp!=cn)
+                                          s->facenormals.push_back(ni-1);
+                                  }
+                              }
+                          }
+                          while (*c && *c != ' ') c++;
+                          while (*c == ' ') c++;
+                      }
+                      s->nvertsPerFace.push_back(nverts);
+                  }
+                  break;
+        case 't': if (line[1] == ' ') {
+                      shape::tag * t = shape::tag::parseTag( line );
+                      if (t)
+                          s->tags.push_back(t);
+                  }
+                  break;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Appends a member vector of the shapes parsed from each chunk to the same
+// vector of the shape s
+template <class T> void
+concatShapeChunks( shape * s, std::vector<shape *> const & chunks, std::vector<T> shape::* member ) {
+
+    int nchunks = (int)chunks.size();
+
+    std::vector<size_t> offsets(nchunks+1, 0);
+    for (int i=0; i<nchunks; ++i)
+        offsets[i+1] = offsets[i] + (chunks[i]->*member).size();
+
+    (s->*member).resize(offsets[nchunks]);
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for
+#endif
+    for (int i=0; i<nchunks; ++i) {
+        std::vector<T> const & src = chunks[i]->*member;
+        if (not src.empty())
+            std::copy(src.begin(), src.end(), (s->*member).begin() + offsets[i]);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Parses the first length characters of an obj shape (the string does not
+// need to be null terminated) : the text is split into chunks of lines that
+// are parsed in parallel, and then concatenated in order. Same syntax and
+// result as shape::parseShape.
+inline shape * parseShapeParallel( char const * shapestr, size_t length, int axis=1 ) {
+
+    int nchunks = 1;
+#ifdef OPENSUBDIV_HAS_OPENMP
+    // small chunks balance the load between the threads
+    static const size_t minChunkSize = 64*1024;
+    nchunks = std::max(1, std::min(4*omp_get_max_threads(), (int)(length/minChunkSize)));
+#endif
+
+    // split at line boundaries
+    std::vector<size_t> bounds(nchunks+1);
+    bounds[0] = 0;
+    bounds[nchunks] = length;
+    for (int i=1; i<nchunks; ++i) {
+        size_t pos = std::max(bounds[i-1], length/nchunks*i);
+        while (pos<length and shapestr[pos]!='\n')
+            ++pos;
+        bounds[i] = std::min(pos+1, length);
+    }
+
+    std::vector<shape *> chunks(nchunks);
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (int i=0; i<nchunks; ++i) {
+        shape * s = new shape;
+
+        std::vector<char> line;
+        char const * cp = shapestr + bounds[i],
+                   * end = shapestr + bounds[i+1];
+        while (cp<end) {
+            char const * eol = (char const *)memchr(cp, '\n', end-cp);
+            if (not eol)
+                eol = end;
+
+            // null terminated copy of the line
+            line.assign(cp, eol);
+            if (not line.empty() and line.back()=='\r')
+                line.pop_back();
+            line.push_back('\0');
+
+            parseShapeLine(&line[0], axis, s);
+
+            cp = eol+1;
+        }
+        chunks[i] = s;
+    }
+
+    shape * s = new shape;
+    concatShapeChunks(s, chunks, &shape::verts);
+    concatShapeChunks(s, chunks, &shape::uvs);
+    concatShapeChunks(s, chunks, &shape::normals);
+    concatShapeChunks(s, chunks, &shape::nvertsPerFace);
+    concatShapeChunks(s, chunks, &shape::faceverts);
+    concatShapeChunks(s, chunks, &shape::faceuvs);
+    concatShapeChunks(s, chunks, &shape::facenormals);
+    for (int i=0; i<nchunks; ++i) {
+        s->tags.insert(s->tags.end(), chunks[i]->tags.begin(), chunks[i]->tags.end());
+        chunks[i]->tags.clear();
+        delete chunks[i];
+    }
+    return s;
+}
+
+//------------------------------------------------------------------------------
+// Read-only memory mapping of a file
+struct mappedFile {
+
+    mappedFile( char const * path ) : data(0), size(0) {
+#if defined(_WIN32)
+        file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+                           FILE_FLAG_SEQUENTIAL_SCAN, 0);
+        mapping = 0;
+        if (file==INVALID_HANDLE_VALUE)
+            return;
+        LARGE_INTEGER fileSize;
+        if (not GetFileSizeEx(file, &fileSize) or fileSize.QuadPart==0)
+            return;
+        size = (size_t)fileSize.QuadPart;
+        mapping = CreateFileMapping(file, 0, PAGE_READONLY, 0, 0, 0);
+        if (mapping)
+            data = (char const *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+        fd = open(path, O_RDONLY);
+        if (fd<0)
+            return;
+        struct stat st;
+        if (fstat(fd, &st)!=0 or st.st_size==0)
+            return;
+        void * ptr = mmap(0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr==MAP_FAILED)
+            return;
+        data = (char const *)ptr;
+        size = (size_t)st.st_size;
+        // the file is parsed front to back
+        madvise(ptr, size, MADV_SEQUENTIAL);
+#endif
+        if (not data)
+            size = 0;
+    }
+
+    ~mappedFile() {
+#if defined(_WIN32)
+        if (data)
+            UnmapViewOfFile(data);
+        if (mapping)
+            CloseHandle(mapping);
+        if (file!=INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+#else
+        if (data)
+            munmap(const_cast<char *>(data), size);
+        if (fd>=0)
+            close(fd);
+#endif
+    }
+
+    char const * data;
+    size_t       size;
+
+private:
+#if defined(_WIN32)
+    HANDLE file,
+           mapping;
+#else
+    int fd;
+#endif
+};
+
+//------------------------------------------------------------------------------
+// Memory maps an obj file and parses it in parallel. Returns 0 if the file
+// cannot be read.
+inline shape * parseShapeFile( char const * path, int axis=1 ) {
+
+    mappedFile file(path);
+    if (not file.data)
+        return 0;
+
+    return parseShapeParallel(file.data, file.size, axis);
+}
+
+//------------------------------------------------------------------------------
+// Applies the tags of the shape to the mesh (the crease and corner tags are
+// skipped if sharpness is false)
 template <class T>
-void applyTags( OpenSubdiv::HbrMesh<T> * mesh, shape const * sh ) {
+void applyTags( OpenSubdiv::HbrMesh<T> * mesh, shape const * sh, bool sharpness=true ) {
 
     for (int i=0; i<(int)sh->tags.size(); ++i) {
         shape::tag * t = sh->tags[i];
 
         if (t->name=="crease") {
+            if (not sharpness)
+                continue;
             for (int j=0; j<(int)t->intargs.size()-1; j += 2) {
                 OpenSubdiv::HbrVertex<T> * v = mesh->GetVertex( t->intargs[j] ),
                                          * w = mesh->GetVertex( t->intargs[j+1] );
@@ -387,6 +651,8 @@ void applyTags( OpenSubdiv::HbrMesh<T> * mesh, shape const * sh ) {
                 }
             }
         } else if (t->name=="corner") {
+            if (not sharpness)
+                continue;
             for (int j=0; j<(int)t->intargs.size(); ++j) {
                 OpenSubdiv::HbrVertex<T> * v = mesh->GetVertex( t->intargs[j] );
                 if(v) {
@@ -838,6 +1104,78 @@ createTopology( shape const * sh, OpenSubdiv::HbrMesh<T> * mesh, Scheme scheme)
     }
 }
 
+//------------------------------------------------------------------------------
+// Same as createTopology, but creates the faces, creases and corners in bulk
+// with HbrMesh::NewFaces
+template <class T> void
+createTopologyBulk( shape const * sh, OpenSubdiv::HbrMesh<T> * mesh, Scheme scheme) {
+
+    int nfaces = sh->getNfaces();
+
+    if (scheme==kLoop) {
+        for (int f=0; f<nfaces; ++f) {
+            if (sh->nvertsPerFace[f]!=3) {
+                printf("Trying to create a Loop subd with non-triangle face\n");
+                exit(1);
+            }
+        }
+    }
+
+    std::vector<int>   creases, corners;
+    std::vector<float> creaseSharpness, cornerSharpness;
+    for (int i=0; i<(int)sh->tags.size(); ++i) {
+        shape::tag * t = sh->tags[i];
+
+        int nfloat = (int) t->floatargs.size();
+        if (t->name=="crease") {
+            for (int j=0; j<(int)t->intargs.size()-1; j += 2) {
+                creases.push_back(t->intargs[j]);
+                creases.push_back(t->intargs[j+1]);
+                creaseSharpness.push_back( std::max(0.0f, ((nfloat > 1) ? t->floatargs[j] : t->floatargs[0])) );
+            }
+        } else if (t->name=="corner") {
+            for (int j=0; j<(int)t->intargs.size(); ++j) {
+                corners.push_back(t->intargs[j]);
+                cornerSharpness.push_back( std::max(0.0f, ((nfloat > 1) ? t->floatargs[j] : t->floatargs[0])) );
+            }
+        }
+    }
+
+    if (nfaces>0 and not mesh->NewFaces(nfaces, &sh->nvertsPerFace[0], &sh->faceverts[0],
+            (int)creaseSharpness.size(), creases.empty() ? 0 : &creases[0],
+            creaseSharpness.empty() ? 0 : &creaseSharpness[0],
+            (int)cornerSharpness.size(), corners.empty() ? 0 : &corners[0],
+            cornerSharpness.empty() ? 0 : &cornerSharpness[0])) {
+        printf(" The specified subdivmesh contains a nonexistent vertex, a degenerate or"
+               " non-manifold edge, or a crease tag on a nonexistent edge\n");
+        exit(1);
+    }
+
+    for(int f=0, ptxidx=0; f<nfaces; f++ ) {
+
+        int nv = sh->nvertsPerFace[f];
+
+        mesh->GetFace(f)->SetPtexIndex(ptxidx);
+
+        if ( (scheme==kCatmark or scheme==kBilinear) and nv != 4 )
+            ptxidx+=nv;
+        else
+            ptxidx++;
+    }
+
+    mesh->SetInterpolateBoundaryMethod( OpenSubdiv::HbrMesh<T>::k_InterpolateBoundaryEdgeOnly );
+
+    applyTags<T>( mesh, sh, false );
+
+    mesh->Finish();
+
+    // check for disconnected vertices
+    if (mesh->GetNumDisconnectedVertices()) {
+        printf("The specified subdivmesh contains disconnected surface components.\n");
+        exit(1);
+    }
+}
+
 //------------------------------------------------------------------------------
 template <class T> void
 createFaceVaryingUV( shape const * sh, OpenSubdiv::HbrMesh<T> * mesh) {
@@ -0,0 +1,1747 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+
+//
+// Regression testing of the CPU code paths of Osd : each check runs the
+// regression shapes through two code paths that must agree (a controller and
+// its reference, a cached and an uncached mesh...), prints its result and
+// returns the number of failures.
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include <algorithm>
+
+#include <far/meshFactory.h>
+#include <far/kernelBatchProfiler.h>
+#include <far/subdivisionMatrix.h>
+
+#include <osd/clock.h>
+#include <osd/vertex.h>
+#include <osd/cpuVertexBuffer.h>
+#include <osd/cpuComputeContext.h>
+#include <osd/cpuComputeController.h>
+#include <osd/cpuAsyncComputeController.h>
+#include <osd/cpuBlendShapes.h>
+#include <osd/cpuDeformer.h>
+#include <osd/doubleBuffer.h>
+#include <osd/cpuEvalLimitContext.h>
+#include <osd/cpuEvalLimitController.h>
+#include <osd/cpuPatchBounds.h>
+#include <osd/cpuAdjointController.h>
+#include <osd/cpuMeshCache.h>
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #include <osd/ompComputeController.h>
+    #include <osd/ompRefineScheduler.h>
+#endif
+
+#include "../common/shape_utils.h"
+
+using namespace OpenSubdiv;
+
+typedef HbrMesh<OsdVertex>     OsdHbrMesh;
+typedef FarMesh<OsdVertex>     OsdFarMesh;
+typedef FarMeshFactory<OsdVertex> OsdFarMeshFactory;
+
+//------------------------------------------------------------------------------
+struct shaperec {
+
+    shaperec(char const * iname, std::string const & idata, Scheme ischeme) :
+        name(iname), data(idata), scheme(ischeme) { }
+
+    std::string name,
+                data;
+    Scheme      scheme;
+};
+
+static std::vector<shaperec> g_shapes;
+
+#include "../shapes/bilinear_cube.h"
+#include "../shapes/catmark_bishop.h"
+#include "../shapes/catmark_car.h"
+#include "../shapes/catmark_cube_corner0.h"
+#include "../shapes/catmark_cube_corner1.h"
+#include "../shapes/catmark_cube_corner2.h"
+#include "../shapes/catmark_cube_corner3.h"
+#include "../shapes/catmark_cube_corner4.h"
+#include "../shapes/catmark_cube_creases0.h"
+#include "../shapes/catmark_cube_creases1.h"
+#include "../shapes/catmark_cube.h"
+#include "../shapes/catmark_dart_edgecorner.h"
+#include "../shapes/catmark_dart_edgeonly.h"
+#include "../shapes/catmark_edgecorner.h"
+#include "../shapes/catmark_edgeonly.h"
+#include "../shapes/catmark_flap.h"
+#include "../shapes/catmark_flap2.h"
+#include "../shapes/catmark_gregory_test1.h"
+#include "../shapes/catmark_gregory_test2.h"
+#include "../shapes/catmark_gregory_test3.h"
+#include "../shapes/catmark_gregory_test4.h"
+#include "../shapes/catmark_helmet.h"
+#include "../shapes/catmark_hole_test1.h"
+#include "../shapes/catmark_hole_test2.h"
+#include "../shapes/catmark_pawn.h"
+#include "../shapes/catmark_pyramid_creases0.h"
+#include "../shapes/catmark_pyramid_creases1.h"
+#include "../shapes/catmark_pyramid.h"
+#include "../shapes/catmark_rook.h"
+#include "../shapes/catmark_square_hedit0.h"
+#include "../shapes/catmark_square_hedit1.h"
+#include "../shapes/catmark_square_hedit2.h"
+#include "../shapes/catmark_square_hedit3.h"
+#include "../shapes/catmark_square_hedit4.h"
+#include "../shapes/catmark_tent_creases0.h"
+#include "../shapes/catmark_tent_creases1.h"
+#include "../shapes/catmark_tent.h"
+#include "../shapes/catmark_torus.h"
+#include "../shapes/catmark_torus_creases0.h"
+#include "../shapes/loop_cube_creases0.h"
+#include "../shapes/loop_cube_creases1.h"
+#include "../shapes/loop_cube.h"
+#include "../shapes/loop_icosahedron.h"
+#include "../shapes/loop_saddle_edgecorner.h"
+#include "../shapes/loop_saddle_edgeonly.h"
+#include "../shapes/loop_triangle_edgecorner.h"
+#include "../shapes/loop_triangle_edgeonly.h"
+
+//------------------------------------------------------------------------------
+static void initShapes() {
+    g_shapes.push_back( shaperec("bilinear_cube",            bilinear_cube,            kBilinear) );
+    g_shapes.push_back( shaperec("catmark_bishop",           catmark_bishop,           kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_car",              catmark_car,              kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_cube_corner0",     catmark_cube_corner0,     kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_cube_corner1",     catmark_cube_corner1,     kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_cube_corner2",     catmark_cube_corner2,     kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_cube_corner3",     catmark_cube_corner3,     kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_cube_corner4",     catmark_cube_corner4,     kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_cube_creases0",    catmark_cube_creases0,    kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_cube_creases1",    catmark_cube_creases1,    kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_cube",             catmark_cube,             kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_dart_edgecorner",  catmark_dart_edgecorner,  kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_dart_edgeonly",    catmark_dart_edgeonly,    kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_edgecorner",       catmark_edgecorner,       kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_edgeonly",         catmark_edgeonly,         kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_flap",             catmark_flap,             kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_flap2",            catmark_flap2,            kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_gregory_test1",    catmark_gregory_test1,    kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_gregory_test2",    catmark_gregory_test2,    kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_gregory_test3",    catmark_gregory_test3,    kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_gregory_test4",    catmark_gregory_test4,    kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_helmet",           catmark_helmet,           kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_hole_test1",       catmark_hole_test1,       kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_hole_test2",       catmark_hole_test2,       kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_pawn",             catmark_pawn,             kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_pyramid_creases0", catmark_pyramid_creases0, kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_pyramid_creases1", catmark_pyramid_creases1, kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_pyramid",          catmark_pyramid,          kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_rook",             catmark_rook,             kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_square_hedit0",    catmark_square_hedit0,    kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_square_hedit1",    catmark_square_hedit1,    kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_square_hedit2",    catmark_square_hedit2,    kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_square_hedit3",    catmark_square_hedit3,    kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_square_hedit4",    catmark_square_hedit4,    kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_tent_creases0",    catmark_tent_creases0 ,   kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_tent_creases1",    catmark_tent_creases1 ,   kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_tent",             catmark_tent,             kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_torus",            catmark_torus,            kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_torus_creases0",   catmark_torus_creases0,   kCatmark ) );
+    g_shapes.push_back( shaperec("loop_cube_creases0",       loop_cube_creases0,       kLoop    ) );
+    g_shapes.push_back( shaperec("loop_cube_creases1",       loop_cube_creases1,       kLoop    ) );
+    g_shapes.push_back( shaperec("loop_cube",                loop_cube,                kLoop    ) );
+    g_shapes.push_back( shaperec("loop_icosahedron",         loop_icosahedron,         kLoop    ) );
+    g_shapes.push_back( shaperec("loop_saddle_edgecorner",   loop_saddle_edgecorner,   kLoop    ) );
+    g_shapes.push_back( shaperec("loop_saddle_edgeonly",     loop_saddle_edgeonly,     kLoop    ) );
+    g_shapes.push_back( shaperec("loop_triangle_edgecorner", loop_triangle_edgecorner, kLoop    ) );
+    g_shapes.push_back( shaperec("loop_triangle_edgeonly",   loop_triangle_edgeonly,   kLoop    ) );
+}
+
+//------------------------------------------------------------------------------
+// Builds the HbrMesh of a shape and returns its coarse vertex positions
+static OsdHbrMesh *
+createHbrMesh(shaperec const & rec, std::vector<float> & verts) {
+
+    return simpleHbr<OsdVertex>(rec.data.c_str(), rec.scheme, verts);
+}
+
+//------------------------------------------------------------------------------
+// Returns true if both shapes hold the same data and tags
+static bool
+sameShape(shape const * a, shape const * b) {
+
+    if (a->verts!=b->verts or a->uvs!=b->uvs or a->normals!=b->normals or
+        a->nvertsPerFace!=b->nvertsPerFace or a->faceverts!=b->faceverts or
+        a->faceuvs!=b->faceuvs or a->facenormals!=b->facenormals or
+        a->tags.size()!=b->tags.size())
+        return false;
+    for (int i=0; i<(int)a->tags.size(); ++i) {
+        if (a->tags[i]->genTag()!=b->tags[i]->genTag())
+            return false;
+    }
+    return true;
+}
+
+// Parses a shape with parseShapeParallel and builds its HbrMesh with
+// createTopologyBulk, and checks that the shape matches parseShape and that
+// the refined vertices are bit-identical to the per-face createTopology path.
+static bool
+checkBulkShape(std::string const & data, Scheme scheme) {
+
+    int const level = 2,
+              numElements = 3;
+
+    shape * sh = shape::parseShape(data.c_str()),
+          * psh = parseShapeParallel(data.c_str(), data.size());
+
+    bool ok = sameShape(sh, psh);
+
+    OsdHbrMesh * hmeshes[2] = { createMesh<OsdVertex>(scheme, 0),
+                                createMesh<OsdVertex>(scheme, 0) };
+
+    std::vector<float> coarse[2];
+    createVertices<OsdVertex>(sh, hmeshes[0], coarse[0]);
+    createVertices<OsdVertex>(psh, hmeshes[1], coarse[1]);
+
+    createTopology<OsdVertex>(sh, hmeshes[0], scheme);
+    createTopologyBulk<OsdVertex>(psh, hmeshes[1], scheme);
+
+    // Finish splits the non-manifold vertices
+    copyVertexPositions<OsdVertex>(sh, hmeshes[0], coarse[0]);
+    copyVertexPositions<OsdVertex>(psh, hmeshes[1], coarse[1]);
+
+    std::vector<float> refined[2];
+
+    for (int i=0; i<2; ++i) {
+
+        OsdFarMeshFactory factory(hmeshes[i], level);
+        OsdFarMesh * farmesh = factory.Create();
+
+        OsdCpuComputeContext * context = OsdCpuComputeContext::Create(farmesh);
+
+        int numVertices = farmesh->GetNumVertices();
+
+        OsdCpuVertexBuffer * vbuffer = OsdCpuVertexBuffer::Create(numElements, numVertices);
+        vbuffer->UpdateData(&coarse[i][0], 0, (int)coarse[i].size()/numElements);
+
+        OsdCpuComputeController controller;
+        controller.Refine(context, farmesh->GetKernelBatches(), vbuffer);
+
+        refined[i].assign(vbuffer->BindCpuBuffer(),
+                          vbuffer->BindCpuBuffer() + numVertices*numElements);
+
+        delete vbuffer;
+        delete context;
+        delete farmesh;
+    }
+
+    ok = ok and refined[0]==refined[1];
+
+    delete hmeshes[0];
+    delete hmeshes[1];
+    delete psh;
+    delete sh;
+
+    return ok;
+}
+
+// Runs checkBulkShape on the corpus, and on a creased grid large enough to be
+// split into several chunks by parseShapeParallel.
+static int
+checkBulkTopology() {
+
+    int const gridSize = 120;
+
+    int failures = 0;
+
+    for (int i=0; i<(int)g_shapes.size(); ++i) {
+        if (not checkBulkShape(g_shapes[i].data, g_shapes[i].scheme)) {
+            printf("  bulk topology : %s FAILED\n", g_shapes[i].name.c_str());
+            ++failures;
+        }
+    }
+
+    std::stringstream grid;
+    for (int y=0; y<=gridSize; ++y) {
+        for (int x=0; x<=gridSize; ++x)
+            grid << "v " << x << " " << y << " " << sinf(0.1f*(x+y)) << "\n";
+    }
+    for (int y=0; y<gridSize; ++y) {
+        for (int x=0; x<gridSize; ++x) {
+            int v = y*(gridSize+1) + x + 1;
+            grid << "f " << v << " " << v+1 << " " << v+gridSize+2 << " " << v+gridSize+1 << "\n";
+        }
+    }
+    for (int x=0, v=(gridSize/2)*(gridSize+1); x<gridSize; ++x, ++v)
+        grid << "t crease 2/1/0 " << v << " " << v+1 << " 2.5\n";
+
+    if (not checkBulkShape(grid.str(), kCatmark)) {
+        printf("  bulk topology : %dx%d grid FAILED\n", gridSize, gridSize);
+        ++failures;
+    }
+
+    printf("bulk topology : %d meshes, %d characters grid %s\n",
+        (int)g_shapes.size()+1, (int)grid.str().size(), failures ? "FAILED" : "ok");
+
+    return failures;
+}
+
+//------------------------------------------------------------------------------
+#ifdef OPENSUBDIV_HAS_OPENMP
+// Refines the catmark corpus concurrently with OsdOmpRefineScheduler, with a
+// kernel batch profiler attached to each context, and checks that every
+// profiler recorded exactly the batches of its mesh, in order and without
+// overlap, and that the refined vertices match the serial controller.
+struct SchedulerJob {
+    OsdHbrMesh * hmesh;
+    OsdFarMesh * farmesh;
+    OsdCpuComputeContext * context;
+    OsdCpuVertexBuffer * vbuffer,
+                       * reference;
+    FarKernelBatchProfiler profiler;
+};
+
+static int
+checkRefineScheduler() {
+
+    int const level = 3,
+              numElements = 3;
+
+    std::vector<SchedulerJob *> jobs;
+
+    // small split threshold so that both the split and the serial tasks run
+    OsdOmpRefineScheduler scheduler(4, 1024);
+
+    for (int i=0; i<(int)g_shapes.size(); ++i) {
+
+        if (g_shapes[i].scheme!=kCatmark)
+            continue;
+
+        SchedulerJob * job = new SchedulerJob;
+
+        std::vector<float> coarse;
+        job->hmesh = createHbrMesh(g_shapes[i], coarse);
+
+        OsdFarMeshFactory factory(job->hmesh, level);
+        job->farmesh = factory.Create();
+
+        job->context = OsdCpuComputeContext::Create(job->farmesh);
+
+        int numVertices = job->farmesh->GetNumVertices(),
+            numCoarse = (int)coarse.size()/numElements;
+
+        job->vbuffer = OsdCpuVertexBuffer::Create(numElements, numVertices);
+        job->vbuffer->UpdateData(&coarse[0], 0, numCoarse);
+
+        job->reference = OsdCpuVertexBuffer::Create(numElements, numVertices);
+        job->reference->UpdateData(&coarse[0], 0, numCoarse);
+
+        OsdCpuComputeController controller;
+        controller.Refine(job->context, job->farmesh->GetKernelBatches(), job->reference);
+
+        job->context->SetKernelBatchObserver(&job->profiler);
+
+        scheduler.AddJob(job->context, job->farmesh->GetKernelBatches(), job->vbuffer);
+
+        jobs.push_back(job);
+    }
+
+    scheduler.Refine();
+
+    int failures = 0,
+        numBatches = 0;
+
+    FarKernelBatchProfiler merged;
+
+    for (int i=0; i<(int)jobs.size(); ++i) {
+
+        SchedulerJob * job = jobs[i];
+
+        FarKernelBatchVector const & batches = job->farmesh->GetKernelBatches();
+        std::vector<FarKernelBatchProfiler::Event> const & events = job->profiler.GetEvents();
+
+        bool ok = events.size()==batches.size();
+        for (int j=0; ok and j<(int)events.size(); ++j) {
+            ok = events[j].kernelType==batches[j].GetKernelType() and
+                 events[j].level==batches[j].GetLevel() and
+                 events[j].duration>=0.0 and
+                 (j==0 or events[j].start>=events[j-1].start+events[j-1].duration);
+        }
+
+        int numVertices = job->farmesh->GetNumVertices();
+        if (memcmp(job->vbuffer->BindCpuBuffer(), job->reference->BindCpuBuffer(),
+                   numVertices*numElements*sizeof(float))!=0)
+            ok = false;
+
+        if (not ok) {
+            printf("  refine scheduler : mesh %d (%d batches, %d events) FAILED\n",
+                i, (int)batches.size(), (int)events.size());
+            ++failures;
+        }
+
+        numBatches += (int)batches.size();
+        merged.Merge(job->profiler);
+
+        job->context->SetKernelBatchObserver(0);
+        delete job->reference;
+        delete job->vbuffer;
+        delete job->context;
+        delete job->farmesh;
+        delete job->hmesh;
+        delete job;
+    }
+
+    int numEvents = 0;
+    for (int i=0; i<=FarKernelBatch::END_CAP; ++i)
+        numEvents += merged.GetStatistics((FarKernelBatch::KernelType)i).numBatches;
+    if (numEvents!=numBatches)
+        ++failures;
+
+    printf("refine scheduler : %d meshes, %d tasks (%d split), %d batches, %d events %s\n",
+        (int)jobs.size(), scheduler.GetNumTasks(), scheduler.GetNumSplitTasks(),
+        numBatches, numEvents, failures ? "FAILED" : "ok");
+
+    return failures;
+}
+
+// Places the refined vertices of the uniform and structured grid refinements
+// of the catmark corpus with OsdOmpComputeController::FirstTouch after the
+// coarse vertices are uploaded, and checks that the openmp refinement still
+// matches the serial controller : first touch must not write outside the
+// vertex ranges of the batches.
+static int
+checkFirstTouch() {
+
+    int const level = 3,
+              numElements = 3;
+
+    int failures = 0,
+        numMeshes = 0;
+
+    OsdOmpComputeController ompController;
+    OsdCpuComputeController cpuController;
+
+    for (int i=0; i<(int)g_shapes.size(); ++i) {
+
+        if (g_shapes[i].scheme!=kCatmark)
+            continue;
+
+        for (int config=0; config<2; ++config) {
+
+            FarMeshFactoryOptions options;
+            options.structuredGrids = config==1;
+
+            std::vector<float> coarse;
+            OsdHbrMesh * hmesh = createHbrMesh(g_shapes[i], coarse);
+
+            OsdFarMeshFactory factory(hmesh, level, options);
+            OsdFarMesh * farmesh = factory.Create();
+
+            OsdCpuComputeContext * context = OsdCpuComputeContext::Create(farmesh);
+
+            int numVertices = farmesh->GetNumVertices(),
+                numCoarse = (int)coarse.size()/numElements;
+
+            OsdCpuVertexBuffer * vbuffer = OsdCpuVertexBuffer::Create(numElements, numVertices),
+                               * reference = OsdCpuVertexBuffer::Create(numElements, numVertices);
+
+            vbuffer->UpdateData(&coarse[0], 0, numCoarse);
+            reference->UpdateData(&coarse[0], 0, numCoarse);
+
+            ompController.FirstTouch(farmesh->GetKernelBatches(), vbuffer);
+
+            bool ok = memcmp(vbuffer->BindCpuBuffer(), &coarse[0],
+                             numCoarse*numElements*sizeof(float))==0;
+
+            ompController.Refine(context, farmesh->GetKernelBatches(), vbuffer);
+            cpuController.Refine(context, farmesh->GetKernelBatches(), reference);
+
+            if (memcmp(vbuffer->BindCpuBuffer(), reference->BindCpuBuffer(),
+                       numVertices*numElements*sizeof(float))!=0)
+                ok = false;
+
+            if (not ok) {
+                printf("  first touch : %s%s FAILED\n",
+                    g_shapes[i].name.c_str(), config==1 ? " (structured)" : "");
+                ++failures;
+            }
+            ++numMeshes;
+
+            delete reference;
+            delete vbuffer;
+            delete context;
+            delete farmesh;
+            delete hmesh;
+        }
+    }
+
+    printf("first touch : %d meshes %s\n", numMeshes, failures ? "FAILED" : "ok");
+
+    return failures;
+}
+#endif
+
+//------------------------------------------------------------------------------
+// Animates the corpus over several frames, refining each frame into the back
+// buffer of an OsdDoubleBuffer with OsdCpuAsyncComputeController while the
+// front buffer holds the previous frame, and checks that the front buffer is
+// left untouched by the refinement in flight and that every frame is
+// bit-identical to a synchronous refinement.
+struct AsyncJob {
+    OsdHbrMesh * hmesh;
+    OsdFarMesh * farmesh;
+    OsdCpuComputeContext * context,
+                         * referenceContext;
+    OsdDoubleBuffer<OsdCpuVertexBuffer> * buffers;
+    OsdCpuVertexBuffer * reference,
+                       * previous;
+    std::vector<float> coarse;
+};
+
+// Coarse vertex positions of a frame of the animation
+static void
+animate(std::vector<float> const & coarse, int frame, std::vector<float> & result) {
+
+    result.resize(coarse.size());
+    for (int i=0; i<(int)coarse.size(); ++i)
+        result[i] = coarse[i] * (1.0f + 0.1f*frame*sinf((float)i));
+}
+
+static int
+checkAsyncRefine() {
+
+    int const level = 3,
+              numElements = 3,
+              numFrames = 4;
+
+    std::vector<AsyncJob *> jobs;
+
+    for (int i=0; i<(int)g_shapes.size(); ++i) {
+
+        AsyncJob * job = new AsyncJob;
+
+        job->hmesh = createHbrMesh(g_shapes[i], job->coarse);
+
+        OsdFarMeshFactory factory(job->hmesh, level);
+        job->farmesh = factory.Create();
+
+        job->context = OsdCpuComputeContext::Create(job->farmesh);
+        job->referenceContext = OsdCpuComputeContext::Create(job->farmesh);
+
+        int numVertices = job->farmesh->GetNumVertices();
+
+        job->buffers = OsdDoubleBuffer<OsdCpuVertexBuffer>::Create(numElements, numVertices);
+        job->reference = OsdCpuVertexBuffer::Create(numElements, numVertices);
+        job->previous = OsdCpuVertexBuffer::Create(numElements, numVertices);
+
+        jobs.push_back(job);
+    }
+
+    OsdCpuAsyncComputeController controller(4);
+    OsdCpuComputeController referenceController;
+
+    int failures = 0;
+
+    std::vector<OsdCpuRefineHandle *> handles(jobs.size());
+    std::vector<float> positions;
+
+    for (int frame=0; frame<numFrames; ++frame) {
+
+        // enqueue the frame into the back buffers
+        for (int i=0; i<(int)jobs.size(); ++i) {
+
+            AsyncJob * job = jobs[i];
+
+            animate(job->coarse, frame, positions);
+
+            OsdCpuVertexBuffer * back = job->buffers->GetBackBuffer();
+            back->UpdateData(&positions[0], 0, (int)positions.size()/numElements);
+
+            handles[i] = controller.RefineAsync(job->context, job->farmesh->GetKernelBatches(), back);
+        }
+
+        // refine the same frame synchronously meanwhile, and check that the
+        // front buffers still hold the previous frame
+        for (int i=0; i<(int)jobs.size(); ++i) {
+
+            AsyncJob * job = jobs[i];
+
+            int size = job->farmesh->GetNumVertices()*numElements*sizeof(float);
+
+            if (frame>0 and memcmp(job->buffers->GetFrontBuffer()->BindCpuBuffer(),
+                                   job->previous->BindCpuBuffer(), size)!=0) {
+                printf("  async refine : %s frame %d front buffer modified FAILED\n",
+                    g_shapes[i].name.c_str(), frame);
+                ++failures;
+            }
+
+            animate(job->coarse, frame, positions);
+
+            job->reference->UpdateData(&positions[0], 0, (int)positions.size()/numElements);
+            referenceController.Refine(job->referenceContext, job->farmesh->GetKernelBatches(), job->reference);
+        }
+
+        // wait for the refinements, swap and compare
+        for (int i=0; i<(int)jobs.size(); ++i) {
+
+            AsyncJob * job = jobs[i];
+
+            delete handles[i];
+            job->buffers->Swap();
+
+            int numVertices = job->farmesh->GetNumVertices(),
+                size = numVertices*numElements*sizeof(float);
+
+            if (memcmp(job->buffers->GetFrontBuffer()->BindCpuBuffer(),
+                       job->reference->BindCpuBuffer(), size)!=0) {
+                printf("  async refine : %s frame %d FAILED\n",
+                    g_shapes[i].name.c_str(), frame);
+                ++failures;
+            }
+
+            job->previous->UpdateData(job->reference->BindCpuBuffer(), 0, numVertices);
+        }
+    }
+
+    controller.Synchronize();
+
+    for (int i=0; i<(int)jobs.size(); ++i) {
+        AsyncJob * job = jobs[i];
+        delete job->previous;
+        delete job->reference;
+        delete job->buffers;
+        delete job->referenceContext;
+        delete job->context;
+        delete job->farmesh;
+        delete job->hmesh;
+        delete job;
+    }
+
+    printf("async refine : %d meshes, %d frames, %d threads %s\n",
+        (int)jobs.size(), numFrames, controller.GetNumThreads(), failures ? "FAILED" : "ok");
+
+    return failures;
+}
+
+//------------------------------------------------------------------------------
+// Applies weighted blend shapes to the refined neutral pose of the corpus with
+// OsdCpuBlendShapes, and checks the result against the refinement of the
+// blended coarse cage (up to rounding : the deltas are summed in a different
+// order). Meshes with hierarchical edits are skipped ("set" edits do not
+// commute with the blending).
+static int
+checkBlendShapes() {
+
+    int const level = 2,
+              numElements = 3,
+              numShapes = 3;
+
+    float const tolerance = 1e-5f,
+                weights[numShapes] = { 0.5f, 0.0f, -1.25f };
+
+    int failures = 0,
+        numMeshes = 0;
+
+    float maxError = 0.0f;
+
+    for (int i=0; i<(int)g_shapes.size(); ++i) {
+
+        std::vector<float> coarse;
+        OsdHbrMesh * hmesh = createHbrMesh(g_shapes[i], coarse);
+
+        if (hmesh->HasVertexEdits()) {
+            delete hmesh;
+            continue;
+        }
+
+        int numCoarse = (int)coarse.size()/numElements;
+
+        // shape s moves every (s+2)th coarse vertex
+        std::vector<int> offsets(1, 0),
+                         vertices;
+        std::vector<float> deltas;
+        for (int s=0; s<numShapes; ++s) {
+            for (int v=s; v<numCoarse; v+=s+2) {
+                vertices.push_back(v);
+                for (int k=0; k<numElements; ++k)
+                    deltas.push_back(0.1f*(s+1)*sinf((float)(v*numElements+k)));
+            }
+            offsets.push_back((int)vertices.size());
+        }
+
+        std::vector<float> blended(coarse);
+        for (int s=0; s<numShapes; ++s) {
+            for (int j=offsets[s]; j<offsets[s+1]; ++j) {
+                for (int k=0; k<numElements; ++k)
+                    blended[vertices[j]*numElements+k] += weights[s]*deltas[j*numElements+k];
+            }
+        }
+
+        OsdFarMeshFactory factory(hmesh, level);
+        OsdFarMesh * farmesh = factory.Create();
+
+        OsdCpuComputeContext * context = OsdCpuComputeContext::Create(farmesh);
+
+        int numVertices = farmesh->GetNumVertices();
+
+        OsdCpuBlendShapes * shapes = OsdCpuBlendShapes::Create(farmesh,
+            numElements, numShapes, &offsets[0], &vertices[0], &deltas[0]);
+
+        OsdCpuVertexBuffer * vbuffer = OsdCpuVertexBuffer::Create(numElements, numVertices),
+                           * reference = OsdCpuVertexBuffer::Create(numElements, numVertices);
+
+        OsdCpuComputeController controller;
+
+        vbuffer->UpdateData(&coarse[0], 0, numCoarse);
+        controller.Refine(context, farmesh->GetKernelBatches(), vbuffer);
+        shapes->Apply(weights, vbuffer);
+
+        reference->UpdateData(&blended[0], 0, numCoarse);
+        controller.Refine(context, farmesh->GetKernelBatches(), reference);
+
+        float const * a = vbuffer->BindCpuBuffer(),
+                    * b = reference->BindCpuBuffer();
+
+        float error = 0.0f;
+        for (int j=0; j<numVertices*numElements; ++j)
+            error = std::max(error, fabsf(a[j]-b[j]));
+
+        if (error>tolerance) {
+            printf("  blend shapes : %s error %g FAILED\n", g_shapes[i].name.c_str(), error);
+            ++failures;
+        }
+
+        maxError = std::max(maxError, error);
+        ++numMeshes;
+
+        delete reference;
+        delete vbuffer;
+        delete shapes;
+        delete context;
+        delete farmesh;
+        delete hmesh;
+    }
+
+    printf("blend shapes : %d meshes, max error %g %s\n",
+        numMeshes, maxError, failures ? "FAILED" : "ok");
+
+    return failures;
+}
+
+//------------------------------------------------------------------------------
+// Skins the coarse vertices of the corpus with an OsdCpuSkinningDeformer
+// attached to the compute context, and checks that the refined vertices are
+// bit-identical to the refinement of the skinned vertices uploaded with
+// UpdateData, with the CPU and the OpenMP controllers. The skinned vertices
+// are also checked against a direct linear blend of the joint transforms.
+static int
+checkDeformer() {
+
+    int const level = 2,
+              numElements = 3,
+              numJoints = 3;
+
+    float const tolerance = 1e-5f;
+
+    // rotations around z, x and y, and translations
+    float const matrices[numJoints*12] = {
+        0.8f,-0.6f, 0.0f, 0.5f,   0.6f, 0.8f, 0.0f,-0.25f,  0.0f, 0.0f, 1.0f, 0.0f,
+        1.0f, 0.0f, 0.0f, 0.0f,   0.0f, 0.6f,-0.8f, 1.0f,   0.0f, 0.8f, 0.6f, 0.5f,
+        0.6f, 0.0f, 0.8f,-1.0f,   0.0f, 1.0f, 0.0f, 0.0f,  -0.8f, 0.0f, 0.6f, 0.25f };
+
+    int failures = 0,
+        numMeshes = 0;
+
+    float maxError = 0.0f;
+
+    for (int i=0; i<(int)g_shapes.size(); ++i) {
+
+        std::vector<float> coarse;
+        OsdHbrMesh * hmesh = createHbrMesh(g_shapes[i], coarse);
+
+        int numCoarse = (int)coarse.size()/numElements;
+
+        // 2 influences per vertex
+        std::vector<int> offsets(1, 0),
+                         joints;
+        std::vector<float> weights;
+        for (int v=0; v<numCoarse; ++v) {
+            joints.push_back(v%numJoints);
+            joints.push_back((v+1)%numJoints);
+            weights.push_back(0.75f);
+            weights.push_back(0.25f);
+            offsets.push_back((int)joints.size());
+        }
+
+        OsdCpuSkinningDeformer * deformer = OsdCpuSkinningDeformer::Create(
+            numElements, numCoarse, &coarse[0], &offsets[0], &joints[0], &weights[0], numJoints);
+        deformer->SetJointMatrices(matrices);
+
+        std::vector<float> skinned(coarse.size());
+        deformer->Deform(OsdVertexDescriptor(numElements, 0), &skinned[0], 0, numCoarse);
+
+        float error = 0.0f;
+        for (int v=0; v<numCoarse; ++v) {
+            float const * p = &coarse[v*numElements];
+            for (int k=0; k<3; ++k) {
+                float q = 0.0f;
+                for (int j=offsets[v]; j<offsets[v+1]; ++j) {
+                    float const * m = matrices + joints[j]*12 + k*4;
+                    q += weights[j] * (m[0]*p[0] + m[1]*p[1] + m[2]*p[2] + m[3]);
+                }
+                error = std::max(error, fabsf(q-skinned[v*numElements+k]));
+            }
+        }
+
+        OsdFarMeshFactory factory(hmesh, level);
+        OsdFarMesh * farmesh = factory.Create();
+
+        OsdCpuComputeContext * context = OsdCpuComputeContext::Create(farmesh);
+
+        int numVertices = farmesh->GetNumVertices(),
+            size = numVertices*numElements*sizeof(float);
+
+        OsdCpuVertexBuffer * vbuffer = OsdCpuVertexBuffer::Create(numElements, numVertices),
+                           * reference = OsdCpuVertexBuffer::Create(numElements, numVertices);
+
+        reference->UpdateData(&skinned[0], 0, numCoarse);
+
+        OsdCpuComputeController controller;
+        controller.Refine(context, farmesh->GetKernelBatches(), reference);
+
+        // the deformer writes the coarse vertices : start from the rest pose
+        context->SetDeformer(deformer);
+
+        vbuffer->UpdateData(&coarse[0], 0, numCoarse);
+        controller.Refine(context, farmesh->GetKernelBatches(), vbuffer);
+
+        bool ok = error<=tolerance and
+            memcmp(vbuffer->BindCpuBuffer(), reference->BindCpuBuffer(), size)==0;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+        OsdOmpComputeController ompController;
+
+        vbuffer->UpdateData(&coarse[0], 0, numCoarse);
+        ompController.Refine(context, farmesh->GetKernelBatches(), vbuffer);
+
+        ok = ok and memcmp(vbuffer->BindCpuBuffer(), reference->BindCpuBuffer(), size)==0;
+#endif
+
+        if (not ok) {
+            printf("  deformer : %s (skinning error %g) FAILED\n", g_shapes[i].name.c_str(), error);
+            ++failures;
+        }
+
+        maxError = std::max(maxError, error);
+        ++numMeshes;
+
+        context->SetDeformer(0);
+
+        delete reference;
+        delete vbuffer;
+        delete context;
+        delete farmesh;
+        delete deformer;
+        delete hmesh;
+    }
+
+    printf("deformer : %d meshes, max skinning error %g %s\n",
+        numMeshes, maxError, failures ? "FAILED" : "ok");
+
+    return failures;
+}
+
+//------------------------------------------------------------------------------
+// Returns true if both bounds hold the same volumes
+static bool
+sameBounds(OsdCpuPatchBounds const & a, OsdCpuPatchBounds const & b) {
+
+    int n = a.GetNumPatches();
+    if (n!=b.GetNumPatches())
+        return false;
+    if (n==0)
+        return true;
+    if (memcmp(a.GetBoxes(), b.GetBoxes(), n*sizeof(OsdCpuPatchBounds::Box))!=0)
+        return false;
+    return (not a.GetCones() and not b.GetCones()) or
+        (a.GetCones() and b.GetCones() and
+         memcmp(a.GetCones(), b.GetCones(), n*sizeof(OsdCpuPatchBounds::Cone))==0);
+}
+
+// Refines the adaptive catmark corpus with patch bounds attached to the
+// compute and eval contexts, and checks that the controllers and the binding
+// of the eval vertex data refresh them like a standalone update.
+static int
+checkPatchBounds() {
+
+    int const level = 3,
+              numElements = 3;
+
+    int failures = 0,
+        numMeshes = 0,
+        numPatches = 0;
+
+    for (int i=0; i<(int)g_shapes.size(); ++i) {
+
+        if (g_shapes[i].scheme!=kCatmark)
+            continue;
+
+        std::vector<float> coarse;
+        OsdHbrMesh * hmesh = createHbrMesh(g_shapes[i], coarse);
+
+        OsdFarMeshFactory factory(hmesh, level, /*adaptive*/ true);
+        OsdFarMesh * farmesh = factory.Create();
+
+        FarPatchTables const * patchTables = farmesh->GetPatchTables();
+
+        OsdCpuComputeContext * context = OsdCpuComputeContext::Create(farmesh);
+
+        OsdCpuVertexBuffer * vbuffer =
+            OsdCpuVertexBuffer::Create(numElements, farmesh->GetNumVertices());
+        vbuffer->UpdateData(&coarse[0], 0, (int)coarse.size()/numElements);
+
+        OsdCpuPatchBounds * refined = OsdCpuPatchBounds::Create(patchTables, true),
+                          * reference = OsdCpuPatchBounds::Create(patchTables, true);
+
+        context->SetPatchBounds(refined);
+
+        OsdCpuComputeController controller;
+        controller.Refine(context, farmesh->GetKernelBatches(), vbuffer);
+
+        reference->Update(vbuffer);
+
+        bool ok = sameBounds(*refined, *reference);
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+        OsdCpuPatchBounds * ompRefined = OsdCpuPatchBounds::Create(patchTables, true);
+        context->SetPatchBounds(ompRefined);
+
+        vbuffer->UpdateData(&coarse[0], 0, (int)coarse.size()/numElements);
+
+        OsdOmpComputeController ompController(4);
+        ompController.Refine(context, farmesh->GetKernelBatches(), vbuffer);
+
+        ok = ok and sameBounds(*ompRefined, *reference);
+        delete ompRefined;
+#endif
+        context->SetPatchBounds(0);
+
+        OsdCpuEvalLimitContext * evalContext = OsdCpuEvalLimitContext::Create(farmesh);
+        OsdCpuPatchBounds * evaluated = OsdCpuPatchBounds::Create(patchTables, true);
+        evalContext->SetPatchBounds(evaluated);
+
+        OsdCpuVertexBuffer * Q = OsdCpuVertexBuffer::Create(numElements, 1);
+        OsdVertexBufferDescriptor desc(0, numElements, numElements);
+        evalContext->GetVertexData().Bind(desc, vbuffer, desc, Q);
+        evalContext->GetVertexData().Unbind();
+
+        ok = ok and sameBounds(*evaluated, *reference);
+
+        if (not ok) {
+            printf("  patch bounds : %s FAILED\n", g_shapes[i].name.c_str());
+            ++failures;
+        }
+
+        ++numMeshes;
+        numPatches += refined->GetNumPatches();
+
+        delete Q;
+        delete evaluated;
+        delete evalContext;
+        delete reference;
+        delete refined;
+        delete vbuffer;
+        delete context;
+        delete farmesh;
+        delete hmesh;
+    }
+
+    printf("patch bounds : %d meshes, %d patches %s\n",
+        numMeshes, numPatches, failures ? "FAILED" : "ok");
+
+    return failures;
+}
+
+//------------------------------------------------------------------------------
+// Evaluates samplesPerFace^2 limit positions on each ptex face of an adaptive
+// FarMesh from its refined vertices
+static void
+evalLimitSamples(OsdFarMesh const * farmesh, OsdCpuVertexBuffer * vbuffer,
+                 bool compressPatchTable, int samplesPerFace, std::vector<float> & positions) {
+
+    int const numElements = 3;
+
+    int numSamples = farmesh->GetNumPtexFaces() * samplesPerFace * samplesPerFace;
+
+    OsdCpuEvalLimitContext * evalContext =
+        OsdCpuEvalLimitContext::Create(farmesh, false, false, compressPatchTable);
+
+    OsdCpuVertexBuffer * Q   = OsdCpuVertexBuffer::Create(numElements, numSamples),
+                       * dQu = OsdCpuVertexBuffer::Create(numElements, numSamples),
+                       * dQv = OsdCpuVertexBuffer::Create(numElements, numSamples);
+
+    // the samples of the holes are not written
+    std::vector<float> zeros(numSamples*numElements, 0.0f);
+    Q->UpdateData(&zeros[0], 0, numSamples);
+
+    OsdVertexBufferDescriptor desc(0, numElements, numElements);
+    evalContext->GetVertexData().Bind(desc, vbuffer, desc, Q, dQu, dQv);
+
+    OsdCpuEvalLimitController evalController;
+
+    for (int face=0, n=0; face<farmesh->GetNumPtexFaces(); ++face) {
+        for (int j=0; j<samplesPerFace; ++j) {
+            for (int i=0; i<samplesPerFace; ++i, ++n) {
+                OsdEvalCoords coords( face, (i+0.5f)/(float)samplesPerFace,
+                                            (j+0.5f)/(float)samplesPerFace );
+                evalController.EvalLimitSample<OsdCpuVertexBuffer,
+                    OsdCpuVertexBuffer>( coords, evalContext, n );
+            }
+        }
+    }
+
+    evalContext->GetVertexData().Unbind();
+
+    positions.assign(Q->BindCpuBuffer(), Q->BindCpuBuffer() + numSamples*numElements);
+
+    delete Q;
+    delete dQu;
+    delete dQv;
+    delete evalContext;
+}
+
+// Evaluates samplesPerFace^2 limit positions on each ptex face of an adaptive
+// FarMesh built with the given options
+static void
+evalLimitPositions(shaperec const & rec, int level, FarMeshFactoryOptions const & options,
+                   int samplesPerFace, std::vector<float> & positions) {
+
+    int const numElements = 3;
+
+    std::vector<float> coarse;
+    OsdHbrMesh * hmesh = createHbrMesh(rec, coarse);
+
+    OsdFarMeshFactory factory(hmesh, level, options);
+    OsdFarMesh * farmesh = factory.Create();
+
+    OsdCpuComputeContext * context = OsdCpuComputeContext::Create(farmesh);
+
+    OsdCpuVertexBuffer * vbuffer =
+        OsdCpuVertexBuffer::Create(numElements, farmesh->GetNumVertices());
+    vbuffer->UpdateData(&coarse[0], 0, (int)coarse.size()/numElements);
+
+    OsdCpuComputeController controller;
+    controller.Refine(context, farmesh->GetKernelBatches(), vbuffer);
+
+    evalLimitSamples(farmesh, vbuffer, false, samplesPerFace, positions);
+
+    delete vbuffer;
+    delete context;
+    delete farmesh;
+    delete hmesh;
+}
+
+// Evaluates the limit surface of the creased torus with single crease patches
+// at level 1 and checks it against the crease isolated down to level 10.
+static int
+checkSingleCrease() {
+
+    int const samplesPerFace = 5;
+
+    float const tolerance = 1e-6f;
+
+    shaperec const * rec = 0;
+    for (int i=0; i<(int)g_shapes.size(); ++i) {
+        if (g_shapes[i].name=="catmark_torus_creases0")
+            rec = &g_shapes[i];
+    }
+    assert(rec);
+
+    FarMeshFactoryOptions options;
+    options.adaptive = true;
+
+    std::vector<float> reference;
+    evalLimitPositions(*rec, 10, options, samplesPerFace, reference);
+
+    options.singleCreasePatch = true;
+
+    std::vector<float> positions;
+    evalLimitPositions(*rec, 1, options, samplesPerFace, positions);
+
+    float maxError = 0.0f;
+
+    int failures = positions.size()!=reference.size();
+    for (int i=0; not failures and i<(int)positions.size(); ++i) {
+        maxError = std::max(maxError, fabsf(positions[i]-reference[i]));
+    }
+    if (maxError>tolerance)
+        ++failures;
+
+    printf("single crease : %d samples, max error %g %s\n",
+        (int)positions.size()/3, maxError, failures ? "FAILED" : "ok");
+
+    return failures;
+}
+
+// Evaluates the limit surface of the adaptive catmark corpus with the sparse
+// and the dense vertex valence tables of the Gregory patches, and checks that
+// both layouts give the same positions. The adaptive refinement orders the
+// vertices by address, so two builds of a mesh only agree up to rounding.
+static int
+checkSparseValenceTable() {
+
+    int const level = 3,
+              samplesPerFace = 3;
+
+    float const tolerance = 1e-5f;
+
+    int failures = 0,
+        numMeshes = 0,
+        numSamples = 0;
+
+    float maxError = 0.0f;
+
+    for (int i=0; i<(int)g_shapes.size(); ++i) {
+
+        if (g_shapes[i].scheme!=kCatmark)
+            continue;
+
+        FarMeshFactoryOptions options;
+        options.adaptive = true;
+
+        std::vector<float> reference;
+        evalLimitPositions(g_shapes[i], level, options, samplesPerFace, reference);
+
+        options.sparseValenceTable = true;
+
+        std::vector<float> positions;
+        evalLimitPositions(g_shapes[i], level, options, samplesPerFace, positions);
+
+        float error = 0.0f;
+        for (int j=0; j<(int)positions.size() and j<(int)reference.size(); ++j)
+            error = std::max(error, fabsf(positions[j]-reference[j]));
+
+        if (positions.size()!=reference.size() or error>tolerance) {
+            printf("  sparse valence table : %s error %g FAILED\n",
+                g_shapes[i].name.c_str(), error);
+            ++failures;
+        }
+
+        maxError = std::max(maxError, error);
+
+        ++numMeshes;
+        numSamples += (int)reference.size()/3;
+    }
+
+    printf("sparse valence table : %d meshes, %d samples, max error %g %s\n",
+        numMeshes, numSamples, maxError, failures ? "FAILED" : "ok");
+
+    return failures;
+}
+
+// Evaluates the limit surface of the adaptive catmark corpus with plain and
+// compressed patch tables of the same FarMesh, and checks that they give
+// bit-identical positions.
+static int
+checkCompressedPatchTable() {
+
+    int const level = 3,
+              numElements = 3,
+              samplesPerFace = 3;
+
+    int failures = 0,
+        numMeshes = 0,
+        numSamples = 0;
+
+    for (int i=0; i<(int)g_shapes.size(); ++i) {
+
+        if (g_shapes[i].scheme!=kCatmark)
+            continue;
+
+        std::vector<float> coarse;
+        OsdHbrMesh * hmesh = createHbrMesh(g_shapes[i], coarse);
+
+        OsdFarMeshFactory factory(hmesh, level, /*adaptive*/ true);
+        OsdFarMesh * farmesh = factory.Create();
+
+        OsdCpuComputeContext * context = OsdCpuComputeContext::Create(farmesh);
+
+        OsdCpuVertexBuffer * vbuffer =
+            OsdCpuVertexBuffer::Create(numElements, farmesh->GetNumVertices());
+        vbuffer->UpdateData(&coarse[0], 0, (int)coarse.size()/numElements);
+
+        OsdCpuComputeController controller;
+        controller.Refine(context, farmesh->GetKernelBatches(), vbuffer);
+
+        std::vector<float> reference, positions;
+        evalLimitSamples(farmesh, vbuffer, false, samplesPerFace, reference);
+        evalLimitSamples(farmesh, vbuffer, true, samplesPerFace, positions);
+
+        if (positions.size()!=reference.size() or (not positions.empty() and
+            memcmp(&positions[0], &reference[0], positions.size()*sizeof(float))!=0)) {
+            printf("  compressed patch table : %s FAILED\n", g_shapes[i].name.c_str());
+            ++failures;
+        }
+
+        ++numMeshes;
+        numSamples += (int)reference.size()/numElements;
+
+        delete vbuffer;
+        delete context;
+        delete farmesh;
+        delete hmesh;
+    }
+
+    printf("compressed patch table : %d meshes, %d samples %s\n",
+        numMeshes, numSamples, failures ? "FAILED" : "ok");
+
+    return failures;
+}
+
+//------------------------------------------------------------------------------
+// Projects the vertices of a shape refined uniformly to the given level onto
+// the limit surface, and returns the limit positions and normals of the
+// descendants of the coarse vertices and of the midpoints of the coarse edges,
+// which are the same points of the limit surface at every level. Semi-sharp
+// creases can be made infinitely sharp, and the normals of the corners (which
+// are not defined) are returned as 0.
+static void
+evalLimitPoints(shaperec const & rec, int level, bool sharpen,
+                std::vector<float> & positions, std::vector<float> & normals) {
+
+    int const numElements = 3;
+
+    std::vector<float> coarse;
+    OsdHbrMesh * hmesh = createHbrMesh(rec, coarse);
+
+    int numCoarseVertices = hmesh->GetNumVertices();
+
+    for (int i=0; sharpen and i<hmesh->GetNumCoarseFaces(); ++i) {
+        HbrFace<OsdVertex> * f = hmesh->GetFace(i);
+        for (int j=0; j<f->GetNumVertices(); ++j) {
+            if (f->GetEdge(j)->GetSharpness()>=1.0f)
+                f->GetEdge(j)->SetSharpness(HbrHalfedge<OsdVertex>::k_InfinitelySharp);
+        }
+    }
+
+    FarMeshFactoryOptions options;
+    options.limitTables = true;
+
+    OsdFarMeshFactory factory(hmesh, level, options);
+    OsdFarMesh * farmesh = factory.Create();
+
+    std::vector<HbrVertex<OsdVertex> *> points;
+    for (int i=0; i<numCoarseVertices; ++i)
+        points.push_back(hmesh->GetVertex(i));
+    for (int i=0; i<hmesh->GetNumCoarseFaces(); ++i) {
+        HbrFace<OsdVertex> * f = hmesh->GetFace(i);
+        for (int j=0; j<f->GetNumVertices(); ++j)
+            points.push_back(f->GetEdge(j)->Subdivide());
+    }
+    for (int i=0; i<(int)points.size(); ++i) {
+        int depth = i<numCoarseVertices ? level : level-1;
+        for (int j=0; j<depth; ++j)
+            points[i] = points[i]->Subdivide();
+    }
+
+    OsdCpuComputeContext * context = OsdCpuComputeContext::Create(farmesh);
+
+    int numVertices = farmesh->GetNumVertices();
+
+    OsdCpuVertexBuffer * vbuffer = OsdCpuVertexBuffer::Create(numElements, numVertices),
+                       * P = OsdCpuVertexBuffer::Create(numElements, numVertices),
+                       * T1 = OsdCpuVertexBuffer::Create(numElements, numVertices),
+                       * T2 = OsdCpuVertexBuffer::Create(numElements, numVertices);
+    vbuffer->UpdateData(&coarse[0], 0, (int)coarse.size()/numElements);
+
+    OsdCpuComputeController controller;
+    controller.Refine(context, farmesh->GetKernelBatches(), vbuffer);
+    controller.ComputeLimit(context, vbuffer, P, T1, T2);
+
+    std::vector<int> const & remap = factory.GetRemappingTable();
+
+    positions.resize(points.size()*3);
+    normals.resize(points.size()*3);
+
+    for (int i=0; i<(int)points.size(); ++i) {
+
+        int index = remap[points[i]->GetID()]*numElements;
+
+        float const * p = P->BindCpuBuffer() + index,
+                    * t1 = T1->BindCpuBuffer() + index,
+                    * t2 = T2->BindCpuBuffer() + index;
+
+        float n[3] = { t1[1]*t2[2]-t1[2]*t2[1],
+                       t1[2]*t2[0]-t1[0]*t2[2],
+                       t1[0]*t2[1]-t1[1]*t2[0] },
+              length = sqrtf(n[0]*n[0]+n[1]*n[1]+n[2]*n[2]);
+
+        if (points[i]->GetMask(false)>=HbrVertex<OsdVertex>::k_Corner)
+            length = 0.0f;
+
+        for (int k=0; k<3; ++k) {
+            positions[3*i+k] = p[k];
+            normals[3*i+k] = length>0.0f ? n[k]/length : 0.0f;
+        }
+    }
+
+    delete T2;
+    delete T1;
+    delete P;
+    delete vbuffer;
+    delete context;
+    delete farmesh;
+    delete hmesh;
+}
+
+// Projects Catmark and Loop shapes with boundaries and creases onto their limit
+// surface at successive levels, and checks that the limit positions and normals
+// of the same points do not change with the level. The levels are high enough
+// for the semi-sharp creases to have decayed.
+static int
+checkLimitMasks() {
+
+    struct LimitCase {
+        char const * name;
+        int          minLevel;
+        bool         sharpen;
+    };
+
+    static LimitCase const cases[] = {
+        { "catmark_edgeonly",         1, false },
+        { "catmark_edgecorner",       1, false },
+        { "catmark_dart_edgeonly",    3, false },
+        { "catmark_tent_creases0",    3, false },
+        { "catmark_pyramid_creases0", 3, false },
+        { "catmark_cube_creases1",    1, true  },
+        { "loop_saddle_edgeonly",     1, false },
+        { "loop_saddle_edgecorner",   1, false },
+        { "loop_triangle_edgeonly",   1, false },
+        { "loop_icosahedron",         1, false },
+        { "loop_cube_creases0",       3, false },
+        { "loop_cube_creases1",       1, true  },
+    };
+
+    int const maxLevel = 4;
+
+    float const positionTolerance = 1e-5f,
+                normalTolerance = 1e-5f;
+
+    int failures = 0,
+        numPoints = 0;
+
+    float maxPositionError = 0.0f,
+          maxNormalError = 0.0f;
+
+    for (int i=0; i<(int)(sizeof(cases)/sizeof(cases[0])); ++i) {
+
+        shaperec const * rec = 0;
+        for (int j=0; j<(int)g_shapes.size(); ++j) {
+            if (g_shapes[j].name==cases[i].name)
+                rec = &g_shapes[j];
+        }
+        assert(rec);
+
+        std::vector<float> positions, normals;
+        evalLimitPoints(*rec, cases[i].minLevel, cases[i].sharpen, positions, normals);
+
+        for (int level=cases[i].minLevel+1; level<=maxLevel; ++level) {
+
+            std::vector<float> finerPositions, finerNormals;
+            evalLimitPoints(*rec, level, cases[i].sharpen, finerPositions, finerNormals);
+
+            float positionError = 0.0f,
+                  normalError = 0.0f;
+
+            for (int j=0; j<(int)positions.size(); j+=3) {
+                for (int k=0; k<3; ++k)
+                    positionError = std::max(positionError,
+                        fabsf(positions[j+k]-finerPositions[j+k]));
+
+                float const * n = &normals[j],
+                            * m = &finerNormals[j];
+                bool corner = n[0]==0.0f and n[1]==0.0f and n[2]==0.0f;
+                if (not corner)
+                    normalError = std::max(normalError,
+                        1.0f - (n[0]*m[0]+n[1]*m[1]+n[2]*m[2]));
+            }
+
+            if (positionError>positionTolerance or normalError>normalTolerance) {
+                printf("  limit masks : %s levels %d and %d : position error %g, 1-cos %g FAILED\n",
+                    rec->name.c_str(), level-1, level, positionError, normalError);
+                ++failures;
+            }
+
+            maxPositionError = std::max(maxPositionError, positionError);
+            maxNormalError = std::max(maxNormalError, normalError);
+            numPoints += (int)positions.size()/3;
+
+            positions.swap(finerPositions);
+            normals.swap(finerNormals);
+        }
+    }
+
+    printf("limit masks : %d points, max position error %g, max 1-cos %g %s\n",
+        numPoints, maxPositionError, maxNormalError, failures ? "FAILED" : "ok");
+
+    return failures;
+}
+
+//------------------------------------------------------------------------------
+// Returns the largest absolute difference between two arrays
+static float
+maxDifference(float const * a, float const * b, int n) {
+
+    float result = 0.0f;
+    for (int i=0; i<n; ++i)
+        result = std::max(result, fabsf(a[i]-b[i]));
+    return result;
+}
+
+// Checks the adjoint of the refinement of a FarMesh with the dot product
+// test <A x, y> == <x, At y>, and checks the forward and adjoint controllers
+// against the matrix of the subdivision operator.
+static bool
+checkAdjointMesh(OsdFarMesh const * farmesh, std::vector<float> const & coarse) {
+
+    int const numElements = 3;
+
+    int numVertices = farmesh->GetNumVertices(),
+        numCoarse = (int)coarse.size()/numElements;
+
+    OsdCpuComputeContext * context = OsdCpuComputeContext::Create(farmesh);
+
+    // A x with the forward controller
+    OsdCpuVertexBuffer * vbuffer = OsdCpuVertexBuffer::Create(numElements, numVertices);
+    vbuffer->UpdateData(&coarse[0], 0, numCoarse);
+
+    OsdCpuComputeController controller;
+    controller.Refine(context, farmesh->GetKernelBatches(), vbuffer);
+
+    // At y with the adjoint controller (deterministic pseudo-random y)
+    std::vector<float> y(numVertices*numElements);
+    for (int i=0; i<(int)y.size(); ++i)
+        y[i] = (float)((i*7919)%1009)/1009.0f - 0.5f;
+
+    OsdCpuVertexBuffer * gbuffer = OsdCpuVertexBuffer::Create(numElements, numVertices);
+    gbuffer->UpdateData(&y[0], 0, numVertices);
+
+    OsdCpuAdjointController adjointController;
+    adjointController.Refine(context, farmesh->GetKernelBatches(), gbuffer);
+
+    float const * Ax = vbuffer->BindCpuBuffer(),
+                * Aty = gbuffer->BindCpuBuffer();
+
+    double lhs = 0.0, rhs = 0.0, norm = 0.0;
+    for (int i=0; i<numVertices*numElements; ++i) {
+        lhs += (double)Ax[i]*y[i];
+        norm += fabs((double)Ax[i]*y[i]);
+    }
+    for (int i=0; i<numCoarse*numElements; ++i)
+        rhs += (double)coarse[i]*Aty[i];
+
+    bool ok = fabs(lhs-rhs) <= 1e-5*std::max(norm, 1.0);
+
+    // the same products with the explicit matrix
+    FarSubdivisionMatrix matrix(*farmesh);
+
+    std::vector<float> matrixAx(numVertices*numElements),
+                       matrixAty(numCoarse*numElements);
+    matrix.Apply(&coarse[0], &matrixAx[0], numElements);
+    matrix.ApplyTranspose(&y[0], &matrixAty[0], numElements);
+
+    ok = ok and maxDifference(Ax, &matrixAx[0], numVertices*numElements) < 1e-4f and
+                maxDifference(Aty, &matrixAty[0], numCoarse*numElements) < 1e-4f;
+
+    delete gbuffer;
+    delete vbuffer;
+    delete context;
+
+    return ok;
+}
+
+// Runs the adjoint checks on the uniform, structured grid and B-spline end
+// cap refinements of the corpus. The hierarchical edits are affine, so the
+// meshes with edits are skipped.
+static int
+checkAdjoint() {
+
+    int const level = 2;
+
+    int failures = 0,
+        numMeshes = 0;
+
+    for (int i=0; i<(int)g_shapes.size(); ++i) {
+
+        bool catmark = g_shapes[i].scheme==kCatmark;
+
+        for (int config=0; config<3; ++config) {
+
+            FarMeshFactoryOptions options;
+            if (config==1) {
+                if (not catmark) continue;
+                options.structuredGrids = true;
+            } else if (config==2) {
+                if (not catmark) continue;
+                options.adaptive = true;
+                options.bsplineEndCaps = true;
+            }
+
+            // each factory refines its own HbrMesh
+            std::vector<float> coarse;
+            OsdHbrMesh * hmesh = createHbrMesh(g_shapes[i], coarse);
+
+            OsdFarMeshFactory factory(hmesh, level, options);
+            OsdFarMesh * farmesh = factory.Create();
+
+            FarKernelBatchVector const & batches = farmesh->GetKernelBatches();
+
+            bool hasEdits = false;
+            for (int j=0; j<(int)batches.size(); ++j)
+                hasEdits |= batches[j].GetKernelType()==FarKernelBatch::HIERARCHICAL_EDIT;
+
+            if (not hasEdits) {
+                if (not checkAdjointMesh(farmesh, coarse)) {
+                    printf("  adjoint : %s (config %d) FAILED\n",
+                        g_shapes[i].name.c_str(), config);
+                    ++failures;
+                }
+                ++numMeshes;
+            }
+
+            delete farmesh;
+            delete hmesh;
+        }
+    }
+
+    printf("adjoint : %d meshes %s\n", numMeshes, failures ? "FAILED" : "ok");
+
+    return failures;
+}
+
+//------------------------------------------------------------------------------
+// Acquires the manifold Catmark shapes tagged with creases, corners, holes and
+// boundary rules only from the mesh cache, as flat arrays and then as HbrMesh,
+// and checks that both forms of a topology share their entry, that the creases
+// hash alike in any order and orientation, and that the cached FarMesh refines
+// like a FarMesh built from the HbrMesh.
+static int
+checkMeshCache() {
+
+    int const level = 2,
+              numElements = 3;
+
+    OsdCpuMeshCache & cache = OsdCpuMeshCache::GetInstance();
+    cache.Clear();
+
+    OsdCpuMeshCache::Options options;
+    options.maxLevel = level;
+
+    int failures = 0,
+        numMeshes = 0;
+
+    for (int i=0; i<(int)g_shapes.size(); ++i) {
+
+        if (g_shapes[i].scheme!=kCatmark)
+            continue;
+
+        shape * sh = shape::parseShape( g_shapes[i].data.c_str() );
+
+        OsdCpuMeshCache::Topology topology;
+
+        std::vector<int>   holes, creases, corners;
+        std::vector<float> creaseSharpness, cornerSharpness;
+
+        bool supported = true;
+        for (int j=0; j<(int)sh->tags.size(); ++j) {
+            shape::tag * t = sh->tags[j];
+            int nfloat = (int)t->floatargs.size();
+            if (t->name=="crease") {
+                for (int k=0; k<(int)t->intargs.size()-1; k+=2) {
+                    creases.push_back(t->intargs[k]);
+                    creases.push_back(t->intargs[k+1]);
+                    creaseSharpness.push_back(nfloat>1 ? t->floatargs[k] : t->floatargs[0]);
+                }
+            } else if (t->name=="corner") {
+                for (int k=0; k<(int)t->intargs.size(); ++k) {
+                    corners.push_back(t->intargs[k]);
+                    cornerSharpness.push_back(nfloat>1 ? t->floatargs[k] : t->floatargs[0]);
+                }
+            } else if (t->name=="hole") {
+                holes.insert(holes.end(), t->intargs.begin(), t->intargs.end());
+            } else if (t->name=="interpolateboundary" and t->intargs.size()==1) {
+                switch (t->intargs[0]) {
+                    case 0 : topology.interpolateBoundary = OsdHbrMesh::k_InterpolateBoundaryNone; break;
+                    case 1 : topology.interpolateBoundary = OsdHbrMesh::k_InterpolateBoundaryEdgeAndCorner; break;
+                    case 2 : topology.interpolateBoundary = OsdHbrMesh::k_InterpolateBoundaryEdgeOnly; break;
+                    default : supported = false; break;
+                }
+            } else {
+                supported = false;
+            }
+        }
+        std::vector<float> coarse;
+        OsdHbrMesh * hmesh = createHbrMesh(g_shapes[i], coarse);
+
+        // the non-manifold vertices split by HbrMesh::Finish change the
+        // topology of the HbrMesh
+        if (not supported or hmesh->GetNumVertices()!=sh->getNverts()) {
+            delete hmesh;
+            delete sh;
+            continue;
+        }
+
+        topology.numVertices = sh->getNverts();
+        topology.numFaces = sh->getNfaces();
+        topology.numVertsPerFace = &sh->nvertsPerFace[0];
+        topology.vertIndices = &sh->faceverts[0];
+        topology.numHoles = (int)holes.size();
+        topology.holes = holes.empty() ? 0 : &holes[0];
+        topology.numCreases = (int)creaseSharpness.size();
+        topology.creases = creases.empty() ? 0 : &creases[0];
+        topology.creaseSharpness = creaseSharpness.empty() ? 0 : &creaseSharpness[0];
+        topology.numCorners = (int)cornerSharpness.size();
+        topology.corners = corners.empty() ? 0 : &corners[0];
+        topology.cornerSharpness = cornerSharpness.empty() ? 0 : &cornerSharpness[0];
+
+        OsdCpuMeshCache::Entry const * entry = cache.Acquire(topology, options),
+                                     * again = cache.Acquire(topology, options);
+
+        OsdCpuMeshCache::Entry const * hbrEntry = cache.Acquire(hmesh, options);
+
+        bool ok = entry and entry==again and hbrEntry==entry;
+
+        // the creases reversed, in the reverse order
+        std::vector<int>   reversedCreases(creases.rbegin(), creases.rend());
+        std::vector<float> reversedSharpness(creaseSharpness.rbegin(), creaseSharpness.rend());
+
+        OsdCpuMeshCache::Topology reversed = topology;
+        reversed.creases = reversedCreases.empty() ? 0 : &reversedCreases[0];
+        reversed.creaseSharpness = reversedSharpness.empty() ? 0 : &reversedSharpness[0];
+
+        ok = ok and OsdCpuMeshCache::ComputeHash(reversed, options)==
+                    OsdCpuMeshCache::ComputeHash(topology, options);
+
+        if (ok) {
+            // the entry was built from the flat arrays : the HbrMesh is
+            // refined by a factory of its own
+            OsdFarMeshFactory factory(hmesh, level);
+            OsdFarMesh * hbrFarmesh = factory.Create();
+            OsdCpuComputeContext * hbrContext = OsdCpuComputeContext::Create(hbrFarmesh);
+
+            OsdFarMesh const * farmesh = entry->GetFarMesh();
+
+            int numVertices = farmesh->GetNumVertices(),
+                numCoarse = (int)coarse.size()/numElements;
+
+            ok = numVertices==hbrFarmesh->GetNumVertices();
+
+            if (ok) {
+                OsdCpuVertexBuffer * vbuffer = OsdCpuVertexBuffer::Create(numElements, numVertices),
+                                   * reference = OsdCpuVertexBuffer::Create(numElements, numVertices);
+                vbuffer->UpdateData(&coarse[0], 0, numCoarse);
+                reference->UpdateData(&coarse[0], 0, numCoarse);
+
+                OsdCpuComputeController controller;
+                controller.Refine(entry->GetComputeContext(), farmesh->GetKernelBatches(), vbuffer);
+                controller.Refine(hbrContext, hbrFarmesh->GetKernelBatches(), reference);
+
+                ok = maxDifference(vbuffer->BindCpuBuffer(), reference->BindCpuBuffer(),
+                                   numVertices*numElements) < 1e-5f;
+
+                delete reference;
+                delete vbuffer;
+            }
+
+            delete hbrContext;
+            delete hbrFarmesh;
+        }
+
+        if (not ok) {
+            printf("  mesh cache : %s FAILED\n", g_shapes[i].name.c_str());
+            ++failures;
+        }
+        ++numMeshes;
+
+        cache.Release(hbrEntry);
+        cache.Release(again);
+        cache.Release(entry);
+
+        delete hmesh;
+        delete sh;
+    }
+
+    if (cache.GetNumHits()!=2*numMeshes or cache.GetNumMisses()!=numMeshes)
+        ++failures;
+
+    printf("mesh cache : %d meshes, %d hits, %d misses %s\n", numMeshes,
+        cache.GetNumHits(), cache.GetNumMisses(), failures ? "FAILED" : "ok");
+
+    cache.Clear();
+
+    return failures;
+}
+
+//------------------------------------------------------------------------------
+int main(int, char **) {
+
+    initShapes();
+
+    FarStopwatch::SetClock(OsdGetTime);
+
+    int failures = 0;
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    failures += checkRefineScheduler();
+
+    failures += checkFirstTouch();
+#endif
+
+    failures += checkBulkTopology();
+
+    failures += checkAsyncRefine();
+
+    failures += checkBlendShapes();
+
+    failures += checkDeformer();
+
+    failures += checkPatchBounds();
+
+    failures += checkSingleCrease();
+
+    failures += checkSparseValenceTable();
+
+    failures += checkCompressedPatchTable();
+
+    failures += checkLimitMasks();
+
+    failures += checkAdjoint();
+
+    failures += checkMeshCache();
+
+    printf("%s\n", failures ? "Some checks failed." : "All checks passed.");
+
+    return failures ? 1 : 0;
+}
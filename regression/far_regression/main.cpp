@@ -130,6 +130,10 @@ typedef OpenSubdiv::FarPatchTables              fPatches;
 
 static bool g_debugmode = false;
 static bool g_dumphbr = false;
+static bool g_structuredGrids = false;
+static bool g_sparse = false;
+static bool g_animate = false;
+static bool g_bulk = false;
 
 //------------------------------------------------------------------------------
 // visual debugging using Maya
@@ -308,7 +312,19 @@ int checkMesh( char const * msg, xyzmesh * hmesh, int levels, Scheme scheme=kCat
     float deltaAvg[3] = {0.0f, 0.0f, 0.0f},
           deltaCnt[3] = {0.0f, 0.0f, 0.0f};
 
-    fMeshFactory fact( hmesh, levels );
+    // sparse mode : only refine every other coarse face
+    std::vector<int> faceLevels;
+    if (g_sparse) {
+        faceLevels.resize(hmesh->GetNumCoarseFaces());
+        for (int i=0; i<(int)faceLevels.size(); ++i)
+            faceLevels[i] = (i%2) ? 0 : levels;
+    }
+
+    OpenSubdiv::FarMeshFactoryOptions options;
+    options.structuredGrids = g_structuredGrids;
+    options.faceLevels = g_sparse ? &faceLevels : 0;
+
+    fMeshFactory fact( hmesh, levels, options );
     fMesh * m = fact.Create( );
     OpenSubdiv::FarComputeController<xyzVV>::_DefaultController.Refine(m);
 
@@ -391,6 +407,344 @@ int checkMesh( char const * msg, xyzmesh * hmesh, int levels, Scheme scheme=kCat
     return count;
 }
 
+//------------------------------------------------------------------------------
+// Sharpness of the coarse edges and vertices of a mesh, gathered before it is
+// refined
+struct coarseSharpness {
+
+    coarseSharpness( xyzmesh * hmesh ) {
+        for (int i=0; i<hmesh->GetNumFaces(); ++i) {
+            xyzface * f = hmesh->GetFace(i);
+            for (int j=0; j<f->GetNumVertices(); ++j) {
+                edges.push_back(f->GetEdge(j));
+                edgeValues.push_back(f->GetEdge(j)->GetSharpness());
+            }
+        }
+        for (int i=0; i<hmesh->GetNumVertices(); ++i) {
+            verts.push_back(hmesh->GetVertex(i));
+            vertValues.push_back(hmesh->GetVertex(i)->GetSharpness());
+        }
+    }
+
+    // Scales the original sharpness, either directly or through the factory
+    void Apply( float scale, fMeshFactory * factory=0 ) const {
+        for (int i=0; i<(int)edges.size(); ++i) {
+            if (factory)
+                factory->SetEdgeSharpness(edges[i], edgeValues[i]*scale);
+            else
+                edges[i]->SetSharpness(edgeValues[i]*scale);
+        }
+        for (int i=0; i<(int)verts.size(); ++i) {
+            if (factory)
+                factory->SetVertexSharpness(verts[i], vertValues[i]*scale);
+            else
+                verts[i]->SetSharpness(vertValues[i]*scale);
+        }
+    }
+
+    std::vector<xyzhalfedge *> edges;
+    std::vector<float>         edgeValues;
+    std::vector<xyzvertex *>   verts;
+    std::vector<float>         vertValues;
+};
+
+//------------------------------------------------------------------------------
+// Returns the vertex of a mesh matching a vertex of another mesh with the
+// same coarse topology : the refined vertices are matched through their
+// parents, as their IDs depend on the order of refinement.
+static xyzvertex * matchVertex( xyzvertex * v, xyzmesh * other, std::vector<xyzvertex *> & matches ) {
+
+    xyzvertex * & match = matches[v->GetID()];
+    if (match)
+        return match;
+
+    if (xyzvertex * pv = v->GetParentVertex()) {
+        match = matchVertex(pv, other, matches)->Subdivide();
+    } else if (xyzhalfedge * pe = v->GetParentEdge()) {
+        xyzvertex * org = matchVertex(pe->GetOrgVertex(), other, matches),
+                  * dst = matchVertex(pe->GetDestVertex(), other, matches);
+        xyzhalfedge * e = org->GetEdge(dst);
+        match = (e ? e : dst->GetEdge(org))->Subdivide();
+    } else if (xyzface * pf = v->GetParentFace()) {
+        // the half-edge between the first two vertices of the face
+        xyzvertex * v0 = matchVertex(pf->GetVertex(0), other, matches),
+                  * v1 = matchVertex(pf->GetVertex(1), other, matches);
+        match = v0->GetEdge(v1)->GetFace()->Subdivide();
+    } else {
+        match = other->GetVertex(v->GetID());
+    }
+    return match;
+}
+
+//------------------------------------------------------------------------------
+// Returns the number of refined vertices of a FarMesh that differ from the
+// matching vertices of another FarMesh refined from the same coarse topology
+// (both FarMeshes must have been refined)
+static int compareRefined( char const * msg, xyzmesh * hmesh, fMesh * m, fMeshFactory & fact,
+                           xyzmesh * otherHmesh, fMesh * other, fMeshFactory & otherFact ) {
+
+    if (otherHmesh->GetNumVertices()!=hmesh->GetNumVertices()) {
+        printf("// %s : %d vertices, %d expected\n", msg,
+            hmesh->GetNumVertices(), otherHmesh->GetNumVertices());
+        return 1;
+    }
+
+    std::vector<int> const & remap = fact.GetRemappingTable(),
+                           & otherRemap = otherFact.GetRemappingTable();
+
+    std::vector<xyzvertex *> matches(hmesh->GetNumVertices(), (xyzvertex *)0);
+
+    int count = 0;
+    for (int i=0; i<hmesh->GetNumVertices(); ++i) {
+        xyzvertex * v = hmesh->GetVertex(i);
+        if (not v)
+            continue;
+
+        int j = matchVertex(v, otherHmesh, matches)->GetID();
+
+        float const * p = m->GetVertex( remap[i] ).GetPos(),
+                    * q = other->GetVertex( otherRemap[j] ).GetPos();
+
+        float delta[3] = { p[0]-q[0], p[1]-q[1], p[2]-q[2] };
+        float dist = sqrtf( delta[0]*delta[0]+delta[1]*delta[1]+delta[2]*delta[2]);
+        if ( dist > PRECISION ) {
+            printf("// %s : HbrVertex<T> %d fails : dist=%.10f\n", msg, i, dist);
+            count++;
+        }
+    }
+    return count;
+}
+
+//------------------------------------------------------------------------------
+// Returns the number of refined vertices of an animated FarMesh that differ
+// from a FarMesh rebuilt from the shape with the same sharpness
+static int compareRebuilt( char const * shapestr, int levels, Scheme scheme, float scale,
+                           xyzmesh * hmesh, fMesh * m, fMeshFactory & fact ) {
+
+    xyzmesh * rebuiltHmesh = simpleHbr<xyzVV>(shapestr, scheme, 0);
+    coarseSharpness(rebuiltHmesh).Apply(scale);
+
+    fMeshFactory rebuiltFact( rebuiltHmesh, levels );
+    fMesh * rebuilt = rebuiltFact.Create( );
+    OpenSubdiv::FarComputeController<xyzVV>::_DefaultController.Refine(rebuilt);
+
+    OpenSubdiv::FarComputeController<xyzVV>::_DefaultController.Refine(m);
+
+    char msg[64];
+    snprintf(msg, sizeof(msg), "sharpness %g", scale);
+
+    int count = compareRefined(msg, hmesh, m, fact, rebuiltHmesh, rebuilt, rebuiltFact);
+
+    delete rebuilt;
+    delete rebuiltHmesh;
+
+    return count;
+}
+
+//------------------------------------------------------------------------------
+// Animation mode : the FarMesh is created with the sharpness of the shape
+// cleared, then animated to the sharpness of the shape and to half of it with
+// UpdateSharpness. After each update, the refined vertices must match those
+// of a FarMesh rebuilt with the same sharpness. A mesh created with the
+// sharpness of the shape and animated back to smooth may not fit its tables :
+// a rejected update must then leave the FarMesh untouched.
+int checkAnimation( char const * msg, char const * shapestr, int levels, Scheme scheme=kCatmark ) {
+
+    printf("- %s (scheme=%d)\n", msg, scheme);
+
+    int count = 0,
+        numUpdated = 0,
+        numRejected = 0;
+
+    // from smooth to sharp
+    {
+        xyzmesh * hmesh = simpleHbr<xyzVV>(shapestr, scheme, 0);
+
+        coarseSharpness sharpness(hmesh);
+        sharpness.Apply(0.0f);
+
+        fMeshFactory fact( hmesh, levels );
+        fMesh * m = fact.Create( );
+
+        float const scales[] = { 1.0f, 0.5f, 0.0f };
+        for (int i=0; i<3; ++i) {
+            sharpness.Apply(scales[i], &fact);
+            if (fact.UpdateSharpness(m)) {
+                count += compareRebuilt(shapestr, levels, scheme, scales[i], hmesh, m, fact);
+                ++numUpdated;
+            } else
+                ++numRejected;
+        }
+
+        delete m;
+        delete hmesh;
+    }
+
+    // from sharp to smooth
+    {
+        xyzmesh * hmesh = simpleHbr<xyzVV>(shapestr, scheme, 0);
+
+        coarseSharpness sharpness(hmesh);
+
+        fMeshFactory fact( hmesh, levels );
+        fMesh * m = fact.Create( );
+
+        fSubdivision const * tables = m->GetSubdivisionTables();
+        std::vector<int> E_IT = tables->Get_E_IT(),
+                         V_ITa = tables->Get_V_ITa();
+        std::vector<unsigned int> V_IT = tables->Get_V_IT();
+        std::vector<float> E_W = tables->Get_E_W(),
+                           V_W = tables->Get_V_W();
+        OpenSubdiv::FarKernelBatchVector batches = m->GetKernelBatches();
+
+        sharpness.Apply(0.0f, &fact);
+        if (fact.UpdateSharpness(m)) {
+            count += compareRebuilt(shapestr, levels, scheme, 0.0f, hmesh, m, fact);
+            ++numUpdated;
+        } else {
+            bool untouched = E_IT==tables->Get_E_IT() and V_ITa==tables->Get_V_ITa() and
+                V_IT==tables->Get_V_IT() and E_W==tables->Get_E_W() and
+                V_W==tables->Get_V_W() and batches.size()==m->GetKernelBatches().size();
+            for (int i=0; untouched and i<(int)batches.size(); ++i) {
+                OpenSubdiv::FarKernelBatch const & a = batches[i],
+                                                 & b = m->GetKernelBatches()[i];
+                untouched = a.GetKernelType()==b.GetKernelType() and
+                    a.GetLevel()==b.GetLevel() and a.GetStart()==b.GetStart() and
+                    a.GetEnd()==b.GetEnd() and a.GetTableOffset()==b.GetTableOffset() and
+                    a.GetVertexOffset()==b.GetVertexOffset();
+            }
+            if (not untouched) {
+                printf("// rejected update modified the FarMesh\n");
+                count++;
+            }
+            ++numRejected;
+        }
+
+        delete m;
+        delete hmesh;
+    }
+
+    printf("  updates : %d in place, %d rejected\n", numUpdated, numRejected);
+    if (count==0)
+        printf("  success !\n");
+
+    return count;
+}
+
+//------------------------------------------------------------------------------
+// Returns the number of differences between the coarse topologies of two
+// meshes built from the same shape
+static int compareCoarse( xyzmesh * hmesh, xyzmesh * other ) {
+
+    if (hmesh->GetNumVertices()!=other->GetNumVertices() or
+        hmesh->GetNumCoarseFaces()!=other->GetNumCoarseFaces()) {
+        printf("// %d vertices and %d faces, %d and %d expected\n",
+            hmesh->GetNumVertices(), hmesh->GetNumCoarseFaces(),
+            other->GetNumVertices(), other->GetNumCoarseFaces());
+        return 1;
+    }
+
+    int count = 0;
+
+    for (int i=0; i<hmesh->GetNumCoarseFaces(); ++i) {
+        xyzface * f = hmesh->GetFace(i),
+                * g = other->GetFace(i);
+
+        bool same = f->GetNumVertices()==g->GetNumVertices() and
+                    f->GetPtexIndex()==g->GetPtexIndex() and
+                    f->IsHole()==g->IsHole();
+
+        for (int j=0; same and j<f->GetNumVertices(); ++j) {
+            xyzhalfedge * e = f->GetEdge(j),
+                        * h = g->GetEdge(j);
+            xyzface * fopp = e->GetRightFace(),
+                    * gopp = h->GetRightFace();
+            same = f->GetVertex(j)->GetID()==g->GetVertex(j)->GetID() and
+                   e->GetSharpness()==h->GetSharpness() and
+                   (fopp ? fopp->GetID() : -1)==(gopp ? gopp->GetID() : -1);
+        }
+        if (not same) {
+            printf("// face %d differs\n", i);
+            count++;
+        }
+    }
+
+    for (int i=0; i<hmesh->GetNumVertices(); ++i) {
+        xyzvertex * v = hmesh->GetVertex(i),
+                  * w = other->GetVertex(i);
+        if (not v or not w) {
+            if (v!=w) {
+                printf("// vertex %d differs\n", i);
+                count++;
+            }
+            continue;
+        }
+        if (v->GetSharpness()!=w->GetSharpness() or
+            v->GetValence()!=w->GetValence() or
+            v->GetMask(false)!=w->GetMask(false)) {
+            printf("// vertex %d differs\n", i);
+            count++;
+        }
+    }
+    return count;
+}
+
+//------------------------------------------------------------------------------
+// Bulk mode : the shape is built face by face with HbrMesh::NewFace and in bulk
+// with HbrMesh::NewFaces. Both coarse meshes must have the same topology and
+// refine to the same vertices.
+static int checkBulk( char const * msg, char const * shapestr, int levels, Scheme scheme=kCatmark ) {
+
+    printf("- %s (scheme=%d)\n", msg, scheme);
+
+    xyzmesh * hmesh = simpleHbr<xyzVV>(shapestr, scheme, 0);
+
+    shape * sh = shape::parseShape( shapestr );
+    xyzmesh * bulkHmesh = createMesh<xyzVV>(scheme);
+    createVertices<xyzVV>(sh, bulkHmesh, 0);
+    createTopologyBulk<xyzVV>(sh, bulkHmesh, scheme);
+    delete sh;
+
+    int count = compareCoarse(bulkHmesh, hmesh);
+
+    if (count==0) {
+        fMeshFactory fact( hmesh, levels ),
+                     bulkFact( bulkHmesh, levels );
+
+        fMesh * m = fact.Create( ),
+              * bulk = bulkFact.Create( );
+
+        OpenSubdiv::FarComputeController<xyzVV>::_DefaultController.Refine(m);
+        OpenSubdiv::FarComputeController<xyzVV>::_DefaultController.Refine(bulk);
+
+        count = compareRefined("bulk", bulkHmesh, bulk, bulkFact, hmesh, m, fact);
+
+        delete bulk;
+        delete m;
+    }
+
+    delete bulkHmesh;
+    delete hmesh;
+
+    if (count==0)
+        printf("  success !\n");
+
+    return count;
+}
+
+//------------------------------------------------------------------------------
+// Checks a shape in the mode selected on the command line
+static int checkShape( char const * msg, std::string const & shapestr, int levels, Scheme scheme=kCatmark ) {
+
+    if (g_animate)
+        return checkAnimation( msg, shapestr.c_str(), levels, scheme );
+
+    if (g_bulk)
+        return checkBulk( msg, shapestr.c_str(), levels, scheme );
+
+    return checkMesh( msg, simpleHbr<xyzVV>(shapestr.c_str(), scheme, 0), levels, scheme );
+}
+
 //------------------------------------------------------------------------------
 static void parseArgs(int argc, char ** argv) {
     if (argc>1) {
@@ -400,8 +754,16 @@ static void parseArgs(int argc, char ** argv) {
             else if (strcmp(argv[i],"-dumphbr")==0) {
                 g_debugmode=true;
                 g_dumphbr=true;
+            } else if (strcmp(argv[i],"-grids")==0) {
+                g_structuredGrids=true;
+            } else if (strcmp(argv[i],"-sparse")==0) {
+                g_sparse=true;
+            } else if (strcmp(argv[i],"-animate")==0) {
+                g_animate=true;
+            } else if (strcmp(argv[i],"-bulk")==0) {
+                g_bulk=true;
             } else {
-                printf("Unknown argument \"%s\". Valid arguments are [\"-debug\", \"-dumphbr\"].\n", argv[i]);
+                printf("Unknown argument \"%s\". Valid arguments are [\"-debug\", \"-dumphbr\", \"-grids\", \"-sparse\", \"-animate\", \"-bulk\"].\n", argv[i]);
                 exit(1);
             }
         }
@@ -455,166 +817,166 @@ int main(int argc, char ** argv) {
 
 #ifdef test_catmark_edgeonly
 #include "../shapes/catmark_edgeonly.h"
-    total += checkMesh( "test_catmark_edgeonly", simpleHbr<xyzVV>(catmark_edgeonly.c_str(), kCatmark, 0), levels );
+    total += checkShape( "test_catmark_edgeonly", catmark_edgeonly, levels );
 #endif
 
 #ifdef test_catmark_edgecorner
 #include "../shapes/catmark_edgecorner.h"
-    total += checkMesh( "test_catmark_edgeonly", simpleHbr<xyzVV>(catmark_edgecorner.c_str(), kCatmark, 0), levels );
+    total += checkShape( "test_catmark_edgeonly", catmark_edgecorner, levels );
 #endif
 
 #ifdef test_catmark_pyramid
 #include "../shapes/catmark_pyramid.h"
-    total += checkMesh( "test_catmark_pyramid", simpleHbr<xyzVV>(catmark_pyramid.c_str(), kCatmark, 0), levels );
+    total += checkShape( "test_catmark_pyramid", catmark_pyramid, levels );
 #endif
 
 #ifdef test_catmark_pyramid_creases0
 #include "../shapes/catmark_pyramid_creases0.h"
-    total += checkMesh( "test_catmark_pyramid_creases0", simpleHbr<xyzVV>(catmark_pyramid_creases0.c_str(), kCatmark, 0), levels );
+    total += checkShape( "test_catmark_pyramid_creases0", catmark_pyramid_creases0, levels );
 #endif
 
 #ifdef test_catmark_pyramid_creases1
 #include "../shapes/catmark_pyramid_creases1.h"
-    total += checkMesh( "test_catmark_pyramid_creases1", simpleHbr<xyzVV>(catmark_pyramid_creases1.c_str(), kCatmark, 0), levels );
+    total += checkShape( "test_catmark_pyramid_creases1", catmark_pyramid_creases1, levels );
 #endif
 
 #ifdef test_catmark_cube
 #include "../shapes/catmark_cube.h"
-    total += checkMesh( "test_catmark_cube", simpleHbr<xyzVV>(catmark_cube.c_str(), kCatmark, 0), levels );
+    total += checkShape( "test_catmark_cube", catmark_cube, levels );
 #endif
 
 #ifdef test_catmark_cube_creases0
 #include "../shapes/catmark_cube_creases0.h"
-    total += checkMesh( "test_catmark_cube_creases0", simpleHbr<xyzVV>(catmark_cube_creases0.c_str(), kCatmark, 0), levels );
+    total += checkShape( "test_catmark_cube_creases0", catmark_cube_creases0, levels );
 #endif
 
 #ifdef test_catmark_cube_creases1
 #include "../shapes/catmark_cube_creases1.h"
-    total += checkMesh( "test_catmark_cube_creases1", simpleHbr<xyzVV>(catmark_cube_creases1.c_str(), kCatmark, 0), levels );
+    total += checkShape( "test_catmark_cube_creases1", catmark_cube_creases1, levels );
 #endif
 
 #ifdef test_catmark_cube_corner0
 #include "../shapes/catmark_cube_corner0.h"
-    total += checkMesh( "test_catmark_cube_corner0", simpleHbr<xyzVV>(catmark_cube_corner0.c_str(), kCatmark, 0), levels );
+    total += checkShape( "test_catmark_cube_corner0", catmark_cube_corner0, levels );
 #endif
 
 #ifdef test_catmark_cube_corner1
 #include "../shapes/catmark_cube_corner1.h"
-    total += checkMesh( "test_catmark_cube_corner1", simpleHbr<xyzVV>(catmark_cube_corner1.c_str(), kCatmark, 0), levels );
+    total += checkShape( "test_catmark_cube_corner1", catmark_cube_corner1, levels );
 #endif
 
 #ifdef test_catmark_cube_corner2
 #include "../shapes/catmark_cube_corner2.h"
-    total += checkMesh( "test_catmark_cube_corner2", simpleHbr<xyzVV>(catmark_cube_corner2.c_str(), kCatmark, 0), levels );
+    total += checkShape( "test_catmark_cube_corner2", catmark_cube_corner2, levels );
 #endif
 
 #ifdef test_catmark_cube_corner3
 #include "../shapes/catmark_cube_corner3.h"
-    total += checkMesh( "test_catmark_cube_corner3", simpleHbr<xyzVV>(catmark_cube_corner3.c_str(), kCatmark, 0), levels );
+    total += checkShape( "test_catmark_cube_corner3", catmark_cube_corner3, levels );
 #endif
 
 #ifdef test_catmark_cube_corner4
 #include "../shapes/catmark_cube_corner4.h"
-    total += checkMesh( "test_catmark_cube_corner4", simpleHbr<xyzVV>(catmark_cube_corner4.c_str(), kCatmark, 0), levels );
+    total += checkShape( "test_catmark_cube_corner4", catmark_cube_corner4, levels );
 #endif
 
 #ifdef test_catmark_dart_edgecorner
 #include "../shapes/catmark_dart_edgecorner.h"
-    total += checkMesh( "test_catmark_dart_edgecorner", simpleHbr<xyzVV>(catmark_dart_edgecorner.c_str(), kCatmark, 0), levels );
+    total += checkShape( "test_catmark_dart_edgecorner", catmark_dart_edgecorner, levels );
 #endif
 
 #ifdef test_catmark_dart_edgeonly
 #include "../shapes/catmark_dart_edgeonly.h"
-    total += checkMesh( "test_catmark_dart_edgeonly", simpleHbr<xyzVV>(catmark_dart_edgeonly.c_str(), kCatmark, 0), levels );
+    total += checkShape( "test_catmark_dart_edgeonly", catmark_dart_edgeonly, levels );
 #endif
 
 #ifdef test_catmark_flap
 #include "../shapes/catmark_flap.h"
-    total += checkMesh( "test_catmark_flap", simpleHbr<xyzVV>(catmark_flap.c_str(), kCatmark, 0), levels);
+    total += checkShape( "test_catmark_flap", catmark_flap, levels );
 #endif
 
 #ifdef test_catmark_tent
 #include "../shapes/catmark_tent.h"
-    total += checkMesh( "test_catmark_tent", simpleHbr<xyzVV>(catmark_tent.c_str(), kCatmark, 0), levels );
+    total += checkShape( "test_catmark_tent", catmark_tent, levels );
 #endif
 
 #ifdef test_catmark_tent_creases0
 #include "../shapes/catmark_tent_creases0.h"
-    total += checkMesh( "test_catmark_tent_creases0", simpleHbr<xyzVV>(catmark_tent_creases0.c_str(), kCatmark, 0), levels );
+    total += checkShape( "test_catmark_tent_creases0", catmark_tent_creases0, levels );
 #endif
 
 #ifdef test_catmark_tent_creases1
 #include "../shapes/catmark_tent_creases1.h"
-    total += checkMesh( "test_catmark_tent_creases1", simpleHbr<xyzVV>(catmark_tent_creases1.c_str(), kCatmark, NULL), levels );
+    total += checkShape( "test_catmark_tent_creases1", catmark_tent_creases1, levels );
 #endif
 
 #ifdef test_catmark_square_hedit0
 #include "../shapes/catmark_square_hedit0.h"
-    total += checkMesh( "test_catmark_square_hedit0", simpleHbr<xyzVV>(catmark_square_hedit0.c_str(), kCatmark, 0), levels );
+    total += checkShape( "test_catmark_square_hedit0", catmark_square_hedit0, levels );
 #endif
 
 #ifdef test_catmark_square_hedit1
 #include "../shapes/catmark_square_hedit1.h"
-    total += checkMesh( "test_catmark_square_hedit1", simpleHbr<xyzVV>(catmark_square_hedit1.c_str(), kCatmark, 0), levels );
+    total += checkShape( "test_catmark_square_hedit1", catmark_square_hedit1, levels );
 #endif
 
 #ifdef test_catmark_square_hedit2
 #include "../shapes/catmark_square_hedit2.h"
-    total += checkMesh( "test_catmark_square_hedit2", simpleHbr<xyzVV>(catmark_square_hedit2.c_str(), kCatmark, 0), levels );
+    total += checkShape( "test_catmark_square_hedit2", catmark_square_hedit2, levels );
 #endif
 
 #ifdef test_catmark_square_hedit3
 #include "../shapes/catmark_square_hedit3.h"
-    total += checkMesh( "test_catmark_square_hedit3", simpleHbr<xyzVV>(catmark_square_hedit3.c_str(), kCatmark, 0), levels );
+    total += checkShape( "test_catmark_square_hedit3", catmark_square_hedit3, levels );
 #endif
 
 
 
 #ifdef test_loop_triangle_edgeonly
 #include "../shapes/loop_triangle_edgeonly.h"
-    total += checkMesh( "test_loop_triangle_edgeonly", simpleHbr<xyzVV>(loop_triangle_edgeonly.c_str(), kLoop, 0), levels, kLoop );
+    total += checkShape( "test_loop_triangle_edgeonly", loop_triangle_edgeonly, levels, kLoop );
 #endif
 
 #ifdef test_loop_triangle_edgecorner
 #include "../shapes/loop_triangle_edgecorner.h"
-    total += checkMesh( "test_loop_triangle_edgecorner", simpleHbr<xyzVV>(loop_triangle_edgecorner.c_str(), kLoop, 0), levels, kLoop );
+    total += checkShape( "test_loop_triangle_edgecorner", loop_triangle_edgecorner, levels, kLoop );
 #endif
 
 #ifdef test_loop_saddle_edgeonly
 #include "../shapes/loop_saddle_edgeonly.h"
-    total += checkMesh( "test_loop_saddle_edgeonly", simpleHbr<xyzVV>(loop_saddle_edgeonly.c_str(), kLoop, 0), levels, kLoop );
+    total += checkShape( "test_loop_saddle_edgeonly", loop_saddle_edgeonly, levels, kLoop );
 #endif
 
 #ifdef test_loop_saddle_edgecorner
 #include "../shapes/loop_saddle_edgecorner.h"
-    total += checkMesh( "test_loop_saddle_edgecorner", simpleHbr<xyzVV>(loop_saddle_edgecorner.c_str(), kLoop, 0), levels, kLoop );
+    total += checkShape( "test_loop_saddle_edgecorner", loop_saddle_edgecorner, levels, kLoop );
 #endif
 
 #ifdef test_loop_icosahedron
 #include "../shapes/loop_icosahedron.h"
-    total += checkMesh( "test_loop_icosahedron", simpleHbr<xyzVV>(loop_icosahedron.c_str(), kLoop, 0), levels, kLoop );
+    total += checkShape( "test_loop_icosahedron", loop_icosahedron, levels, kLoop );
 #endif
 
 #ifdef test_loop_cube
 #include "../shapes/loop_cube.h"
-    total += checkMesh( "test_loop_cube", simpleHbr<xyzVV>(loop_cube.c_str(), kLoop, 0), levels, kLoop );
+    total += checkShape( "test_loop_cube", loop_cube, levels, kLoop );
 #endif
 
 #ifdef test_loop_cube_creases0
 #include "../shapes/loop_cube_creases0.h"
-    total += checkMesh( "test_loop_cube_creases0", simpleHbr<xyzVV>(loop_cube_creases0.c_str(), kLoop, 0), levels, kLoop );
+    total += checkShape( "test_loop_cube_creases0", loop_cube_creases0, levels, kLoop );
 #endif
 
 #ifdef test_loop_cube_creases1
 #include "../shapes/loop_cube_creases1.h"
-    total += checkMesh( "test_loop_cube_creases1", simpleHbr<xyzVV>(loop_cube_creases1.c_str(), kLoop, 0), levels, kLoop );
+    total += checkShape( "test_loop_cube_creases1", loop_cube_creases1, levels, kLoop );
 #endif
 
 
 
 #ifdef test_bilinear_cube
 #include "../shapes/bilinear_cube.h"
-    total += checkMesh( "test_bilinear_cube", simpleHbr<xyzVV>(bilinear_cube.c_str(), kBilinear, 0), levels, kBilinear );
+    total += checkShape( "test_bilinear_cube", bilinear_cube, levels, kBilinear );
 #endif
 
 
@@ -626,6 +988,8 @@ int main(int argc, char ** argv) {
         else
           printf("Total failures : %d\n", total);
     }
+
+    return total==0 ? 0 : 1;
 }
 
 //------------------------------------------------------------------------------
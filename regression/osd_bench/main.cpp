@@ -0,0 +1,828 @@
+//
+//     Copyright 2013 Pixar
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License
+//     and the following modification to it: Section 6 Trademarks.
+//     deleted and replaced with:
+//
+//     6. Trademarks. This License does not grant permission to use the
+//     trade names, trademarks, service marks, or product names of the
+//     Licensor and its affiliates, except as required for reproducing
+//     the content of the NOTICE file.
+//
+//     You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//     Unless required by applicable law or agreed to in writing,
+//     software distributed under the License is distributed on an
+//     "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+//     either express or implied.  See the License for the specific
+//     language governing permissions and limitations under the
+//     License.
+
+//
+// Headless benchmark of the CPU code paths : runs over the regression shapes
+// corpus and a set of synthetic meshes, and times the following stages for
+// each subdivision level :
+//
+// - parsing of the shape and HbrMesh construction, both serial and with the
+//   parallel parser and the bulk HbrMesh construction
+// - FarMeshFactory construction & FarMeshFactory::Create
+// - OsdCpuComputeContext creation
+// - Refine with every available CPU compute controller
+// - batch and single-sample limit evaluation (feature-adaptive catmark only)
+//
+// The results, along with the peak resident set size of the process, are
+// written as JSON to stdout (or to the file given with -o).
+//
+// On multi-socket machines, -numa selects the placement of the CPU buffers
+// and tables, -pin pins the openmp threads and -scaling times the openmp
+// controller over an increasing number of threads. -alloc selects the
+// allocator of the CPU buffers and tables (pooled, optionally on huge pages).
+// -structured refines the regular regions of the uniform meshes with
+// structured grids instead of the indexing tables. -compress evaluates the
+// limit with a compressed patch table ; the compression ratio of the patch
+// table is reported for every feature-adaptive shape. -obj adds shapes read
+// from (memory mapped) obj files to the corpus.
+//
+// The correctness checks of these code paths live in cpu_regression.
+//
+
+#if defined(_WIN32)
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <far/meshFactory.h>
+#include <far/kernelBatchProfiler.h>
+#include <far/factoryStats.h>
+#include <far/compressedPatchTable.h>
+
+#include <osd/clock.h>
+#include <osd/vertex.h>
+#include <osd/cpuVertexBuffer.h>
+#include <osd/cpuComputeContext.h>
+#include <osd/cpuComputeController.h>
+#include <osd/cpuAllocator.h>
+#include <osd/cpuNuma.h>
+#include <osd/cpuEvalLimitContext.h>
+#include <osd/cpuEvalLimitController.h>
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    #include <osd/ompComputeController.h>
+#endif
+
+#ifdef OPENSUBDIV_HAS_GCD
+    #include <osd/gcdComputeController.h>
+#endif
+
+#include "../common/shape_utils.h"
+
+using namespace OpenSubdiv;
+
+typedef HbrMesh<OsdVertex>     OsdHbrMesh;
+typedef FarMesh<OsdVertex>     OsdFarMesh;
+typedef FarMeshFactory<OsdVertex> OsdFarMeshFactory;
+
+//------------------------------------------------------------------------------
+struct shaperec {
+
+    shaperec(char const * iname, std::string const & idata, Scheme ischeme) :
+        name(iname), data(idata), scheme(ischeme) { }
+
+    std::string name,
+                data;
+    Scheme      scheme;
+};
+
+static std::vector<shaperec> g_shapes;
+
+#include "../shapes/bilinear_cube.h"
+#include "../shapes/catmark_bishop.h"
+#include "../shapes/catmark_car.h"
+#include "../shapes/catmark_cube_corner0.h"
+#include "../shapes/catmark_cube_corner1.h"
+#include "../shapes/catmark_cube_corner2.h"
+#include "../shapes/catmark_cube_corner3.h"
+#include "../shapes/catmark_cube_corner4.h"
+#include "../shapes/catmark_cube_creases0.h"
+#include "../shapes/catmark_cube_creases1.h"
+#include "../shapes/catmark_cube.h"
+#include "../shapes/catmark_dart_edgecorner.h"
+#include "../shapes/catmark_dart_edgeonly.h"
+#include "../shapes/catmark_edgecorner.h"
+#include "../shapes/catmark_edgeonly.h"
+#include "../shapes/catmark_flap.h"
+#include "../shapes/catmark_flap2.h"
+#include "../shapes/catmark_gregory_test1.h"
+#include "../shapes/catmark_gregory_test2.h"
+#include "../shapes/catmark_gregory_test3.h"
+#include "../shapes/catmark_gregory_test4.h"
+#include "../shapes/catmark_helmet.h"
+#include "../shapes/catmark_hole_test1.h"
+#include "../shapes/catmark_hole_test2.h"
+#include "../shapes/catmark_pawn.h"
+#include "../shapes/catmark_pyramid_creases0.h"
+#include "../shapes/catmark_pyramid_creases1.h"
+#include "../shapes/catmark_pyramid.h"
+#include "../shapes/catmark_rook.h"
+#include "../shapes/catmark_square_hedit0.h"
+#include "../shapes/catmark_square_hedit1.h"
+#include "../shapes/catmark_square_hedit2.h"
+#include "../shapes/catmark_square_hedit3.h"
+#include "../shapes/catmark_square_hedit4.h"
+#include "../shapes/catmark_tent_creases0.h"
+#include "../shapes/catmark_tent_creases1.h"
+#include "../shapes/catmark_tent.h"
+#include "../shapes/catmark_torus.h"
+#include "../shapes/catmark_torus_creases0.h"
+#include "../shapes/loop_cube_creases0.h"
+#include "../shapes/loop_cube_creases1.h"
+#include "../shapes/loop_cube.h"
+#include "../shapes/loop_icosahedron.h"
+#include "../shapes/loop_saddle_edgecorner.h"
+#include "../shapes/loop_saddle_edgeonly.h"
+#include "../shapes/loop_triangle_edgecorner.h"
+#include "../shapes/loop_triangle_edgeonly.h"
+
+//------------------------------------------------------------------------------
+static void initShapes() {
+    g_shapes.push_back( shaperec("bilinear_cube",            bilinear_cube,            kBilinear) );
+    g_shapes.push_back( shaperec("catmark_bishop",           catmark_bishop,           kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_car",              catmark_car,              kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_cube_corner0",     catmark_cube_corner0,     kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_cube_corner1",     catmark_cube_corner1,     kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_cube_corner2",     catmark_cube_corner2,     kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_cube_corner3",     catmark_cube_corner3,     kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_cube_corner4",     catmark_cube_corner4,     kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_cube_creases0",    catmark_cube_creases0,    kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_cube_creases1",    catmark_cube_creases1,    kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_cube",             catmark_cube,             kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_dart_edgecorner",  catmark_dart_edgecorner,  kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_dart_edgeonly",    catmark_dart_edgeonly,    kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_edgecorner",       catmark_edgecorner,       kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_edgeonly",         catmark_edgeonly,         kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_flap",             catmark_flap,             kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_flap2",            catmark_flap2,            kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_gregory_test1",    catmark_gregory_test1,    kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_gregory_test2",    catmark_gregory_test2,    kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_gregory_test3",    catmark_gregory_test3,    kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_gregory_test4",    catmark_gregory_test4,    kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_helmet",           catmark_helmet,           kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_hole_test1",       catmark_hole_test1,       kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_hole_test2",       catmark_hole_test2,       kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_pawn",             catmark_pawn,             kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_pyramid_creases0", catmark_pyramid_creases0, kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_pyramid_creases1", catmark_pyramid_creases1, kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_pyramid",          catmark_pyramid,          kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_rook",             catmark_rook,             kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_square_hedit0",    catmark_square_hedit0,    kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_square_hedit1",    catmark_square_hedit1,    kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_square_hedit2",    catmark_square_hedit2,    kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_square_hedit3",    catmark_square_hedit3,    kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_square_hedit4",    catmark_square_hedit4,    kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_tent_creases0",    catmark_tent_creases0 ,   kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_tent_creases1",    catmark_tent_creases1 ,   kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_tent",             catmark_tent,             kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_torus",            catmark_torus,            kCatmark ) );
+    g_shapes.push_back( shaperec("catmark_torus_creases0",   catmark_torus_creases0,   kCatmark ) );
+    g_shapes.push_back( shaperec("loop_cube_creases0",       loop_cube_creases0,       kLoop    ) );
+    g_shapes.push_back( shaperec("loop_cube_creases1",       loop_cube_creases1,       kLoop    ) );
+    g_shapes.push_back( shaperec("loop_cube",                loop_cube,                kLoop    ) );
+    g_shapes.push_back( shaperec("loop_icosahedron",         loop_icosahedron,         kLoop    ) );
+    g_shapes.push_back( shaperec("loop_saddle_edgecorner",   loop_saddle_edgecorner,   kLoop    ) );
+    g_shapes.push_back( shaperec("loop_saddle_edgeonly",     loop_saddle_edgeonly,     kLoop    ) );
+    g_shapes.push_back( shaperec("loop_triangle_edgecorner", loop_triangle_edgecorner, kLoop    ) );
+    g_shapes.push_back( shaperec("loop_triangle_edgeonly",   loop_triangle_edgeonly,   kLoop    ) );
+}
+
+//------------------------------------------------------------------------------
+// Generates a planar grid of (approximately) nfaces quads, or twice as many
+// triangles for the loop scheme, in the obj format expected by parseShape()
+static std::string genGridShape(int nfaces, Scheme scheme) {
+
+    int res = 1;
+    while (res*res < nfaces)
+        ++res;
+
+    std::stringstream ss;
+
+    for (int j=0; j<=res; ++j) {
+        for (int i=0; i<=res; ++i) {
+            ss << "v " << (float)i/(float)res << " " << (float)j/(float)res << " 0\n";
+        }
+    }
+
+    for (int j=0; j<res; ++j) {
+        for (int i=0; i<res; ++i) {
+            int v0 = j*(res+1)+i+1, // obj indices are 1-based
+                v1 = v0+1,
+                v2 = v1+res+1,
+                v3 = v0+res+1;
+            if (scheme==kLoop) {
+                ss << "f " << v0 << " " << v1 << " " << v2 << "\n";
+                ss << "f " << v0 << " " << v2 << " " << v3 << "\n";
+            } else {
+                ss << "f " << v0 << " " << v1 << " " << v2 << " " << v3 << "\n";
+            }
+        }
+    }
+    return ss.str();
+}
+
+//------------------------------------------------------------------------------
+static char const * getSchemeName(Scheme scheme) {
+    switch (scheme) {
+        case kBilinear : return "bilinear";
+        case kCatmark  : return "catmark";
+        case kLoop     : return "loop";
+    }
+    return "unknown";
+}
+
+//------------------------------------------------------------------------------
+// Returns the peak resident set size of the process in kilobytes
+static long getPeakRSS() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return (long)(counters.PeakWorkingSetSize / 1024);
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage)!=0)
+        return 0;
+#if defined(__APPLE__)
+    return (long)(usage.ru_maxrss / 1024); // bytes on OSX
+#else
+    return (long)usage.ru_maxrss;
+#endif
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Command line options
+static int  g_level = 3,
+            g_repeats = 5,
+            g_samplesPerFace = 4;
+
+static bool g_skipCorpus = false,
+            g_pinThreads = false,
+            g_scaling = false,
+            g_structuredGrids = false,
+            g_compressPatchTable = false;
+
+static std::vector<int> g_gridSizes;
+
+static std::vector<char const *> g_objFiles;
+
+static char const * g_output = 0,
+                  * g_traceOutput = 0,
+                  * g_phasesOutput = 0;
+
+static FILE * g_out = stdout;
+
+static OsdCpuPoolAllocator * g_poolAllocator = 0;
+
+// per-batch instrumentation is only attached to the contexts on request so
+// that the refine timings are not skewed by default
+static FarKernelBatchProfiler * g_profiler = 0;
+
+//------------------------------------------------------------------------------
+// Writes a string to the JSON output as a quoted JSON string : the names of
+// the -obj shapes are file paths
+static void writeJsonString(char const * str) {
+
+    fputc('"', g_out);
+    for (; *str; ++str) {
+        unsigned char c = (unsigned char)*str;
+        if (c=='"' or c=='\\')
+            fprintf(g_out, "\\%c", c);
+        else if (c<0x20)
+            fprintf(g_out, "\\u%04x", c);
+        else
+            fputc(c, g_out);
+    }
+    fputc('"', g_out);
+}
+
+//------------------------------------------------------------------------------
+// Parses the shape and builds the HbrMesh, recording both times. If requested,
+// the shape is also parsed with the parallel parser and built with the bulk
+// HbrMesh path, which are timed and discarded.
+static OsdHbrMesh *
+createHbrMesh(shaperec const & rec, std::vector<float> & verts,
+              double & parseTime, double & createTime,
+              double * parallelParseTime=0, double * bulkCreateTime=0) {
+
+    FarStopwatch timer;
+
+    timer.Start();
+    shape * sh = shape::parseShape( rec.data.c_str() );
+    parseTime = timer.GetElapsed()*1000.0;
+
+    timer.Start();
+    OsdHbrMesh * mesh = createMesh<OsdVertex>(rec.scheme);
+
+    createVertices<OsdVertex>(sh, mesh, verts);
+
+    createTopology<OsdVertex>(sh, mesh, rec.scheme);
+    createTime = timer.GetElapsed()*1000.0;
+
+    copyVertexPositions<OsdVertex>(sh, mesh, verts);
+
+    delete sh;
+
+    if (parallelParseTime and bulkCreateTime) {
+        timer.Start();
+        shape * sh = parseShapeParallel( rec.data.c_str(), rec.data.size() );
+        *parallelParseTime = timer.GetElapsed()*1000.0;
+
+        std::vector<float> bulkVerts;
+
+        timer.Start();
+        OsdHbrMesh * bulkMesh = createMesh<OsdVertex>(rec.scheme);
+
+        createVertices<OsdVertex>(sh, bulkMesh, bulkVerts);
+
+        createTopologyBulk<OsdVertex>(sh, bulkMesh, rec.scheme);
+        *bulkCreateTime = timer.GetElapsed()*1000.0;
+
+        delete bulkMesh;
+        delete sh;
+    }
+
+    return mesh;
+}
+
+//------------------------------------------------------------------------------
+// Distributes the pages of a new vertex buffer across the NUMA nodes (only
+// the openmp controller runs its kernels on several sockets)
+template <class CONTROLLER> static void
+placeBuffer(CONTROLLER &, OsdFarMesh const *, OsdCpuVertexBuffer *) {
+}
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+static void
+placeBuffer(OsdOmpComputeController & controller, OsdFarMesh const * farmesh,
+            OsdCpuVertexBuffer * vbuffer) {
+
+    if (OsdCpuNuma::GetPlacement()==OsdCpuNuma::kPlacementFirstTouch)
+        controller.FirstTouch(farmesh->GetKernelBatches(), vbuffer);
+}
+#endif
+
+//------------------------------------------------------------------------------
+// Returns the best time (in ms) out of g_repeats refinements of the coarse
+// vertices with the given controller
+template <class CONTROLLER> static double
+benchRefine(CONTROLLER & controller, OsdCpuComputeContext * context,
+            OsdFarMesh const * farmesh, std::vector<float> const & coarse) {
+
+    int numElements = 3,
+        numCoarse = (int)coarse.size() / numElements;
+
+    OsdCpuVertexBuffer * vbuffer =
+        OsdCpuVertexBuffer::Create(numElements, farmesh->GetNumVertices());
+
+    placeBuffer(controller, farmesh, vbuffer);
+
+    double best = -1.0;
+
+    FarStopwatch timer;
+    for (int i=0; i<g_repeats; ++i) {
+
+        vbuffer->UpdateData(&coarse[0], 0, numCoarse);
+
+        timer.Start();
+        controller.Refine(context, farmesh->GetKernelBatches(), vbuffer);
+        controller.Synchronize();
+        double elapsed = timer.GetElapsed()*1000.0;
+
+        if (best<0.0 or elapsed<best)
+            best = elapsed;
+    }
+
+    delete vbuffer;
+
+    return best;
+}
+
+//------------------------------------------------------------------------------
+// Feature-adaptive limit evaluation : evaluates g_samplesPerFace^2 samples on
+// each ptex face, then evaluates a single sample repeatedly
+static void
+benchLimitEval(shaperec const & rec, int level) {
+
+    std::vector<float> coarse;
+    double parseTime, createTime;
+    OsdHbrMesh * hmesh = createHbrMesh(rec, coarse, parseTime, createTime);
+
+    FarStopwatch timer;
+
+    timer.Start();
+    OsdFarMeshFactory factory(hmesh, level, /*adaptive*/ true);
+    OsdFarMesh * farmesh = factory.Create();
+    double factoryTime = timer.GetElapsed()*1000.0;
+
+    OsdCpuComputeContext * computeContext = OsdCpuComputeContext::Create(farmesh);
+    computeContext->SetKernelBatchObserver(g_profiler);
+
+    int numElements = 3,
+        numPtexFaces = farmesh->GetNumPtexFaces(),
+        numSamples = numPtexFaces * g_samplesPerFace * g_samplesPerFace;
+
+    OsdCpuVertexBuffer * vbuffer =
+        OsdCpuVertexBuffer::Create(numElements, farmesh->GetNumVertices());
+    vbuffer->UpdateData(&coarse[0], 0, (int)coarse.size()/numElements);
+
+    OsdCpuComputeController computeController;
+    computeController.Refine(computeContext, farmesh->GetKernelBatches(), vbuffer);
+
+    timer.Start();
+    OsdCpuEvalLimitContext * evalContext = OsdCpuEvalLimitContext::Create(farmesh,
+        /*requireFVarData*/ false, /*referenceFarTables*/ false, g_compressPatchTable);
+    double contextTime = timer.GetElapsed()*1000.0;
+
+    FarCompressedPatchTable compressedPatchTable(*farmesh->GetPatchTables());
+
+    fprintf(g_out, ",\n      \"limit\" : { ");
+    fprintf(g_out, "\"far_create_ms\" : %g, ", factoryTime);
+    fprintf(g_out, "\"context_create_ms\" : %g, ", contextTime);
+    fprintf(g_out, "\"ptable_bytes\" : %lu, ",
+        (unsigned long)(farmesh->GetPatchTables()->GetPatchTable().size() * sizeof(unsigned int)));
+    fprintf(g_out, "\"compressed_ptable_bytes\" : %d, ", compressedPatchTable.GetMemoryUsed());
+    fprintf(g_out, "\"ptable_compression\" : %g, ", compressedPatchTable.GetCompressionRatio());
+
+    if (evalContext and numSamples>0) {
+
+        OsdCpuVertexBuffer * Q   = OsdCpuVertexBuffer::Create(numElements, numSamples),
+                           * dQu = OsdCpuVertexBuffer::Create(numElements, numSamples),
+                           * dQv = OsdCpuVertexBuffer::Create(numElements, numSamples);
+
+        OsdVertexBufferDescriptor desc(0, numElements, numElements);
+
+        evalContext->GetVertexData().Bind(desc, vbuffer, desc, Q, dQu, dQv);
+
+        OsdCpuEvalLimitController evalController;
+
+        std::vector<OsdEvalCoords> coords;
+        coords.reserve(numSamples);
+        for (int face=0; face<numPtexFaces; ++face) {
+            for (int j=0; j<g_samplesPerFace; ++j) {
+                for (int i=0; i<g_samplesPerFace; ++i) {
+                    coords.push_back( OsdEvalCoords( face,
+                        (i+0.5f)/(float)g_samplesPerFace,
+                        (j+0.5f)/(float)g_samplesPerFace ) );
+                }
+            }
+        }
+
+        // batch : every sample once
+        int found = 0;
+        timer.Start();
+        for (int i=0; i<numSamples; ++i) {
+            found += evalController.EvalLimitSample<OsdCpuVertexBuffer,
+                OsdCpuVertexBuffer>( coords[i], evalContext, i );
+        }
+        double batchTime = timer.GetElapsed()*1000.0;
+
+        // single-sample : the same location repeatedly
+        timer.Start();
+        for (int i=0; i<numSamples; ++i) {
+            evalController.EvalLimitSample<OsdCpuVertexBuffer,
+                OsdCpuVertexBuffer>( coords[0], evalContext, 0 );
+        }
+        double singleTime = timer.GetElapsed()*1000.0;
+
+        evalContext->GetVertexData().Unbind();
+
+        fprintf(g_out, "\"samples\" : %d, ", numSamples);
+        fprintf(g_out, "\"samples_found\" : %d, ", found);
+        fprintf(g_out, "\"batch_ms\" : %g, ", batchTime);
+        fprintf(g_out, "\"single_sample_us\" : %g ", singleTime*1000.0/numSamples);
+
+        delete Q;
+        delete dQu;
+        delete dQv;
+    } else {
+        fprintf(g_out, "\"samples\" : 0 ");
+    }
+    fprintf(g_out, "}");
+
+    delete evalContext;
+    delete vbuffer;
+    delete computeContext;
+    delete farmesh;
+    delete hmesh;
+}
+
+//------------------------------------------------------------------------------
+static void
+benchShape(shaperec const & rec, int level, bool first) {
+
+    std::vector<float> coarse;
+    double parseTime, hbrTime, parallelParseTime, bulkHbrTime;
+    OsdHbrMesh * hmesh = createHbrMesh(rec, coarse, parseTime, hbrTime,
+                                       &parallelParseTime, &bulkHbrTime);
+
+    int numCoarseFaces = hmesh->GetNumFaces();
+
+    FarStopwatch timer;
+
+    timer.Start();
+    FarMeshFactoryOptions options;
+    options.structuredGrids = g_structuredGrids;
+
+    OsdFarMeshFactory factory(hmesh, level, options);
+    OsdFarMesh * farmesh = factory.Create();
+    double factoryTime = timer.GetElapsed()*1000.0;
+
+    timer.Start();
+    OsdCpuComputeContext * context = OsdCpuComputeContext::Create(farmesh);
+    double contextTime = timer.GetElapsed()*1000.0;
+
+    context->SetKernelBatchObserver(g_profiler);
+
+    int numEditBatches = 0,
+        numEdits = 0;
+    FarVertexEditTables<OsdVertex> const * edits = farmesh->GetVertexEdit();
+    if (edits) {
+        numEditBatches = edits->GetNumBatches();
+        for (int i=0; i<numEditBatches; ++i)
+            numEdits += (int)edits->GetBatch(i).GetVertexIndices().size();
+    }
+
+    fprintf(g_out, "%s\n    { \"shape\" : ", first ? "" : ",");
+    writeJsonString(rec.name.c_str());
+    fprintf(g_out, ", \"scheme\" : \"%s\", \"level\" : %d,\n", getSchemeName(rec.scheme), level);
+    fprintf(g_out, "      \"coarse_faces\" : %d, \"vertices\" : %d, \"kernel_batches\" : %d, ",
+        numCoarseFaces, farmesh->GetNumVertices(), (int)farmesh->GetKernelBatches().size());
+    fprintf(g_out, "\"edit_batches\" : %d, \"edits\" : %d,\n", numEditBatches, numEdits);
+    fprintf(g_out, "      \"parse_ms\" : %g, \"hbr_create_ms\" : %g, ", parseTime, hbrTime);
+    fprintf(g_out, "\"parse_parallel_ms\" : %g, \"hbr_bulk_create_ms\" : %g,\n      ",
+        parallelParseTime, bulkHbrTime);
+    fprintf(g_out, "\"far_create_ms\" : %g, \"context_create_ms\" : %g,\n", factoryTime, contextTime);
+    fprintf(g_out, "      \"hbr_bytes\" : %lu, \"hbr_peak_bytes\" : %lu, ",
+        (unsigned long)hmesh->GetMemStats(),
+        (unsigned long)(hmesh->GetFaceAllocator().GetPeakMemoryUsed() +
+                        hmesh->GetVertexAllocator().GetPeakMemoryUsed() +
+                        hmesh->GetFaceChildrenAllocator().GetPeakMemoryUsed()));
+    fprintf(g_out, "\"far_bytes\" : %lu, \"context_bytes\" : %lu,\n",
+        (unsigned long)farmesh->GetMemoryUsage().GetTotal(),
+        (unsigned long)context->GetMemoryUsage().GetTotal());
+
+    fprintf(g_out, "      \"refine_ms\" : { ");
+    {
+        OsdCpuComputeController controller;
+        fprintf(g_out, "\"cpu\" : %g", benchRefine(controller, context, farmesh, coarse));
+    }
+#ifdef OPENSUBDIV_HAS_OPENMP
+    {
+        OsdOmpComputeController controller(-1, g_pinThreads);
+        fprintf(g_out, ", \"omp\" : %g", benchRefine(controller, context, farmesh, coarse));
+    }
+#endif
+#ifdef OPENSUBDIV_HAS_GCD
+    {
+        OsdGcdComputeController controller;
+        fprintf(g_out, ", \"gcd\" : %g", benchRefine(controller, context, farmesh, coarse));
+    }
+#endif
+    fprintf(g_out, " }");
+
+#ifdef OPENSUBDIV_HAS_OPENMP
+    if (g_scaling) {
+        // openmp refine time for 1, 2, 4... threads up to all the processors
+        fprintf(g_out, ",\n      \"omp_scaling_ms\" : { ");
+        int numProcs = omp_get_num_procs();
+        for (int n=1; ; n = (n*2 < numProcs) ? n*2 : numProcs) {
+            OsdOmpComputeController controller(n, g_pinThreads);
+            fprintf(g_out, "%s\"%d\" : %g", n==1 ? "" : ", ", n,
+                benchRefine(controller, context, farmesh, coarse));
+            if (n==numProcs)
+                break;
+        }
+        fprintf(g_out, " }");
+    }
+#endif
+
+    delete context;
+    delete farmesh;
+    delete hmesh;
+
+    // the feature-adaptive code path only supports catmark at this point
+    if (rec.scheme==kCatmark)
+        benchLimitEval(rec, level);
+
+    fprintf(g_out, ",\n      \"peak_rss_kb\" : %ld }", getPeakRSS());
+    fflush(g_out);
+}
+
+//------------------------------------------------------------------------------
+static void usage(char const * program) {
+    printf("Usage : %s [-l <level>] [-r <repeats>] [-s <samples>] [-g <nfaces>]... [-nocorpus] [-o <file>] [-trace <file>] [-phases <file>] [-numa <placement>] [-pin] [-scaling] [-alloc <allocator>] [-structured] [-compress]\n", program);
+    printf("    -l <level>     max subdivision level (default %d)\n", g_level);
+    printf("    -r <repeats>   number of refinements timed per controller (default %d)\n", g_repeats);
+    printf("    -s <samples>   limit samples per ptex face along u & v (default %d)\n", g_samplesPerFace);
+    printf("    -g <nfaces>    adds a synthetic grid of <nfaces> faces (can be repeated)\n");
+    printf("    -nocorpus      skips the regression shapes\n");
+    printf("    -obj <file>    adds a catmark shape read from an obj file (can be repeated)\n");
+    printf("    -o <file>      writes the JSON results to <file> instead of stdout\n");
+    printf("    -trace <file>  writes a Chrome trace of the kernel batches to <file>\n");
+    printf("    -phases <file> writes a Chrome trace of the Far factory phases to <file>\n");
+    printf("    -numa <placement> places the CPU buffers : default, interleave or firsttouch\n");
+    printf("    -pin           pins the openmp threads to the allowed CPUs\n");
+    printf("    -scaling       times the openmp refinement for 1, 2, 4... threads\n");
+    printf("    -alloc <allocator> CPU buffers allocator : default, pool, pool-thp or pool-hugetlb\n");
+    printf("    -structured    refines the regular regions with structured grids (uniform)\n");
+    printf("    -compress      evaluates the limit with a compressed patch table\n");
+}
+
+//------------------------------------------------------------------------------
+static void parseArgs(int argc, char ** argv) {
+    for (int i=1; i<argc; ++i) {
+        if (strcmp(argv[i],"-l")==0 and i+1<argc) {
+            g_level = atoi(argv[++i]);
+        } else if (strcmp(argv[i],"-r")==0 and i+1<argc) {
+            g_repeats = atoi(argv[++i]);
+        } else if (strcmp(argv[i],"-s")==0 and i+1<argc) {
+            g_samplesPerFace = atoi(argv[++i]);
+        } else if (strcmp(argv[i],"-g")==0 and i+1<argc) {
+            g_gridSizes.push_back(atoi(argv[++i]));
+        } else if (strcmp(argv[i],"-obj")==0 and i+1<argc) {
+            g_objFiles.push_back(argv[++i]);
+        } else if (strcmp(argv[i],"-nocorpus")==0) {
+            g_skipCorpus = true;
+        } else if (strcmp(argv[i],"-o")==0 and i+1<argc) {
+            g_output = argv[++i];
+        } else if (strcmp(argv[i],"-trace")==0 and i+1<argc) {
+            g_traceOutput = argv[++i];
+        } else if (strcmp(argv[i],"-phases")==0 and i+1<argc) {
+            g_phasesOutput = argv[++i];
+        } else if (strcmp(argv[i],"-numa")==0 and i+1<argc) {
+            ++i;
+            if (strcmp(argv[i],"default")==0) {
+                OsdCpuNuma::SetPlacement(OsdCpuNuma::kPlacementDefault);
+            } else if (strcmp(argv[i],"interleave")==0) {
+                OsdCpuNuma::SetPlacement(OsdCpuNuma::kPlacementInterleave);
+            } else if (strcmp(argv[i],"firsttouch")==0) {
+                OsdCpuNuma::SetPlacement(OsdCpuNuma::kPlacementFirstTouch);
+            } else {
+                usage(argv[0]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i],"-pin")==0) {
+            g_pinThreads = true;
+        } else if (strcmp(argv[i],"-scaling")==0) {
+            g_scaling = true;
+        } else if (strcmp(argv[i],"-structured")==0) {
+            g_structuredGrids = true;
+        } else if (strcmp(argv[i],"-compress")==0) {
+            g_compressPatchTable = true;
+        } else if (strcmp(argv[i],"-alloc")==0 and i+1<argc) {
+            ++i;
+            delete g_poolAllocator;
+            g_poolAllocator = 0;
+            if (strcmp(argv[i],"pool")==0) {
+                g_poolAllocator = new OsdCpuPoolAllocator();
+            } else if (strcmp(argv[i],"pool-thp")==0) {
+                g_poolAllocator = new OsdCpuPoolAllocator(OsdCpuPoolAllocator::kHugePagesTransparent);
+            } else if (strcmp(argv[i],"pool-hugetlb")==0) {
+                g_poolAllocator = new OsdCpuPoolAllocator(OsdCpuPoolAllocator::kHugePagesExplicit);
+            } else if (strcmp(argv[i],"default")!=0) {
+                usage(argv[0]);
+                exit(1);
+            }
+        } else {
+            usage(argv[0]);
+            exit(1);
+        }
+    }
+
+    if (g_level<1 or g_repeats<1 or g_samplesPerFace<1) {
+        usage(argv[0]);
+        exit(1);
+    }
+
+    if (g_gridSizes.empty()) {
+        g_gridSizes.push_back(256);
+        g_gridSizes.push_back(4096);
+    }
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char ** argv) {
+
+    parseArgs(argc, argv);
+
+    FarStopwatch::SetClock(OsdGetTime);
+
+    if (g_output) {
+        g_out = fopen(g_output, "w");
+        if (not g_out) {
+            printf("Cannot open \"%s\" for writing.\n", g_output);
+            return 1;
+        }
+    }
+
+    if (not g_skipCorpus)
+        initShapes();
+
+    for (int i=0; i<(int)g_objFiles.size(); ++i) {
+        mappedFile file(g_objFiles[i]);
+        if (not file.data) {
+            printf("Cannot read \"%s\".\n", g_objFiles[i]);
+            return 1;
+        }
+        g_shapes.push_back( shaperec(g_objFiles[i],
+            std::string(file.data, file.size), kCatmark) );
+    }
+
+    std::vector<std::string> gridNames;
+    for (int i=0; i<(int)g_gridSizes.size(); ++i) {
+        for (int s=0; s<2; ++s) {
+            Scheme scheme = s==0 ? kCatmark : kLoop;
+
+            std::stringstream name;
+            name << getSchemeName(scheme) << "_grid" << g_gridSizes[i];
+
+            g_shapes.push_back( shaperec(name.str().c_str(),
+                genGridShape(g_gridSizes[i], scheme), scheme) );
+        }
+    }
+
+    static char const * placementNames[] = { "default", "interleave", "firsttouch" };
+
+    fprintf(g_out, "{\n  \"osd_bench\" : { \"max_level\" : %d, \"repeats\" : %d, \"samples_per_face\" : %d,\n",
+        g_level, g_repeats, g_samplesPerFace);
+    fprintf(g_out, "                  \"numa_nodes\" : %d, \"numa_placement\" : \"%s\", \"pin_threads\" : %s },\n",
+        OsdCpuNuma::GetNumNodes(), placementNames[OsdCpuNuma::GetPlacement()],
+        g_pinThreads ? "true" : "false");
+    fprintf(g_out, "  \"results\" : [");
+
+    FarKernelBatchProfiler profiler;
+    if (g_traceOutput)
+        g_profiler = &profiler;
+
+    FarFactoryStats factoryStats;
+    if (g_phasesOutput)
+        FarFactoryStats::SetCurrent(&factoryStats);
+
+    if (g_poolAllocator)
+        OsdCpuAllocator::SetCurrent(g_poolAllocator);
+
+    bool first = true;
+    for (int i=0; i<(int)g_shapes.size(); ++i) {
+        for (int level=1; level<=g_level; ++level) {
+            benchShape(g_shapes[i], level, first);
+            first = false;
+        }
+    }
+
+    fprintf(g_out, "\n  ],\n");
+    if (g_poolAllocator) {
+        fprintf(g_out, "  \"pool\" : { \"hits\" : %d, \"misses\" : %d, \"pooled_bytes\" : %lu },\n",
+            g_poolAllocator->GetNumHits(), g_poolAllocator->GetNumMisses(),
+            (unsigned long)g_poolAllocator->GetPooledBytes());
+    }
+    fprintf(g_out, "  \"peak_rss_kb\" : %ld\n}\n", getPeakRSS());
+
+    // all the buffers have been released at this point
+    OsdCpuAllocator::SetCurrent(0);
+    delete g_poolAllocator;
+
+    if (g_out!=stdout)
+        fclose(g_out);
+
+    if (g_traceOutput) {
+        g_profiler = 0;
+
+        std::ofstream trace(g_traceOutput);
+        profiler.WriteChromeTrace(trace);
+
+        profiler.PrintStatistics(std::cerr);
+    }
+
+    if (g_phasesOutput) {
+        FarFactoryStats::SetCurrent(0);
+
+        std::ofstream trace(g_phasesOutput);
+        factoryStats.WriteChromeTrace(trace);
+    }
+
+    return 0;
+}